@@ -9,7 +9,7 @@ uniform mat4 u_projectionMat;
 uniform mat4 u_viewMat;
 uniform float u_scale;
 uniform float u_textSize;
-uniform vec2 u_viewport_size;
+uniform vec2 u_image_size;
 
 out vec2 v_texcoord;
 out float v_alpha;
@@ -19,7 +19,7 @@ void main()
     v_texcoord = texcoord;
     v_alpha = alpha;
 
-    float textScale = u_textSize / u_viewport_size.y;
+    float textScale = u_textSize / u_image_size.y;
 
     vec3 cameraPos = vec3(u_viewMat * vec4(position, 1.0));
     cameraPos.z += 0.7 * u_scale;
@@ -7,7 +7,14 @@ in highp vec3 v_position;
 flat in highp vec4 v_selection_id;
 flat in int v_selected;
 in float v_mask;
-out highp vec4 f_color;
+layout(location = 0) out highp vec4 f_color;
+// summed weights, only written during the weighted blended transparency pass
+layout(location = 1) out highp vec4 f_weight;
+
+// 0: all fragments, ordinary alpha blending
+// 1: opaque fragments only (transparent ones are deferred)
+// 2: transparent fragments only, weighted blended accumulation
+uniform int u_transparencyPass;
 
 #define SELECTION_OUTLINE 1
 #include "common.glsl"
@@ -19,6 +26,13 @@ vec3 applyMaskEffect(vec3 color, float maskValue) {
     return mix(color, color * darkenFactor, edgeFactor);
 }
 
+// McGuire & Bavoil (2013) depth weight; depth is inverted, so near is 1.0
+float transparencyWeight(float depth, float a) {
+    float z = 1.0 - depth;
+    return a * clamp(pow(min(1.0, a * 10.0) + 0.01, 3.0) * 1e8 *
+                     pow(1.0 - z * 0.9, 3.0), 1e-2, 3e3);
+}
+
 void main()
 {
     // Apply mask effect to base color and calculate alpha
@@ -29,4 +43,16 @@ void main()
     // Use unified shading
     f_color = calculateShading(u_renderMode, materialColor, u_cameraPosVec, v_position, v_normal, alpha, v_selection_id.xyz);
     f_color = applyFog(f_color, u_depthFogColor, u_depthFogOffset, u_depthFogDensity, gl_FragCoord.z);
+
+    bool opaque = alpha >= 0.999;
+    if (u_transparencyPass == 1 && !opaque) discard;
+    if (u_transparencyPass == 2) {
+        if (opaque) discard;
+        // with blend (ONE, ONE, ZERO, ONE_MINUS_SRC_ALPHA) the alpha channel
+        // of the first target accumulates the revealage product
+        float a = f_color.a;
+        float w = transparencyWeight(gl_FragCoord.z, a);
+        f_color = vec4(f_color.rgb * w, a);
+        f_weight = vec4(w, 0.0, 0.0, 0.0);
+    }
 }
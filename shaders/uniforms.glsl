@@ -1,6 +1,7 @@
 uniform float u_time;
 uniform float u_screenGamma;
 uniform vec2 u_viewport_size;
+uniform vec2 u_image_size;
 uniform float u_ortho;
 uniform float u_pointSize;
 uniform int u_renderMode;
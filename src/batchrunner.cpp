@@ -0,0 +1,560 @@
+#include "batchrunner.h"
+#include "chemicalstructure.h"
+#include "crystalx.h"
+#include "elementdata.h"
+#include "fingerprintplot.h"
+#include "isosurface_calculator.h"
+#include "mesh.h"
+#include "pair_energy_calculator.h"
+#include "project.h"
+#include "raytracer.h"
+#include "save_pair_energy_json.h"
+#include "settings.h"
+#include "streaming_image_writer.h"
+#include "structure_export_data.h"
+#include "taskmanager.h"
+#include "wavefunction_calculator.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QTimer>
+#include <QWidget>
+
+namespace impl {
+
+QStringList expandInputPattern(const QString &pattern,
+                               const QString &baseDirectory) {
+  QFileInfo info(pattern);
+  if (info.isRelative())
+    info = QFileInfo(QDir(baseDirectory), pattern);
+
+  if (!pattern.contains('*') && !pattern.contains('?') &&
+      !pattern.contains('[')) {
+    return {info.absoluteFilePath()};
+  }
+
+  QStringList result;
+  QDir dir = info.absoluteDir();
+  for (const auto &entry :
+       dir.entryInfoList({info.fileName()}, QDir::Files, QDir::Name)) {
+    result.append(entry.absoluteFilePath());
+  }
+  return result;
+}
+
+QString readString(const nlohmann::json &j, const char *key,
+                   const QString &fallback) {
+  if (!j.contains(key))
+    return fallback;
+  return QString::fromStdString(j.at(key).get<std::string>());
+}
+
+} // namespace impl
+
+BatchJob BatchJob::fromJson(const nlohmann::json &j,
+                            const QString &baseDirectory) {
+  BatchJob job;
+  if (j.contains("inputs")) {
+    const auto &inputs = j.at("inputs");
+    if (inputs.is_string()) {
+      job.inputs = impl::expandInputPattern(
+          QString::fromStdString(inputs.get<std::string>()), baseDirectory);
+    } else {
+      for (const auto &input : inputs) {
+        job.inputs.append(impl::expandInputPattern(
+            QString::fromStdString(input.get<std::string>()), baseDirectory));
+      }
+    }
+  }
+
+  QString outputDirectory =
+      impl::readString(j, "outputDirectory", job.outputDirectory);
+  if (QFileInfo(outputDirectory).isRelative())
+    outputDirectory = QDir(baseDirectory).filePath(outputDirectory);
+  job.outputDirectory = QDir::cleanPath(outputDirectory);
+
+  job.threads = j.value("threads", job.threads);
+  job.concurrentStructures =
+      std::max(1, j.value("concurrentStructures", job.concurrentStructures));
+  job.fingerprints = j.value("fingerprints", job.fingerprints);
+  job.saveProject = j.value("saveProject", job.saveProject);
+  if (j.contains("image")) {
+    const auto &image = j.at("image");
+    if (image.is_boolean()) {
+      job.image = image.get<bool>();
+    } else {
+      job.image = true;
+      job.imageWidth = std::max(1, image.value("width", job.imageWidth));
+      job.imageHeight = std::max(1, image.value("height", job.imageHeight));
+    }
+  }
+  job.timeoutSeconds = j.value("timeout", job.timeoutSeconds);
+
+  if (j.contains("surfaces")) {
+    const auto &s = j.at("surfaces");
+    if (s.is_boolean()) {
+      job.surfaces = s.get<bool>();
+    } else {
+      job.surfaces = true;
+      if (s.contains("kind"))
+        job.surfaceKind =
+            isosurface::stringToKind(impl::readString(s, "kind", "hirshfeld"));
+      job.isovalue = s.value("isovalue", job.isovalue);
+      if (s.contains("resolution")) {
+        job.separation = isosurface::resolutionValue(
+            isosurface::stringToResolution(
+                impl::readString(s, "resolution", "High")));
+      }
+      job.separation = s.value("separation", job.separation);
+    }
+  }
+
+  if (j.contains("energies")) {
+    const auto &e = j.at("energies");
+    if (e.is_object()) {
+      job.energyModel = impl::readString(e, "model", "ce-1p");
+      job.energyMethod = impl::readString(e, "method", job.energyMethod);
+      job.energyBasis = impl::readString(e, "basis", job.energyBasis);
+    } else if (e.is_string()) {
+      job.energyModel = QString::fromStdString(e.get<std::string>());
+    } else if (e.is_boolean() && e.get<bool>()) {
+      job.energyModel = "ce-1p";
+    }
+  }
+  return job;
+}
+
+bool BatchJob::loadFromFile(const QString &filename, BatchJob &job,
+                            QString &errorMessage) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    errorMessage = "Could not open batch job file: " + filename;
+    return false;
+  }
+  try {
+    auto j = nlohmann::json::parse(file.readAll().toStdString());
+    job = BatchJob::fromJson(j, QFileInfo(filename).absolutePath());
+  } catch (const std::exception &e) {
+    errorMessage =
+        QString("Could not parse batch job file %1: %2").arg(filename, e.what());
+    return false;
+  }
+  if (job.inputs.isEmpty()) {
+    errorMessage = "Batch job has no input files";
+    return false;
+  }
+  return true;
+}
+
+BatchRunner::BatchRunner(const BatchJob &job, QObject *parent)
+    : QObject(parent), m_job(job) {
+  m_taskManager = new TaskManager(this);
+  int threads = m_job.threads > 0 ? m_job.threads : QThread::idealThreadCount();
+  m_taskManager->setMaximumConcurrency(threads);
+}
+
+void BatchRunner::start() {
+  QString filename =
+      settings::readSetting(settings::keys::ELEMENTDATA_FILE).toString();
+  bool useJmolColors =
+      settings::readSetting(settings::keys::USE_JMOL_COLORS).toBool();
+  if (!ElementData::getData(filename, useJmolColors)) {
+    qWarning() << "Could not read element data from" << filename;
+  }
+
+  if (!QDir().mkpath(m_job.outputDirectory) ||
+      !QDir::setCurrent(m_job.outputDirectory)) {
+    qWarning() << "Could not use output directory" << m_job.outputDirectory;
+    m_failures = m_job.inputs.size();
+    emit finished(m_failures);
+    return;
+  }
+
+  m_summary = {{"outputDirectory", m_job.outputDirectory},
+               {"structures", nlohmann::json::array()}};
+  m_pending.clear();
+  for (const auto &input : m_job.inputs) {
+    m_pending.enqueue(input);
+  }
+  qDebug() << "Batch job with" << m_pending.size() << "structures,"
+           << m_taskManager->maximumConcurrency() << "threads";
+  startNextStructures();
+}
+
+void BatchRunner::startNextStructures() {
+  while (m_running < m_job.concurrentStructures && !m_pending.isEmpty()) {
+    QString filename = m_pending.dequeue();
+    QString name = QFileInfo(filename).completeBaseName();
+    // structures write their working files into the shared output directory
+    // under their own name, so names must be unique within the batch
+    if (m_names.contains(name))
+      name = QString("%1_%2").arg(name).arg(m_index);
+    m_names.insert(name);
+    m_index++;
+
+    auto *structureJob = new BatchStructureJob(filename, name, m_job,
+                                               m_taskManager, this);
+    connect(structureJob, &BatchStructureJob::finished, this,
+            [this, structureJob](bool success) {
+              structureFinished(structureJob, success);
+            });
+    m_running++;
+    structureJob->start();
+  }
+
+  if (m_running == 0 && m_pending.isEmpty() && !m_done) {
+    m_done = true;
+    writeSummary();
+    emit finished(m_failures);
+  }
+}
+
+void BatchRunner::structureFinished(BatchStructureJob *structureJob,
+                                    bool success) {
+  m_running--;
+  if (!success)
+    m_failures++;
+  m_summary["structures"].push_back(structureJob->summary());
+  qDebug() << "Finished" << structureJob->filename()
+           << (success ? "successfully" : "with errors");
+  // frees the structure's project, which can be large
+  structureJob->deleteLater();
+  // the next structure must not be started from within the signal emission
+  QTimer::singleShot(0, this, &BatchRunner::startNextStructures);
+}
+
+void BatchRunner::writeSummary() {
+  m_summary["failures"] = m_failures;
+  QFile file(QDir(m_job.outputDirectory).filePath("batch_summary.json"));
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Could not write batch summary to" << file.fileName();
+    return;
+  }
+  file.write(QByteArray::fromStdString(m_summary.dump(2)));
+}
+
+BatchStructureJob::BatchStructureJob(const QString &filename,
+                                     const QString &name, const BatchJob &job,
+                                     TaskManager *taskManager, QObject *parent)
+    : QObject(parent), m_filename(filename), m_name(name), m_job(job),
+      m_taskManager(taskManager) {
+  m_summary = {{"input", m_filename}, {"name", m_name}};
+  // the task manager is shared with the other structures, so only tasks
+  // added while this job is submitting work belong to it
+  connect(m_taskManager, &TaskManager::taskAdded, this, [this](TaskID id) {
+    if (m_submittingTasks)
+      m_tasks.append(id);
+  });
+}
+
+void BatchStructureJob::submitTasks(const std::function<void()> &submit) {
+  m_submittingTasks = true;
+  submit();
+  m_submittingTasks = false;
+}
+
+void BatchStructureJob::start() {
+  if (m_job.timeoutSeconds > 0) {
+    QTimer::singleShot(m_job.timeoutSeconds * 1000, this, [this]() {
+      finish(false, QString("Timed out after %1 s").arg(m_job.timeoutSeconds));
+    });
+  }
+
+  if (!loadStructure()) {
+    finish(false, "Could not load structure");
+    return;
+  }
+
+  auto *structure = m_project->currentStructure();
+  structure->setName(m_name);
+  m_project->completeFragmentsForCurrentCrystal();
+
+  // one surface per symmetry unique fragment, using the first complete
+  // fragment generated from each
+  QSet<int> seen;
+  for (const auto &[index, fragment] : structure->getFragments()) {
+    int u = fragment.asymmetricFragmentIndex.u;
+    if (seen.contains(u))
+      continue;
+    seen.insert(u);
+    m_pendingFragments.enqueue(index);
+  }
+  m_summary["fragments"] = m_pendingFragments.size();
+  m_summary["surfaces"] = nlohmann::json::array();
+
+  if (!m_job.surfaces)
+    m_pendingFragments.clear();
+  startNextSurface();
+}
+
+bool BatchStructureJob::loadStructure() {
+  m_project = new Project(this);
+  QFileInfo info(m_filename);
+  QString suffix = info.suffix().toLower();
+  bool success = false;
+  if (m_filename.endsWith(PROJECT_EXTENSION, Qt::CaseInsensitive)) {
+    success = m_project->loadFromFile(m_filename);
+  } else if (suffix == CIF_EXTENSION || suffix == CIF2_EXTENSION) {
+    success = m_project->loadCrystalStructuresFromCifFile(m_filename);
+  } else if (suffix == "pdb") {
+    success = m_project->loadCrystalStructuresFromPdbFile(m_filename);
+  } else if (suffix == XYZ_FILE_EXTENSION) {
+    success = m_project->loadChemicalStructureFromXyzFile(m_filename);
+  } else if (suffix == "gin") {
+    success = m_project->loadGulpInputFile(m_filename);
+  } else if (suffix == "json") {
+    success = m_project->loadCrystalClearJson(m_filename);
+  }
+  return success && m_project->currentStructure();
+}
+
+void BatchStructureJob::startNextSurface() {
+  if (m_finished)
+    return;
+  if (m_pendingFragments.isEmpty()) {
+    startEnergies();
+    return;
+  }
+
+  auto *structure = m_project->currentStructure();
+  m_currentFragment = m_pendingFragments.dequeue();
+  const auto &fragment = structure->getFragments().at(m_currentFragment);
+  structure->setFlagForAllAtoms(AtomFlag::Selected, false);
+  structure->setFlagForAtoms(fragment.atomIndices, AtomFlag::Selected);
+
+  isosurface::Parameters params;
+  params.kind = m_job.surfaceKind;
+  params.isovalue = m_job.isovalue;
+  params.separation = m_job.separation;
+  params.structure = structure;
+
+  auto *calc = new volume::IsosurfaceCalculator(this);
+  calc->setTaskManager(m_taskManager);
+  connect(calc, &volume::IsosurfaceCalculator::calculationComplete, this,
+          [this, calc](isosurface::Result result) {
+            calc->deleteLater();
+            surfaceFinished(result.success);
+          });
+  connect(calc, &volume::IsosurfaceCalculator::errorOccurred, this,
+          [this, calc](QString message) {
+            qWarning() << "Surface generation failed for" << m_name << message;
+            calc->deleteLater();
+            surfaceFinished(false);
+          });
+  submitTasks([calc, params]() { calc->start(params); });
+}
+
+void BatchStructureJob::surfaceFinished(bool success) {
+  if (m_finished)
+    return;
+  auto *structure = m_project->currentStructure();
+  const auto &fragment = structure->getFragments().at(m_currentFragment);
+  int u = fragment.asymmetricFragmentIndex.u;
+  nlohmann::json entry = {{"fragment", u}, {"success", success}};
+
+  if (success) {
+    // the calculator parents the new mesh to the structure
+    auto meshes = structure->findChildren<Mesh *>(Qt::FindDirectChildrenOnly);
+    Mesh *mesh = meshes.isEmpty() ? nullptr : meshes.last();
+    if (mesh) {
+      entry["area"] = mesh->surfaceArea();
+      entry["volume"] = mesh->volume();
+      entry["globularity"] = mesh->globularity();
+      entry["asphericity"] = mesh->asphericity();
+      if (m_job.fingerprints && m_job.surfaceKind == isosurface::Kind::Hirshfeld)
+        entry["fingerprint"] = fingerprintSummary(mesh);
+    }
+  }
+  m_summary["surfaces"].push_back(entry);
+  startNextSurface();
+}
+
+nlohmann::json BatchStructureJob::fingerprintSummary(Mesh *mesh) {
+  auto *structure = m_project->currentStructure();
+  QString filename = QString("%1_%2_fingerprint.png")
+                         .arg(m_name)
+                         .arg(m_summary["surfaces"].size());
+  // the plot resizes its parent whenever it is updated
+  QWidget container;
+  FingerprintPlot plot(&container);
+  plot.setMesh(mesh);
+  plot.saveFingerprint(filename);
+
+  QStringList symbols;
+  auto addSymbols = [&](const std::vector<GenericAtomIndex> &idxs) {
+    auto nums = structure->atomicNumbersForIndices(idxs);
+    for (int i = 0; i < nums.rows(); i++) {
+      auto *element = ElementData::elementFromAtomicNumber(nums(i));
+      if (element && !symbols.contains(element->symbol()))
+        symbols.append(element->symbol());
+    }
+  };
+  addSymbols(mesh->atomsInside());
+  addSymbols(mesh->atomsOutside());
+
+  // percentage contributions of inside -> outside element contacts
+  nlohmann::json breakdown;
+  const double total = mesh->surfaceArea();
+  for (const auto &inside : symbols) {
+    auto areas = plot.filteredAreas(inside, symbols);
+    for (int i = 0; i < areas.size(); i++) {
+      if (areas[i] <= 0.0)
+        continue;
+      QString key = inside + "..." + symbols[i];
+      breakdown[key.toStdString()] =
+          total > 0.0 ? 100.0 * areas[i] / total : 0.0;
+    }
+  }
+  return {{"image", filename}, {"breakdown", breakdown}};
+}
+
+void BatchStructureJob::startEnergies() {
+  if (m_finished)
+    return;
+  if (m_job.energyModel.isEmpty()) {
+    finish(true);
+    return;
+  }
+
+  auto *structure = m_project->currentStructure();
+  structure->ensureDimerMappingTableForCurrentExtent();
+  auto fragmentPairs = structure->findFragmentPairs();
+
+  pair_energy::EnergyModelParameters modelParameters;
+  modelParameters.model = m_job.energyModel;
+  modelParameters.pairs = fragmentPairs.uniquePairs;
+
+  // xtb and custom calculators work from the geometry alone
+  if (!modelParameters.isXtbModel() && !modelParameters.isCustomModel()) {
+    FragmentIndexSet wavefunctionsNeeded;
+    for (const auto &pair : fragmentPairs.uniquePairs) {
+      wavefunctionsNeeded.insert(pair.a.asymmetricFragmentIndex);
+      wavefunctionsNeeded.insert(pair.b.asymmetricFragmentIndex);
+    }
+    const auto &uniqueFragments = structure->symmetryUniqueFragments();
+    for (const auto &uniqueIndex : wavefunctionsNeeded) {
+      const auto &uniqueFrag = uniqueFragments.at(uniqueIndex);
+      wfn::Parameters params;
+      params.charge = uniqueFrag.state.charge;
+      params.multiplicity = uniqueFrag.state.multiplicity;
+      params.method = m_job.energyMethod;
+      params.basis = m_job.energyBasis;
+      params.structure = structure;
+      params.atoms = uniqueFrag.atomIndices;
+      params.accepted = true;
+      modelParameters.wavefunctions.push_back(params);
+    }
+  }
+  m_summary["pairs"] = modelParameters.pairs.size();
+
+  auto computePairs = [this, structure, modelParameters]() {
+    if (m_finished)
+      return;
+    std::vector<pair_energy::Parameters> energies;
+    if (!PairEnergyCalculator::resolvePairParameters(structure,
+                                                     modelParameters, energies)) {
+      finish(false, "Missing wavefunctions for pair energies");
+      return;
+    }
+    auto *calc = new PairEnergyCalculator(this);
+    calc->setTaskManager(m_taskManager);
+    connect(calc, &PairEnergyCalculator::calculationComplete, this,
+            [this, calc, structure]() {
+              calc->deleteLater();
+              QString filename = m_name + "_energies.json";
+              if (!save_pair_interactions_json(structure->pairInteractions(),
+                                               filename)) {
+                finish(false, "Could not write " + filename);
+                return;
+              }
+              m_summary["energies"] = filename;
+              finish(true);
+            });
+    connect(calc, &PairEnergyCalculator::errorOccurred, this,
+            [this](QString message) {
+              finish(false, "Pair energy calculation failed: " + message);
+            });
+    submitTasks([calc, &energies]() { calc->start_batch(energies); });
+  };
+
+  if (modelParameters.wavefunctions.empty()) {
+    computePairs();
+    return;
+  }
+  auto *wavefunctionCalc = new WavefunctionCalculator(this);
+  wavefunctionCalc->setTaskManager(m_taskManager);
+  connect(wavefunctionCalc, &WavefunctionCalculator::calculationComplete, this,
+          [wavefunctionCalc, computePairs]() {
+            wavefunctionCalc->deleteLater();
+            computePairs();
+          });
+  connect(wavefunctionCalc, &WavefunctionCalculator::errorOccurred, this,
+          [this](QString message) {
+            finish(false, "Wavefunction calculation failed: " + message);
+          });
+  submitTasks([wavefunctionCalc, &modelParameters]() {
+    wavefunctionCalc->start_batch(modelParameters.wavefunctions);
+  });
+}
+
+bool BatchStructureJob::renderImage() {
+  using cx::io::StreamingImageWriter;
+  // there is no window, so the structure and its surfaces are framed from
+  // the primitives themselves rather than from the view
+  const auto data =
+      cx::graphics::structureExportData(*m_project->currentStructure());
+  cx::graphics::RayTracerOptions options;
+  options.width = m_job.imageWidth;
+  options.height = m_job.imageHeight;
+  options.threads = m_taskManager->maximumConcurrency();
+  const auto camera = cx::graphics::RayTracerCamera::fitting(
+      data, static_cast<float>(options.width) / options.height);
+
+  QString filename = m_name + ".png";
+  StreamingImageWriter writer(filename, options.width, options.height,
+                              StreamingImageWriter::Format::PNG);
+  if (!writer.open())
+    return false;
+  const bool rendered = cx::graphics::RayTracer(data).render(
+      camera, options,
+      [&writer](const QImage &band, int) { return writer.writeRows(band); });
+  if (!rendered || !writer.finish())
+    return false;
+  m_summary["image"] = filename;
+  return true;
+}
+
+void BatchStructureJob::finish(bool success, const QString &message) {
+  if (m_finished)
+    return;
+  m_finished = true;
+
+  // nothing may still be working on the project once it is reported, e.g.
+  // after a timeout or when one of several wavefunctions failed
+  for (const auto &id : m_tasks) {
+    m_taskManager->cancel(id);
+  }
+  m_tasks.clear();
+
+  if (success && m_job.image && !renderImage()) {
+    success = false;
+    m_summary["error"] = "Could not write image " + m_name + ".png";
+  }
+
+  if (success && m_job.saveProject) {
+    QString filename = m_name + "." + PROJECT_EXTENSION;
+    if (m_project->saveToFile(filename)) {
+      m_summary["project"] = filename;
+    } else {
+      success = false;
+      m_summary["error"] = "Could not save project " + filename;
+    }
+  }
+  if (!message.isEmpty()) {
+    m_summary["error"] = message;
+    qWarning() << m_name << message;
+  }
+  m_summary["success"] = success;
+  emit finished(success);
+}
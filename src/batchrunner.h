@@ -0,0 +1,135 @@
+#pragma once
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+#include "fragment_index.h"
+#include "isosurface_parameters.h"
+#include "json.h"
+#include "taskmanager.h"
+
+class Project;
+class Mesh;
+
+/**
+ * \brief Description of a headless batch job
+ *
+ * Read from a JSON file passed to `CrystalExplorer --batch job.json`:
+ *
+ * \code{.json}
+ * {
+ *   "inputs": ["structures/*.cif", "extra/urea.cif"],
+ *   "outputDirectory": "results",
+ *   "threads": 16,
+ *   "concurrentStructures": 4,
+ *   "surfaces": {"kind": "hirshfeld", "isovalue": 0.5, "resolution": "High"},
+ *   "fingerprints": true,
+ *   "energies": {"model": "ce-1p", "method": "b3lyp", "basis": "6-31g(d,p)"},
+ *   "image": {"width": 2048, "height": 2048},
+ *   "saveProject": true,
+ *   "timeout": 3600
+ * }
+ * \endcode
+ */
+struct BatchJob {
+  QStringList inputs;
+  QString outputDirectory{"."};
+  int threads{0};               ///< 0 = all available cores
+  int concurrentStructures{1};
+  bool surfaces{true};
+  isosurface::Kind surfaceKind{isosurface::Kind::Hirshfeld};
+  float isovalue{0.5};
+  float separation{0.2};
+  bool fingerprints{true};
+  QString energyModel;          ///< empty = no pair energies, may name a custom calculator
+  QString energyMethod{"b3lyp"};
+  QString energyBasis{"6-31g(d,p)"};
+  bool image{false};            ///< ray traced figure of the structure
+  int imageWidth{1024};
+  int imageHeight{1024};
+  bool saveProject{true};
+  int timeoutSeconds{0};        ///< per structure, 0 = no limit
+
+  static BatchJob fromJson(const nlohmann::json &, const QString &baseDirectory);
+  static bool loadFromFile(const QString &filename, BatchJob &job,
+                           QString &errorMessage);
+};
+
+class BatchStructureJob;
+
+/**
+ * \brief Drives Project and the calculators without any windows
+ *
+ * Structures are processed concurrently, up to job.concurrentStructures at
+ * a time, sharing one TaskManager so the external programs they launch stay
+ * within the job's core budget.
+ */
+class BatchRunner : public QObject {
+  Q_OBJECT
+public:
+  explicit BatchRunner(const BatchJob &job, QObject *parent = nullptr);
+
+  void start();
+  inline int numberOfFailures() const { return m_failures; }
+
+signals:
+  void finished(int failures);
+
+private:
+  void startNextStructures();
+  void structureFinished(BatchStructureJob *, bool success);
+  void writeSummary();
+
+  BatchJob m_job;
+  TaskManager *m_taskManager{nullptr};
+  QQueue<QString> m_pending;
+  QSet<QString> m_names;
+  int m_running{0};
+  int m_failures{0};
+  int m_index{0};
+  bool m_done{false};
+  nlohmann::json m_summary;
+};
+
+/**
+ * \brief Load, compute and export a single structure within a batch job
+ */
+class BatchStructureJob : public QObject {
+  Q_OBJECT
+public:
+  BatchStructureJob(const QString &filename, const QString &name,
+                    const BatchJob &job, TaskManager *taskManager,
+                    QObject *parent = nullptr);
+
+  void start();
+  inline const QString &filename() const { return m_filename; }
+  inline const nlohmann::json &summary() const { return m_summary; }
+
+signals:
+  void finished(bool success);
+
+private:
+  bool loadStructure();
+  void startNextSurface();
+  void surfaceFinished(bool success);
+  void startEnergies();
+  bool renderImage();
+  void finish(bool success, const QString &message = {});
+  void submitTasks(const std::function<void()> &submit);
+  nlohmann::json fingerprintSummary(Mesh *);
+
+  QString m_filename;
+  QString m_name;
+  const BatchJob &m_job;
+  TaskManager *m_taskManager{nullptr};
+  Project *m_project{nullptr};
+  QQueue<FragmentIndex> m_pendingFragments;
+  FragmentIndex m_currentFragment;
+  QList<TaskID> m_tasks;
+  bool m_submittingTasks{false};
+  bool m_finished{false};
+  nlohmann::json m_summary;
+};
@@ -0,0 +1,79 @@
+#include "atom_spatial_index.h"
+#include <occ/core/kdtree.h>
+
+struct AtomSpatialIndex::Block {
+  Block(size_t off, occ::Mat3N pos)
+      : offset(off), positions(std::move(pos)),
+        tree(3, positions, occ::core::max_leaf) {
+    tree.index->buildIndex();
+  }
+
+  size_t offset{0};
+  occ::Mat3N positions; // must be declared before tree, which refers to it
+  occ::core::KDTree<double> tree;
+};
+
+AtomSpatialIndex::AtomSpatialIndex(const occ::Mat3N &positions) {
+  addBlock(positions);
+}
+
+std::shared_ptr<const AtomSpatialIndex>
+AtomSpatialIndex::appended(const occ::Mat3N &positions) const {
+  std::shared_ptr<AtomSpatialIndex> result(new AtomSpatialIndex());
+  result->m_blocks = m_blocks;
+  result->m_size = m_size;
+  result->addBlock(positions);
+  return result;
+}
+
+void AtomSpatialIndex::addBlock(const occ::Mat3N &positions) {
+  if (positions.cols() == 0)
+    return;
+
+  occ::Mat3N pending = positions;
+  size_t offset = m_size;
+  // merge with trailing blocks that are not at least twice as large, which
+  // keeps the number of blocks logarithmic in the number of atoms
+  while (!m_blocks.empty() &&
+         m_blocks.back()->positions.cols() < 2 * pending.cols()) {
+    const auto &last = *m_blocks.back();
+    occ::Mat3N merged(3, last.positions.cols() + pending.cols());
+    merged << last.positions, pending;
+    offset = last.offset;
+    pending = std::move(merged);
+    m_blocks.pop_back();
+  }
+  m_blocks.push_back(std::make_shared<const Block>(offset, std::move(pending)));
+  m_size += positions.cols();
+}
+
+void AtomSpatialIndex::radiusSearch(const occ::Vec3 &point, double radius,
+                                    std::vector<Neighbor> &result) const {
+  result.clear();
+  std::vector<Neighbor> blockResult;
+  for (const auto &block : m_blocks) {
+    nanoflann::RadiusResultSet results(radius * radius, blockResult);
+    block->tree.index->findNeighbors(results, point.data(),
+                                     nanoflann::SearchParams());
+    for (const auto &[idx, d2] : blockResult) {
+      result.emplace_back(block->offset + idx, d2);
+    }
+  }
+}
+
+std::pair<int, double>
+AtomSpatialIndex::nearest(const occ::Vec3 &point) const {
+  std::pair<int, double> best{-1, std::numeric_limits<double>::max()};
+  for (const auto &block : m_blocks) {
+    Eigen::Index idx{0};
+    double d2{0.0};
+    nanoflann::KNNResultSet<double, Eigen::Index> results(1);
+    results.init(&idx, &d2);
+    block->tree.index->findNeighbors(results, point.data(),
+                                     nanoflann::SearchParams());
+    if (d2 < best.second) {
+      best = {static_cast<int>(block->offset + idx), d2};
+    }
+  }
+  return best;
+}
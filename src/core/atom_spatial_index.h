@@ -0,0 +1,45 @@
+#pragma once
+#include <memory>
+#include <occ/core/linear_algebra.h>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief KD-tree over atomic positions that can be extended cheaply
+ *
+ * Positions are held in a small number of blocks, each with its own
+ * KD-tree, with block sizes kept roughly geometric so that appending atoms
+ * only rebuilds the most recent blocks. Blocks own a copy of their
+ * positions, so the source matrix may be resized or reallocated freely.
+ *
+ * An index is immutable once built: appended() returns a new index sharing
+ * the existing blocks, so a snapshot held by one thread stays valid while
+ * another produces the next one. All queries are const and thread safe.
+ */
+class AtomSpatialIndex {
+public:
+  // (atom index, squared distance)
+  using Neighbor = std::pair<size_t, double>;
+
+  explicit AtomSpatialIndex(const occ::Mat3N &positions);
+
+  [[nodiscard]] std::shared_ptr<const AtomSpatialIndex>
+  appended(const occ::Mat3N &positions) const;
+
+  [[nodiscard]] inline size_t size() const { return m_size; }
+
+  // Replaces the contents of result with all points within radius of point
+  void radiusSearch(const occ::Vec3 &point, double radius,
+                    std::vector<Neighbor> &result) const;
+
+  // Returns (atom index, squared distance), or (-1, max) if empty
+  [[nodiscard]] std::pair<int, double> nearest(const occ::Vec3 &point) const;
+
+private:
+  struct Block;
+  AtomSpatialIndex() = default;
+  void addBlock(const occ::Mat3N &positions);
+
+  std::vector<std::shared_ptr<const Block>> m_blocks;
+  size_t m_size{0};
+};
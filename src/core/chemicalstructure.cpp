@@ -44,10 +44,19 @@ void ChemicalStructure::updateBondGraph() {
   setAllFragmentColors(FragmentColorSettings{});
 }
 
-void ChemicalStructure::guessBondsBasedOnDistances() {
+std::shared_ptr<const AtomSpatialIndex>
+ChemicalStructure::spatialIndex() const {
+  QMutexLocker lock(&m_spatialIndexMutex);
+  if (!m_spatialIndex || m_spatialIndexGeneration != m_positionGeneration) {
+    m_spatialIndex =
+        std::make_shared<const AtomSpatialIndex>(m_atomicPositions);
+    m_spatialIndexGeneration = m_positionGeneration;
+  }
+  return m_spatialIndex;
+}
 
-  occ::core::KDTree<double> tree(3, m_atomicPositions, occ::core::max_leaf);
-  tree.index->buildIndex();
+void ChemicalStructure::guessBondsBasedOnDistances() {
+  const auto tree = spatialIndex();
   using VertexDesc = typename occ::core::graph::BondGraph::VertexDescriptor;
   using EdgeDesc = typename occ::core::graph::BondGraph::EdgeDescriptor;
   using Connection = occ::core::graph::Edge::Connection;
@@ -58,10 +67,9 @@ void ChemicalStructure::guessBondsBasedOnDistances() {
   occ::Vec vdw = vdwRadii();
   const double maxVdw = vdw.maxCoeff();
   // TODO allow changing buffer of 0.4
-  const double max_dist2 = (maxVdw * 2 + 0.4) * (maxVdw * 2 + 0.4);
+  const double max_dist = maxVdw * 2 + 0.4;
 
-  std::vector<std::pair<size_t, double>> idxs_dists;
-  nanoflann::RadiusResultSet results(max_dist2, idxs_dists);
+  std::vector<AtomSpatialIndex::Neighbor> idxs_dists;
 
   m_bondGraphVertices.clear();
   m_bondGraphEdges.clear();
@@ -129,8 +137,7 @@ void ChemicalStructure::guessBondsBasedOnDistances() {
   for (int a = 0; a < numberOfAtoms(); a++) {
     double cov_a = cov(a);
     double vdw_a = vdw(a);
-    const double *q = m_atomicPositions.col(a).data();
-    tree.index->findNeighbors(results, q, nanoflann::SearchParams());
+    tree->radiusSearch(m_atomicPositions.col(a), max_dist, idxs_dists);
     for (const auto &result : idxs_dists) {
       int idx = result.first;
       double d2 = result.second;
@@ -148,10 +155,10 @@ void ChemicalStructure::guessBondsBasedOnDistances() {
         }
       }
     }
-    results.clear();
   }
 
   m_bondsNeedUpdate = false;
+  fragmentsChanged();
   m_fragments.clear();
   m_symmetryUniqueFragments.clear();
   m_fragmentForAtom.clear();
@@ -332,6 +339,7 @@ void ChemicalStructure::clearAtoms() {
   m_atomicPositions = occ::Mat3N();
   m_flags.clear();
   m_labels.clear();
+  positionsChanged();
 }
 
 void ChemicalStructure::setAtoms(const std::vector<QString> &elementSymbols,
@@ -367,6 +375,7 @@ void ChemicalStructure::setAtoms(const std::vector<QString> &elementSymbols,
   }
   m_origin = m_atomicPositions.rowwise().mean();
   m_bondsNeedUpdate = true;
+  positionsChanged();
   emit atomsChanged();
 }
 
@@ -402,6 +411,19 @@ void ChemicalStructure::addAtoms(const std::vector<QString> &elementSymbols,
   }
   m_origin = m_atomicPositions.rowwise().mean();
   m_bondsNeedUpdate = true;
+
+  {
+    // extend an up to date index with the new atoms instead of rebuilding
+    QMutexLocker lock(&m_spatialIndexMutex);
+    const bool indexCurrent =
+        m_spatialIndex && m_spatialIndexGeneration == m_positionGeneration;
+    positionsChanged();
+    if (indexCurrent) {
+      m_spatialIndex =
+          m_spatialIndex->appended(m_atomicPositions.rightCols(numAdded));
+      m_spatialIndexGeneration = m_positionGeneration;
+    }
+  }
   emit atomsChanged();
 }
 
@@ -494,6 +516,7 @@ void ChemicalStructure::deleteAtomsByOffset(
   m_labels = newLabels;
   m_origin = m_atomicPositions.rowwise().mean();
   m_bondsNeedUpdate = true;
+  positionsChanged();
   emit atomsChanged();
 }
 
@@ -784,17 +807,12 @@ std::vector<GenericAtomIndex> ChemicalStructure::atomsSurroundingAtoms(
   ankerl::unordered_dense::set<GenericAtomIndex, GenericAtomIndexHash> idx_set(
       idxs.begin(), idxs.end());
 
-  occ::core::KDTree<double> tree(3, m_atomicPositions, occ::core::max_leaf);
-  tree.index->buildIndex();
-  const double max_dist2 = radius * radius;
-
-  std::vector<std::pair<size_t, double>> idxs_dists;
-  nanoflann::RadiusResultSet results(max_dist2, idxs_dists);
+  const auto tree = spatialIndex();
+  std::vector<AtomSpatialIndex::Neighbor> idxs_dists;
 
   for (const auto &idx : idx_set) {
     int i = idx.unique;
-    const double *q = m_atomicPositions.col(i).data();
-    tree.index->findNeighbors(results, q, nanoflann::SearchParams());
+    tree->radiusSearch(m_atomicPositions.col(i), radius, idxs_dists);
     for (const auto &result : idxs_dists) {
       auto candidate = GenericAtomIndex{static_cast<int>(result.first)};
       if (idx_set.contains(candidate)) {
@@ -813,17 +831,12 @@ ChemicalStructure::atomsSurroundingAtomsWithFlags(const AtomFlags &flags,
   ankerl::unordered_dense::set<GenericAtomIndex, GenericAtomIndexHash>
       unique_idxs;
 
-  occ::core::KDTree<double> tree(3, m_atomicPositions, occ::core::max_leaf);
-  tree.index->buildIndex();
-  const double max_dist2 = radius * radius;
-
-  std::vector<std::pair<size_t, double>> idxs_dists;
-  nanoflann::RadiusResultSet results(max_dist2, idxs_dists);
+  const auto tree = spatialIndex();
+  std::vector<AtomSpatialIndex::Neighbor> idxs_dists;
 
   for (GenericAtomIndex i = {0}; i.unique < numberOfAtoms(); i.unique++) {
     if (m_flags.at(i) & flags) {
-      const double *q = m_atomicPositions.col(i.unique).data();
-      tree.index->findNeighbors(results, q, nanoflann::SearchParams());
+      tree->radiusSearch(m_atomicPositions.col(i.unique), radius, idxs_dists);
       for (const auto &result : idxs_dists) {
         int idx = result.first;
         unique_idxs.insert({idx});
@@ -900,19 +913,11 @@ ChemicalStructure::getAtomIndicesUnderTransformation(
       (transform.rotation() * atomicPositionsForIndices(idxs)).colwise() +
       transform.translation();
 
-  occ::core::KDTree<double> tree(3, m_atomicPositions, occ::core::max_leaf);
-  tree.index->buildIndex();
-  size_t idx;
-  double d;
-  nanoflann::KNNResultSet<double> resultSet(1);
-  resultSet.init(&idx, &d);
-
+  const auto tree = spatialIndex();
   for (int i = 0; i < pos.cols(); i++) {
-    occ::Vec3 position = pos.col(i);
-    tree.index->findNeighbors(resultSet, position.data(),
-                              nanoflann::SearchParams(10));
-    if (d < 1e-3)
-      result.push_back({static_cast<int>(idx)});
+    const auto [idx, d2] = tree->nearest(pos.col(i));
+    if (d2 < 1e-3)
+      result.push_back({idx});
   }
   return result;
 }
@@ -1440,6 +1445,7 @@ bool ChemicalStructure::fromJsonBase(const nlohmann::json &j) {
 
     qDebug() << "Loading atomic positions";
     j.at("atomicPositions").get_to(m_atomicPositions);
+    positionsChanged();
     qDebug() << "Loading atomic numbers";
     j.at("atomicNumbers").get_to(m_atomicNumbers);
     qDebug() << "Loading labels";
@@ -1,5 +1,6 @@
 #pragma once
 #include "adp.h"
+#include "atom_spatial_index.h"
 #include "atomflags.h"
 #include "bond_override.h"
 #include "cell_index.h"
@@ -16,6 +17,7 @@
 #include "slab_options.h"
 #include <Eigen/Dense>
 #include <QColor>
+#include <QMutex>
 #include <QStringList>
 #include <QVariant>
 #include <QVector3D>
@@ -104,6 +106,17 @@ public:
   inline const auto &labels() const { return m_labels; }
   inline int numberOfAtoms() const { return m_atomicNumbers.rows(); }
 
+  // Incremented whenever atomic positions change, for caches keyed on them
+  inline quint64 positionGeneration() const { return m_positionGeneration; }
+
+  // Incremented whenever bonds or fragments are redefined
+  inline quint64 fragmentGeneration() const { return m_fragmentGeneration; }
+
+  // KD-tree over atomicPositions(), rebuilt on first query after the
+  // positions change and extended rather than rebuilt by addAtoms. The
+  // returned snapshot may be queried from any thread.
+  [[nodiscard]] std::shared_ptr<const AtomSpatialIndex> spatialIndex() const;
+
   inline void setName(const QString &name) { m_name = name; }
   inline const auto &name() const { return m_name; }
 
@@ -312,6 +325,7 @@ protected:
 
   void connectChildSignals(QObject *child);
   bool eventFilter(QObject *obj, QEvent *event) override;
+  inline void fragmentsChanged() { m_fragmentGeneration++; }
 
   occ::Mat3N m_atomicPositions;
   Eigen::VectorXi m_atomicNumbers;
@@ -338,6 +352,7 @@ private:
   void deleteAtomsByOffset(const std::vector<int> &atomIndices);
   void deleteAtom(int atomIndex);
   void guessBondsBasedOnDistances();
+  inline void positionsChanged() { m_positionGeneration++; }
 
   template <class Function>
   void depth_first_traversal(int atomId, Function &func) {
@@ -359,6 +374,12 @@ private:
 
   bool m_bondsNeedUpdate{true};
 
+  quint64 m_positionGeneration{0};
+  quint64 m_fragmentGeneration{0};
+  mutable QMutex m_spatialIndexMutex;
+  mutable std::shared_ptr<const AtomSpatialIndex> m_spatialIndex;
+  mutable quint64 m_spatialIndexGeneration{0};
+
   QString m_filename;
   QByteArray m_fileContents;
 
@@ -4,6 +4,10 @@
 #include <algorithm>
 #include <cmath>
 
+#ifdef CX_HAS_CONCURRENT
+#include <QtConcurrent>
+#endif
+
 ElasticTensorResults::ElasticTensorResults(QObject *parent)
     : QObject(parent), m_name("Elastic Tensor"),
       m_elasticMatrix(occ::Mat6::Zero()) {
@@ -201,7 +205,8 @@ Mesh *ElasticTensorResults::createPropertyMesh(PropertyType property,
                                                double radius,
                                                const Eigen::Vector3d& centerOffset) const {
   // Validate inputs
-  if (subdivisions < 0 || subdivisions > 7) {
+  if (subdivisions < 0 ||
+      subdivisions > cx::primitives::MaxIcosphereSubdivisions) {
     qDebug() << "Invalid subdivisions:" << subdivisions;
     return nullptr;
   }
@@ -216,15 +221,14 @@ Mesh *ElasticTensorResults::createPropertyMesh(PropertyType property,
     return nullptr;
   }
 
-  // Generate unit icosphere using IcosphereMesh class
-  auto unitVertices = IcosphereMesh::generateVertices(subdivisions);
-  auto faces = IcosphereMesh::generateFaces(subdivisions);
-
-  // Validate geometry
-  if (unitVertices.cols() == 0 || faces.cols() == 0) {
+  // Shared unit icosphere, generated once per subdivision level
+  auto sphere = cx::primitives::icosphere(subdivisions);
+  if (!sphere) {
     qDebug() << "Failed to generate icosphere geometry";
     return nullptr;
   }
+  const auto &unitVertices = sphere->vertices;
+  const auto &faces = sphere->faces;
 
   // Calculate ALL property values for each vertex direction
   Mesh::ScalarPropertyValues youngsValues(unitVertices.cols());
@@ -238,95 +242,69 @@ Mesh *ElasticTensorResults::createPropertyMesh(PropertyType property,
   double maxValue = 0.0;
 
   try {
-    for (int i = 0; i < unitVertices.cols(); ++i) {
-      occ::Vec3 direction = unitVertices.col(i).normalized();
-
-      // Validate direction vector
-      if (direction.norm() < 1e-10) {
-        qDebug() << "Warning: Invalid direction vector at vertex" << i;
-        direction = occ::Vec3(1, 0, 0); // Default to x-direction
-      }
-
-      // Calculate all properties for this direction
-      double young = youngsModulus(direction);
-
-      // Find min/max shear modulus by sampling angles
-      double shearMax = 0.0;
-      double shearMin = std::numeric_limits<double>::max();
-      const int numSamples = 36; // Sample every 5 degrees
-      for (int j = 0; j < numSamples; ++j) {
-        double angle = (j * M_PI) / numSamples;
-        double shear = shearModulus(direction, angle);
-        if (std::isfinite(shear)) {
-          shearMax = std::max(shearMax, shear);
-          shearMin = std::min(shearMin, shear);
-        }
-      }
-      if (shearMin == std::numeric_limits<double>::max()) {
-        shearMin = 0.0; // Fallback if all values were non-finite
-      }
-
-      double compress = linearCompressibility(direction);
-
-      // Find min/max Poisson's ratio by sampling angles
-      double poissonMax = -std::numeric_limits<double>::max();
-      double poissonMin = std::numeric_limits<double>::max();
-      for (int j = 0; j < numSamples; ++j) {
-        double angle = (j * M_PI) / numSamples;
-        double poisson = poissonRatio(direction, angle);
-        if (std::isfinite(poisson)) {
-          poissonMax = std::max(poissonMax, poisson);
-          poissonMin = std::min(poissonMin, poisson);
-        }
-      }
-      if (poissonMin == std::numeric_limits<double>::max()) {
-        poissonMin = 0.0; // Fallback if all values were non-finite
-        poissonMax = 0.0;
-      }
+    const int numVertices = unitVertices.cols();
+    const occ::Mat3N &directions = unitVertices;
+
+    // Evaluate directions in independent column blocks so large
+    // icospheres are spread over the available cores
+    constexpr int blockSize = 1024;
+    std::vector<std::pair<int, int>> blocks;
+    for (int start = 0; start < numVertices; start += blockSize) {
+      blocks.emplace_back(start, std::min(blockSize, numVertices - start));
+    }
 
-      // Validate computed values
-      if (!std::isfinite(young))
-        young = 0.0;
-      if (!std::isfinite(compress))
-        compress = 0.0;
-
-      youngsValues(i) = static_cast<float>(young);
-      shearMaxValues(i) = static_cast<float>(shearMax);
-      shearMinValues(i) = static_cast<float>(shearMin);
-      compressValues(i) = static_cast<float>(compress);
-      poissonMaxValues(i) = static_cast<float>(poissonMax);
-      poissonMinValues(i) = static_cast<float>(poissonMin);
-
-      // Find max value for the primary property being visualized (for scaling)
-      double value = 0.0;
-      switch (property) {
-      case PropertyType::YoungsModulus:
-        value = young;
-        propertyName = "Young's Modulus (GPa)";
-        break;
-      case PropertyType::ShearModulusMax:
-        value = shearMax;
-        propertyName = "Shear Modulus Max (GPa)";
-        break;
-      case PropertyType::ShearModulusMin:
-        value = shearMin;
-        propertyName = "Shear Modulus Min (GPa)";
-        break;
-      case PropertyType::LinearCompressibility:
-        value = compress;
-        propertyName = "Linear Compressibility (TPa⁻¹)";
-        break;
-      case PropertyType::PoissonRatioMax:
-        value = poissonMax;
-        propertyName = "Poisson Ratio Max";
-        break;
-      case PropertyType::PoissonRatioMin:
-        value = poissonMin;
-        propertyName = "Poisson Ratio Min";
-        break;
+    const auto &tensor = *m_tensor;
+    auto evaluateBlock = [&](const std::pair<int, int> &block) {
+      auto [start, count] = block;
+      auto props =
+          tensor.directional_properties(directions.middleCols(start, count));
+      auto sanitize = [](double v) {
+        return std::isfinite(v) ? static_cast<float>(v) : 0.0f;
+      };
+      for (int j = 0; j < count; ++j) {
+        const int i = start + j;
+        youngsValues(i) = sanitize(props.youngs_modulus(j));
+        compressValues(i) = sanitize(props.linear_compressibility(j));
+        shearMaxValues(i) = sanitize(props.shear_modulus_max(j));
+        shearMinValues(i) = sanitize(props.shear_modulus_min(j));
+        poissonMaxValues(i) = sanitize(props.poisson_ratio_max(j));
+        poissonMinValues(i) = sanitize(props.poisson_ratio_min(j));
       }
+    };
 
-      maxValue = std::max(maxValue, std::abs(value));
+#ifdef CX_HAS_CONCURRENT
+    QtConcurrent::blockingMap(blocks, evaluateBlock);
+#else
+    for (const auto &block : blocks) {
+      evaluateBlock(block);
+    }
+#endif
+
+    switch (property) {
+    case PropertyType::YoungsModulus:
+      propertyName = "Young's Modulus (GPa)";
+      maxValue = youngsValues.cwiseAbs().maxCoeff();
+      break;
+    case PropertyType::ShearModulusMax:
+      propertyName = "Shear Modulus Max (GPa)";
+      maxValue = shearMaxValues.cwiseAbs().maxCoeff();
+      break;
+    case PropertyType::ShearModulusMin:
+      propertyName = "Shear Modulus Min (GPa)";
+      maxValue = shearMinValues.cwiseAbs().maxCoeff();
+      break;
+    case PropertyType::LinearCompressibility:
+      propertyName = "Linear Compressibility (TPa⁻¹)";
+      maxValue = compressValues.cwiseAbs().maxCoeff();
+      break;
+    case PropertyType::PoissonRatioMax:
+      propertyName = "Poisson Ratio Max";
+      maxValue = poissonMaxValues.cwiseAbs().maxCoeff();
+      break;
+    case PropertyType::PoissonRatioMin:
+      propertyName = "Poisson Ratio Min";
+      maxValue = poissonMinValues.cwiseAbs().maxCoeff();
+      break;
     }
   } catch (const std::exception &e) {
     qDebug() << "Error calculating property values:" << e.what();
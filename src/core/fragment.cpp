@@ -2,6 +2,7 @@
 #include "json.h"
 #include <cmath>
 #include <occ/core/element.h>
+#include <occ/core/kdtree.h>
 #include <occ/core/util.h>
 
 using nlohmann::json;
@@ -208,6 +209,36 @@ QVector3D Fragment::posVector3D(int index) const {
 
 Fragment::NearestAtomResult Fragment::nearestAtom(const Fragment &other) const {
   Fragment::NearestAtomResult result{0, 0, std::numeric_limits<double>::max()};
+
+  // all pairs is cheapest for typical molecules, only build a tree over the
+  // larger fragment when the product gets big (e.g. frameworks, clusters)
+  constexpr size_t kdTreeThreshold = 10000;
+  if (size() * other.size() > kdTreeThreshold) {
+    const bool swapped = size() < other.size();
+    const Fragment &treeFragment = swapped ? other : *this;
+    const Fragment &queryFragment = swapped ? *this : other;
+    const occ::Mat3N &treePositions = treeFragment.positions;
+    occ::core::KDTree<double> tree(treePositions.rows(), treePositions,
+                                   occ::core::max_leaf);
+    tree.index->buildIndex();
+
+    for (size_t j = 0; j < queryFragment.size(); j++) {
+      Eigen::Index idx{0};
+      double d2{0.0};
+      nanoflann::KNNResultSet<double, Eigen::Index> results(1);
+      results.init(&idx, &d2);
+      tree.index->findNeighbors(results, queryFragment.positions.col(j).data(),
+                                nanoflann::SearchParams());
+      double d = std::sqrt(d2);
+      if (d < result.distance) {
+        size_t i = static_cast<size_t>(idx);
+        result = swapped ? Fragment::NearestAtomResult{j, i, d}
+                         : Fragment::NearestAtomResult{i, j, d};
+      }
+    }
+    return result;
+  }
+
   for (size_t i = 0; i < size(); i++) {
     const occ::Vec3 &p1 = positions.col(i);
     for (size_t j = 0; j < other.size(); j++) {
@@ -0,0 +1,110 @@
+#include "geometry_primitives.h"
+#include <ankerl/unordered_dense.h>
+#include <array>
+#include <cmath>
+#include <mutex>
+
+namespace cx::primitives {
+
+namespace {
+
+using Vertices = Eigen::Matrix<double, 3, Eigen::Dynamic>;
+using Faces = Eigen::Matrix<int, 3, Eigen::Dynamic>;
+
+void fillBuffers(Icosphere &sphere) {
+  sphere.vertexData.resize(3 * sphere.vertices.cols());
+  Eigen::Map<Eigen::Matrix<float, 3, Eigen::Dynamic>>(
+      sphere.vertexData.data(), 3, sphere.vertices.cols()) =
+      sphere.vertices.cast<float>();
+  sphere.indexData.resize(3 * sphere.faces.cols());
+  Eigen::Map<Eigen::Matrix<uint32_t, 3, Eigen::Dynamic>>(
+      sphere.indexData.data(), 3, sphere.faces.cols()) =
+      sphere.faces.cast<uint32_t>();
+}
+
+std::shared_ptr<Icosphere> icosahedron() {
+  const double phi = (1.0 + std::sqrt(5.0)) / 2.0;
+  auto result = std::make_shared<Icosphere>();
+  result->vertices.resize(3, 12);
+  // clang-format off
+  result->vertices << -1,  1, -1,   1,    0,   0,    0,   0,  phi, phi, -phi, -phi,
+                     phi, phi, -phi, -phi, -1,   1,   -1,   1,    0,   0,    0,    0,
+                       0,   0,    0,    0, phi, phi, -phi, -phi, -1,   1,   -1,    1;
+  result->faces.resize(3, 20);
+  result->faces << 0, 0,  0,  0,  0, 1,  5, 11, 10, 7, 3, 3, 3, 3, 3, 4, 2, 6, 8, 9,
+                  11, 5,  1,  7, 10, 5, 11, 10,  7, 1, 9, 4, 2, 6, 8, 9, 4, 2, 6, 8,
+                   5, 1,  7, 10, 11, 9,  4,  2,  6, 8, 4, 2, 6, 8, 9, 5, 11, 10, 7, 1;
+  // clang-format on
+  result->vertices.colwise().normalize();
+  return result;
+}
+
+// Splits every face into four, sharing each new edge midpoint between the
+// two faces on either side of the edge.
+std::shared_ptr<Icosphere> subdivide(const Icosphere &previous) {
+  const Vertices &v = previous.vertices;
+  const Faces &f = previous.faces;
+  const int numVertices = v.cols();
+  const int numFaces = f.cols();
+  // V - E + F = 2 for a closed sphere, and each face has 3 half edges
+  const int numEdges = 3 * numFaces / 2;
+
+  auto result = std::make_shared<Icosphere>();
+  result->subdivisions = previous.subdivisions + 1;
+  result->vertices.resize(3, numVertices + numEdges);
+  result->vertices.leftCols(numVertices) = v;
+  result->faces.resize(3, 4 * numFaces);
+
+  ankerl::unordered_dense::map<uint64_t, int> midpoints;
+  midpoints.reserve(numEdges);
+  int next = numVertices;
+  auto midpoint = [&](int a, int b) {
+    const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) |
+                         static_cast<uint32_t>(std::max(a, b));
+    auto [it, inserted] = midpoints.try_emplace(key, next);
+    if (inserted) {
+      result->vertices.col(next++) = (v.col(a) + v.col(b)).normalized();
+    }
+    return it->second;
+  };
+
+  for (int i = 0; i < numFaces; i++) {
+    const int a = f(0, i), b = f(1, i), c = f(2, i);
+    const int ab = midpoint(a, b);
+    const int bc = midpoint(b, c);
+    const int ca = midpoint(c, a);
+    result->faces.col(4 * i) = Eigen::Vector3i(a, ab, ca);
+    result->faces.col(4 * i + 1) = Eigen::Vector3i(b, bc, ab);
+    result->faces.col(4 * i + 2) = Eigen::Vector3i(c, ca, bc);
+    result->faces.col(4 * i + 3) = Eigen::Vector3i(ab, bc, ca);
+  }
+  return result;
+}
+
+} // namespace
+
+std::shared_ptr<const Icosphere> icosphere(int subdivisions) {
+  if (subdivisions < 0 || subdivisions > MaxIcosphereSubdivisions)
+    return nullptr;
+
+  static std::mutex mutex;
+  static std::array<std::shared_ptr<const Icosphere>,
+                    MaxIcosphereSubdivisions + 1>
+      levels;
+
+  std::lock_guard lock(mutex);
+  if (levels[subdivisions])
+    return levels[subdivisions];
+
+  int level = subdivisions;
+  while (level > 0 && !levels[level - 1])
+    level--;
+  for (; level <= subdivisions; level++) {
+    auto sphere = level == 0 ? icosahedron() : subdivide(*levels[level - 1]);
+    fillBuffers(*sphere);
+    levels[level] = std::move(sphere);
+  }
+  return levels[subdivisions];
+}
+
+} // namespace cx::primitives
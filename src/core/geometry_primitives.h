@@ -0,0 +1,38 @@
+#pragma once
+#include <Eigen/Core>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cx::primitives {
+
+constexpr int MaxIcosphereSubdivisions = 7;
+
+/**
+ * \brief Unit icosphere geometry shared between renderers and exporters
+ *
+ * Vertices lie on the unit sphere, so they double as the vertex normals.
+ * The same geometry is available as Eigen matrices (for Mesh and property
+ * evaluation) and as flat float/uint32 arrays ready for GPU or glTF buffer
+ * upload.
+ */
+struct Icosphere {
+  int subdivisions{0};
+  Eigen::Matrix<double, 3, Eigen::Dynamic> vertices;
+  Eigen::Matrix<int, 3, Eigen::Dynamic> faces;
+  std::vector<float> vertexData;   // xyz per vertex
+  std::vector<uint32_t> indexData; // three indices per face
+
+  [[nodiscard]] inline size_t numberOfVertices() const {
+    return vertices.cols();
+  }
+  [[nodiscard]] inline size_t numberOfFaces() const { return faces.cols(); }
+};
+
+// Returns the process-wide icosphere for the given subdivision level, or
+// nullptr if it is outside [0, MaxIcosphereSubdivisions]. Each level is
+// generated once (from the level below) on first use; the returned geometry
+// is immutable and may be shared freely between threads.
+std::shared_ptr<const Icosphere> icosphere(int subdivisions);
+
+} // namespace cx::primitives
@@ -1,7 +1,10 @@
 #pragma once
+#include "geometry_primitives.h"
 #include "mesh.h"
 #include <occ/core/linear_algebra.h>
 
+// Thin wrapper over cx::primitives::icosphere, which caches each
+// subdivision level; prefer that directly to avoid copying the geometry.
 class IcosphereMesh {
 public:
     // Generate a basic icosphere mesh with given subdivisions and radius
@@ -12,9 +15,4 @@ public:
     
     // Generate icosphere faces
     static Mesh::FaceList generateFaces(int subdivisions = 2);
-    
-private:
-    // Helper to subdivide triangles
-    static void subdivideTriangle(const occ::Vec3 &v1, const occ::Vec3 &v2, const occ::Vec3 &v3,
-                                  int depth, std::vector<occ::Vec3> &vertices);
 };
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <QFile>
 #include <QSignalBlocker>
 #include <fmt/os.h>
+#include <occ/core/kdtree.h>
 
 using VertexList = Mesh::VertexList;
 using FaceList = Mesh::FaceList;
@@ -580,6 +581,34 @@ Mesh::ContainmentDebugInfo Mesh::containsPointDebug(const occ::Vec3& point) cons
   return debugInfo;
 }
 
+struct Mesh::VertexTree {
+  explicit VertexTree(const VertexList &vertices)
+      : tree(vertices.rows(), vertices, occ::core::max_leaf) {
+    tree.index->buildIndex();
+  }
+  occ::core::KDTree<double> tree;
+};
+
+const Mesh::VertexTree &Mesh::vertexTree() const {
+  std::call_once(m_vertexTreeOnce, [this]() {
+    m_vertexTree = std::make_shared<VertexTree>(m_vertices);
+  });
+  return *m_vertexTree;
+}
+
+std::pair<int, double> Mesh::nearestVertex(const occ::Vec3 &point) const {
+  if (m_vertices.cols() == 0)
+    return {-1, std::numeric_limits<double>::max()};
+
+  Eigen::Index idx{0};
+  double d2{0.0};
+  nanoflann::KNNResultSet<double, Eigen::Index> results(1);
+  results.init(&idx, &d2);
+  vertexTree().tree.index->findNeighbors(results, point.data(),
+                                         nanoflann::SearchParams());
+  return {static_cast<int>(idx), std::sqrt(d2)};
+}
+
 std::pair<occ::Vec3, occ::Vec3> Mesh::boundingBox() const {
   if (m_vertices.cols() == 0) {
     return {occ::Vec3::Zero(), occ::Vec3::Zero()};
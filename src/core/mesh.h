@@ -6,6 +6,8 @@
 #include <QMap>
 #include <QObject>
 #include <ankerl/unordered_dense.h>
+#include <memory>
+#include <mutex>
 
 class Mesh : public QObject {
   Q_OBJECT
@@ -162,6 +164,13 @@ public:
   [[nodiscard]] ContainmentDebugInfo containsPointDebug(const occ::Vec3& point) const;
 
   [[nodiscard]] std::pair<occ::Vec3, occ::Vec3> boundingBox() const; // returns (min, max)
+
+  // Nearest vertex to a point given in the mesh frame, returns (index,
+  // distance) or (-1, max) for an empty mesh. The KD-tree behind this is
+  // built on first use and kept for the lifetime of the mesh, as vertices
+  // never change after construction.
+  [[nodiscard]] std::pair<int, double>
+  nearestVertex(const occ::Vec3 &point) const;
   [[nodiscard]] std::vector<GenericAtomIndex> findAtomsInside(const class ChemicalStructure* structure) const;
 
   bool haveChildMatchingTransform(const Eigen::Isometry3d &transform) const;
@@ -194,6 +203,9 @@ signals:
   void selectedPropertyChanged();
 
 private:
+  struct VertexTree;
+  const VertexTree &vertexTree() const;
+
   [[nodiscard]] ScalarPropertyValues computeVertexAreas() const;
   void updateVertexFaceMapping();
   void updateFaceProperties();
@@ -217,6 +229,9 @@ private:
 
   std::vector<std::vector<int>> m_facesUsingVertex;
 
+  mutable std::once_flag m_vertexTreeOnce;
+  mutable std::shared_ptr<VertexTree> m_vertexTree;
+
   std::vector<GenericAtomIndex> m_atomsInside;
   std::vector<GenericAtomIndex> m_atomsOutside;
 
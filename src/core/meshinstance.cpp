@@ -1,5 +1,6 @@
 #include "meshinstance.h"
 #include "chemicalstructure.h"
+#include <algorithm>
 #include <fmt/core.h>
 
 MeshInstance::MeshInstance(Mesh *parent, const MeshTransform &transform)
@@ -176,63 +177,85 @@ MeshInstance *MeshInstance::newInstanceFromSelectedAtoms(
   return instance;
 }
 
-// TODO speed up these queries rather than iterating through all points
+// Distances are invariant under the instance transform, so queries are
+// mapped into the mesh frame and answered by the mesh's cached KD-tree
 MeshInstance::NearestPointResult
 MeshInstance::nearestPoint(const Fragment &other) const {
-  const auto v = vertices();
   MeshInstance::NearestPointResult result;
+  if (!m_mesh)
+    return result;
 
-  for (size_t i = 0; i < v.cols(); i++) {
-    const occ::Vec3 &p1 = v.col(i);
-    for (size_t j = 0; j < other.size(); j++) {
-      const occ::Vec3 &p2 = other.positions.col(j);
-      double d = (p2 - p1).norm();
-      if (d < result.distance) {
-        result.idx_this = i;
-        result.idx_other = j;
-        result.distance = d;
-      }
+  const MeshTransform inverse = m_transform.inverse();
+  for (int j = 0; j < static_cast<int>(other.size()); j++) {
+    const occ::Vec3 local = inverse * occ::Vec3(other.positions.col(j));
+    const auto [idx, d] = m_mesh->nearestVertex(local);
+    if (d < result.distance) {
+      result.idx_this = idx;
+      result.idx_other = j;
+      result.distance = d;
     }
   }
   return result;
 }
 
-// TODO speed up these queries rather than iterating through all points
 MeshInstance::NearestPointResult
 MeshInstance::nearestPoint(const occ::Vec3 &p2) const {
-  const auto v = vertices();
   MeshInstance::NearestPointResult result;
+  if (!m_mesh)
+    return result;
 
-  for (size_t i = 0; i < v.cols(); i++) {
-    const occ::Vec3 &p1 = v.col(i);
-    double d = (p2 - p1).norm();
-    if (d < result.distance) {
-      result.idx_this = i;
-      result.idx_other = 0;
-      result.distance = d;
-    }
+  const auto [idx, d] = m_mesh->nearestVertex(m_transform.inverse() * p2);
+  if (idx >= 0) {
+    result.idx_this = idx;
+    result.idx_other = 0;
+    result.distance = d;
   }
   return result;
 }
 
 MeshInstance::NearestPointResult
 MeshInstance::nearestPoint(const MeshInstance *other) const {
-  const auto v = vertices();
-  const auto v2 = other->vertices();
-
   MeshInstance::NearestPointResult result;
-  for (size_t i = 0; i < v.cols(); i++) {
-    const occ::Vec3 &p1 = v.col(i);
-    for (size_t j = 0; j < v2.cols(); j++) {
-      const occ::Vec3 &p2 = v2.col(j);
-      double d = (p2 - p1).norm();
-      if (d < result.distance) {
-        result.idx_this = i;
-        result.idx_other = j;
-        result.distance = d;
-      }
+  if (!m_mesh || !other || !other->m_mesh)
+    return result;
+
+  // walk the smaller vertex set, querying the KD-tree of the larger mesh
+  const bool swapped =
+      m_mesh->numberOfVertices() > other->m_mesh->numberOfVertices();
+  const MeshInstance *query = swapped ? other : this;
+  const MeshInstance *target = swapped ? this : other;
+
+  const MeshTransform toTarget =
+      target->m_transform.inverse() * query->m_transform;
+  const Mesh::VertexList points =
+      (toTarget.rotation() * query->m_mesh->vertices()).colwise() +
+      toTarget.translation();
+
+  // visit points closest to the target's bounding box first, once the lower
+  // bound from the box exceeds the best distance no later point can win
+  const auto [boxMin, boxMax] = target->m_mesh->boundingBox();
+  std::vector<std::pair<double, int>> order(points.cols());
+  for (int i = 0; i < points.cols(); i++) {
+    const occ::Vec3 p = points.col(i);
+    const occ::Vec3 outside =
+        (boxMin - p).cwiseMax(p - boxMax).cwiseMax(occ::Vec3::Zero());
+    order[i] = {outside.norm(), i};
+  }
+  std::sort(order.begin(), order.end());
+
+  int bestQuery = -1, bestTarget = -1;
+  for (const auto &[lowerBound, i] : order) {
+    if (lowerBound >= result.distance)
+      break;
+    const auto [idx, d] = target->m_mesh->nearestVertex(points.col(i));
+    if (d < result.distance) {
+      bestQuery = i;
+      bestTarget = idx;
+      result.distance = d;
     }
   }
+  result.idx_this = swapped ? bestTarget : bestQuery;
+  result.idx_other = swapped ? bestQuery : bestTarget;
   return result;
 }
 
@@ -1,9 +1,16 @@
 #include "pair_energy_parameters.h"
 #include "chemicalstructure.h"
+#include "settings.h"
 #include "xtb_parameters.h"
 
 namespace pair_energy {
 
+bool isCustomModel(const QString &model) {
+  return settings::readSetting(settings::keys::CUSTOM_CALCULATORS)
+      .toStringList()
+      .contains(model);
+}
+
 bool EnergyModelParameters::operator==(const EnergyModelParameters &rhs) const {
   if (model != rhs.model)
     return false;
@@ -14,6 +21,10 @@ bool EnergyModelParameters::isXtbModel() const {
   return xtb::isXtbMethod(model);
 }
 
+bool EnergyModelParameters::isCustomModel() const {
+  return pair_energy::isCustomModel(model);
+}
+
 bool Parameters::operator==(const Parameters &rhs) const {
   if (model != rhs.model)
     return false;
@@ -56,6 +67,10 @@ int Parameters::multiplicity() const {
 
 bool Parameters::isXtbModel() const { return xtb::isXtbMethod(model); }
 
+bool Parameters::isCustomModel() const {
+  return pair_energy::isCustomModel(model);
+}
+
 } // namespace pair_energy
 
 void to_json(nlohmann::json &j, const pair_energy::Parameters &p) {
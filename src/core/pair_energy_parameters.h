@@ -13,6 +13,9 @@ class ChemicalStructure;
 
 namespace pair_energy {
 
+// Models run by a user configured program (see settings::keys::CUSTOM_CALCULATORS)
+bool isCustomModel(const QString &model);
+
 struct EnergyModelParameters {
   QString model{"ce-1p"};
   std::vector<wfn::Parameters> wavefunctions;
@@ -22,6 +25,7 @@ struct EnergyModelParameters {
     return !(*this == rhs);
   }
   bool isXtbModel() const;
+  bool isCustomModel() const;
 };
 
 struct Parameters {
@@ -49,6 +53,7 @@ struct Parameters {
   }
 
   bool isXtbModel() const;
+  bool isCustomModel() const;
   bool hasPermutationSymmetry{true};
 };
 
@@ -1,6 +1,27 @@
 #include "pair_energy_results.h"
 #include "chemicalstructure.h"
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double missingValue = std::numeric_limits<double>::quiet_NaN();
+
+const std::vector<PairInteraction *> noInteractions;
+const std::vector<double> noValues;
+} // namespace
+
+int EnergyComponentRegistry::intern(const QString &name) {
+  const auto [it, inserted] = m_ids.insert({name, static_cast<int>(m_names.size())});
+  if (inserted)
+    m_names.append(name);
+  return it->second;
+}
+
+int EnergyComponentRegistry::id(const QString &name) const {
+  const auto kv = m_ids.find(name);
+  return kv != m_ids.end() ? kv->second : -1;
+}
 
 PairInteraction::PairInteraction(const QString &interactionModel,
                                  QObject *parent)
@@ -8,8 +29,38 @@ PairInteraction::PairInteraction(const QString &interactionModel,
   setObjectName(interactionModel);
 }
 
+PairInteraction::~PairInteraction() {
+  if (m_owner)
+    m_owner->detach(this);
+}
+
 void PairInteraction::addComponent(const QString &component, double value) {
-  m_components.insert({component, value});
+  if (m_owner) {
+    m_owner->setComponent(this, component, value);
+  } else {
+    m_components.insert({component, value});
+  }
+}
+
+PairInteraction::EnergyComponents PairInteraction::components() const {
+  if (!m_owner)
+    return m_components;
+  EnergyComponents result;
+  const auto &registry = m_owner->componentRegistry();
+  for (int id = 0; id < registry.size(); id++) {
+    const double value = m_owner->componentValue(this, id);
+    if (!std::isnan(value))
+      result.insert({registry.name(id), value});
+  }
+  return result;
+}
+
+QStringList PairInteraction::componentNames() const {
+  QStringList result;
+  for (const auto &[component, value] : components()) {
+    result.append(component);
+  }
+  return result;
 }
 
 void PairInteraction::addMetadata(const QString &component,
@@ -17,13 +68,32 @@ void PairInteraction::addMetadata(const QString &component,
   m_metadata.insert({component, value});
 }
 
+bool PairInteraction::hasComponent(const QString &c) const {
+  if (m_owner)
+    return hasComponent(m_owner->componentId(c));
+  return m_components.contains(c);
+}
+
 double PairInteraction::getComponent(const QString &c) const {
+  if (m_owner)
+    return getComponent(m_owner->componentId(c));
   const auto kv = m_components.find(c);
   if (kv != m_components.end())
     return kv->second;
   return 0.0;
 }
 
+bool PairInteraction::hasComponent(int componentId) const {
+  return m_owner && !std::isnan(m_owner->componentValue(this, componentId));
+}
+
+double PairInteraction::getComponent(int componentId) const {
+  if (!m_owner)
+    return 0.0;
+  const double value = m_owner->componentValue(this, componentId);
+  return std::isnan(value) ? 0.0 : value;
+}
+
 QVariant PairInteraction::getMetadata(const QString &c) const {
   const auto kv = m_metadata.find(c);
   if (kv != m_metadata.end())
@@ -44,6 +114,115 @@ PairInteractions::PairInteractions(QObject *parent) : QObject(parent) {
   setObjectName("Pair Interactions");
 }
 
+PairInteractions::~PairInteractions() {
+  // interactions may outlive this (or be deleted as children after it), so
+  // they get their values back
+  for (auto &[model, table] : m_componentTables) {
+    for (auto *interaction : table.rows) {
+      for (int id = 0; id < m_componentRegistry.size(); id++) {
+        const double value = table.value(id, interaction->m_row);
+        if (!std::isnan(value))
+          interaction->m_components.insert(
+              {m_componentRegistry.name(id), value});
+      }
+      interaction->m_owner = nullptr;
+      interaction->m_row = -1;
+    }
+  }
+}
+
+int PairInteractions::componentId(const QString &component) const {
+  return m_componentRegistry.id(component);
+}
+
+void PairInteractions::attach(PairInteraction *interaction) {
+  auto &table = m_componentTables[interaction->interactionModel()];
+  const int row = table.rows.size();
+  table.rows.push_back(interaction);
+  for (auto &column : table.columns) {
+    if (!column.empty())
+      column.push_back(missingValue);
+  }
+  interaction->m_owner = this;
+  interaction->m_row = row;
+
+  for (const auto &[component, value] : interaction->m_components) {
+    setComponent(interaction, component, value);
+  }
+  interaction->m_components.clear();
+}
+
+void PairInteractions::detach(PairInteraction *interaction) {
+  if (interaction->m_owner != this)
+    return;
+  const QString model = interaction->interactionModel();
+  auto kv = m_componentTables.find(model);
+  if (kv == m_componentTables.end())
+    return;
+  auto &table = kv->second;
+  const int row = interaction->m_row;
+
+  interaction->m_components.clear();
+  for (int id = 0; id < m_componentRegistry.size(); id++) {
+    const double value = table.value(id, row);
+    if (!std::isnan(value))
+      interaction->m_components.insert({m_componentRegistry.name(id), value});
+  }
+
+  // move the last row into the gap
+  const int last = table.rows.size() - 1;
+  for (auto &column : table.columns) {
+    if (column.empty())
+      continue;
+    column[row] = column[last];
+    column.pop_back();
+  }
+  table.rows[row] = table.rows[last];
+  table.rows[row]->m_row = row;
+  table.rows.pop_back();
+  if (table.rows.empty())
+    m_componentTables.erase(kv);
+
+  interaction->m_owner = nullptr;
+  interaction->m_row = -1;
+}
+
+void PairInteractions::setComponent(PairInteraction *interaction,
+                                    const QString &component, double value) {
+  auto &table = m_componentTables[interaction->interactionModel()];
+  const int id = m_componentRegistry.intern(component);
+  if (id >= static_cast<int>(table.columns.size()))
+    table.columns.resize(id + 1);
+  auto &column = table.columns[id];
+  if (column.empty())
+    column.assign(table.rows.size(), missingValue);
+  column[interaction->m_row] = value;
+}
+
+double PairInteractions::componentValue(const PairInteraction *interaction,
+                                        int id) const {
+  const auto kv = m_componentTables.find(interaction->interactionModel());
+  if (kv == m_componentTables.end())
+    return missingValue;
+  return kv->second.value(id, interaction->m_row);
+}
+
+const std::vector<PairInteraction *> &
+PairInteractions::storedInteractions(const QString &model) const {
+  const auto kv = m_componentTables.find(model);
+  return kv != m_componentTables.end() ? kv->second.rows : noInteractions;
+}
+
+const std::vector<double> &
+PairInteractions::componentValues(const QString &model,
+                                  const QString &component) const {
+  const auto kv = m_componentTables.find(model);
+  const int id = componentId(component);
+  if (kv == m_componentTables.end() || !kv->second.hasColumn(id))
+    return noValues;
+  return kv->second.columns[id];
+}
+
 int PairInteractions::getCount(const QString &model) const {
   int result = 0;
   if (model.isEmpty()) {
@@ -68,18 +247,20 @@ QStringList PairInteractions::interactionModels() const {
 }
 
 QStringList PairInteractions::interactionComponents(const QString &model) {
-
-  const auto kv = m_pairInteractions.find(model);
-  if (kv == m_pairInteractions.end())
+  const auto kv = m_componentTables.find(model);
+  if (kv == m_componentTables.end())
     return {};
 
-  QSet<QString> uniqueComponents;
-  for (const auto &[index, interaction] : kv->second) {
-    for (const auto &[component, value] : interaction->components()) {
-      uniqueComponents.insert(component);
+  QStringList result;
+  const auto &table = kv->second;
+  for (int id = 0; id < static_cast<int>(table.columns.size()); id++) {
+    const auto &column = table.columns[id];
+    if (std::any_of(column.begin(), column.end(),
+                    [](double v) { return !std::isnan(v); })) {
+      result.append(m_componentRegistry.name(id));
     }
   }
-  return QStringList(uniqueComponents.begin(), uniqueComponents.end());
+  return result;
 }
 
 void PairInteractions::add(PairInteraction *result) {
@@ -89,7 +270,14 @@ void PairInteractions::add(PairInteraction *result) {
   if (result->label() == "Not set") {
     result->setLabel(QString("%1").arg(m_pairInteractions[model].size() + 1));
   }
-  m_pairInteractions[model].insert({result->pairIndex(), result});
+  if (result->m_owner && result->m_owner != this) {
+    result->m_owner->detach(result);
+  }
+  const bool inserted =
+      m_pairInteractions[model].insert({result->pairIndex(), result}).second;
+  if (inserted && !result->m_owner) {
+    attach(result);
+  }
   impl::ValueRange currentRange;
   {
     const auto kv = m_distanceRange.find(model);
@@ -117,6 +305,8 @@ void PairInteractions::remove(PairInteraction *result) {
   if (kv == m_pairInteractions.end())
     return;
 
+  detach(result);
+
   bool removeModel = false;
   {
     auto &interactions = kv->second;
@@ -148,15 +338,11 @@ void PairInteractions::remove(PairInteraction *result) {
 QList<PairInteraction *>
 PairInteractions::filterByComponent(const QString &component) const {
   QList<PairInteraction *> filtereds;
-  for (const auto &[model, interactions] : m_pairInteractions) {
-    for (const auto &kv : interactions) {
-      PairInteraction *result = kv.second;
-      for (const auto &pair : result->components()) {
-        if (pair.first == component) {
-          filtereds.append(result);
-          break;
-        }
-      }
+  for (const auto &[model, table] : m_componentTables) {
+    const auto &values = componentValues(model, component);
+    for (size_t row = 0; row < values.size(); row++) {
+      if (!std::isnan(values[row]))
+        filtereds.append(table.rows[row]);
     }
   }
   return filtereds;
@@ -166,18 +352,11 @@ QList<PairInteraction *>
 PairInteractions::filterByModelAndComponent(const QString &model,
                                             const QString &component) const {
   QList<PairInteraction *> filtereds;
-  const auto interactions = m_pairInteractions.find(model);
-  if (interactions == m_pairInteractions.end())
-    return filtereds;
-
-  for (const auto kv : interactions->second) {
-    PairInteraction *result = kv.second;
-    for (const auto &pair : result->components()) {
-      if (pair.first == component) {
-        filtereds.append(result);
-        break;
-      }
-    }
+  const auto &rows = storedInteractions(model);
+  const auto &values = componentValues(model, component);
+  for (size_t row = 0; row < values.size(); row++) {
+    if (!std::isnan(values[row]))
+      filtereds.append(rows[row]);
   }
   return filtereds;
 }
@@ -274,7 +453,7 @@ nlohmann::json PairInteraction::toJson() const {
 
   // Energy components
   nlohmann::json componentsJson = nlohmann::json::object();
-  for (const auto &[component, value] : m_components) {
+  for (const auto &[component, value] : components()) {
     componentsJson[component.toStdString()] = value;
   }
   j["components"] = componentsJson;
@@ -383,10 +562,12 @@ bool PairInteractions::fromJson(const nlohmann::json &j) {
     // Clear existing data first
     for (auto &[model, interactions] : m_pairInteractions) {
       for (auto &[index, interaction] : interactions) {
+        interaction->m_owner = nullptr;
         delete interaction;
       }
     }
     m_pairInteractions.clear();
+    m_componentTables.clear();
     m_distanceRange.clear();
 
     // Deserialize interactions
@@ -6,7 +6,26 @@
 #include <QObject>
 #include <QVariant>
 #include <ankerl/unordered_dense.h>
+#include <limits>
 #include <occ/crystal/dimer_mapping_table.h>
+#include <vector>
+
+class PairInteractions;
+
+// Interns energy component names ("Total", "Coulomb" etc.) to small integer
+// ids, shared by every interaction held in a PairInteractions
+class EnergyComponentRegistry {
+public:
+  int intern(const QString &name);
+  // -1 if the name has not been seen
+  int id(const QString &name) const;
+  inline const QString &name(int id) const { return m_names[id]; }
+  inline int size() const { return static_cast<int>(m_names.size()); }
+
+private:
+  ankerl::unordered_dense::map<QString, int> m_ids;
+  QStringList m_names;
+};
 
 class PairInteraction : public QObject {
   Q_OBJECT
@@ -16,10 +35,20 @@ public:
 
   explicit PairInteraction(const QString &interactionModel,
                            QObject *parent = nullptr);
+  ~PairInteraction();
   QString interactionModel() const;
   void addComponent(const QString &component, double value);
-  inline const auto &components() const { return m_components; }
+  // Copy of the components, the values themselves are stored by the owning
+  // PairInteractions once the interaction has been added to one
+  EnergyComponents components() const;
+  QStringList componentNames() const;
+  bool hasComponent(const QString &) const;
   double getComponent(const QString &) const;
+  // Lookup by id from owner()->componentId(), avoiding the name lookup when
+  // the same component is read for many interactions
+  bool hasComponent(int componentId) const;
+  double getComponent(int componentId) const;
+  inline PairInteractions *owner() const { return m_owner; }
 
   void addMetadata(const QString &label, const QVariant &value);
   inline const auto &metadata() const { return m_metadata; }
@@ -57,11 +86,15 @@ public:
                                    QObject *parent = nullptr);
 
 private:
+  friend class PairInteractions;
+
+  PairInteractions *m_owner{nullptr};
+  int m_row{-1}; // in the owner's component table for the model
   int m_count{0};
   QColor m_color{Qt::white};
   QString m_label{"Not set"};
   QString m_interactionModel;
-  EnergyComponents m_components;
+  EnergyComponents m_components; // only used while there is no owner
   Metadata m_metadata;
   pair_energy::Parameters m_parameters;
 };
@@ -79,6 +112,24 @@ struct ValueRange {
     return ValueRange{qMin(minValue, v), qMax(maxValue, v)};
   }
 };
+
+// Energy components of every interaction for one model, stored by column
+// (component id x row) so a component can be read for all interactions
+// without any per-interaction lookups. A column is empty if no interaction
+// of the model has the component, and NaN marks a missing value otherwise.
+struct ComponentTable {
+  std::vector<PairInteraction *> rows;
+  std::vector<std::vector<double>> columns;
+
+  inline bool hasColumn(int id) const {
+    return id >= 0 && id < static_cast<int>(columns.size()) &&
+           !columns[id].empty();
+  }
+  inline double value(int id, int row) const {
+    return hasColumn(id) ? columns[id][row]
+                         : std::numeric_limits<double>::quiet_NaN();
+  }
+};
 } // namespace impl
 
 class PairInteractions : public QObject {
@@ -92,6 +143,7 @@ public:
       ankerl::unordered_dense::map<QString, PairInteractionMap>;
 
   explicit PairInteractions(QObject *parent = nullptr);
+  ~PairInteractions();
 
   void add(PairInteraction *result);
   void remove(PairInteraction *result);
@@ -107,6 +159,18 @@ public:
 
   QStringList interactionModels() const;
   QStringList interactionComponents(const QString &model);
+
+  inline const EnergyComponentRegistry &componentRegistry() const {
+    return m_componentRegistry;
+  }
+  // -1 if no interaction has the component
+  int componentId(const QString &component) const;
+  // Interactions of the model in storage order, with the component values
+  // in the matching order (NaN where missing). Empty if either is unknown.
+  const std::vector<PairInteraction *> &
+  storedInteractions(const QString &model) const;
+  const std::vector<double> &componentValues(const QString &model,
+                                             const QString &component) const;
   PairInteractionMap filterByModel(const QString &model) const;
   QList<PairInteraction *> filterByComponent(const QString &component) const;
   QList<PairInteraction *>
@@ -125,7 +189,16 @@ signals:
   void interactionRemoved();
 
 private:
+  friend class PairInteraction;
+
+  void attach(PairInteraction *);
+  void detach(PairInteraction *);
+  void setComponent(PairInteraction *, const QString &component, double value);
+  double componentValue(const PairInteraction *, int id) const;
+
   ModelInteractions m_pairInteractions;
+  EnergyComponentRegistry m_componentRegistry;
+  ankerl::unordered_dense::map<QString, impl::ComponentTable> m_componentTables;
   ankerl::unordered_dense::map<QString, impl::ValueRange> m_distanceRange;
   bool m_haveDimerMap{false};
   occ::crystal::DimerMappingTable m_dimerMappingTable;
@@ -0,0 +1,226 @@
+#include "performancetimer.h"
+#include "json.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QThread>
+
+namespace cx::trace {
+
+std::vector<Event> ThreadBuffer::snapshot() const {
+  const quint64 capacity = m_events.size();
+  const quint64 head = m_head.load(std::memory_order_acquire);
+  const quint64 start = std::max(head > capacity ? head - capacity : 0,
+                                 m_cleared.load(std::memory_order_relaxed));
+
+  std::vector<Event> result;
+  result.reserve(head > start ? head - start : 0);
+  for (quint64 i = start; i < head; i++) {
+    result.push_back(m_events[i % capacity]);
+  }
+
+  // anything the writer may have lapped while we were copying is unreliable,
+  // including slot `after`, which it may be part way through writing
+  const quint64 after = m_head.load(std::memory_order_acquire);
+  const quint64 firstValid = after >= capacity ? after - capacity + 1 : 0;
+  if (firstValid > start) {
+    const auto stale = std::min<quint64>(firstValid - start, result.size());
+    result.erase(result.begin(), result.begin() + stale);
+  }
+  return result;
+}
+
+void ThreadBuffer::markCleared() {
+  m_cleared.store(m_head.load(std::memory_order_acquire));
+}
+
+void ThreadBuffer::reset(quint32 threadId, const QString &threadName) {
+  m_head.store(0, std::memory_order_relaxed);
+  m_cleared.store(0, std::memory_order_relaxed);
+  m_depth = 0;
+  m_threadId = threadId;
+  m_threadName = threadName;
+  retired.store(false);
+}
+
+} // namespace cx::trace
+
+namespace {
+
+std::atomic<bool> s_timerDestroyed{false};
+
+// Marks the calling thread's buffer as reusable once the thread exits, so
+// short-lived pool threads don't accumulate buffers.
+struct ThreadBufferHandle {
+  cx::trace::ThreadBuffer *buffer{nullptr};
+  ~ThreadBufferHandle() {
+    if (buffer && !s_timerDestroyed.load())
+      buffer->retired.store(true);
+  }
+};
+
+thread_local ThreadBufferHandle t_bufferHandle;
+thread_local QHash<QString, quint32> t_nameIds;
+
+} // namespace
+
+PerformanceTimer::PerformanceTimer() {
+  m_traceClock.start();
+  QString traceFile = qEnvironmentVariable("CX_TRACE_FILE");
+  if (!traceFile.isEmpty()) {
+    m_traceFile = traceFile;
+    m_tracing.store(true);
+  }
+}
+
+PerformanceTimer::~PerformanceTimer() {
+  if (!m_traceFile.isEmpty()) {
+    writeTrace(m_traceFile);
+  }
+  s_timerDestroyed.store(true);
+}
+
+cx::trace::ThreadBuffer *PerformanceTimer::threadBuffer() {
+  if (t_bufferHandle.buffer)
+    return t_bufferHandle.buffer;
+
+  QThread *thread = QThread::currentThread();
+  QString threadName = thread ? thread->objectName() : QString();
+  auto *app = QCoreApplication::instance();
+  if (app && thread == app->thread())
+    threadName = "Main thread";
+
+  QMutexLocker lock(&m_traceMutex);
+  const quint32 threadId = m_nextThreadId++;
+  if (threadName.isEmpty())
+    threadName = QString("Thread %1").arg(threadId);
+
+  cx::trace::ThreadBuffer *buffer = nullptr;
+  for (auto &candidate : m_threadBuffers) {
+    if (candidate->retired.load()) {
+      buffer = candidate.get();
+      break;
+    }
+  }
+  if (buffer) {
+    drainRetiredBuffer(*buffer);
+  } else {
+    m_threadBuffers.push_back(
+        std::make_unique<cx::trace::ThreadBuffer>(m_traceCapacity));
+    buffer = m_threadBuffers.back().get();
+  }
+  buffer->reset(threadId, threadName);
+  t_bufferHandle.buffer = buffer;
+  return buffer;
+}
+
+void PerformanceTimer::drainRetiredBuffer(
+    const cx::trace::ThreadBuffer &buffer) {
+  // the owning thread has exited, so nothing is writing to the buffer
+  auto events = buffer.snapshot();
+  if (events.empty())
+    return;
+  m_retiredEventCount += events.size();
+  m_retiredThreads.push_back(
+      {buffer.threadId(), buffer.threadName(), std::move(events)});
+
+  // keep no more than a few full buffers' worth, dropping the oldest threads
+  const size_t limit = 16 * m_traceCapacity;
+  size_t dropped = 0;
+  while (m_retiredEventCount > limit && dropped + 1 < m_retiredThreads.size()) {
+    m_retiredEventCount -= m_retiredThreads[dropped].events.size();
+    dropped++;
+  }
+  m_retiredThreads.erase(m_retiredThreads.begin(),
+                         m_retiredThreads.begin() + dropped);
+}
+
+quint32 PerformanceTimer::internName(const QString &name) {
+  // names are looked up per thread first so steady-state recording is
+  // lock free
+  auto loc = t_nameIds.constFind(name);
+  if (loc != t_nameIds.constEnd())
+    return *loc;
+
+  QMutexLocker lock(&m_traceMutex);
+  auto global = m_traceNameIds.constFind(name);
+  quint32 id;
+  if (global != m_traceNameIds.constEnd()) {
+    id = *global;
+  } else {
+    id = m_traceNames.size();
+    m_traceNames.append(name);
+    m_traceNameIds.insert(name, id);
+  }
+  t_nameIds.insert(name, id);
+  return id;
+}
+
+void PerformanceTimer::recordTraceEvent(char phase, const QString &name) {
+  const qint64 timestamp = m_traceClock.nsecsElapsed();
+  const quint32 nameId = internName(name);
+  threadBuffer()->push(phase, nameId, timestamp);
+}
+
+bool PerformanceTimer::writeTrace(const QString &filename) const {
+  nlohmann::json events = nlohmann::json::array();
+  auto appendThread = [&](quint32 tid, const QString &threadName,
+                          const std::vector<cx::trace::Event> &threadEvents) {
+    events.push_back({{"name", "thread_name"},
+                      {"ph", "M"},
+                      {"pid", 1},
+                      {"tid", tid},
+                      {"args", {{"name", threadName}}}});
+
+    // a wrapped ring can start part way through a scope, drop end events
+    // that have no matching begin
+    int open = 0;
+    for (const auto &event : threadEvents) {
+      if (event.nameId >= static_cast<quint32>(m_traceNames.size()))
+        continue;
+      if (event.phase == 'E') {
+        if (open == 0)
+          continue;
+        open--;
+      } else {
+        open++;
+      }
+      events.push_back({{"name", m_traceNames[event.nameId]},
+                        {"ph", std::string(1, event.phase)},
+                        {"ts", event.timestamp_ns / 1000.0},
+                        {"pid", 1},
+                        {"tid", tid},
+                        {"args", {{"depth", event.depth}}}});
+    }
+  };
+
+  {
+    QMutexLocker lock(&m_traceMutex);
+    for (const auto &retired : m_retiredThreads) {
+      appendThread(retired.threadId, retired.threadName, retired.events);
+    }
+    for (const auto &buffer : m_threadBuffers) {
+      appendThread(buffer->threadId(), buffer->threadName(),
+                   buffer->snapshot());
+    }
+  }
+
+  QFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "PerformanceTimer: could not write trace to" << filename;
+    return false;
+  }
+  nlohmann::json doc = {{"traceEvents", events}, {"displayTimeUnit", "ms"}};
+  file.write(QByteArray::fromStdString(doc.dump()));
+  qDebug() << "PerformanceTimer: wrote" << events.size() << "trace events to"
+           << filename;
+  return true;
+}
+
+void PerformanceTimer::clearTrace() {
+  QMutexLocker lock(&m_traceMutex);
+  for (auto &buffer : m_threadBuffers) {
+    buffer->markCleared();
+  }
+  m_retiredThreads.clear();
+  m_retiredEventCount = 0;
+}
@@ -3,11 +3,76 @@
 #include <QElapsedTimer>
 #include <QString>
 #include <QDebug>
+#include <QHash>
 #include <QMap>
+#include <QStringList>
+#include <QMutex>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 // Define CX_ENABLE_PERFORMANCE_TIMING in CMake or as a compile flag to enable timing
 // e.g., cmake -DCX_ENABLE_PERFORMANCE_TIMING=ON or add -DCX_ENABLE_PERFORMANCE_TIMING to compiler flags
+//
+// In addition to the per-name averages, timers can record every begin/end
+// event with its thread and nesting depth (trace mode), exported as Chrome
+// trace-event JSON for chrome://tracing or https://ui.perfetto.dev.
+// Set CX_TRACE_FILE=trace.json in the environment to record from startup
+// and write the trace at exit, or use PERF_TRACE_SET_ENABLED/PERF_TRACE_WRITE.
+
+namespace cx::trace {
+
+struct Event {
+    qint64 timestamp_ns{0};
+    quint32 nameId{0};
+    quint16 depth{0};
+    char phase{'B'}; // 'B' begin, 'E' end
+};
+
+// Fixed size ring of events written only by its owning thread, so recording
+// needs no locks. Readers copy the ring and then discard any slots the
+// writer may have overwritten while they were copying.
+class ThreadBuffer {
+public:
+    explicit ThreadBuffer(size_t capacity) : m_events(capacity) {}
+
+    inline void push(char phase, quint32 nameId, qint64 timestamp_ns) {
+        if (phase == 'E' && m_depth > 0) m_depth--;
+        const quint64 head = m_head.load(std::memory_order_relaxed);
+        m_events[head % m_events.size()] = {timestamp_ns, nameId, m_depth, phase};
+        m_head.store(head + 1, std::memory_order_release);
+        if (phase == 'B') m_depth++;
+    }
+
+    std::vector<Event> snapshot() const;
+    // hide everything recorded so far, safe while the owner is writing
+    void markCleared();
+    // only for buffers whose owning thread has exited
+    void reset(quint32 threadId, const QString &threadName);
+
+    inline quint32 threadId() const { return m_threadId; }
+    inline const QString &threadName() const { return m_threadName; }
+
+    std::atomic<bool> retired{false};
+
+private:
+    std::vector<Event> m_events;
+    std::atomic<quint64> m_head{0};
+    std::atomic<quint64> m_cleared{0};
+    quint16 m_depth{0};
+    quint32 m_threadId{0};
+    QString m_threadName;
+};
+
+// What an exited thread recorded, kept for export once its buffer has been
+// handed to another thread
+struct RetiredThread {
+    quint32 threadId{0};
+    QString threadName;
+    std::vector<Event> events;
+};
+
+} // namespace cx::trace
 
 class PerformanceTimer {
 public:
@@ -22,11 +87,17 @@ public:
         return timer;
     }
 
+    ~PerformanceTimer();
+
     void startTiming(const QString &name) {
+        if (tracingEnabled()) recordTraceEvent('B', name);
+        QMutexLocker lock(&m_mutex);
         m_currentTimings[name].start();
     }
 
     void endTiming(const QString &name) {
+        if (tracingEnabled()) recordTraceEvent('E', name);
+        QMutexLocker lock(&m_mutex);
         if (!m_currentTimings.contains(name)) {
             qWarning() << "PerformanceTimer: No start timing found for" << name;
             return;
@@ -45,11 +116,15 @@ public:
     }
 
     void startFrame() {
+        if (tracingEnabled()) recordTraceEvent('B', QStringLiteral("Frame"));
+        QMutexLocker lock(&m_mutex);
         m_frameTimings.clear();
         m_frameTimer.start();
     }
 
     void endFrame() {
+        if (tracingEnabled()) recordTraceEvent('E', QStringLiteral("Frame"));
+        QMutexLocker lock(&m_mutex);
         qint64 totalFrame = m_frameTimer.nsecsElapsed();
         m_frameTimings.push_back({"Total Frame", totalFrame});
         
@@ -78,9 +153,27 @@ public:
     const std::vector<TimingData>& getLastFrameTimings() const { return m_frameTimings; }
     const QMap<QString, double>& getAverages() const { return m_averages; }
 
+    // Trace mode
+    inline bool tracingEnabled() const {
+        return m_tracing.load(std::memory_order_relaxed);
+    }
+    void setTracingEnabled(bool enabled) { m_tracing.store(enabled); }
+    // events kept per thread before the oldest are overwritten
+    void setTraceBufferCapacity(size_t events) { m_traceCapacity = events; }
+    // written by the destructor, i.e. at application exit
+    void setTraceOutputFile(const QString &filename) { m_traceFile = filename; }
+    void recordTraceEvent(char phase, const QString &name);
+    bool writeTrace(const QString &filename) const;
+    void clearTrace();
+
 private:
-    PerformanceTimer() = default;
-    
+    PerformanceTimer();
+
+    cx::trace::ThreadBuffer *threadBuffer();
+    void drainRetiredBuffer(const cx::trace::ThreadBuffer &);
+    quint32 internName(const QString &name);
+
+    mutable QMutex m_mutex;
     QMap<QString, QElapsedTimer> m_currentTimings;
     std::vector<TimingData> m_frameTimings;
     QMap<QString, double> m_averages;
@@ -89,6 +182,18 @@ private:
     bool m_enabledOutput{false};
     int m_outputFrequency{60}; // Print every 60 frames
     int m_frameCount{0};
+
+    std::atomic<bool> m_tracing{false};
+    size_t m_traceCapacity{1 << 16};
+    QString m_traceFile;
+    QElapsedTimer m_traceClock;
+    mutable QMutex m_traceMutex; // guards registration and export only
+    std::vector<std::unique_ptr<cx::trace::ThreadBuffer>> m_threadBuffers;
+    std::vector<cx::trace::RetiredThread> m_retiredThreads;
+    size_t m_retiredEventCount{0};
+    QStringList m_traceNames;
+    QHash<QString, quint32> m_traceNameIds;
+    quint32 m_nextThreadId{1};
 };
 
 // RAII helper for automatic timing
@@ -115,6 +220,8 @@ private:
   #define PERF_FRAME_END() PerformanceTimer::instance().endFrame()
   #define PERF_TIMER_SET_ENABLED(enabled) PerformanceTimer::instance().setEnabled(enabled)
   #define PERF_TIMER_SET_FREQUENCY(frames) PerformanceTimer::instance().setOutputFrequency(frames)
+  #define PERF_TRACE_SET_ENABLED(enabled) PerformanceTimer::instance().setTracingEnabled(enabled)
+  #define PERF_TRACE_WRITE(filename) PerformanceTimer::instance().writeTrace(filename)
 #else
   // No-op macros when performance timing is disabled
   #define PERF_TIMER_START(name) ((void)0)
@@ -124,4 +231,6 @@ private:
   #define PERF_FRAME_END() ((void)0)
   #define PERF_TIMER_SET_ENABLED(enabled) ((void)0)
   #define PERF_TIMER_SET_FREQUENCY(frames) ((void)0)
+  #define PERF_TRACE_SET_ENABLED(enabled) ((void)0)
+  #define PERF_TRACE_WRITE(filename) ((void)0)
 #endif
\ No newline at end of file
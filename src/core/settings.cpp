@@ -95,6 +95,7 @@ static const QMap<QString, QVariant> defaults{
     {keys::USE_PERSPECTIVE_FLAG, false},
     {keys::MAIN_WINDOW_SIZE, QSize(1920, 1080)},
     {keys::FACE_HIGHLIGHT_COLOR, "red"},
+    {keys::GLTF_QUANTIZE_INSTANCES, false},
     // Special -- for development only
     {keys::ALLOW_CSV_FINGERPRINT_EXPORT, true},
     {keys::ENERGY_FRAMEWORK_POSITIVE_COLOR, QColor("#ffac00")},
@@ -76,6 +76,9 @@ const QString XTB_EXECUTABLE = XTB_GROUP + "/executablePath";
 // Custom Energy Calculators
 const QString CUSTOM_GROUP = "custom";
 const QString CUSTOM_CALCULATORS = CUSTOM_GROUP + "/calculators";
+const QString CUSTOM_COMMANDS = CUSTOM_GROUP + "/commands";
+// Calculators kept running between pairs, see CalculatorWorkerPool
+const QString CUSTOM_PERSISTENT_CALCULATORS = CUSTOM_GROUP + "/persistentCalculators";
 
 const QString XH_NORMALIZATION = "XHNormalization";
 const QString CH_BOND_LENGTH = "CHBondLength";
@@ -166,6 +169,9 @@ const QString MAIN_WINDOW_SIZE = "general/mainWindowSize";
 const QString FACE_HIGHLIGHT_COLOR = "fingerprint/faceHighlightColor";
 const QString ALLOW_CSV_FINGERPRINT_EXPORT = "fingerprint/allowCsvExport";
 
+// Store instanced glTF transforms as 16-bit integers (KHR_mesh_quantization)
+const QString GLTF_QUANTIZE_INSTANCES = "export/gltfQuantizeInstances";
+
 // Energy Structure
 const QString ENERGY_FRAMEWORK_SCALE = "energyFrameworkScale";
 const QString ENERGY_COLOR_SCHEME = "energyColourScheme";
@@ -68,6 +68,7 @@ void CrystalStructure::updateBondGraph() {
   m_covalentBonds.clear();
   m_hydrogenBonds.clear();
   m_vdwContacts.clear();
+  fragmentsChanged();
   m_fragments.clear();
   m_fragmentForAtom.clear();
   m_fragmentForAtom.resize(numberOfAtoms(), FragmentIndex{-1});
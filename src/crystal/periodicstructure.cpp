@@ -150,6 +150,7 @@ void PeriodicStructure::updateBondGraph() {
   m_covalentBonds.clear();
   m_hydrogenBonds.clear();
   m_vdwContacts.clear();
+  fragmentsChanged();
   m_fragments.clear();
   m_fragmentForAtom.clear();
   m_fragmentForAtom.resize(numberOfAtoms(), FragmentIndex{-1});
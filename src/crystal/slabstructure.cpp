@@ -58,6 +58,7 @@ void SlabStructure::buildFromCrystal(const CrystalStructure &crystal,
   // Clear base class data
   m_periodicAtomOffsets.clear();
   m_periodicAtomMap.clear();
+  fragmentsChanged();
   m_fragments.clear();
   m_fragmentForAtom.clear();
   
@@ -469,6 +470,7 @@ void SlabStructure::resetAtomsAndBonds(bool toSelection) {
   clearAtoms();
   m_periodicAtomOffsets.clear();
   m_periodicAtomMap.clear();
+  fragmentsChanged();
   m_fragments.clear();
   m_fragmentForAtom.clear();
   
@@ -1,6 +1,12 @@
 #include "surface_cut_generator.h"
 #include <occ/crystal/surface.h>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+#ifdef CX_HAS_CONCURRENT
+#include <QtConcurrent>
+#endif
 
 namespace cx::crystal {
 
@@ -72,19 +78,218 @@ QList<SlabStructure*> generateSuggestedSurfaceCuts(
   CrystalStructure *crystalStructure,
   int h, int k, int l,
   double thickness
+) {
+  if (h == 0 && k == 0 && l == 0) {
+    return {};
+  }
+
+  // Screen the plane first so the slabs come out ordered by fewest cut
+  // dimers, without building geometry for the candidates up front
+  const auto candidates =
+      screenSurfaceCuts(crystalStructure, {occ::crystal::HKL{h, k, l}});
+  return generateScreenedSurfaceCuts(crystalStructure, candidates,
+                                     static_cast<int>(candidates.size()),
+                                     thickness);
+}
+
+namespace {
+
+// Shared, read-only data for screening every candidate face. Everything
+// here is independent of the Miller plane so it is computed exactly once.
+struct ScreeningContext {
+  occ::Mat3N centroids;       // unit cell molecule centroids
+  occ::Mat3N neighborOffsets; // c_b - c_a for every unit cell neighbor
+  std::vector<int> neighborOwner;
+  std::vector<double> neighborEnergy;
+  double cellVolume{1.0};
+};
+
+ScreeningContext
+buildScreeningContext(const occ::crystal::Crystal &crystal,
+                      const occ::crystal::CrystalDimers &dimers,
+                      const std::vector<double> &uniqueDimerEnergies) {
+  ScreeningContext ctx;
+  ctx.cellVolume = crystal.unit_cell().volume();
+
+  const auto &ucMols = crystal.unit_cell_molecules();
+  ctx.centroids.resize(3, ucMols.size());
+  for (int i = 0; i < ucMols.size(); i++) {
+    ctx.centroids.col(i) = ucMols[i].centroid();
+  }
+
+  size_t total = 0;
+  for (const auto &neighbors : dimers.molecule_neighbors) {
+    total += neighbors.size();
+  }
+  ctx.neighborOffsets.resize(3, total);
+  ctx.neighborOwner.reserve(total);
+  ctx.neighborEnergy.reserve(total);
+
+  size_t n = 0;
+  for (int i = 0; i < dimers.molecule_neighbors.size(); i++) {
+    for (const auto &[dimer, uniqueIndex] : dimers.molecule_neighbors[i]) {
+      ctx.neighborOffsets.col(n) = dimer.b().centroid() - dimer.a().centroid();
+      ctx.neighborOwner.push_back(i);
+      double e = dimer.interaction_energy();
+      if (uniqueIndex >= 0 &&
+          static_cast<size_t>(uniqueIndex) < uniqueDimerEnergies.size()) {
+        e = uniqueDimerEnergies[uniqueIndex];
+      }
+      ctx.neighborEnergy.push_back(e);
+      n++;
+    }
+  }
+  return ctx;
+}
+
+// A dimer is cut by the family of planes z = offset + n (z in units of the
+// interplanar depth) once for each plane lying between its two centroids,
+// so no slab geometry or translated molecules are required.
+std::vector<SurfaceCutCandidate>
+screenFace(const occ::crystal::Crystal &crystal, const ScreeningContext &ctx,
+           const occ::crystal::HKL &hkl) {
+  std::vector<SurfaceCutCandidate> result;
+  try {
+    occ::crystal::Surface surface(hkl, crystal);
+    const double depth = surface.depth();
+    const occ::Vec3 normal = surface.normal_vector() / depth;
+
+    const occ::Vec za = ctx.centroids.transpose() * normal;
+    const occ::Vec dz = ctx.neighborOffsets.transpose() * normal;
+
+    // each dimer appears in the neighbor list of both molecules
+    const double scale =
+        0.5 * surface.area() * depth / ctx.cellVolume;
+
+    for (double offset : surface.possible_cuts(ctx.centroids)) {
+      double crossings = 0.0;
+      double energy = 0.0;
+      for (int n = 0; n < dz.rows(); n++) {
+        double zA = za(ctx.neighborOwner[n]) - offset;
+        double planes =
+            std::abs(std::floor(zA + dz(n)) - std::floor(zA));
+        crossings += planes;
+        energy += planes * ctx.neighborEnergy[n];
+      }
+      SurfaceCutCandidate candidate;
+      candidate.hkl = hkl;
+      candidate.cutOffset = offset;
+      candidate.dSpacing = surface.d();
+      candidate.area = surface.area();
+      candidate.cutDimers = static_cast<int>(std::lround(crossings * scale));
+      candidate.cutEnergy = energy * scale;
+      result.push_back(candidate);
+    }
+  } catch (const std::exception &e) {
+    qDebug() << "Error screening surface" << hkl.h << hkl.k << hkl.l << ":"
+             << e.what();
+  }
+  return result;
+}
+
+} // namespace
+
+std::vector<SurfaceCutCandidate>
+screenSurfaceCuts(CrystalStructure *crystalStructure,
+                  const std::vector<occ::crystal::HKL> &faces,
+                  const SurfaceCutScreeningOptions &options) {
+  std::vector<SurfaceCutCandidate> results;
+  if (!crystalStructure) {
+    return results;
+  }
+
+  const auto &crystal = crystalStructure->occCrystal();
+
+  std::vector<occ::crystal::HKL> hkls;
+  for (const auto &hkl : faces) {
+    if (hkl.h == 0 && hkl.k == 0 && hkl.l == 0)
+      continue;
+    hkls.push_back(hkl);
+  }
+  if (faces.empty()) {
+    occ::crystal::CrystalSurfaceGenerationParameters params;
+    params.d_min = options.dMin;
+    params.d_max = options.dMax;
+    params.unique = options.uniqueFacesOnly;
+    for (const auto &surface : occ::crystal::generate_surfaces(crystal, params)) {
+      hkls.push_back(surface.hkl());
+    }
+  }
+
+  // Reuse the structure's dimers unless a larger radius was requested
+  occ::crystal::CrystalDimers localDimers;
+  const occ::crystal::CrystalDimers *dimers =
+      &crystalStructure->unitCellDimers();
+  if (options.dimerRadius > dimers->radius ||
+      dimers->molecule_neighbors.size() != crystal.unit_cell_molecules().size()) {
+    localDimers = crystal.unit_cell_dimers(
+        std::max(options.dimerRadius, dimers->radius));
+    dimers = &localDimers;
+  }
+
+  const ScreeningContext ctx =
+      buildScreeningContext(crystal, *dimers, options.uniqueDimerEnergies);
+
+  auto screen = [&crystal, &ctx](const occ::crystal::HKL &hkl) {
+    return screenFace(crystal, ctx, hkl);
+  };
+
+#ifdef CX_HAS_CONCURRENT
+  auto perFace = QtConcurrent::blockingMapped<
+      std::vector<std::vector<SurfaceCutCandidate>>>(hkls, screen);
+#else
+  std::vector<std::vector<SurfaceCutCandidate>> perFace;
+  perFace.reserve(hkls.size());
+  for (const auto &hkl : hkls) {
+    perFace.push_back(screen(hkl));
+  }
+#endif
+
+  for (const auto &candidates : perFace) {
+    results.insert(results.end(), candidates.begin(), candidates.end());
+  }
+
+  if (options.ranking == SurfaceCutRanking::Energy) {
+    std::stable_sort(results.begin(), results.end(),
+                     [](const SurfaceCutCandidate &a,
+                        const SurfaceCutCandidate &b) {
+                       return a.cutEnergy > b.cutEnergy;
+                     });
+  } else {
+    std::stable_sort(results.begin(), results.end(),
+                     [](const SurfaceCutCandidate &a,
+                        const SurfaceCutCandidate &b) {
+                       if (a.cutDimers != b.cutDimers)
+                         return a.cutDimers < b.cutDimers;
+                       return a.cutEnergy > b.cutEnergy;
+                     });
+  }
+
+  if (options.maxResults > 0 &&
+      results.size() > static_cast<size_t>(options.maxResults)) {
+    results.resize(options.maxResults);
+  }
+  return results;
+}
+
+QList<SlabStructure*> generateScreenedSurfaceCuts(
+  CrystalStructure *crystalStructure,
+  const std::vector<SurfaceCutCandidate> &candidates,
+  int count,
+  double thickness
 ) {
   QList<SlabStructure*> results;
-  
-  std::vector<double> cuts = getSuggestedCuts(crystalStructure, h, k, l);
-  
-  for (double cut : cuts) {
-    SlabStructure* cutStructure = generateSurfaceCut(
-      crystalStructure, h, k, l, cut, thickness);
+  for (const auto &candidate : candidates) {
+    if (results.size() >= count) {
+      break;
+    }
+    SlabStructure *cutStructure = generateSurfaceCut(
+        crystalStructure, candidate.hkl.h, candidate.hkl.k, candidate.hkl.l,
+        candidate.cutOffset, thickness);
     if (cutStructure) {
       results.append(cutStructure);
     }
   }
-  
   return results;
 }
 
@@ -39,6 +39,10 @@ std::vector<double> getSuggestedCuts(
 
 /**
  * \brief Generate multiple surface cuts at suggested positions
+ *
+ * Cuts are screened with screenSurfaceCuts and returned with the fewest
+ * cut dimers first.
+ *
  * \param crystalStructure The source crystal structure
  * \param h Miller index h
  * \param k Miller index k
@@ -52,6 +56,81 @@ QList<SlabStructure*> generateSuggestedSurfaceCuts(
   double thickness = 5.0
 );
 
+/**
+ * \brief Quantity used to order screened surface cut candidates
+ */
+enum class SurfaceCutRanking {
+  DimerCount, ///< Fewest dimers crossing the cut plane first
+  Energy      ///< Weakest (least negative) attachment energy first
+};
+
+/**
+ * \brief Options controlling batch surface cut screening
+ */
+struct SurfaceCutScreeningOptions {
+  double dMin{0.1};     ///< Minimum d-spacing used to enumerate faces
+  double dMax{1.0};     ///< Maximum d-spacing used to enumerate faces
+  bool uniqueFacesOnly{true};
+  double dimerRadius{0.0}; ///< 0 = reuse the structure's unit cell dimers
+  SurfaceCutRanking ranking{SurfaceCutRanking::DimerCount};
+  int maxResults{0}; ///< 0 = return every candidate
+
+  /// Optional energies indexed by unique dimer index. When empty the
+  /// interaction energy stored on each dimer is used.
+  std::vector<double> uniqueDimerEnergies;
+};
+
+/**
+ * \brief A single (hkl, offset) candidate evaluated by screenSurfaceCuts
+ *
+ * Counts and energies are per surface cell, i.e. for one repeat of the
+ * surface lattice vectors, and each crossing dimer is counted once.
+ */
+struct SurfaceCutCandidate {
+  occ::crystal::HKL hkl;
+  double cutOffset{0.0};
+  double dSpacing{0.0};
+  double area{0.0};
+  int cutDimers{0};
+  double cutEnergy{0.0};
+};
+
+/**
+ * \brief Evaluate many surface cuts without building any slab geometry
+ *
+ * The unit cell dimers and molecule centroids are computed once and shared
+ * between every candidate; each Miller plane is then screened in parallel
+ * (when Qt Concurrent is available) by counting the dimers whose centroid
+ * separation crosses the cut plane. Results are sorted according to
+ * options.ranking.
+ *
+ * \param crystalStructure The source crystal structure
+ * \param faces Miller planes to screen, if empty faces are enumerated from
+ * the d-spacing limits in options
+ * \param options Screening options
+ * \return Ranked list of candidates
+ */
+std::vector<SurfaceCutCandidate> screenSurfaceCuts(
+  CrystalStructure *crystalStructure,
+  const std::vector<occ::crystal::HKL> &faces = {},
+  const SurfaceCutScreeningOptions &options = {}
+);
+
+/**
+ * \brief Build slab structures for the best screened candidates
+ * \param crystalStructure The source crystal structure
+ * \param candidates Candidates, typically the result of screenSurfaceCuts
+ * \param count Maximum number of slabs to build
+ * \param thickness Slab thickness in Angstroms (0 = auto)
+ * \return List of new SlabStructures
+ */
+QList<SlabStructure*> generateScreenedSurfaceCuts(
+  CrystalStructure *crystalStructure,
+  const std::vector<SurfaceCutCandidate> &candidates,
+  int count,
+  double thickness = 5.0
+);
+
 // No detail namespace needed - SlabStructure handles the conversion internally
 
 } // namespace cx::crystal
\ No newline at end of file
@@ -20,6 +20,8 @@
 #include <QtDebug>
 
 #include "aboutcrystalexplorerdialog.h"
+#include "cifblockdialog.h"
+#include "ciffile.h"
 #include "confirmationbox.h"
 #include "crystalx.h"
 #include "dialoghtml.h"
@@ -41,6 +43,7 @@
 #include "slabstructure.h"
 #include "surface_cut_generator.h"
 #include "ply_writer.h"
+#include "streaming_image_writer.h"
 #include "wavefunction_calculator.h"
 
 Crystalx::Crystalx() : QMainWindow() {
@@ -1072,7 +1075,27 @@ void Crystalx::processCif(QString &filename) {
   qDebug() << "Loading CIF file: " << filename;
   // must be done outside lambda, filename must be copied.
   showStatusMessage(QString("Loading CIF file from %1").arg(filename));
-  project->loadCrystalStructuresFromCifFile(filename);
+  if (!project->loadCifCatalogue(filename)) {
+    showStatusMessage(QString("No data blocks found in %1").arg(filename));
+    return;
+  }
+
+  // structures are only built for the blocks that are opened
+  const CifCatalogue *catalogue = project->cifCatalogue();
+  QList<int> blocks;
+  if (catalogue->numberOfBlocks() > 1) {
+    CifBlockDialog dialog(catalogue, this);
+    if (dialog.exec() != QDialog::Accepted) {
+      return;
+    }
+    blocks = dialog.selectedBlocks();
+  } else if (catalogue->firstValidBlock() >= 0) {
+    blocks.append(catalogue->firstValidBlock());
+  }
+
+  if (!project->openCifBlocks(blocks)) {
+    showStatusMessage(QString("No valid crystal structures in %1").arg(filename));
+  }
 }
 
 void Crystalx::processPdb(QString &filename) {
@@ -1909,14 +1932,16 @@ void Crystalx::quickExportCurrentGraphics() {
 void Crystalx::exportCurrentGraphics(const QString &filename) {
   bool success = false;
 
-  if (filename.toLower().endsWith(".png")) {
-    QImage img =
-        glWindow->exportToImage(m_exportDialog->currentResolutionScale(),
-                                m_exportDialog->currentBackgroundColor());
-    qDebug() << "Exporting image with scale factor"
-             << m_exportDialog->currentResolutionScale() << "resolution"
-             << img.size();
-    success = img.save(filename);
+  if (cx::io::StreamingImageWriter::formatForFilename(filename)) {
+    const int scale = m_exportDialog->currentResolutionScale();
+    qDebug() << "Exporting image with scale factor" << scale << "resolution"
+             << glWindow->size() * scale;
+    const QColor background = m_exportDialog->currentBackgroundColor();
+    if (m_exportDialog->rayTracingSelected()) {
+      success = glWindow->exportRayTracedImageFile(filename, scale, background);
+    } else {
+      success = glWindow->exportToImageFile(filename, scale, background);
+    }
   } else {
     QFile outputFile(filename);
     outputFile.open(QIODevice::WriteOnly);
@@ -1978,6 +2003,10 @@ void Crystalx::handleExportToGLTF() {
 
     // Set binary format based on file extension
     options.binaryFormat = filename.endsWith(".glb", Qt::CaseInsensitive);
+    // A node per atom makes large structures slow to write and to load
+    options.gpuInstancing = structure->numberOfAtoms() > 10000;
+    options.quantizeInstances =
+        settings::readSetting(settings::keys::GLTF_QUANTIZE_INSTANCES).toBool();
 
     // Use scene export to get current display state including framework
     bool success = exporter.exportScene(project->currentScene(), filename, options);
@@ -2391,68 +2420,10 @@ void Crystalx::calculatePairEnergiesWithExistingWavefunctions(
   if (!structure)
     return;
 
-  std::vector<MolecularWavefunction *> wavefunctions;
-  for (const auto &wfn : modelParameters.wavefunctions) {
-    auto candidates = structure->wavefunctionsAndTransformsForAtoms(wfn.atoms);
-    bool found = false;
-    qDebug() << "Found " << candidates.size() << "candidates";
-    for (auto &candidate : candidates) {
-      if (wfn.hasEquivalentMethodTo(candidate.wavefunction->parameters())) {
-        found = true;
-        wavefunctions.push_back(candidate.wavefunction);
-        break;
-      }
-    }
-    if (!found) {
-      qDebug() << "Unable to find corresponding wavefunction...";
-    }
-  }
-
   std::vector<pair_energy::Parameters> energies;
-
-  auto *pairInteractions = structure->pairInteractions();
-  for (const auto &pair : modelParameters.pairs) {
-    pair_energy::Parameters p;
-    p.fragmentDimer = pair;
-    p.structure = structure;
-    p.atomsA = pair.a.atomIndices;
-    p.atomsB = pair.b.atomIndices;
-    p.model = modelParameters.model;
-
-    bool foundA = false;
-    bool foundB = false;
-    for (auto *wfn : wavefunctions) {
-      if (foundA && foundB)
-        break;
-      if (!foundA) {
-        foundA = structure->getTransformation(wfn->atomIndices(), p.atomsA,
-                                              p.transformA);
-        if (foundA) {
-          qDebug() << "Found wavefunction for A";
-          p.wfnA = wfn;
-        }
-      }
-      if (!foundB) {
-        foundB = structure->getTransformation(wfn->atomIndices(), p.atomsB,
-                                              p.transformB);
-        if (foundB) {
-          qDebug() << "Found wavefunction for B";
-          p.wfnB = wfn;
-        }
-      }
-    }
-    if (!foundA && foundB) {
-      qDebug() << "Unable to find wavefunctions for A and B";
-      return;
-    }
-
-    QString model = modelParameters.model.toUpper();
-    auto *existingInteraction = pairInteractions->getInteraction(model, pair);
-    if (!existingInteraction) {
-      energies.push_back(p);
-    } else {
-      qDebug() << "Found matching interaction:" << existingInteraction;
-    }
+  if (!PairEnergyCalculator::resolvePairParameters(structure, modelParameters,
+                                                   energies)) {
+    return;
   }
 
   PairEnergyCalculator *calc = new PairEnergyCalculator(this);
@@ -0,0 +1,183 @@
+#include "cifblockdialog.h"
+#include "ciffile.h"
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QPushButton>
+#include <QVBoxLayout>
+#include <algorithm>
+
+CifCatalogueModel::CifCatalogueModel(const CifCatalogue *catalogue, QObject *parent)
+    : QAbstractTableModel(parent), m_catalogue(catalogue) {}
+
+int CifCatalogueModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid() || !m_catalogue)
+        return 0;
+    return m_catalogue->numberOfBlocks();
+}
+
+int CifCatalogueModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : NumberOfColumns;
+}
+
+QVariant CifCatalogueModel::data(const QModelIndex &index, int role) const {
+    if (!m_catalogue || !index.isValid())
+        return {};
+    const CifBlockSummary &summary = m_catalogue->summary(index.row());
+
+    if (role == Qt::ToolTipRole && !summary.isValid()) {
+        return "No unit cell or atom sites found in this block";
+    }
+    if (role == Qt::TextAlignmentRole && index.column() >= A) {
+        return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole && role != Qt::UserRole)
+        return {};
+
+    // UserRole gives numbers for sorting
+    switch (index.column()) {
+    case Name:
+        return summary.name;
+    case Formula:
+        return summary.formula;
+    case SpaceGroup:
+        return summary.spaceGroup;
+    case A:
+    case B:
+    case C:
+    case Alpha:
+    case Beta:
+    case Gamma: {
+        double value = summary.cell[index.column() - A];
+        if (role == Qt::UserRole)
+            return value;
+        return value > 0.0 ? QString::number(value, 'f', 3) : QString();
+    }
+    case Atoms:
+        return summary.numberOfAtomSites;
+    default:
+        return {};
+    }
+}
+
+QVariant CifCatalogueModel::headerData(int section, Qt::Orientation orientation,
+                                       int role) const {
+    if (role != Qt::DisplayRole)
+        return {};
+    if (orientation == Qt::Vertical)
+        return section + 1;
+
+    switch (section) {
+    case Name:
+        return "Block";
+    case Formula:
+        return "Formula";
+    case SpaceGroup:
+        return "Space group";
+    case A:
+        return "a (Å)";
+    case B:
+        return "b (Å)";
+    case C:
+        return "c (Å)";
+    case Alpha:
+        return "α (°)";
+    case Beta:
+        return "β (°)";
+    case Gamma:
+        return "γ (°)";
+    case Atoms:
+        return "Sites";
+    default:
+        return {};
+    }
+}
+
+Qt::ItemFlags CifCatalogueModel::flags(const QModelIndex &index) const {
+    if (!m_catalogue || !index.isValid())
+        return Qt::NoItemFlags;
+    if (!m_catalogue->summary(index.row()).isValid())
+        return Qt::NoItemFlags;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+CifBlockDialog::CifBlockDialog(const CifCatalogue *catalogue, QWidget *parent)
+    : QDialog(parent), m_catalogue(catalogue) {
+    setupUI();
+}
+
+void CifBlockDialog::setupUI() {
+    setWindowTitle("Open Structures from CIF");
+    resize(800, 500);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText("Filter by block name, formula or space group");
+    m_filterEdit->setClearButtonEnabled(true);
+    mainLayout->addWidget(m_filterEdit);
+
+    m_model = new CifCatalogueModel(m_catalogue, this);
+    m_proxyModel = new QSortFilterProxyModel(this);
+    m_proxyModel->setSourceModel(m_model);
+    m_proxyModel->setSortRole(Qt::UserRole);
+    m_proxyModel->setFilterKeyColumn(-1);
+    m_proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    connect(m_filterEdit, &QLineEdit::textChanged, m_proxyModel,
+            &QSortFilterProxyModel::setFilterFixedString);
+
+    m_tableView = new QTableView(this);
+    m_tableView->setModel(m_proxyModel);
+    m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_tableView->setSortingEnabled(true);
+    m_tableView->sortByColumn(-1, Qt::AscendingOrder);
+    m_tableView->setAlternatingRowColors(true);
+    m_tableView->verticalHeader()->setDefaultSectionSize(
+        m_tableView->fontMetrics().height() + 6);
+    // uniform rows keep the view cheap for very large catalogues
+    m_tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_tableView->horizontalHeader()->setSectionResizeMode(
+        CifCatalogueModel::Formula, QHeaderView::Stretch);
+    mainLayout->addWidget(m_tableView);
+
+    m_selectionLabel = new QLabel(this);
+    mainLayout->addWidget(m_selectionLabel);
+
+    m_buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Open | QDialogButtonBox::Cancel, this);
+    connect(m_buttonBox, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(m_buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(m_tableView, &QTableView::doubleClicked, this, &QDialog::accept);
+    connect(m_tableView->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &CifBlockDialog::updateSelectionLabel);
+    mainLayout->addWidget(m_buttonBox);
+
+    setLayout(mainLayout);
+
+    const int first = m_catalogue ? m_catalogue->firstValidBlock() : -1;
+    if (first >= 0) {
+        QModelIndex index = m_proxyModel->mapFromSource(m_model->index(first, 0));
+        m_tableView->selectionModel()->select(
+            index, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
+        m_tableView->scrollTo(index);
+    }
+    updateSelectionLabel();
+}
+
+void CifBlockDialog::updateSelectionLabel() {
+    const int selected = m_tableView->selectionModel()->selectedRows().size();
+    m_selectionLabel->setText(QString("%1 of %2 blocks selected")
+                                  .arg(selected)
+                                  .arg(m_model->rowCount()));
+    m_buttonBox->button(QDialogButtonBox::Open)->setEnabled(selected > 0);
+}
+
+QList<int> CifBlockDialog::selectedBlocks() const {
+    QList<int> result;
+    const auto rows = m_tableView->selectionModel()->selectedRows();
+    for (const QModelIndex &index : rows) {
+        result.append(m_proxyModel->mapToSource(index).row());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
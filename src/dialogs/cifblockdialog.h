@@ -0,0 +1,53 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QSortFilterProxyModel>
+#include <QTableView>
+
+class CifCatalogue;
+
+// Table of the data blocks in a CIF catalogue, read directly from the block
+// summaries so large catalogues need no per-row items
+class CifCatalogueModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { Name, Formula, SpaceGroup, A, B, C, Alpha, Beta, Gamma, Atoms, NumberOfColumns };
+
+    explicit CifCatalogueModel(const CifCatalogue *catalogue, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+    const CifCatalogue *m_catalogue{nullptr};
+};
+
+class CifBlockDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit CifBlockDialog(const CifCatalogue *catalogue, QWidget *parent = nullptr);
+
+    // Catalogue indices of the selected blocks, in catalogue order
+    QList<int> selectedBlocks() const;
+
+private:
+    void setupUI();
+    void updateSelectionLabel();
+
+    const CifCatalogue *m_catalogue{nullptr};
+    CifCatalogueModel *m_model{nullptr};
+    QSortFilterProxyModel *m_proxyModel{nullptr};
+    QLineEdit *m_filterEdit{nullptr};
+    QTableView *m_tableView{nullptr};
+    QLabel *m_selectionLabel{nullptr};
+    QDialogButtonBox *m_buttonBox{nullptr};
+};
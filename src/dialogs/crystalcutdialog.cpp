@@ -192,19 +192,24 @@ void CrystalCutDialog::updateSuggestedOffsets() {
         return;
     }
     
-    // Get structure-based suggestions using the same function as PlaneGenerationDialog
-    std::vector<double> cuts = cx::crystal::getSuggestedCuts(_crystalStructure, _options.h, _options.k, _options.l);
-    
-    if (cuts.empty()) {
+    if (_options.h == 0 && _options.k == 0 && _options.l == 0) {
         ui->suggestedOffsetsList->addItem("No suggestions available for this plane");
         return;
     }
-    
-    // Convert fractional cuts to d-spacing multiples and add to list
-    for (double cut : cuts) {
-        QString suggestion = QString("%1 d (fractional: %2)")
-                            .arg(cut, 0, 'f', 3)
-                            .arg(cut, 0, 'f', 4);
+
+    // Screen the molecule-preserving cuts for this plane, fewest cut dimers first
+    auto candidates = cx::crystal::screenSurfaceCuts(
+        _crystalStructure, {occ::crystal::HKL{_options.h, _options.k, _options.l}});
+
+    if (candidates.empty()) {
+        ui->suggestedOffsetsList->addItem("No suggestions available for this plane");
+        return;
+    }
+
+    for (const auto &candidate : candidates) {
+        QString suggestion = QString("%1 d (%2 dimers cut)")
+                            .arg(candidate.cutOffset, 0, 'f', 3)
+                            .arg(candidate.cutDimers);
         ui->suggestedOffsetsList->addItem(suggestion);
     }
 }
@@ -2,7 +2,7 @@
 #include "predictelastictensordialog.h"
 #include "chemicalstructure.h"
 #include "scene.h"
-#include "icosphere_mesh.h"
+#include "geometry_primitives.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -260,7 +260,7 @@ void ElasticTensorInfoDocument::insertExtremaAndDirections(QTextCursor &cursor,
     cursor.insertText("\n");
     
     // Sample directions to find extrema - using icosphere vertices for good coverage
-    const int samples = 162; // 3-subdivision icosphere
+    const int samples = 162; // 2-subdivision icosphere
     double minYoung = std::numeric_limits<double>::max();
     double maxYoung = std::numeric_limits<double>::lowest();
     double minShear = std::numeric_limits<double>::max();
@@ -275,8 +275,8 @@ void ElasticTensorInfoDocument::insertExtremaAndDirections(QTextCursor &cursor,
     occ::Vec3 minCompressDir, maxCompressDir;
     occ::Vec3 minPoissonDir, maxPoissonDir;
     
-    // Create icosphere for sampling
-    auto vertices = IcosphereMesh::generateVertices(3);
+    // Shared 2-subdivision icosphere (162 vertices) for sampling
+    const auto &vertices = cx::primitives::icosphere(2)->vertices;
     
     for (int i = 0; i < vertices.cols() && i < samples; ++i) {
         occ::Vec3 dir = vertices.col(i).normalized();
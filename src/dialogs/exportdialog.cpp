@@ -12,6 +12,7 @@ ExportDialog::ExportDialog(QWidget *parent)
   QStringList resolutionOptions{"1x", "2x", "3x", "4x"};
   ui->resolutionScaleComboBox->addItems(resolutionOptions);
   ui->resolutionScaleComboBox->setCurrentText("1x");
+  ui->rendererComboBox->addItems({"OpenGL", "Ray traced (CPU)"});
   initConnections();
 }
 
@@ -49,6 +50,10 @@ int ExportDialog::currentResolutionScale() const {
   return scale;
 }
 
+bool ExportDialog::rayTracingSelected() const {
+  return ui->rendererComboBox->currentIndex() == 1;
+}
+
 void ExportDialog::updateResolutionLabel() {
   int scale = currentResolutionScale();
   if (m_currentPixmap.isNull()) {
@@ -83,7 +88,8 @@ void ExportDialog::updateBackgroundColor(const QColor &color) {
 }
 
 void ExportDialog::selectFile() {
-  QString filter = "Portable Network Graphics (*.png);; POV-ray (*.pov)";
+  QString filter = "Portable Network Graphics (*.png);; TIFF (*.tif *.tiff);; "
+                   "POV-ray (*.pov)";
   QString filePath = QFileDialog::getSaveFileName(this, tr("Export graphics"),
                                                   m_currentFilePath, filter);
 
@@ -16,6 +16,8 @@ public:
   QString currentFilePath() const { return m_currentFilePath; }
   int currentResolutionScale() const;
   QColor currentBackgroundColor() const;
+  // Trace the image on the CPU instead of rendering it with OpenGL
+  bool rayTracingSelected() const;
 
 public slots:
   void updateImage(const QImage &);
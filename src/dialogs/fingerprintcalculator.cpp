@@ -4,98 +4,298 @@
 #include "elementdata.h"
 #include "isosurface.h"
 #include <QObject>
+#include <algorithm>
+#include <vector>
 
-FingerprintCalculator::FingerprintCalculator(Mesh *mesh) : m_mesh(mesh) {}
+namespace {
 
-void FingerprintCalculator::setMesh(Mesh *mesh) {
-    m_mesh = mesh;
+// Faces processed between checks for cancellation
+constexpr int CancelCheckInterval = 4096;
+
+// Maps atomic number -> position of the first matching symbol, -1 elsewhere
+std::vector<int> elementLookup(const QStringList &elementSymbols) {
+    std::vector<int> lookup;
+    for (int i = 0; i < elementSymbols.size(); ++i) {
+        int atomicNumber = ElementData::atomicNumberFromElementSymbol(elementSymbols[i]);
+        if (atomicNumber < 0)
+            continue;
+        if (atomicNumber >= static_cast<int>(lookup.size()))
+            lookup.resize(atomicNumber + 1, -1);
+        if (lookup[atomicNumber] == -1)
+            lookup[atomicNumber] = i;
+    }
+    return lookup;
 }
 
-QVector<double> FingerprintCalculator::calculateElementBreakdown(const QString &insideElement, 
-                                                               const QStringList &elementSymbols) {
-    QVector<double> result;
-    if (!m_mesh)
-        return result;
+inline int lookupIndex(const std::vector<int> &lookup, int atomicNumber) {
+    if (atomicNumber < 0 || atomicNumber >= static_cast<int>(lookup.size()))
+        return -1;
+    return lookup[atomicNumber];
+}
+
+inline int dominantVertex(double a, double b, double c,
+                          const Eigen::Vector3i &face) {
+    if (a >= b && a >= c)
+        return face[0];
+    if (b >= c)
+        return face[1];
+    return face[2];
+}
 
-    // Get element assignment data
-    auto *structure = qobject_cast<ChemicalStructure *>(m_mesh->parent());
-    if (!structure)
+// Accumulates the sampled area for each (row, column) pair of inside and
+// outside elements, returned as percentages of the total surface area.
+QVector<QVector<double>>
+elementBreakdown(const FingerprintSnapshot &snapshot,
+                 const std::vector<int> &rows, int numberOfRows,
+                 const std::vector<int> &columns, int numberOfColumns,
+                 int samplesPerEdge,
+                 const FingerprintCalculator::CancelCheck &cancelled) {
+    QVector<QVector<double>> result;
+    if (!snapshot.haveElements() || snapshot.surfaceArea <= 0.0)
         return result;
-        
-    auto insideNums = structure->atomicNumbersForIndices(m_mesh->atomsInside());
-    auto outsideNums = structure->atomicNumbersForIndices(m_mesh->atomsOutside());
+
+    QVector<QVector<double>> areas(numberOfRows,
+                                   QVector<double>(numberOfColumns, 0.0));
+    const int samplesPerFace = (samplesPerEdge + 1) * (samplesPerEdge + 2) / 2;
+
+    for (int faceIdx = 0; faceIdx < snapshot.numberOfFaces(); ++faceIdx) {
+        if (cancelled && (faceIdx % CancelCheckInterval) == 0 && cancelled())
+            return {};
+        const Eigen::Vector3i face = snapshot.faces.col(faceIdx);
+        if (snapshot.insideElements(face[0]) < 0 ||
+            snapshot.insideElements(face[1]) < 0 ||
+            snapshot.insideElements(face[2]) < 0)
+            continue;
+
+        const double sampleArea = snapshot.faceAreas(faceIdx) / samplesPerFace;
+        for (int i = 0; i <= samplesPerEdge; ++i) {
+            for (int j = 0; j <= samplesPerEdge - i; ++j) {
+                double a = static_cast<double>(i) / samplesPerEdge;
+                double b = static_cast<double>(j) / samplesPerEdge;
+                double c = 1.0 - a - b;
+                int v = dominantVertex(a, b, c, face);
+                int row = lookupIndex(rows, snapshot.insideElements(v));
+                if (row < 0)
+                    continue;
+                int column = lookupIndex(columns, snapshot.outsideElements(v));
+                if (column < 0)
+                    continue;
+                areas[row][column] += sampleArea;
+            }
+        }
+    }
+
+    for (auto &row : areas) {
+        for (double &area : row) {
+            area = (area / snapshot.surfaceArea) * 100.0;
+        }
+    }
+    return areas;
+}
+
+} // namespace
+
+std::shared_ptr<const FingerprintSnapshot>
+FingerprintSnapshot::fromMesh(const Mesh *mesh) {
+    if (!mesh)
+        return nullptr;
+
+    QString diName = isosurface::getSurfacePropertyDisplayName("di");
+    QString deName = isosurface::getSurfacePropertyDisplayName("de");
+    if (!mesh->haveVertexProperty(diName) || !mesh->haveVertexProperty(deName))
+        return nullptr;
+
+    auto result = std::make_shared<FingerprintSnapshot>();
+    result->di = mesh->vertexProperty(diName).cast<double>();
+    result->de = mesh->vertexProperty(deName).cast<double>();
+    result->faces = mesh->faces();
+    result->faceAreas = mesh->faceAreas().cast<double>();
+    result->surfaceArea = mesh->surfaceArea();
+
+    // Element assignment data
+    auto *structure = qobject_cast<ChemicalStructure *>(mesh->parent());
     QString diIdxName = isosurface::getSurfacePropertyDisplayName("di_idx");
     QString deIdxName = isosurface::getSurfacePropertyDisplayName("de_idx");
-    Eigen::VectorXi di_idx = m_mesh->vertexProperty(diIdxName).cast<int>();
-    Eigen::VectorXi de_idx = m_mesh->vertexProperty(deIdxName).cast<int>();
-    
-    if (di_idx.rows() == 0 || de_idx.rows() == 0)
+    if (!structure || !mesh->haveVertexProperty(diIdxName) ||
+        !mesh->haveVertexProperty(deIdxName))
         return result;
 
-    int insideAtomicNum = ElementData::atomicNumberFromElementSymbol(insideElement);
-    
-    // Get di and de properties for sampling
-    QString diName = isosurface::getSurfacePropertyDisplayName("di");
-    QString deName = isosurface::getSurfacePropertyDisplayName("de");
-    Eigen::VectorXd di = m_mesh->vertexProperty(diName).cast<double>();
-    Eigen::VectorXd de = m_mesh->vertexProperty(deName).cast<double>();
-    
-    if (di.rows() == 0 || de.rows() == 0)
+    auto insideNums = structure->atomicNumbersForIndices(mesh->atomsInside());
+    auto outsideNums = structure->atomicNumbersForIndices(mesh->atomsOutside());
+    Eigen::VectorXi di_idx = mesh->vertexProperty(diIdxName).cast<int>();
+    Eigen::VectorXi de_idx = mesh->vertexProperty(deIdxName).cast<int>();
+
+    const int numVertices = result->numberOfVertices();
+    if (di_idx.rows() != numVertices || de_idx.rows() != numVertices)
         return result;
-    
-    QVector<double> totalFilteredArea(elementSymbols.size(), 0.0);
-    
+
+    result->insideElements = Eigen::VectorXi::Constant(numVertices, -1);
+    result->outsideElements = Eigen::VectorXi::Constant(numVertices, -1);
+    for (int v = 0; v < numVertices; ++v) {
+        const int inside = di_idx(v), outside = de_idx(v);
+        if (inside < 0 || outside < 0 || inside >= insideNums.rows() ||
+            outside >= outsideNums.rows())
+            continue;
+        result->insideElements(v) = insideNums(inside);
+        result->outsideElements(v) = outsideNums(outside);
+    }
+    return result;
+}
+
+FingerprintCalculator::FingerprintCalculator(Mesh *mesh)
+    : m_snapshot(FingerprintSnapshot::fromMesh(mesh)) {}
+
+FingerprintCalculator::FingerprintCalculator(
+    std::shared_ptr<const FingerprintSnapshot> snapshot)
+    : m_snapshot(std::move(snapshot)) {}
+
+void FingerprintCalculator::setMesh(Mesh *mesh) {
+    m_snapshot = FingerprintSnapshot::fromMesh(mesh);
+}
+
+QVector<double> FingerprintCalculator::calculateElementBreakdown(const QString &insideElement,
+                                                               const QStringList &elementSymbols) const {
+    if (!m_snapshot)
+        return {};
+    auto table = elementBreakdown(*m_snapshot, elementLookup({insideElement}), 1,
+                                  elementLookup(elementSymbols),
+                                  elementSymbols.size(), m_samplesPerEdge, {});
+    if (table.isEmpty())
+        return {};
+    return table[0];
+}
+
+QVector<QVector<double>>
+FingerprintCalculator::calculateElementBreakdownTable(const QStringList &elementSymbols,
+                                                      const CancelCheck &cancelled) const {
+    if (!m_snapshot)
+        return {};
+    auto lookup = elementLookup(elementSymbols);
+    return elementBreakdown(*m_snapshot, lookup, elementSymbols.size(), lookup,
+                            elementSymbols.size(), m_samplesPerEdge, cancelled);
+}
+
+bool FingerprintCalculator::calculateHistogram(const FingerprintBinning &binning,
+                                               const FingerprintFilter &filter,
+                                               FingerprintHistogram &result,
+                                               const CancelCheck &cancelled) const {
+    result = FingerprintHistogram{};
+    result.samplesPerEdge = m_samplesPerEdge;
+    result.binnedAreas = Eigen::MatrixXd::Zero(binning.nx, binning.ny);
+    result.binUsed.setConstant(binning.nx, binning.ny, false);
+    if (!m_snapshot)
+        return true;
+
+    const FingerprintSnapshot &snapshot = *m_snapshot;
+    const bool haveElements = snapshot.haveElements();
+
+    auto elementsMatch = [&filter](int inside, int outside) {
+        auto matches = [](int wanted, int value) {
+            return wanted == -1 || value == wanted;
+        };
+        bool match = matches(filter.insideElement, inside) &&
+                     matches(filter.outsideElement, outside);
+        if (filter.includeReciprocalContacts) {
+            match = match || (matches(filter.insideElement, outside) &&
+                              matches(filter.outsideElement, inside));
+        }
+        return match;
+    };
+    auto inRange = [&filter](double value) {
+        return value >= filter.lower && value <= filter.upper;
+    };
+
+    // Vertex mask, used to highlight the filtered region on the surface
+    const int numVertices = snapshot.numberOfVertices();
+    result.vertexMask.setConstant(numVertices, true);
+    for (int v = 0; v < numVertices; ++v) {
+        switch (filter.mode) {
+        case FingerprintFilterMode::None:
+            break;
+        case FingerprintFilterMode::Element:
+            result.vertexMask(v) = haveElements &&
+                                   snapshot.insideElements(v) >= 0 &&
+                                   elementsMatch(snapshot.insideElements(v),
+                                                 snapshot.outsideElements(v));
+            break;
+        case FingerprintFilterMode::Di:
+            result.vertexMask(v) = inRange(snapshot.di(v));
+            break;
+        case FingerprintFilterMode::De:
+            result.vertexMask(v) = inRange(snapshot.de(v));
+            break;
+        }
+    }
+
+    const int n = m_samplesPerEdge;
+    const int samplesPerFace = (n + 1) * (n + 2) / 2;
+    const double xScale = binning.nx / (binning.xmax - binning.xmin);
+    const double yScale = binning.ny / (binning.ymax - binning.ymin);
+    double filteredArea = 0.0;
+
     // Sample each face using barycentric coordinates
-    for (int faceIdx = 0; faceIdx < m_mesh->numberOfFaces(); ++faceIdx) {
-        Eigen::Vector3i faceIndices = m_mesh->faces().col(faceIdx);
-        
-        double faceArea = m_mesh->faceAreas()(faceIdx);
-        int expectedSamplesThisFace = (m_samplesPerEdge + 1) * (m_samplesPerEdge + 2) / 2;
-        
-        for (int i = 0; i <= m_samplesPerEdge; ++i) {
-            for (int j = 0; j <= m_samplesPerEdge - i; ++j) {
-                double a = static_cast<double>(i) / m_samplesPerEdge;
-                double b = static_cast<double>(j) / m_samplesPerEdge;
+    for (int faceIdx = 0; faceIdx < snapshot.numberOfFaces(); ++faceIdx) {
+        if (cancelled && (faceIdx % CancelCheckInterval) == 0 && cancelled())
+            return false;
+
+        const Eigen::Vector3i face = snapshot.faces.col(faceIdx);
+        const double x1 = snapshot.di(face[0]), y1 = snapshot.de(face[0]);
+        const double x2 = snapshot.di(face[1]), y2 = snapshot.de(face[1]);
+        const double x3 = snapshot.di(face[2]), y3 = snapshot.de(face[2]);
+        const double sampleArea = snapshot.faceAreas(faceIdx) / samplesPerFace;
+        const bool faceElementsKnown =
+            haveElements && snapshot.insideElements(face[0]) >= 0 &&
+            snapshot.insideElements(face[1]) >= 0 &&
+            snapshot.insideElements(face[2]) >= 0;
+
+        for (int i = 0; i <= n; ++i) {
+            for (int j = 0; j <= n - i; ++j) {
+                double a = static_cast<double>(i) / n;
+                double b = static_cast<double>(j) / n;
                 double c = 1.0 - a - b;
-                
-                // Determine element assignment for this sample
-                int v0 = faceIndices[0], v1 = faceIndices[1], v2 = faceIndices[2];
-                
-                if (v0 < di_idx.rows() && v1 < di_idx.rows() && v2 < di_idx.rows() &&
-                    di_idx(v0) >= 0 && de_idx(v0) >= 0 && di_idx(v1) >= 0 && de_idx(v1) >= 0 && 
-                    di_idx(v2) >= 0 && de_idx(v2) >= 0) {
-                    
-                    // Use dominant vertex for element assignment
-                    int dominantVertex;
-                    if (a >= b && a >= c) dominantVertex = v0;
-                    else if (b >= c) dominantVertex = v1;
-                    else dominantVertex = v2;
-                    
-                    int sampleInsideAtom = insideNums(di_idx(dominantVertex));
-                    int sampleOutsideAtom = outsideNums(de_idx(dominantVertex));
-                    
-                    // Check if this sample matches the requested inside element
-                    if (sampleInsideAtom == insideAtomicNum) {
-                        // Find which outside element this sample belongs to
-                        for (int elemIdx = 0; elemIdx < elementSymbols.size(); ++elemIdx) {
-                            int outsideAtomicNum = ElementData::atomicNumberFromElementSymbol(elementSymbols[elemIdx]);
-                            if (sampleOutsideAtom == outsideAtomicNum) {
-                                double sampleArea = faceArea / expectedSamplesThisFace;
-                                totalFilteredArea[elemIdx] += sampleArea;
-                                break;
-                            }
-                        }
+                double x = a * x1 + b * x2 + c * x3;
+                double y = a * y1 + b * y2 + c * y3;
+
+                if (x < binning.xmin || x >= binning.xmax ||
+                    y < binning.ymin || y >= binning.ymax)
+                    continue;
+                int xIndex = std::min(binning.nx - 1,
+                                      static_cast<int>((x - binning.xmin) * xScale));
+                int yIndex = std::min(binning.ny - 1,
+                                      static_cast<int>((y - binning.ymin) * yScale));
+
+                bool passes = true;
+                switch (filter.mode) {
+                case FingerprintFilterMode::None:
+                    break;
+                case FingerprintFilterMode::Element:
+                    if (faceElementsKnown) {
+                        int v = dominantVertex(a, b, c, face);
+                        passes = elementsMatch(snapshot.insideElements(v),
+                                               snapshot.outsideElements(v));
+                    } else {
+                        passes = false;
                     }
+                    break;
+                case FingerprintFilterMode::Di:
+                    passes = inRange(x);
+                    break;
+                case FingerprintFilterMode::De:
+                    passes = inRange(y);
+                    break;
+                }
+
+                result.binUsed(xIndex, yIndex) = true;
+                if (passes) {
+                    result.binnedAreas(xIndex, yIndex) += sampleArea;
+                    filteredArea += sampleArea;
                 }
             }
         }
     }
-    
-    // Convert to percentages
-    for (int i = 0; i < totalFilteredArea.size(); ++i) {
-        double percentage = (totalFilteredArea[i] / m_mesh->surfaceArea()) * 100.0;
-        result.append(percentage);
-    }
-    
-    return result;
-}
\ No newline at end of file
+
+    result.filteredArea = filter.mode == FingerprintFilterMode::None
+                              ? snapshot.surfaceArea
+                              : filteredArea;
+    return true;
+}
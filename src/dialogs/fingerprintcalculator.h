@@ -1,20 +1,93 @@
 #pragma once
 
+#include <Eigen/Core>
 #include <QVector>
 #include <QString>
 #include <QStringList>
+#include <functional>
+#include <memory>
 
 class Mesh;
 
+// Fingerprint filtering
+enum class FingerprintFilterMode { None, Element, Di, De };
+
+// Filter options with the element symbols resolved to atomic numbers, where
+// -1 matches any element
+struct FingerprintFilter {
+    FingerprintFilterMode mode{FingerprintFilterMode::None};
+    bool includeReciprocalContacts{false};
+    int insideElement{-1};
+    int outsideElement{-1};
+    double lower{0.0};
+    double upper{100.0};
+};
+
+// Bins of binSize covering [xmin, xmax) x [ymin, ymax) in (di, de)
+struct FingerprintBinning {
+    double xmin{0.0}, xmax{0.0};
+    double ymin{0.0}, ymax{0.0};
+    int nx{0}, ny{0};
+};
+
+struct FingerprintHistogram {
+    Eigen::MatrixXd binnedAreas;
+    Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> binUsed;
+    Eigen::Matrix<bool, Eigen::Dynamic, 1> vertexMask;
+    double filteredArea{0.0};
+    int samplesPerEdge{0};
+};
+
+// Immutable copy of the surface data fingerprints are computed from, so the
+// binning can run on a worker thread while the mesh stays with the GUI.
+struct FingerprintSnapshot {
+    Eigen::VectorXd di, de;
+    Eigen::Matrix<int, 3, Eigen::Dynamic> faces;
+    Eigen::VectorXd faceAreas;
+    // atomic numbers of the nearest inside/outside atoms for each vertex, -1
+    // where the assignment is unknown
+    Eigen::VectorXi insideElements, outsideElements;
+    double surfaceArea{0.0};
+
+    [[nodiscard]] inline int numberOfVertices() const { return di.rows(); }
+    [[nodiscard]] inline int numberOfFaces() const { return faces.cols(); }
+    [[nodiscard]] inline bool haveElements() const {
+        return insideElements.rows() == di.rows() && di.rows() > 0;
+    }
+
+    // Returns nullptr if the mesh has no di/de properties
+    static std::shared_ptr<const FingerprintSnapshot> fromMesh(const Mesh *);
+};
+
 class FingerprintCalculator {
 public:
+    // Returns true when the calculation should be abandoned
+    using CancelCheck = std::function<bool()>;
+
     explicit FingerprintCalculator(Mesh *mesh = nullptr);
-    
+    explicit FingerprintCalculator(
+        std::shared_ptr<const FingerprintSnapshot> snapshot);
+
     void setMesh(Mesh *mesh);
-    QVector<double> calculateElementBreakdown(const QString &insideElement, 
-                                            const QStringList &elementSymbols);
+    inline void setSamplesPerEdge(int n) { m_samplesPerEdge = n; }
+
+    QVector<double> calculateElementBreakdown(const QString &insideElement,
+                                            const QStringList &elementSymbols) const;
+    // One row per inside element, as calculateElementBreakdown, from a single
+    // pass over the surface
+    QVector<QVector<double>>
+    calculateElementBreakdownTable(const QStringList &elementSymbols,
+                                   const CancelCheck &cancelled = {}) const;
+
+    // Area sampled into each bin, with the samples rejected by the filter
+    // marking bins as used but contributing no area. Returns false if
+    // cancelled.
+    bool calculateHistogram(const FingerprintBinning &binning,
+                            const FingerprintFilter &filter,
+                            FingerprintHistogram &result,
+                            const CancelCheck &cancelled = {}) const;
 
 private:
-    Mesh *m_mesh{nullptr};
+    std::shared_ptr<const FingerprintSnapshot> m_snapshot;
     int m_samplesPerEdge{3}; // Default sampling resolution
-};
\ No newline at end of file
+};
@@ -19,11 +19,20 @@
 #include "isosurface.h"
 #include <vector>
 
+#ifdef CX_HAS_CONCURRENT
+#include <QtConcurrent>
+#endif
+
 FingerprintPlot::FingerprintPlot(QWidget *parent) : QWidget(parent) { init(); }
 
 void FingerprintPlot::init() {
   setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
   m_mesh = nullptr;
+#ifdef CX_HAS_CONCURRENT
+  m_histogramWatcher = new QFutureWatcher<FingerprintHistogram>(this);
+  connect(m_histogramWatcher, &QFutureWatcher<FingerprintHistogram>::resultReadyAt,
+          this, &FingerprintPlot::histogramReady);
+#endif
   setRange(FingerprintPlotRange::Standard);
 
   resetFilter();
@@ -32,23 +41,20 @@ void FingerprintPlot::init() {
 void FingerprintPlot::resetFilter() { setFilter({}); }
 
 void FingerprintPlot::setFilter(FingerprintFilterOptions opts) {
-  m_filterMode = opts.filterMode;
-  m_includeReciprocalContacts = opts.includeReciprocalContacts;
-  m_insideFilterElementSymbol = opts.insideFilterElementSymbol;
-  m_outsideFilterElementSymbol = opts.outsideFilterElementSymbol;
-  m_filterInsideElement = -1;
-  m_filterOutsideElement = -1;
-  m_filterLower = opts.filterLower;
-  m_filterUpper = opts.filterUpper;
+  m_filter = FingerprintFilter{};
+  m_filter.mode = opts.filterMode;
+  m_filter.includeReciprocalContacts = opts.includeReciprocalContacts;
+  m_filter.lower = opts.filterLower;
+  m_filter.upper = opts.filterUpper;
 
   if (opts.filterInsideElement) {
-    m_filterInsideElement =
-        ElementData::atomicNumberFromElementSymbol(m_insideFilterElementSymbol);
+    m_filter.insideElement =
+        ElementData::atomicNumberFromElementSymbol(opts.insideFilterElementSymbol);
   }
 
   if (opts.filterOutsideElement) {
-    m_filterOutsideElement = ElementData::atomicNumberFromElementSymbol(
-        m_outsideFilterElementSymbol);
+    m_filter.outsideElement = ElementData::atomicNumberFromElementSymbol(
+        opts.outsideFilterElementSymbol);
   }
 }
 
@@ -69,28 +75,21 @@ void FingerprintPlot::updatePlotRange(FingerprintPlotRange range) {
 
 void FingerprintPlot::setMesh(Mesh *mesh) {
   m_mesh = mesh;
+  m_snapshot = FingerprintSnapshot::fromMesh(mesh);
+  // don't show the bins of the previous surface while this one is computed
+  binnedAreas.resize(0, 0);
   updateFingerprintPlot();
 }
 
 void FingerprintPlot::setPropertiesToPlot() {
-  QString diName = isosurface::getSurfacePropertyDisplayName("di");
-  QString deName = isosurface::getSurfacePropertyDisplayName("de");
-  m_x = m_mesh->vertexProperty(diName).cast<double>();
-  m_y = m_mesh->vertexProperty(deName).cast<double>();
+  m_x = m_snapshot->di;
+  m_y = m_snapshot->de;
 
   m_xmin = m_x.minCoeff();
   m_xmax = m_x.maxCoeff();
   m_ymin = m_y.minCoeff();
   m_ymax = m_y.maxCoeff();
 
-  m_xFace = m_mesh->averagedFaceProperty(diName).cast<double>();
-  m_yFace = m_mesh->averagedFaceProperty(deName).cast<double>();
-
-  m_xFaceMin = m_xFace.minCoeff();
-  m_xFaceMax = m_xFace.maxCoeff();
-  m_yFaceMin = m_yFace.minCoeff();
-  m_yFaceMax = m_yFace.maxCoeff();
-
   setAxisLabels();
 }
 
@@ -100,13 +99,16 @@ void FingerprintPlot::setAxisLabels() {
 }
 
 void FingerprintPlot::updateFingerprintPlot() {
-  if (m_mesh) {
+  if (m_snapshot && m_snapshot->numberOfVertices() > 0) {
     setPropertiesToPlot();
-    initBinnedAreas();
-    initBinnedFilterFlags();
+    updateBinning();
     calculateBinnedAreas();
     drawFingerprint();
   } else {
+#ifdef CX_HAS_CONCURRENT
+    m_histogramWatcher->future().cancel();
+#endif
+    m_histogramPending = false;
     drawEmptyFingerprint();
   }
   setFixedSize(plotSize());
@@ -114,17 +116,28 @@ void FingerprintPlot::updateFingerprintPlot() {
   update();
 }
 
+// The previous bins stay on display until the new histogram arrives, unless
+// their dimensions have changed
+void FingerprintPlot::updateBinning() {
+  m_binning.xmin = usedxPlotMin();
+  m_binning.xmax = usedxPlotMax();
+  m_binning.ymin = usedyPlotMin();
+  m_binning.ymax = usedyPlotMax();
+  m_binning.nx = numUsedxBins();
+  m_binning.ny = numUsedyBins();
+  if (binnedAreas.rows() != m_binning.nx || binnedAreas.cols() != m_binning.ny) {
+    initBinnedAreas();
+    initBinnedFilterFlags();
+  }
+}
+
 void FingerprintPlot::initBinnedAreas() {
-  int numxBins = numUsedxBins();
-  int numyBins = numUsedyBins();
-  binnedAreas = Eigen::MatrixXd::Zero(numxBins, numyBins);
+  binnedAreas = Eigen::MatrixXd::Zero(m_binning.nx, m_binning.ny);
 }
 
 void FingerprintPlot::initBinnedFilterFlags() {
-  int numxBins = numUsedxBins();
-  int numyBins = numUsedyBins();
-  binUsed = Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>::Zero(numxBins,
-                                                                      numyBins);
+  binUsed = Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>::Zero(
+      m_binning.nx, m_binning.ny);
 }
 
 inline double gaussianKernel(double x, double y, double h) {
@@ -180,281 +193,6 @@ double FingerprintPlot::calculateBinnedAreasKDE() {
   return m_mesh->surfaceArea();
 }
 
-double FingerprintPlot::calculateBinnedAreasNoFilter() {
-  // barycentric subsampling, samplesPerEdge = 1 reduces to just the points
-  double nx = numUsedxBins();
-  double ny = numUsedyBins();
-  double xmax = usedxPlotMax();
-  double xmin = usedxPlotMin();
-  double normx = nx / (xmax - xmin);
-  double ymin = usedyPlotMin();
-  double ymax = usedyPlotMax();
-  double normy = ny / (ymax - ymin);
-
-  binnedAreas = Eigen::MatrixXd::Zero(nx, ny);
-  binUsed = Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>::Zero(nx, ny);
-
-  double totalArea = 0.0;
-  double totalAreaSampled = 0.0;
-  
-  // Set vertex mask to show all vertices when no filter is applied
-  auto &vmask = m_mesh->vertexMask();
-  vmask.setConstant(true);
-
-  int facesProcessed = 0;
-  int samplesGenerated = 0;
-  int samplesInBounds = 0;
-  
-  for (int faceIdx = 0; faceIdx < m_mesh->numberOfFaces(); ++faceIdx) {
-    Eigen::Vector3i faceIndices = m_mesh->faces().col(faceIdx);
-
-    double x1 = m_x(faceIndices[0]), y1 = m_y(faceIndices[0]);
-    double x2 = m_x(faceIndices[1]), y2 = m_y(faceIndices[1]);
-    double x3 = m_x(faceIndices[2]), y3 = m_y(faceIndices[2]);
-
-    double faceArea = m_mesh->faceAreas()(faceIdx);
-    totalArea += faceArea;
-    facesProcessed++;
-    
-    // Interpolate points within the face
-    int expectedSamplesThisFace = (m_settings.samplesPerEdge + 1) * (m_settings.samplesPerEdge + 2) / 2;
-    int actualSamplesThisFace = 0;
-    int samplesInBoundsThisFace = 0;
-    
-    for (int i = 0; i <= m_settings.samplesPerEdge; ++i) {
-      for (int j = 0; j <= m_settings.samplesPerEdge - i; ++j) {
-        double a = static_cast<double>(i) / m_settings.samplesPerEdge;
-        double b = static_cast<double>(j) / m_settings.samplesPerEdge;
-        double c = 1.0 - a - b;
-        actualSamplesThisFace++;
-        samplesGenerated++;
-
-        double x = a * x1 + b * x2 + c * x3;
-        double y = a * y1 + b * y2 + c * y3;
-
-        if (x >= xmin && x < xmax && y >= ymin && y < ymax) {
-          int xIndex = static_cast<int>((x - xmin) * normx);
-          int yIndex = static_cast<int>((y - ymin) * normy);
-          samplesInBoundsThisFace++;
-          samplesInBounds++;
-
-          double sampleArea = faceArea / expectedSamplesThisFace;
-          totalAreaSampled += sampleArea;
-
-          binUsed(xIndex, yIndex) = true;
-          binnedAreas(xIndex, yIndex) += sampleArea;
-        }
-      }
-    }
-  }
-
-  
-  // Set face mask to show all faces when no filter is applied
-  auto &faceMask = m_mesh->faceMask();
-  faceMask.setConstant(true);
-
-  return m_mesh->surfaceArea();
-}
-
-double FingerprintPlot::calculateBinnedAreasWithFilter() {
-  double totalFilteredArea = 0.0;
-  double totalAreaSampled = 0.0;
-
-  double nx = numUsedxBins();
-  double ny = numUsedyBins();
-  double xmax = usedxPlotMax();
-  double xmin = usedxPlotMin();
-  double normx = nx / (xmax - xmin);
-  double ymin = usedyPlotMin();
-  double ymax = usedyPlotMax();
-  double normy = ny / (ymax - ymin);
-
-  binnedAreas = Eigen::MatrixXd::Zero(nx, ny);
-  binUsed = Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>::Zero(nx, ny);
-
-
-  int facesProcessed = 0;
-  int facesContributing = 0;  // Faces that contribute some area to this filter
-  int samplesGenerated = 0;
-  int samplesInBounds = 0;
-  int samplesPassingFilter = 0;
-
-  // Get element assignment data for vertex-based filtering (only for element filters)
-  auto *structure = qobject_cast<ChemicalStructure *>(m_mesh->parent());
-  Eigen::VectorXi insideNums, outsideNums, di_idx, de_idx;
-  
-  if (m_filterMode == FingerprintFilterMode::Element && structure) {
-    insideNums = structure->atomicNumbersForIndices(m_mesh->atomsInside());
-    outsideNums = structure->atomicNumbersForIndices(m_mesh->atomsOutside());
-    QString diIdxName = isosurface::getSurfacePropertyDisplayName("di_idx");
-    QString deIdxName = isosurface::getSurfacePropertyDisplayName("de_idx");
-    di_idx = m_mesh->vertexProperty(diIdxName).cast<int>();
-    de_idx = m_mesh->vertexProperty(deIdxName).cast<int>();
-  }
-  
-  // Create vertex mask for display based on filter type
-  auto &vmask = m_mesh->vertexMask();
-  vmask.setConstant(false);  // Start with all vertices hidden
-  
-  switch (m_filterMode) {
-  case FingerprintFilterMode::Element: {
-    // Set vertex mask based on element assignments
-    auto check = [](int ref, int value) { return (ref == -1) || (value == ref); };
-    
-    for (int v = 0; v < di_idx.rows(); v++) {
-      if (di_idx(v) >= 0 && de_idx(v) >= 0) {
-        int insideAtom = insideNums(di_idx(v));
-        int outsideAtom = outsideNums(de_idx(v));
-        
-        bool vertexPassesFilter = check(m_filterInsideElement, insideAtom) && check(m_filterOutsideElement, outsideAtom);
-        if (m_includeReciprocalContacts) {
-          vertexPassesFilter |= (check(m_filterInsideElement, outsideAtom) && check(m_filterOutsideElement, insideAtom));
-        }
-        
-        vmask(v) = vertexPassesFilter;
-      }
-    }
-    break;
-  }
-  case FingerprintFilterMode::Di: {
-    // Set vertex mask based on di values
-    for (int v = 0; v < m_x.rows(); v++) {
-      vmask(v) = (m_x(v) >= m_filterLower && m_x(v) <= m_filterUpper);
-    }
-    break;
-  }
-  case FingerprintFilterMode::De: {
-    // Set vertex mask based on de values
-    for (int v = 0; v < m_y.rows(); v++) {
-      vmask(v) = (m_y(v) >= m_filterLower && m_y(v) <= m_filterUpper);
-    }
-    break;
-  }
-  default:
-    vmask.setConstant(true);
-    break;
-  }
-  
-  // Count vertices passing filter for debug
-  int verticesPassingFilter = 0;
-  for (int v = 0; v < vmask.rows(); ++v) {
-    if (vmask(v)) verticesPassingFilter++;
-  }
-  qDebug() << "Vertices passing filter:" << verticesPassingFilter << "out of" << m_mesh->numberOfVertices() << "(" << (100.0 * verticesPassingFilter / m_mesh->numberOfVertices()) << "%)";
-  
-  for (int faceIdx = 0; faceIdx < m_mesh->numberOfFaces(); ++faceIdx) {
-    Eigen::Vector3i faceIndices = m_mesh->faces().col(faceIdx);
-
-    double x1 = m_x(faceIndices[0]), y1 = m_y(faceIndices[0]);
-    double x2 = m_x(faceIndices[1]), y2 = m_y(faceIndices[1]);
-    double x3 = m_x(faceIndices[2]), y3 = m_y(faceIndices[2]);
-
-    double faceArea = m_mesh->faceAreas()(faceIdx);
-    facesProcessed++;
-    
-    // Track samples for this face
-    int samplesPassingCurrentFilter = 0;
-
-    // Interpolate points within the face with proportional allocation
-    int expectedSamplesThisFace = (m_settings.samplesPerEdge + 1) * (m_settings.samplesPerEdge + 2) / 2;
-    int actualSamplesThisFace = 0;
-    int samplesInBoundsThisFace = 0;
-    int samplesPassingFilterThisFace = 0;
-    
-    for (int i = 0; i <= m_settings.samplesPerEdge; ++i) {
-      for (int j = 0; j <= m_settings.samplesPerEdge - i; ++j) {
-        double a = static_cast<double>(i) / m_settings.samplesPerEdge;
-        double b = static_cast<double>(j) / m_settings.samplesPerEdge;
-        double c = 1.0 - a - b;
-        actualSamplesThisFace++;
-        samplesGenerated++;
-
-        double x = a * x1 + b * x2 + c * x3;
-        double y = a * y1 + b * y2 + c * y3;
-        
-
-        if (x >= xmin && x < xmax && y >= ymin && y < ymax) {
-          int xIndex = static_cast<int>((x - xmin) * normx);
-          int yIndex = static_cast<int>((y - ymin) * normy);
-          samplesInBoundsThisFace++;
-          samplesInBounds++;
-          
-          // Determine if this sample passes the filter based on filter mode
-          bool samplePassesFilter = false;
-          
-          switch (m_filterMode) {
-          case FingerprintFilterMode::Element: {
-            // Element-based filtering using vertex assignments
-            int v0 = faceIndices[0], v1 = faceIndices[1], v2 = faceIndices[2];
-            
-            if (v0 < di_idx.rows() && v1 < di_idx.rows() && v2 < di_idx.rows() &&
-                di_idx(v0) >= 0 && de_idx(v0) >= 0 && di_idx(v1) >= 0 && de_idx(v1) >= 0 && 
-                di_idx(v2) >= 0 && de_idx(v2) >= 0) {
-              
-              // Use the vertex with highest barycentric weight to determine element assignment
-              int dominantVertex;
-              if (a >= b && a >= c) dominantVertex = v0;
-              else if (b >= c) dominantVertex = v1;
-              else dominantVertex = v2;
-              
-              int insideAtom = insideNums(di_idx(dominantVertex));
-              int outsideAtom = outsideNums(de_idx(dominantVertex));
-              
-              // Check if this sample passes the current element filter
-              auto check = [](int ref, int value) { return (ref == -1) || (value == ref); };
-              samplePassesFilter = check(m_filterInsideElement, insideAtom) && check(m_filterOutsideElement, outsideAtom);
-              if (m_includeReciprocalContacts) {
-                samplePassesFilter |= (check(m_filterInsideElement, outsideAtom) && check(m_filterOutsideElement, insideAtom));
-              }
-            }
-            break;
-          }
-          case FingerprintFilterMode::Di: {
-            // Distance-based filtering on di values (x coordinate)
-            samplePassesFilter = (x >= m_filterLower && x <= m_filterUpper);
-            break;
-          }
-          case FingerprintFilterMode::De: {
-            // Distance-based filtering on de values (y coordinate)
-            samplePassesFilter = (y >= m_filterLower && y <= m_filterUpper);
-            break;
-          }
-          default:
-            samplePassesFilter = true;
-            break;
-          }
-
-          double sampleArea = faceArea / expectedSamplesThisFace;
-          totalAreaSampled += sampleArea;
-          
-
-          binUsed(xIndex, yIndex) = true;
-          if (samplePassesFilter) {
-            totalFilteredArea += sampleArea;
-            binnedAreas(xIndex, yIndex) += sampleArea;
-            samplesPassingFilterThisFace++;
-            samplesPassingFilter++;
-            samplesPassingCurrentFilter++;
-          }
-        }
-      }
-    }
-    
-    // Update face statistics - a face contributes if any of its samples pass the filter
-    if (samplesPassingCurrentFilter > 0) {
-      facesContributing++;
-    }
-    
-  }
-
-
-  // Also set face mask to all true since we're using vertex masking for display
-  auto &faceMask = m_mesh->faceMask();
-  faceMask.setConstant(true);
-  
-  return totalFilteredArea;
-}
-
 // Used to determine a complete fingerprint breakdown for the information window
 QVector<double> FingerprintPlot::filteredAreas(QString insideElementSymbol,
                                                QStringList elementSymbolList) {
@@ -555,22 +293,97 @@ QVector<double> FingerprintPlot::filteredAreas(QString insideElementSymbol,
 }
 
 void FingerprintPlot::calculateBinnedAreas() {
-  switch (m_filterMode) {
-  case FingerprintFilterMode::None:
-    m_totalFilteredArea = calculateBinnedAreasNoFilter();
-    break;
-  default:
-    m_totalFilteredArea = calculateBinnedAreasWithFilter();
-    break;
+  FingerprintCalculator calculator(m_snapshot);
+  const FingerprintBinning binning = m_binning;
+  const FingerprintFilter filter = m_filter;
+  const int samplesPerEdge = m_settings.samplesPerEdge;
+  m_histogramPending = true;
+
+#ifdef CX_HAS_CONCURRENT
+  // Replacing the future cancels any stale request, whose results are then
+  // never delivered
+  m_histogramWatcher->future().cancel();
+  m_histogramWatcher->setFuture(QtConcurrent::run(
+      [calculator, binning, filter,
+       samplesPerEdge](QPromise<FingerprintHistogram> &promise) mutable {
+        auto cancelled = [&promise]() { return promise.isCanceled(); };
+        FingerprintHistogram histogram;
+        // vertex-only pass first, so something is shown straight away
+        if (samplesPerEdge > 1) {
+          calculator.setSamplesPerEdge(1);
+          if (!calculator.calculateHistogram(binning, filter, histogram,
+                                             cancelled))
+            return;
+          promise.addResult(histogram);
+        }
+        calculator.setSamplesPerEdge(samplesPerEdge);
+        if (calculator.calculateHistogram(binning, filter, histogram,
+                                          cancelled))
+          promise.addResult(std::move(histogram));
+      }));
+#else
+  FingerprintHistogram histogram;
+  calculator.setSamplesPerEdge(samplesPerEdge);
+  calculator.calculateHistogram(binning, filter, histogram);
+  applyHistogram(histogram);
+#endif
+}
+
+void FingerprintPlot::histogramReady(int index) {
+#ifdef CX_HAS_CONCURRENT
+  applyHistogram(m_histogramWatcher->resultAt(index));
+  drawFingerprint();
+  update();
+#else
+  Q_UNUSED(index);
+#endif
+}
+
+void FingerprintPlot::applyHistogram(const FingerprintHistogram &histogram) {
+  if (!m_snapshot || histogram.binnedAreas.rows() != binnedAreas.rows() ||
+      histogram.binnedAreas.cols() != binnedAreas.cols())
+    return;
+
+  binnedAreas = histogram.binnedAreas;
+  binUsed = histogram.binUsed;
+  m_totalFilteredArea = histogram.filteredArea;
+  if (histogram.samplesPerEdge == m_settings.samplesPerEdge) {
+    m_histogramPending = false;
+  }
+
+  if (m_mesh && histogram.vertexMask.rows() == m_mesh->numberOfVertices()) {
+    m_mesh->vertexMask() = histogram.vertexMask;
+    // vertex masking is used for display, so all faces remain visible
+    m_mesh->faceMask().setConstant(true);
   }
 
-  double percentageOfTotal = (m_totalFilteredArea / m_mesh->surfaceArea()) * 100;
+  double percentageOfTotal =
+      (m_totalFilteredArea / m_snapshot->surfaceArea) * 100;
 
   emit surfaceAreaPercentageChanged(percentageOfTotal);
   emit surfaceFeatureChanged();
 }
 
+// Exports and the batch runner need the fully sampled fingerprint, so finish
+// any outstanding request here rather than waiting for the worker
+void FingerprintPlot::ensureHistogramComplete() {
+  if (!m_snapshot || !m_histogramPending)
+    return;
+#ifdef CX_HAS_CONCURRENT
+  m_histogramWatcher->future().cancel();
+  m_histogramWatcher->setFuture(QFuture<FingerprintHistogram>());
+#endif
+  FingerprintCalculator calculator(m_snapshot);
+  calculator.setSamplesPerEdge(m_settings.samplesPerEdge);
+  FingerprintHistogram histogram;
+  calculator.calculateHistogram(m_binning, m_filter, histogram);
+  applyHistogram(histogram);
+  drawFingerprint();
+  update();
+}
+
 void FingerprintPlot::outputFingerprintAsJSON() {
+  ensureHistogramComplete();
   QString filename = "fingerprint.json";
 
   const double stdAreaForSaturatedColor = 0.001;
@@ -625,6 +438,7 @@ void FingerprintPlot::outputFingerprintAsJSON() {
 }
 
 void FingerprintPlot::outputFingerprintAsTable() {
+  ensureHistogramComplete();
   QString filename = "fingerprint_table";
   QFile finFile(filename);
   if (finFile.open(QIODevice::WriteOnly)) {
@@ -729,96 +543,6 @@ int FingerprintPlot::tolerant_yBinIndex(double value) {
   return binIndex(value, usedyPlotMin(), usedyPlotMax(), numUsedyBins());
 }
 
-// Update computeFaceMask method
-void FingerprintPlot::computeFaceMask() {
-  if (!m_mesh)
-    return;
-  auto &mask = m_mesh->faceMask();
-  auto &vmask = m_mesh->vertexMask();
-  mask.setConstant(true);
-  vmask.setConstant(true);
-
-  switch (m_filterMode) {
-  case FingerprintFilterMode::None:
-    break;
-  case FingerprintFilterMode::Element: {
-    // Existing element filtering code remains the same
-    auto *structure = qobject_cast<ChemicalStructure *>(m_mesh->parent());
-    if (!structure)
-      break;
-
-    auto insideNums = structure->atomicNumbersForIndices(m_mesh->atomsInside());
-    auto outsideNums =
-        structure->atomicNumbersForIndices(m_mesh->atomsOutside());
-
-    QString diIdxName = isosurface::getSurfacePropertyDisplayName("di_idx");
-    QString deIdxName = isosurface::getSurfacePropertyDisplayName("de_idx");
-    Eigen::VectorXi di_idx = m_mesh->vertexProperty(diIdxName).cast<int>();
-    Eigen::VectorXi de_idx = m_mesh->vertexProperty(deIdxName).cast<int>();
-
-    const auto &faces = m_mesh->faces();
-    const auto &v2f = m_mesh->vertexToFace();
-
-    if (di_idx.rows() == 0 || de_idx.rows() == 0) {
-      qDebug() << "Have no interior/exterior atom info";
-      break;
-    }
-
-    auto check = [](int ref, int value) {
-      return (ref == -1) || (value == ref);
-    };
-
-    const int m_i = m_filterInsideElement;
-    const int m_o = m_filterOutsideElement;
-
-    for (int v = 0; v < di_idx.rows(); v++) {
-      int i = insideNums(di_idx(v));
-      int o = outsideNums(de_idx(v));
-
-      vmask(v) = check(m_i, i) && check(m_o, o);
-      if (m_includeReciprocalContacts) {
-        vmask(v) |= (check(m_i, o) && check(m_o, i));
-      }
-
-      if (!vmask(v)) {
-        for (int f : v2f[v]) {
-          mask(f) = false;
-        }
-      }
-    }
-    break;
-  }
-  case FingerprintFilterMode::Di: {
-    // Filter based on di values
-    for (int v = 0; v < m_x.rows(); v++) {
-      vmask(v) = m_x(v) >= m_filterLower && m_x(v) <= m_filterUpper;
-
-      if (!vmask(v)) {
-        const auto &v2f = m_mesh->vertexToFace();
-        for (int f : v2f[v]) {
-          mask(f) = false;
-        }
-      }
-    }
-    break;
-  }
-  case FingerprintFilterMode::De: {
-    // Filter based on de values
-    for (int v = 0; v < m_y.rows(); v++) {
-      vmask(v) = m_y(v) >= m_filterLower && m_y(v) <= m_filterUpper;
-
-      if (!vmask(v)) {
-        const auto &v2f = m_mesh->vertexToFace();
-        for (int f : v2f[v]) {
-          mask(f) = false;
-        }
-      }
-    }
-    break;
-  }
-  }
-}
-
 void FingerprintPlot::drawEmptyFingerprint() {
   plotPixmap = QPixmap(plotSize());
   plotPixmap.fill(PLOT_BACKGROUND_COLOR);
@@ -1112,6 +836,7 @@ void FingerprintPlot::resetSurfaceFeatures(bool mask) {
 }
 
 void FingerprintPlot::saveFingerprint(QString filename) {
+  ensureHistogramComplete();
   QFileInfo fi(filename);
   if (fi.suffix() == "eps") {
     QString title = QInputDialog::getText(
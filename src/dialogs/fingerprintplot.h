@@ -5,7 +5,13 @@
 #include <QWidget>
 
 #include "colormap.h"
+#include "fingerprintcalculator.h"
 #include "meshinstance.h"
+#include <memory>
+
+#ifdef CX_HAS_CONCURRENT
+#include <QFutureWatcher>
+#endif
 
 const QString plotTypeLabel =
     "dᵢ vs. dₑ"; // Used by the fingerprint options widget
@@ -88,9 +94,6 @@ const int MESSAGE_PEN_WIDTH = 2;
 const int AXIS_SCALE_OFFSET = 30;
 const int AXIS_SCALE_TEXT_OFFSET = 2;
 
-// Fingerprint filtering
-enum class FingerprintFilterMode { None, Element, Di, De };
-
 inline const QStringList fingerprintFilterLabels{
     "None",
     "By Element",
@@ -141,6 +144,9 @@ protected:
   void paintEvent(QPaintEvent *);
   void mousePressEvent(QMouseEvent *);
 
+private slots:
+  void histogramReady(int);
+
 private:
   void init();
   void resetFilter();
@@ -153,18 +159,17 @@ private:
   void drawEmptyFingerprint();
   void drawNoFingerprintMessage(QPainter *);
   void drawFingerprint();
-  double calculateBinnedAreasNoFilter();
-  double calculateBinnedAreasWithFilter();
   double calculateBinnedAreasKDE();
+  void updateBinning();
   void calculateBinnedAreas();
+  void applyHistogram(const FingerprintHistogram &);
+  void ensureHistogramComplete();
   int binIndex(double, double, double, int);
   int xBinIndex(double);
   int yBinIndex(double);
   int tolerant_xBinIndex(double);
   int tolerant_yBinIndex(double);
 
-  void computeFaceMask();
-
   bool includeArea(int);
   bool includeAreaFilteredByElement(int);
   void drawGrid(QPainter *);
@@ -231,31 +236,25 @@ private:
   QString m_xAxisLabel{"di"};
   QString m_yAxisLabel{"de"};
 
-  Eigen::VectorXd m_x, m_xFace;
-  Eigen::VectorXd m_y, m_yFace;
+  std::shared_ptr<const FingerprintSnapshot> m_snapshot;
+  Eigen::VectorXd m_x;
+  Eigen::VectorXd m_y;
   double m_xmin{0.0}, m_xmax{0.0};
   double m_ymin{0.0}, m_ymax{0.0};
-
-  double m_xFaceMin{0.0};
-  double m_xFaceMax{0.0};
-  double m_yFaceMin{0.0};
-  double m_yFaceMax{0.0};
+  FingerprintBinning m_binning;
 
   Eigen::MatrixXd binnedAreas;
   Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> binUsed;
   double m_totalFilteredArea{0.0};
+  // true until the fully sampled histogram for the current request is shown
+  bool m_histogramPending{false};
+#ifdef CX_HAS_CONCURRENT
+  QFutureWatcher<FingerprintHistogram> *m_histogramWatcher{nullptr};
+#endif
 
   FingerprintPlotSettings m_settings;
 
-  // Filter options
-  FingerprintFilterMode m_filterMode{FingerprintFilterMode::None};
-  bool m_includeReciprocalContacts{false};
-  int m_filterInsideElement{-1};
-  int m_filterOutsideElement{-1};
-  QString m_insideFilterElementSymbol{"H"};
-  QString m_outsideFilterElementSymbol{"H"};
-  double m_filterLower{0.0};
-  double m_filterUpper{100.0};
+  FingerprintFilter m_filter;
 
   QString m_colorScheme{"RedGreenBlue"};
 };
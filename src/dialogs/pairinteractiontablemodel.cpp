@@ -61,10 +61,14 @@ QVariant PairInteractionTableModel::data(const QModelIndex &index,
         return interaction->dimerDescription();
       }
     } else {
-      const QString &key = m_componentColumns[actualColumn - FixedColumnCount];
-
-      if (interaction->components().contains(key)) {
-        double value = interaction->getComponent(key);
+      const int componentIndex = actualColumn - FixedColumnCount;
+      const QString &key = m_componentColumns[componentIndex];
+      const int componentId = m_componentIds[componentIndex];
+
+      if (componentId >= 0 ? interaction->hasComponent(componentId)
+                           : interaction->hasComponent(key)) {
+        double value = componentId >= 0 ? interaction->getComponent(componentId)
+                                        : interaction->getComponent(key);
         return QString::number(value, 'f', m_energyPrecision);
       }
 
@@ -102,16 +106,22 @@ void PairInteractionTableModel::setInteractionData(
   }
 
   m_componentColumns.clear();
+  m_componentIds.clear();
   if (!m_interactions.empty()) {
     const auto *firstInteraction = m_interactions[0];
-    for (const auto &[component, _] : firstInteraction->components()) {
-      m_componentColumns << component;
-    }
+    m_componentColumns << firstInteraction->componentNames();
 
     for (const auto &[key, _] : firstInteraction->metadata()) {
       m_componentColumns << key;
     }
     std::sort(m_componentColumns.begin(), m_componentColumns.end());
+
+    const auto *owner = firstInteraction->owner();
+    for (const auto &column : std::as_const(m_componentColumns)) {
+      const bool isComponent = firstInteraction->hasComponent(column);
+      m_componentIds.push_back(owner && isComponent ? owner->componentId(column)
+                                                    : -1);
+    }
   }
 
   if (m_columnVisibility.size() <
@@ -131,6 +141,32 @@ void PairInteractionTableModel::sort(int column, Qt::SortOrder order) {
   beginResetModel();
 
   const int actualColumn = visibleToActualColumn(column);
+
+  if (actualColumn >= FixedColumnCount) {
+    // read each value once rather than twice per comparison
+    const int componentIndex = actualColumn - FixedColumnCount;
+    const QString &component = m_componentColumns[componentIndex];
+    const int componentId = m_componentIds[componentIndex];
+    std::vector<std::pair<double, PairInteraction *>> keyed;
+    keyed.reserve(m_interactions.size());
+    for (auto *interaction : m_interactions) {
+      keyed.push_back({componentId >= 0 ? interaction->getComponent(componentId)
+                                        : interaction->getComponent(component),
+                       interaction});
+    }
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [order](const auto &a, const auto &b) {
+                       return order == Qt::DescendingOrder
+                                  ? b.first < a.first
+                                  : a.first < b.first;
+                     });
+    for (size_t i = 0; i < keyed.size(); i++) {
+      m_interactions[i] = keyed[i].second;
+    }
+    endResetModel();
+    return;
+  }
+
   std::sort(m_interactions.begin(), m_interactions.end(),
             [this, actualColumn, order](const PairInteraction *a,
                                         const PairInteraction *b) {
@@ -148,16 +184,9 @@ void PairInteractionTableModel::sort(int column, Qt::SortOrder order) {
                 return a->centroidDistance() < b->centroidDistance();
               case DescriptionColumn:
                 return a->dimerDescription() < b->dimerDescription();
-              default: {
-                if (actualColumn >= FixedColumnCount) {
-                  const QString &component =
-                      m_componentColumns[actualColumn - FixedColumnCount];
-                  return a->getComponent(component) <
-                         b->getComponent(component);
-                }
+              default:
                 return false;
               }
-              }
             });
 
   endResetModel();
@@ -51,6 +51,8 @@ private:
 
   QString m_title{"Interaction Energies"};
   QStringList m_componentColumns;
+  // owner's id for each component column, -1 for metadata columns
+  std::vector<int> m_componentIds;
   QVector<int> m_visibleColumns;
   QVector<bool> m_columnVisibility;
   std::vector<PairInteraction *> m_interactions;
@@ -7,11 +7,20 @@
 #include <QTextCursor>
 #include <fmt/format.h>
 
+#ifdef CX_HAS_CONCURRENT
+#include <QtConcurrent>
+#endif
+
 inline const char *INFO_HORIZONTAL_RULE =
     "--------------------------------------------------------------------------"
     "------------\n";
 
 SurfaceInfoDocument::SurfaceInfoDocument(QWidget *parent) : QWidget(parent) {
+#ifdef CX_HAS_CONCURRENT
+  m_breakdownWatcher = new QFutureWatcher<BreakdownTable>(this);
+  connect(m_breakdownWatcher, &QFutureWatcher<BreakdownTable>::resultReadyAt,
+          this, &SurfaceInfoDocument::fingerprintBreakdownReady);
+#endif
   setupUI();
   populateDocument();
 }
@@ -176,9 +185,19 @@ void SurfaceInfoDocument::insertFingerprintBreakdown(QTextCursor &cursor, Mesh *
   
   cursor.insertText("Contact analysis based on Hirshfeld surface partitioning:\n\n");
   
-  // Create a fingerprint calculator to calculate the breakdown
-  FingerprintCalculator calculator(mesh);
-  
+  if (m_breakdown.mesh != mesh || m_breakdown.elementSymbols != elementSymbols) {
+    requestFingerprintBreakdown(mesh, elementSymbols);
+  }
+  if (m_breakdown.mesh != mesh || m_breakdown.elementSymbols != elementSymbols) {
+    cursor.insertText("Calculating breakdown...\n\n");
+    return;
+  }
+  const BreakdownTable &table = m_breakdown.table;
+  auto percentage = [&table](int row, int col) {
+    return (row < table.size() && col < table[row].size()) ? table[row][col]
+                                                           : 0.0;
+  };
+
   // Create breakdown table
   cursor.insertText(QString("Inside  "));
   for (const QString &outsideElement : elementSymbols) {
@@ -195,16 +214,16 @@ void SurfaceInfoDocument::insertFingerprintBreakdown(QTextCursor &cursor, Mesh *
   cursor.insertText(QString("%1\n").arg(QString("-").repeated(8 + elementSymbols.size() * 8 + 8)));
   
   double grandTotal = 0.0;
+  QVector<double> columnTotals(elementSymbols.size(), 0.0);
   
-  for (const QString &insideElement : elementSymbols) {
-    QVector<double> percentages = calculator.calculateElementBreakdown(insideElement, elementSymbols);
-    
-    cursor.insertText(QString("%1").arg(insideElement, -8));
+  for (int row = 0; row < elementSymbols.size(); ++row) {
+    cursor.insertText(QString("%1").arg(elementSymbols[row], -8));
     
     double rowTotal = 0.0;
-    for (double percentage : percentages) {
-      cursor.insertText(QString("%1 ").arg(percentage, 7, 'f', 1));
-      rowTotal += percentage;
+    for (int col = 0; col < elementSymbols.size(); ++col) {
+      cursor.insertText(QString("%1 ").arg(percentage(row, col), 7, 'f', 1));
+      rowTotal += percentage(row, col);
+      columnTotals[col] += percentage(row, col);
     }
     
     cursor.insertText(QString("%1\n").arg(rowTotal, 7, 'f', 1));
@@ -214,15 +233,7 @@ void SurfaceInfoDocument::insertFingerprintBreakdown(QTextCursor &cursor, Mesh *
   cursor.insertText(QString("%1\n").arg(QString("-").repeated(8 + elementSymbols.size() * 8 + 8)));
   cursor.insertText(QString("Total   "));
   
-  // Calculate column totals
-  for (int col = 0; col < elementSymbols.size(); ++col) {
-    double columnTotal = 0.0;
-    for (const QString &insideElement : elementSymbols) {
-      QVector<double> percentages = calculator.calculateElementBreakdown(insideElement, elementSymbols);
-      if (col < percentages.size()) {
-        columnTotal += percentages[col];
-      }
-    }
+  for (double columnTotal : columnTotals) {
     cursor.insertText(QString("%1 ").arg(columnTotal, 7, 'f', 1));
   }
   
@@ -231,3 +242,47 @@ void SurfaceInfoDocument::insertFingerprintBreakdown(QTextCursor &cursor, Mesh *
   cursor.insertText("Note: Percentages represent the fraction of total surface area\n");
   cursor.insertText("for each type of intermolecular contact.\n\n");
 }
+
+// The breakdown samples the whole surface, so it is computed off the GUI
+// thread and the document is repopulated once it is available
+void SurfaceInfoDocument::requestFingerprintBreakdown(
+    Mesh *mesh, const QStringList &elementSymbols) {
+  if (m_pendingBreakdown.mesh == mesh &&
+      m_pendingBreakdown.elementSymbols == elementSymbols)
+    return;
+  m_pendingBreakdown = {mesh, elementSymbols, {}};
+  FingerprintCalculator calculator(FingerprintSnapshot::fromMesh(mesh));
+
+#ifdef CX_HAS_CONCURRENT
+  m_breakdownWatcher->future().cancel();
+  m_breakdownWatcher->setFuture(QtConcurrent::run(
+      [calculator, elementSymbols](QPromise<BreakdownTable> &promise) {
+        auto table = calculator.calculateElementBreakdownTable(
+            elementSymbols, [&promise]() { return promise.isCanceled(); });
+        if (!promise.isCanceled())
+          promise.addResult(std::move(table));
+      }));
+#else
+  m_pendingBreakdown.table =
+      calculator.calculateElementBreakdownTable(elementSymbols);
+  m_breakdown = m_pendingBreakdown;
+  m_pendingBreakdown = {};
+#endif
+}
+
+void SurfaceInfoDocument::fingerprintBreakdownReady(int index) {
+#ifdef CX_HAS_CONCURRENT
+  m_pendingBreakdown.table = m_breakdownWatcher->resultAt(index);
+  m_breakdown = m_pendingBreakdown;
+  m_pendingBreakdown = {};
+  if (!m_breakdown.mesh || !m_scene)
+    return;
+
+  // only redraw if the surface is still the one on display
+  const auto &selection = m_scene->selectedSurface();
+  if (selection.surface && selection.surface->mesh() == m_breakdown.mesh)
+    populateDocument();
+#else
+  Q_UNUSED(index);
+#endif
+}
@@ -1,11 +1,16 @@
 #pragma once
 #include "scene.h"
 #include "meshinstance.h"
+#include <QPointer>
 #include <QVBoxLayout>
 #include <QTextEdit>
 #include <QTabWidget>
 #include <QWidget>
 
+#ifdef CX_HAS_CONCURRENT
+#include <QFutureWatcher>
+#endif
+
 class SurfaceInfoDocument: public QWidget {
   Q_OBJECT
 
@@ -14,9 +19,26 @@ public:
 
   void updateScene(Scene *scene);
 
+private slots:
+  void fingerprintBreakdownReady(int);
+
 private:
+  using BreakdownTable = QVector<QVector<double>>;
+
+  // Percentage of the surface for each inside/outside element pair
+  struct FingerprintBreakdown {
+    QPointer<Mesh> mesh;
+    QStringList elementSymbols;
+    BreakdownTable table;
+  };
+
   Scene *m_scene{nullptr};
   QTextEdit *m_contents{nullptr};
+  FingerprintBreakdown m_breakdown;
+  FingerprintBreakdown m_pendingBreakdown;
+#ifdef CX_HAS_CONCURRENT
+  QFutureWatcher<BreakdownTable> *m_breakdownWatcher{nullptr};
+#endif
 
   void setupUI();
   void populateDocument();
@@ -25,5 +47,6 @@ private:
   void insertMeshInstanceInformation(QTextCursor &, MeshInstance *);
   void insertPropertyInformation(QTextCursor &, Mesh *);
   void insertFingerprintBreakdown(QTextCursor &, Mesh *);
+  void requestFingerprintBreakdown(Mesh *, const QStringList &);
 
 };
@@ -0,0 +1,349 @@
+#include "calculatorworkerpool.h"
+
+#ifndef Q_OS_WASM
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHash>
+#include <QThread>
+#include <algorithm>
+
+CalculatorWorkerPool::CalculatorWorkerPool(const CalculatorWorkerConfig &config,
+                                           QObject *parent)
+    : QObject(parent), m_config(config) {
+  m_config.maximumWorkers = std::max(m_config.maximumWorkers, 1);
+  m_healthTimer = new QTimer(this);
+  connect(m_healthTimer, &QTimer::timeout, this,
+          &CalculatorWorkerPool::healthCheck);
+  if (m_config.healthCheckInterval > 0)
+    m_healthTimer->start(m_config.healthCheckInterval);
+}
+
+CalculatorWorkerPool::~CalculatorWorkerPool() {
+  const WorkerResponse shutDown{false, {}, "Calculator workers were shut down"};
+  for (auto &request : m_queue) {
+    respond(*request, shutDown);
+  }
+  m_queue.clear();
+
+  // end of input is the request to exit, anything still running is killed
+  for (auto &w : m_workers) {
+    if (w->request)
+      respond(*w->request, shutDown);
+    w->process->disconnect(this);
+    w->process->closeWriteChannel();
+  }
+  for (auto &w : m_workers) {
+    if (!w->process->waitForFinished(1000)) {
+      w->process->kill();
+      w->process->waitForFinished(1000);
+    }
+  }
+  m_workers.clear();
+}
+
+CalculatorWorkerPool *
+CalculatorWorkerPool::forCalculator(const QString &name,
+                                    const CalculatorWorkerConfig &config) {
+  static QHash<QString, QPointer<CalculatorWorkerPool>> pools;
+  auto *app = QCoreApplication::instance();
+  Q_ASSERT(!app || QThread::currentThread() == app->thread());
+
+  QPointer<CalculatorWorkerPool> &pool = pools[name];
+  if (pool && !pool->config().sameCommand(config)) {
+    // outstanding requests fail rather than run with the old command
+    pool->deleteLater();
+    pool = nullptr;
+  }
+  if (!pool) {
+    pool = new CalculatorWorkerPool(config, app);
+  } else {
+    pool->setMaximumWorkers(config.maximumWorkers);
+  }
+  return pool;
+}
+
+CalculatorWorkerPool::Worker *
+CalculatorWorkerPool::worker(QProcess *process) const {
+  for (const auto &w : m_workers) {
+    if (w->process == process)
+      return w.get();
+  }
+  return nullptr;
+}
+
+CalculatorWorkerPool::RequestId
+CalculatorWorkerPool::submit(const nlohmann::json &input, QObject *context,
+                             ResponseCallback onResponse) {
+  Q_ASSERT(QThread::currentThread() == thread());
+  auto request = std::make_unique<Request>();
+  request->id = m_nextId++;
+  request->input = input;
+  request->context = context;
+  request->onResponse = std::move(onResponse);
+  const RequestId id = request->id;
+  m_queue.push_back(std::move(request));
+  dispatch();
+  return id;
+}
+
+void CalculatorWorkerPool::cancel(RequestId id) {
+  auto it = std::find_if(m_queue.begin(), m_queue.end(),
+                         [id](const auto &r) { return r->id == id; });
+  if (it != m_queue.end()) {
+    m_queue.erase(it);
+    return;
+  }
+  // the worker is left to finish, its answer is discarded
+  for (auto &w : m_workers) {
+    if (w->request && w->request->id == id)
+      w->request->onResponse = {};
+  }
+}
+
+void CalculatorWorkerPool::setMaximumWorkers(int count) {
+  m_config.maximumWorkers = std::max(count, 1);
+  dispatch();
+}
+
+int CalculatorWorkerPool::numberOfWorkers() const {
+  return static_cast<int>(m_workers.size());
+}
+
+int CalculatorWorkerPool::numberOfPendingRequests() const {
+  return static_cast<int>(m_queue.size());
+}
+
+void CalculatorWorkerPool::dispatch() {
+  while (!m_queue.empty()) {
+    auto it = std::find_if(m_workers.begin(), m_workers.end(), [](const auto &w) {
+      return w->state == WorkerState::Idle && !w->retiring;
+    });
+    if (it == m_workers.end())
+      break;
+    Worker &w = **it;
+    w.request = std::move(m_queue.front());
+    m_queue.pop_front();
+    w.request->attempts++;
+    w.state = WorkerState::Busy;
+    send(w, {{"type", "request"}, {"input", w.request->input}},
+         m_config.requestTimeout);
+  }
+
+  if (m_queue.empty())
+    return;
+
+  if (m_startupFailures >= m_config.maximumStartupFailures) {
+    // the calculator evidently cannot start, don't keep trying
+    const QString error =
+        QString("Calculator worker failed to start %1 times")
+            .arg(m_startupFailures);
+    while (!m_queue.empty()) {
+      auto request = std::move(m_queue.front());
+      m_queue.pop_front();
+      respond(*request, {false, {}, error});
+    }
+    m_startupFailures = 0;
+    return;
+  }
+
+  // start workers for requests that would otherwise wait, up to the limit
+  int starting = 0;
+  int available = 0;
+  for (const auto &w : m_workers) {
+    if (w->retiring)
+      continue;
+    available++;
+    if (w->state == WorkerState::Starting || w->state == WorkerState::Checking)
+      starting++;
+  }
+  int needed = static_cast<int>(m_queue.size()) - starting;
+  while (needed > 0 && available < m_config.maximumWorkers) {
+    spawnWorker();
+    available++;
+    needed--;
+  }
+}
+
+void CalculatorWorkerPool::spawnWorker() {
+  auto w = std::make_unique<Worker>();
+  w->process = new QProcess(this);
+  w->timer = new QTimer(w->process);
+  w->timer->setSingleShot(true);
+  QProcess *process = w->process;
+  QTimer *timer = w->timer;
+  m_workers.push_back(std::move(w));
+
+  process->setProcessEnvironment(m_config.environment);
+  if (!m_config.workingDirectory.isEmpty())
+    process->setWorkingDirectory(m_config.workingDirectory);
+
+  connect(process, &QProcess::readyReadStandardOutput, this, [this, process]() {
+    if (Worker *w = worker(process))
+      readLines(*w);
+  });
+  connect(process, &QProcess::readyReadStandardError, this, [this, process]() {
+    if (Worker *w = worker(process))
+      w->standardError.append(process->readAllStandardError());
+  });
+  connect(process, &QProcess::finished, this,
+          [this, process]() { workerExited(worker(process)); });
+  connect(process, &QProcess::errorOccurred, this,
+          [this, process](QProcess::ProcessError error) {
+            // finished() is never emitted for a process that failed to start
+            if (error == QProcess::FailedToStart) {
+              QMetaObject::invokeMethod(
+                  this, [this, process]() { workerExited(worker(process)); },
+                  Qt::QueuedConnection);
+            }
+          });
+  connect(timer, &QTimer::timeout, this, [this, process]() {
+    Worker *w = worker(process);
+    if (!w)
+      return;
+    if (!w->retiring) {
+      qWarning() << "Calculator worker" << process->processId()
+                 << "did not answer in time, restarting it";
+    }
+    process->kill();
+  });
+
+  process->start(m_config.program, m_config.arguments);
+  ping(*m_workers.back(), m_config.startupTimeout);
+}
+
+void CalculatorWorkerPool::send(Worker &w, const nlohmann::json &message,
+                                int timeout) {
+  w.messageId = m_nextId++;
+  nlohmann::json line = message;
+  line["id"] = w.messageId;
+  // written before the process has started, QProcess buffers it
+  w.process->write(QByteArray::fromStdString(line.dump()) + '\n');
+  if (timeout > 0) {
+    w.timer->start(timeout);
+  } else {
+    w.timer->stop();
+  }
+}
+
+void CalculatorWorkerPool::ping(Worker &w, int timeout) {
+  send(w, {{"type", "ping"}}, timeout);
+}
+
+void CalculatorWorkerPool::readLines(Worker &w) {
+  w.partialLine.append(w.process->readAllStandardOutput());
+  qsizetype start = 0;
+  qsizetype end = 0;
+  while ((end = w.partialLine.indexOf('\n', start)) >= 0) {
+    const QByteArray line = w.partialLine.mid(start, end - start).trimmed();
+    start = end + 1;
+    if (line.isEmpty() || !line.startsWith('{'))
+      continue;
+    nlohmann::json message =
+        nlohmann::json::parse(line.toStdString(), nullptr, false);
+    if (message.is_discarded() || !message.is_object())
+      continue;
+    handleMessage(w, message);
+    // a finished request may have retired or replaced this worker
+    if (!worker(w.process))
+      return;
+  }
+  w.partialLine.remove(0, start);
+}
+
+void CalculatorWorkerPool::handleMessage(Worker &w,
+                                         const nlohmann::json &message) {
+  if (!message.contains("id") || !message["id"].is_number_integer() ||
+      message["id"].get<RequestId>() != w.messageId)
+    return;
+  w.timer->stop();
+  w.messageId = 0;
+
+  switch (w.state) {
+  case WorkerState::Starting:
+    m_startupFailures = 0;
+    [[fallthrough]];
+  case WorkerState::Checking:
+    w.state = WorkerState::Idle;
+    break;
+  case WorkerState::Busy: {
+    WorkerResponse response;
+    if (message.contains("error")) {
+      const auto &error = message["error"];
+      response.error = QString::fromStdString(
+          error.is_string() ? error.get<std::string>() : error.dump());
+    } else {
+      response.succeeded = true;
+      response.result = message.value("result", nlohmann::json::object());
+    }
+    auto request = std::move(w.request);
+    w.state = WorkerState::Idle;
+    w.completedRequests++;
+    if (m_config.requestsPerWorker > 0 &&
+        w.completedRequests >= m_config.requestsPerWorker) {
+      retire(w);
+    }
+    respond(*request, response);
+    break;
+  }
+  case WorkerState::Idle:
+    break;
+  }
+  dispatch();
+}
+
+void CalculatorWorkerPool::retire(Worker &w) {
+  // finishes on its own once stdin is closed, and is replaced on demand
+  w.retiring = true;
+  w.process->closeWriteChannel();
+  w.timer->start(m_config.healthCheckTimeout);
+}
+
+void CalculatorWorkerPool::workerExited(Worker *w) {
+  if (!w)
+    return;
+  auto it = std::find_if(m_workers.begin(), m_workers.end(),
+                         [w](const auto &p) { return p.get() == w; });
+  std::unique_ptr<Worker> exited = std::move(*it);
+  m_workers.erase(it);
+  exited->process->disconnect(this);
+  exited->process->deleteLater();
+  exited->standardError.append(exited->process->readAllStandardError());
+
+  if (!exited->retiring) {
+    const QString error =
+        QString("Calculator worker exited unexpectedly (%1): %2")
+            .arg(exited->process->errorString())
+            .arg(QString::fromUtf8(exited->standardError.contents()).trimmed());
+    qWarning() << error;
+    if (exited->state == WorkerState::Starting)
+      m_startupFailures++;
+    emit workerFailed(error);
+
+    if (exited->request) {
+      if (exited->request->attempts < 2) {
+        // the request may not be at fault, try it once more on a new worker
+        m_queue.push_front(std::move(exited->request));
+      } else {
+        respond(*exited->request, {false, {}, error});
+      }
+    }
+  }
+  dispatch();
+}
+
+void CalculatorWorkerPool::healthCheck() {
+  for (auto &w : m_workers) {
+    if (w->state == WorkerState::Idle && !w->retiring) {
+      w->state = WorkerState::Checking;
+      ping(*w, m_config.healthCheckTimeout);
+    }
+  }
+}
+
+void CalculatorWorkerPool::respond(Request &request,
+                                   const WorkerResponse &response) {
+  if (request.context && request.onResponse)
+    request.onResponse(response);
+}
+
+#endif // Q_OS_WASM
@@ -0,0 +1,139 @@
+#pragma once
+#include "processsupervisor.h"
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <ankerl/unordered_dense.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+// QProcess and related functionality not available in WASM
+#ifndef Q_OS_WASM
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTimer>
+
+struct CalculatorWorkerConfig {
+    QString program;
+    QStringList arguments;
+    QString workingDirectory;
+    QProcessEnvironment environment{QProcessEnvironment::systemEnvironment()};
+    int maximumWorkers{1};
+    int requestsPerWorker{0};       // restart a worker after this many, 0 for never
+    int startupTimeout{120000};     // milliseconds to answer the first ping
+    int requestTimeout{0};          // milliseconds, 0 for no limit
+    int healthCheckInterval{30000}; // milliseconds between pings of idle workers
+    int healthCheckTimeout{10000};
+    int maximumStartupFailures{3};  // consecutive, before queued requests fail
+
+    [[nodiscard]] inline bool sameCommand(const CalculatorWorkerConfig &other) const {
+        return program == other.program && arguments == other.arguments;
+    }
+};
+
+struct WorkerResponse {
+    bool succeeded{false};
+    nlohmann::json result;
+    QString error;
+};
+
+/**
+ * @brief Long-lived calculator processes answering newline-delimited JSON
+ *
+ * Each worker is started once and then serves requests one at a time, so
+ * interpreter start-up and model loading are paid per worker rather than
+ * per calculation. Every message is a single line of JSON on the worker's
+ * stdin, answered by a single line on its stdout carrying the same id:
+ *
+ *   {"id": 1, "type": "ping"}                  -> {"id": 1}
+ *   {"id": 2, "type": "request", "input": {}}  -> {"id": 2, "result": {}}
+ *                                              or {"id": 2, "error": "..."}
+ *
+ * Lines on stdout that are not JSON objects are ignored, and stderr is only
+ * kept for error messages. A worker is ready once it has answered its first
+ * ping, idle workers are pinged periodically, and workers that crash, time
+ * out or fail a health check are killed and replaced. A request whose
+ * worker dies is retried once on a fresh worker. Closing stdin asks a
+ * worker to exit.
+ *
+ * Like ProcessSupervisor, workers are driven by the event loop of the
+ * pool's thread and callbacks are only invoked while their context is alive.
+ */
+class CalculatorWorkerPool : public QObject {
+    Q_OBJECT
+public:
+    using RequestId = quint64;
+    using ResponseCallback = std::function<void(const WorkerResponse &)>;
+
+    explicit CalculatorWorkerPool(const CalculatorWorkerConfig &,
+                                  QObject *parent = nullptr);
+    ~CalculatorWorkerPool();
+
+    // Pool shared by every task using the named calculator for the rest of
+    // the session, replaced if the command changes. Must be called from the
+    // application's main thread.
+    static CalculatorWorkerPool *forCalculator(const QString &name,
+                                               const CalculatorWorkerConfig &);
+
+    RequestId submit(const nlohmann::json &input, QObject *context,
+                     ResponseCallback onResponse);
+    // The callback for the request will not be called
+    void cancel(RequestId);
+
+    void setMaximumWorkers(int);
+    inline const auto &config() const { return m_config; }
+
+    [[nodiscard]] int numberOfWorkers() const;
+    [[nodiscard]] int numberOfPendingRequests() const;
+
+signals:
+    void workerFailed(QString error);
+
+private:
+    enum class WorkerState { Starting, Idle, Busy, Checking };
+
+    struct Request {
+        RequestId id{0};
+        nlohmann::json input;
+        QPointer<QObject> context;
+        ResponseCallback onResponse;
+        int attempts{0};
+    };
+
+    struct Worker {
+        QProcess *process{nullptr};
+        QTimer *timer{nullptr};
+        WorkerState state{WorkerState::Starting};
+        RequestId messageId{0}; // ping or request awaiting an answer
+        std::unique_ptr<Request> request;
+        QByteArray partialLine;
+        OutputRingBuffer standardError{64 * 1024};
+        int completedRequests{0};
+        bool retiring{false};
+    };
+
+    void dispatch();
+    void spawnWorker();
+    void send(Worker &, const nlohmann::json &message, int timeout);
+    void ping(Worker &, int timeout);
+    void readLines(Worker &);
+    void handleMessage(Worker &, const nlohmann::json &message);
+    void workerExited(Worker *);
+    void retire(Worker &);
+    void healthCheck();
+    void respond(Request &, const WorkerResponse &);
+    Worker *worker(QProcess *) const;
+
+    CalculatorWorkerConfig m_config;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::deque<std::unique_ptr<Request>> m_queue;
+    QTimer *m_healthTimer{nullptr};
+    RequestId m_nextId{1};
+    int m_startupFailures{0};
+};
+
+#endif // Q_OS_WASM
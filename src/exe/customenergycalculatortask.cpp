@@ -38,6 +38,9 @@ void CustomEnergyCalculatorTask::setCalculatorName(const QString &calculatorName
             }
         }
     }
+
+    QStringList persistent = settings::readSetting(settings::keys::CUSTOM_PERSISTENT_CALCULATORS).toStringList();
+    m_persistentWorker = persistent.contains(calculatorName);
 }
 
 QString CustomEnergyCalculatorTask::jsonFilename() const {
@@ -104,15 +107,24 @@ nlohmann::json CustomEnergyCalculatorTask::prepareMoleculeJson(const std::vector
 
 void CustomEnergyCalculatorTask::start() {
     if (!m_parameters.structure) {
-        qWarning() << "No chemical structure specified for custom energy calculator";
+        setErrorMessage("No chemical structure specified for custom energy calculator");
+        emit errorOccurred(errorMessage());
         return;
     }
     
     if (m_calculatorCommand.isEmpty()) {
-        qWarning() << "No command configured for custom calculator:" << m_calculatorName;
+        setErrorMessage("No command configured for custom calculator: " + m_calculatorName);
+        emit errorOccurred(errorMessage());
         return;
     }
     
+#ifndef Q_OS_WASM
+    if (m_persistentWorker) {
+        startWithWorker();
+        return;
+    }
+#endif
+
     QString name = hashedBaseName();
     QString inputJsonName = name + "_input.json";
     QString outputJsonName = jsonFilename();
@@ -146,20 +158,71 @@ void CustomEnergyCalculatorTask::start() {
     ExternalProgramTask::start();
 }
 
+#ifndef Q_OS_WASM
+void CustomEnergyCalculatorTask::startWithWorker() {
+    if (!beginRun()) {
+        return;
+    }
+
+    CalculatorWorkerConfig config;
+    config.program = executable();
+    config.arguments = arguments();
+    config.environment = environment();
+    config.maximumWorkers = m_maximumWorkers;
+    config.requestTimeout = timeout();
+    m_workerPool = CalculatorWorkerPool::forCalculator(m_calculatorName, config);
+
+    emit progressText("Waiting for custom calculator worker");
+    m_workerRequest = m_workerPool->submit(
+        prepareInputJson(m_parameters), this,
+        [this](const WorkerResponse &response) {
+            m_workerRequest = 0;
+            if (!response.succeeded) {
+                setErrorMessage(response.error);
+                qWarning() << "Custom calculator worker failed:" << response.error;
+            } else if (parseEnergyFromResult(response.result)) {
+                qDebug() << "Parsed interaction energy:" << m_interactionEnergy << "from custom calculator worker";
+                emit calculationComplete(m_parameters, this);
+            }
+            emit progress(100);
+            finishRun();
+        });
+}
+#endif
+
+void CustomEnergyCalculatorTask::stop() {
+#ifndef Q_OS_WASM
+    if (m_workerRequest != 0) {
+        m_canceled = true;
+        if (m_workerPool) {
+            m_workerPool->cancel(m_workerRequest);
+        }
+        m_workerRequest = 0;
+        setErrorMessage("Task was canceled");
+        finishRun();
+        return;
+    }
+#endif
+    ExternalProgramTask::stop();
+}
+
 void CustomEnergyCalculatorTask::postProcess() {
     ExternalProgramTask::postProcess();
-    
-    QString outputJsonName = jsonFilename();
-    parseResultJson(outputJsonName);
-    
-    emit calculationComplete(m_parameters, this);
+
+    // a failed command still gets here, finishRun reports the error
+    if (!errorMessage().isEmpty()) {
+        return;
+    }
+    if (parseResultJson(jsonFilename())) {
+        emit calculationComplete(m_parameters, this);
+    }
 }
 
-void CustomEnergyCalculatorTask::parseResultJson(const QString &jsonPath) {
+bool CustomEnergyCalculatorTask::parseResultJson(const QString &jsonPath) {
     QFile file(jsonPath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open result JSON file:" << jsonPath;
-        return;
+        setErrorMessage("Failed to open result JSON file: " + jsonPath);
+        return false;
     }
     
     QTextStream stream(&file);
@@ -168,30 +231,36 @@ void CustomEnergyCalculatorTask::parseResultJson(const QString &jsonPath) {
     
     try {
         nlohmann::json result = nlohmann::json::parse(jsonString.toStdString());
-        m_interactionEnergy = parseEnergyFromResult(result);
+        if (!parseEnergyFromResult(result)) {
+            return false;
+        }
         qDebug() << "Parsed interaction energy:" << m_interactionEnergy << "from custom calculator";
+        return true;
     } catch (const std::exception &e) {
-        qWarning() << "Failed to parse result JSON:" << e.what();
-        m_interactionEnergy = 0.0;
+        setErrorMessage(QString("Failed to parse result JSON: %1").arg(e.what()));
+        return false;
     }
 }
 
-double CustomEnergyCalculatorTask::parseEnergyFromResult(const nlohmann::json &result) const {
+bool CustomEnergyCalculatorTask::parseEnergyFromResult(const nlohmann::json &result) {
     // Check for error first
     if (result.contains("error")) {
-        QString error = QString::fromStdString(result["error"].get<std::string>());
-        qWarning() << "Custom calculator reported error:" << error;
-        return 0.0;
+        const auto &error = result["error"];
+        setErrorMessage("Custom calculator reported error: " +
+                        QString::fromStdString(error.is_string() ? error.get<std::string>() : error.dump()));
+        return false;
     }
     
     // Look for energy field (following occ external energy model convention)
     if (result.contains("energy") && result["energy"].is_number()) {
-        return result["energy"].get<double>();
+        m_interactionEnergy = result["energy"].get<double>();
+        return true;
     }
     
     // Alternative: look for interaction_energy field
     if (result.contains("interaction_energy") && result["interaction_energy"].is_number()) {
-        return result["interaction_energy"].get<double>();
+        m_interactionEnergy = result["interaction_energy"].get<double>();
+        return true;
     }
     
     // If neither found, check for total energy and reference energies to compute interaction
@@ -199,9 +268,10 @@ double CustomEnergyCalculatorTask::parseEnergyFromResult(const nlohmann::json &r
         double total = result["total_energy"].get<double>();
         double ea = result["energy_a"].get<double>();
         double eb = result["energy_b"].get<double>();
-        return total - ea - eb;
+        m_interactionEnergy = total - ea - eb;
+        return true;
     }
     
-    qWarning() << "Custom calculator result does not contain recognizable energy field";
-    return 0.0;
-}
\ No newline at end of file
+    setErrorMessage("Custom calculator result does not contain recognizable energy field");
+    return false;
+}
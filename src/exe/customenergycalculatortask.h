@@ -1,6 +1,7 @@
 #pragma once
 #include "externalprogram.h"
 #include "pair_energy_parameters.h"
+#include "calculatorworkerpool.h"
 #include <nlohmann/json.hpp>
 #include <Eigen/Geometry>
 
@@ -13,8 +14,19 @@ public:
     void setParameters(const pair_energy::Parameters &);
     void setCalculatorName(const QString &calculatorName);
     virtual void start() override;
+    virtual void stop() override;
+
+    // Send the pair to a long-lived worker process for the calculator rather
+    // than starting the command for each pair. Enabled by setCalculatorName
+    // for calculators listed as persistent in the settings.
+    inline void setPersistentWorker(bool persistent) { m_persistentWorker = persistent; }
+    inline bool persistentWorker() const { return m_persistentWorker; }
+    // Upper limit on worker processes for the calculator, normally the
+    // task manager's maximumConcurrency()
+    inline void setMaximumWorkers(int count) { m_maximumWorkers = count; }
 
     QString jsonFilename() const;
+    inline double interactionEnergy() const { return m_interactionEnergy; }
 
 signals:
     void calculationComplete(pair_energy::Parameters params, CustomEnergyCalculatorTask *task);
@@ -26,11 +38,20 @@ private:
     nlohmann::json prepareInputJson(const pair_energy::Parameters &params) const;
     nlohmann::json prepareMoleculeJson(const std::vector<GenericAtomIndex> &atoms, 
                                       const Eigen::Isometry3d &transform = Eigen::Isometry3d::Identity()) const;
-    void parseResultJson(const QString &jsonPath);
-    double parseEnergyFromResult(const nlohmann::json &result) const;
+    // Both set the error message and return false if the calculator failed
+    // or reported no recognisable energy
+    bool parseResultJson(const QString &jsonPath);
+    bool parseEnergyFromResult(const nlohmann::json &result);
+    void startWithWorker();
 
     pair_energy::Parameters m_parameters;
     QString m_calculatorName;
     QString m_calculatorCommand;
     double m_interactionEnergy{0.0};
-};
\ No newline at end of file
+    bool m_persistentWorker{false};
+    int m_maximumWorkers{1};
+#ifndef Q_OS_WASM
+    QPointer<CalculatorWorkerPool> m_workerPool;
+    CalculatorWorkerPool::RequestId m_workerRequest{0};
+#endif
+};
@@ -1,8 +1,14 @@
 #include "exefileutilities.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 #include <QProcessEnvironment>
 #include <QTextStream>
+#include <filesystem>
 
 namespace exe {
 
@@ -59,4 +65,96 @@ QString findProgramInPath(const QString &program) {
 #endif
 }
 
+namespace {
+
+std::filesystem::path toPath(const QString &path) {
+  return std::filesystem::path(path.toStdU16String());
+}
+
+bool removeExisting(const QString &dest, bool overwrite) {
+  QFileInfo info(dest);
+  // exists() follows links, so check for dangling symbolic links too
+  if (!info.exists() && !info.isSymLink())
+    return true;
+  if (!overwrite)
+    return false;
+  return QFile::remove(dest);
+}
+
+} // namespace
+
+bool stageFile(const QString &source, const QString &dest, bool overwrite,
+               StagingMethod *method) {
+  const QString absoluteSource = QFileInfo(source).absoluteFilePath();
+  if (absoluteSource == QFileInfo(dest).absoluteFilePath())
+    return true;
+  if (!QFileInfo::exists(absoluteSource) || !removeExisting(dest, overwrite))
+    return false;
+
+  std::error_code ec;
+  std::filesystem::create_hard_link(toPath(absoluteSource), toPath(dest), ec);
+  if (!ec) {
+    if (method)
+      *method = StagingMethod::HardLink;
+    return true;
+  }
+
+  // e.g. the temporary directory is on a different filesystem
+  std::filesystem::create_symlink(toPath(absoluteSource), toPath(dest), ec);
+  if (!ec) {
+    if (method)
+      *method = StagingMethod::SymbolicLink;
+    return true;
+  }
+
+  if (method)
+    *method = StagingMethod::Copy;
+  return QFile::copy(absoluteSource, dest);
+}
+
+bool moveFile(const QString &source, const QString &dest, bool overwrite) {
+  if (QFileInfo(source).absoluteFilePath() == QFileInfo(dest).absoluteFilePath())
+    return true;
+  if (!removeExisting(dest, overwrite))
+    return false;
+  return QFile::rename(source, dest);
+}
+
+QByteArray fileHash(const QString &filePath) {
+  struct CacheEntry {
+    qint64 size{0};
+    QDateTime lastModified;
+    QByteArray hash;
+  };
+  static QMutex mutex;
+  static QHash<QString, CacheEntry> cache;
+
+  QFileInfo info(filePath);
+  const QString key = info.canonicalFilePath();
+  if (key.isEmpty())
+    return {};
+  const qint64 size = info.size();
+  const QDateTime lastModified = info.lastModified();
+
+  {
+    QMutexLocker lock(&mutex);
+    auto it = cache.constFind(key);
+    if (it != cache.constEnd() && it->size == size &&
+        it->lastModified == lastModified)
+      return it->hash;
+  }
+
+  QFile file(key);
+  if (!file.open(QIODevice::ReadOnly))
+    return {};
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  if (!hash.addData(&file))
+    return {};
+  QByteArray result = hash.result().toHex();
+
+  QMutexLocker lock(&mutex);
+  cache.insert(key, CacheEntry{size, lastModified, result});
+  return result;
+}
+
 } // namespace exe
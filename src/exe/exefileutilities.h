@@ -8,4 +8,20 @@ namespace exe {
 QString readFileContents(const QString& filePath, const QString& binaryPlaceholder = "Binary file");
 QString findProgramInPath(const QString &program);
 
+enum class StagingMethod { HardLink, SymbolicLink, Copy };
+
+// Make a read-only input available at dest without duplicating its data
+// where the filesystem allows: a hard link, else a symbolic link, else a
+// copy. Returns false if none of these succeeded.
+bool stageFile(const QString &source, const QString &dest, bool overwrite,
+               StagingMethod *method = nullptr);
+
+// Move source to dest, which falls back to copy and delete across
+// filesystems
+bool moveFile(const QString &source, const QString &dest, bool overwrite);
+
+// SHA-1 of the file contents, cached by path, size and modification time so
+// inputs shared between many tasks are only read once. Empty on error.
+QByteArray fileHash(const QString &filePath);
+
 }
@@ -3,6 +3,7 @@
 #include <QByteArray>
 #include <QDebug>
 #include <QFileInfo>
+#include <QSet>
 #include <QTextStream>
 
 #ifndef Q_OS_WASM
@@ -68,52 +69,33 @@ void ExternalProgramTask::setArguments(const QStringList &args) {
   m_arguments = args;
 }
 
-void ExternalProgramTask::updateStdoutStderr(QProcess &process) {
-  QString out = properties().value("stdout", "").toString();
-  QString err = properties().value("stderr", "").toString();
-  out += process.readAllStandardOutput();
-  err += process.readAllStandardError();
-  setProperty("stdout", out);
-  setProperty("stderr", err);
-  emit stdoutChanged();
-}
+void ExternalProgramTask::setTimeout(int timeout) { m_timeout = timeout; }
 
-void ExternalProgramTask::setupProcessConnectionsPrivate(QProcess &process) {
-  QObject::connect(
-      &process, &QProcess::finished,
-      [this, &process](int exitCode, QProcess::ExitStatus exitStatus) {
-        if (exitStatus == QProcess::CrashExit) {
-          setErrorMessage("Process crashed");
-        } else {
-          m_exitCode = exitCode;
-          updateStdoutStderr(process);
-        }
-      });
-
-  QObject::connect(&process, &QProcess::errorOccurred, this,
-                   [this](QProcess::ProcessError error) {
-                     // Populate errorMessage based on the type of error
-                     switch (error) {
-                     case QProcess::Timedout:
-                       // timing out is not an error due to the way we're
-                       // running
-                       break;
-                     default:
-                       setErrorMessage(exe::errorString(error));
-                       break;
-                     }
-                   });
-
-  QObject::connect(this, &ExternalProgramTask::stopProcess, &process,
-                   &QProcess::terminate);
-}
-
-bool ExternalProgramTask::copyRequirements(const QString &path) {
+bool ExternalProgramTask::stageRequirements(const QString &path) {
   bool force = overwrite();
+
+  // inputs the program may also write to are copied, so linking can't
+  // modify the originals
+  QSet<QString> outputNames;
+  for (const auto &[output, output_dest] : m_outputs) {
+    outputNames.insert(QFileInfo(output).fileName());
+  }
+
   for (const auto &[input, input_dest] : m_requirements) {
-    QString dest = path + QDir::separator() + QFileInfo(input_dest).fileName();
-    qDebug() << "Copying " << input << "to" << dest;
-    if (!io::copyFile(input, dest, force)) {
+    QString name = QFileInfo(input_dest).fileName();
+    QString dest = path + QDir::separator() + name;
+    bool staged = false;
+    if (outputNames.contains(name)) {
+      staged = io::copyFile(input, dest, force);
+    } else {
+      exe::StagingMethod method;
+      staged = exe::stageFile(input, dest, force, &method);
+      if (staged && method == exe::StagingMethod::Copy) {
+        qDebug() << "Could not link" << input << "into" << path
+                 << "so it was copied";
+      }
+    }
+    if (!staged) {
       setErrorMessage(
           QString("Failed to copy input file to temporary directory: %1 -> %2")
               .arg(input)
@@ -121,33 +103,52 @@ bool ExternalProgramTask::copyRequirements(const QString &path) {
       qDebug() << errorMessage();
       return false;
     }
-    setProperty(getInputFilePropertyName(input), exe::readFileContents(input));
+    recordFile(getInputFilePropertyName(input), input);
   }
   return true;
 }
 
-bool ExternalProgramTask::copyResults(const QString &path) {
+bool ExternalProgramTask::captureResults(const QString &path) {
   bool force = overwrite();
-  qDebug() << "[COPY START]" << property("name").toString();
+  qDebug() << "[CAPTURE START]" << property("name").toString();
 
   for (const auto &[output, output_dest] : m_outputs) {
     QString tmpOutput = path + QDir::separator() + QFileInfo(output).fileName();
-    if (!io::copyFile(tmpOutput, output_dest, force)) {
+    if (!exe::moveFile(tmpOutput, output_dest, force)) {
       setErrorMessage(
           QString(
-              "Failed to copy output file from temporary directory. %1 -> %2")
+              "Failed to move output file from temporary directory. %1 -> %2")
               .arg(tmpOutput)
               .arg(output_dest));
       qDebug() << errorMessage();
       return false;
     }
-    setProperty(getOutputFilePropertyName(output),
-                exe::readFileContents(tmpOutput));
+    recordFile(getOutputFilePropertyName(output), output_dest);
   }
-  qDebug() << "[COPY DONE]" << property("name").toString();
+  qDebug() << "[CAPTURE DONE]" << property("name").toString();
   return true;
 }
 
+void ExternalProgramTask::recordFile(const QString &propertyName,
+                                     const QString &filePath) {
+  setProperty(propertyName, QFileInfo(filePath).absoluteFilePath());
+  setProperty(propertyName + " (sha1)", exe::fileHash(filePath));
+}
+
+QString ExternalProgramTask::inputFileContents(const QString &filename) const {
+  QString path = property(getInputFilePropertyName(filename)).toString();
+  if (path.isEmpty())
+    return QString();
+  return exe::readFileContents(path);
+}
+
+QString ExternalProgramTask::outputFileContents(const QString &filename) const {
+  QString path = property(getOutputFilePropertyName(filename)).toString();
+  if (path.isEmpty())
+    return QString();
+  return exe::readFileContents(path);
+}
+
 bool ExternalProgramTask::deleteRequirements() {
   for (const auto &[input, input_dest] : m_requirements) {
     if (!io::deleteFile(input)) {
@@ -167,109 +168,105 @@ void ExternalProgramTask::postProcess() {
   // Default implementation - can be overridden in derived classes
 }
 
-bool ExternalProgramTask::runExternalProgram(std::function<void(int, QString)> progress) {
-  QString exe = m_executable;
-  QStringList args = m_arguments;
-  {
-    QProcess process;
-    qDebug() << "In task logic";
+void ExternalProgramTask::reportProgress(int percentage,
+                                         const QString &message) {
+  emit progress(percentage);
+  emit progressText(message);
+}
 
-    if (m_tempDir) {
-      delete m_tempDir; // Clean up any previous instance
-    }
+bool ExternalProgramTask::prepareWorkingDirectory(
+    std::function<void(int, QString)> progress) {
+  if (m_tempDir) {
+    delete m_tempDir; // Clean up any previous instance
+  }
 
-    m_tempDir = new QTemporaryDir();
+  m_tempDir = new QTemporaryDir();
 
-    if (!m_tempDir->isValid()) {
-      setErrorMessage("Cannot create temporary directory");
-      return false;
-    }
-    progress(1, "Temporary directory created");
+  if (!m_tempDir->isValid()) {
+    setErrorMessage("Cannot create temporary directory");
+    return false;
+  }
+  progress(1, "Temporary directory created");
 
-    process.setProcessEnvironment(m_environment);
-    process.setWorkingDirectory(m_tempDir->path());
-    progress(2, "Process environment set");
+  if (!stageRequirements(m_tempDir->path())) {
+    setErrorMessage(
+        "Could not stage necessary files in temporary directory");
+    return false;
+  }
+  progress(3, "Staged files in temporary directory");
+  return true;
+}
 
-    setupProcessConnectionsPrivate(process);
+// Runs on the task's thread: the process itself is monitored by the
+// supervisor's event loop, so no backend thread is held while it runs
+void ExternalProgramTask::launchProcess() {
+  if (isCanceled() && errorMessage().isEmpty()) {
+    setErrorMessage("Task was canceled");
+  }
+  if (!errorMessage().isEmpty()) {
+    finishRun();
+    return;
+  }
 
-    if (!copyRequirements(m_tempDir->path())) {
-      setErrorMessage(
-          "Could not copy necessary files into temporary directory");
-      return false;
-    }
-    progress(3, "Copied files to temporary directory");
-    process.start(exe, args);
-    progress(4, "Starting background process");
-    process.waitForStarted();
-    progress(5, "Background process started");
-
-    int timeTaken = 0;
-
-    while (!process.waitForFinished(m_timeIncrement)) {
-      timeTaken += m_timeIncrement;
-      updateStdoutStderr(process);
-      progress(timeTaken / m_timeIncrement,
-                                      QString("Running %1").arg(m_executable));
-      if (isCanceled()) {
-        setErrorMessage("Task was canceled");
-        process.kill();
-        progress(100, "Task canceled");
-        return false;
-      }
-      if (m_timeout > 0) {
-        if (timeTaken > m_timeout) {
-          setErrorMessage("Process timeout");
-          progress(
-              100, "Background process canceled due to timeout");
-          process.kill();
-          return false;
-        }
-      }
+  ProcessRequest request;
+  request.program = m_executable;
+  request.arguments = m_arguments;
+  request.workingDirectory = m_tempDir->path();
+  request.environment = m_environment;
+  request.timeout = m_timeout;
+
+  reportProgress(4, "Starting background process");
+  m_processId = ProcessSupervisor::instance()->launch(
+      request, this,
+      [this](const ProcessResult &result) { processFinished(result); },
+      [this](QProcess::ProcessChannel) { emit stdoutChanged(); });
+  reportProgress(5, QString("Running %1").arg(m_executable));
+}
 
-      if (process.error() != QProcess::Timedout) {
-        progress(100,
-                                        "Background process failed: " +
-                                            exe::errorString(process.error()));
-        process.kill();
-        return false;
-      }
-    }
-    progress(90, "Background process complete");
-    updateStdoutStderr(process);
-
-    // Explicitly close all channels before process object is destroyed
-    process.closeReadChannel(QProcess::StandardOutput);
-    process.closeReadChannel(QProcess::StandardError);
-    process.closeWriteChannel();
-
-    // Make sure the process has terminated
-    if (process.state() != QProcess::NotRunning) {
-      process.terminate();
-      if (!process.waitForFinished(3000)) { // 3 second timeout
-        process.kill();
-        process.waitForFinished(1000);
-      }
-    }
+void ExternalProgramTask::processFinished(const ProcessResult &result) {
+  m_processId = 0;
+  setProperty("stdout", QString::fromUtf8(result.standardOutput));
+  setProperty("stderr", QString::fromUtf8(result.standardError));
+  emit stdoutChanged();
+  if (result.droppedOutputBytes > 0) {
+    qDebug() << "Discarded" << result.droppedOutputBytes
+             << "bytes of early output from" << m_executable;
   }
 
-  // SUCCESS
-  if (m_exitCode == 0) {
-    if (!copyResults(m_tempDir->path())) {
-      setErrorMessage("Could not copy results out of temporary directory");
-    }
-  } else {
-    setErrorMessage(QString("Failed with exit code: %1").arg(m_exitCode));
+  if (result.canceled) {
+    setErrorMessage("Task was canceled");
+    reportProgress(100, "Task canceled");
+    finishRun();
+    return;
+  }
+  if (result.timedOut) {
+    setErrorMessage("Process timeout");
+    reportProgress(100, "Background process canceled due to timeout");
+    finishRun();
+    return;
+  }
+  if (result.failedToStart) {
+    setErrorMessage(exe::errorString(QProcess::FailedToStart));
+    reportProgress(100, "Background process failed: " + result.errorString);
+    finishRun();
+    return;
+  }
+  if (result.exitStatus == QProcess::CrashExit) {
+    setErrorMessage("Process crashed");
+    finishRun();
+    return;
   }
-  return true;
-}
 
-// In the cpp file:
-void ExternalProgramTask::start() {
-  auto taskLogic = [this](std::function<void(int, QString)> progress) {
-    preProcess();
+  m_exitCode = result.exitCode;
+  reportProgress(90, "Background process complete");
 
-    if (!runExternalProgram(progress)) {
-      return;
+  auto collectResults = [this](std::function<void(int, QString)> progress) {
+    if (m_exitCode == 0) {
+      if (!captureResults(m_tempDir->path())) {
+        setErrorMessage("Could not move results out of temporary directory");
+      }
+    } else {
+      setErrorMessage(QString("Failed with exit code: %1").arg(m_exitCode));
     }
 
     progress(95, "Begin any post-processing steps");
@@ -281,11 +278,25 @@ void ExternalProgramTask::start() {
     progress(100, "Task complete");
     qDebug() << "[TASK LOGIC DONE]" << property("name").toString();
   };
+  runStage(collectResults, [this]() { finishRun(); });
+}
 
-  Task::run(taskLogic);
+void ExternalProgramTask::start() {
+  if (!beginRun())
+    return;
+
+  auto prepare = [this](std::function<void(int, QString)> progress) {
+    preProcess();
+    prepareWorkingDirectory(progress);
+  };
+  runStage(prepare, [this]() { launchProcess(); });
 }
 
-void ExternalProgramTask::stop() { emit stopProcess(); }
+void ExternalProgramTask::stop() {
+  m_canceled = true;
+  if (m_processId != 0)
+    ProcessSupervisor::instance()->cancel(m_processId);
+}
 
 void ExternalProgramTask::setEnvironment(const QProcessEnvironment &env) {
   m_environment = env;
@@ -344,6 +355,12 @@ bool ExternalProgramTask::overwrite() const { return false; }
 QString ExternalProgramTask::getInputFilePropertyName(QString filename) {
   return "input_" + filename;
 }
+QString ExternalProgramTask::inputFileContents(const QString &) const {
+  return QString();
+}
+QString ExternalProgramTask::outputFileContents(const QString &) const {
+  return QString();
+}
 QString ExternalProgramTask::getOutputFilePropertyName(QString filename) {
   return "output_" + filename;
 }
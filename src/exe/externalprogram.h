@@ -2,6 +2,7 @@
 #include "task.h"
 #include "filedependency.h"
 #include "chemicalstructure.h"
+#include "processsupervisor.h"
 #include <QString>
 #include <occ/core/molecule.h>
 #include <ankerl/unordered_dense.h>
@@ -74,28 +75,36 @@ public:
     static QString getInputFilePropertyName(QString filename);
     static QString getOutputFilePropertyName(QString filename);
 
+    // Inputs and outputs are recorded in the properties as absolute paths
+    // with a SHA-1 hash, their contents are only read when asked for
+    QString inputFileContents(const QString &filename) const;
+    QString outputFileContents(const QString &filename) const;
+
 protected:
     virtual void preProcess();
     virtual void postProcess();
-    bool runExternalProgram(std::function<void(int, QString)> progress);
 
 signals:
-    void stopProcess();
+    // The "stdout"/"stderr" properties are set once the process exits, this
+    // is also emitted as output arrives while it runs
     void stdoutChanged();
 
 private:
 #ifndef Q_OS_WASM
     QTemporaryDir *m_tempDir{nullptr};
-    void updateStdoutStderr(QProcess&);
-    bool copyRequirements(const QString &path);
-    bool copyResults(const QString &path);
+    bool prepareWorkingDirectory(std::function<void(int, QString)> progress);
+    void launchProcess();
+    void processFinished(const ProcessResult &);
+    void reportProgress(int, const QString &);
+    bool stageRequirements(const QString &path);
+    bool captureResults(const QString &path);
+    void recordFile(const QString &propertyName, const QString &filePath);
     bool deleteRequirements();
-    void setupProcessConnectionsPrivate(QProcess&);
     void cleanupResources();
 
+    ProcessId m_processId{0};
     int m_exitCode{-1};
     int m_timeout{0};
-    int m_timeIncrement{100};
     bool m_deleteWorkingFiles{false};
     QProcessEnvironment m_environment;
 
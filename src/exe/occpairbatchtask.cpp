@@ -0,0 +1,255 @@
+#include "occpairbatchtask.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+
+OccPairBatchTask::OccPairBatchTask(QObject *parent) : Task(parent) {
+  // pairs still outstanding when the task fails fail with it
+  connect(this, &Task::errorOccurred, this, [this](QString error) {
+    for (int i = 0; i < static_cast<int>(m_pairs.size()); i++) {
+      failPair(i, error);
+    }
+  });
+}
+
+OccPairBatchTask::~OccPairBatchTask() {
+#ifndef Q_OS_WASM
+  auto *supervisor = ProcessSupervisor::instance();
+  for (const auto &[index, id] : m_running) {
+    supervisor->cancel(id);
+  }
+#endif
+}
+
+void OccPairBatchTask::setPairs(
+    const std::vector<pair_energy::Parameters> &pairs) {
+  m_pairs = pairs;
+  m_pairReported.assign(m_pairs.size(), false);
+}
+
+void OccPairBatchTask::failPair(int index, const QString &error) {
+  if (m_pairReported[index])
+    return;
+  m_pairReported[index] = true;
+  emit pairFailed(index, error);
+}
+
+int OccPairBatchTask::threads() const {
+  return std::max(1, properties().value("threads", 1).toInt());
+}
+
+#ifndef Q_OS_WASM
+
+namespace {
+
+void appendTransformArguments(const QString &suffix,
+                              const Eigen::Isometry3d &transform,
+                              QStringList &args) {
+  const auto t = transform.matrix();
+  for (int i = 0; i < 3; i++) {
+    args << QString("--translation-%1=%2").arg(suffix).arg(t(i, 3));
+  }
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      args << QString("--rotation-%1=%2").arg(suffix).arg(t(i, j));
+    }
+  }
+}
+
+QString pairOutputName(int index) {
+  return QString("pair_%1_energies.json").arg(index);
+}
+
+} // namespace
+
+void OccPairBatchTask::writeInputs(std::function<void(int, QString)> progress) {
+  m_tempDir = std::make_unique<QTemporaryDir>();
+  if (!m_tempDir->isValid()) {
+    setErrorMessage("Cannot create temporary directory");
+    return;
+  }
+  QDir dir(m_tempDir->path());
+
+  // every pair sharing a monomer refers to the same file
+  ankerl::unordered_dense::map<const MolecularWavefunction *, int> indices;
+  auto wavefunctionIndex = [&](MolecularWavefunction *wfn) {
+    auto [it, inserted] =
+        indices.emplace(wfn, static_cast<int>(m_wavefunctionFiles.size()));
+    if (inserted) {
+      QString filename = dir.filePath(
+          QString("wfn_%1%2").arg(it->second).arg(wfn->fileSuffix()));
+      progress(1, QString("Writing %1").arg(QFileInfo(filename).fileName()));
+      if (!wfn->writeToFile(filename)) {
+        setErrorMessage("Could not write wavefunction file " + filename);
+      }
+      m_wavefunctionFiles.append(filename);
+    }
+    return it->second;
+  };
+
+  m_wavefunctionA.clear();
+  m_wavefunctionB.clear();
+  for (int i = 0; i < static_cast<int>(m_pairs.size()); i++) {
+    const auto &params = m_pairs[i];
+    if (m_pairReported[i]) {
+      // already failed for lack of wavefunctions
+      m_wavefunctionA.push_back(-1);
+      m_wavefunctionB.push_back(-1);
+      continue;
+    }
+    m_wavefunctionA.push_back(wavefunctionIndex(params.wfnA));
+    m_wavefunctionB.push_back(wavefunctionIndex(params.wfnB));
+    if (!errorMessage().isEmpty())
+      return;
+  }
+  progress(5, QString("Wrote %1 wavefunctions for %2 pairs")
+                  .arg(m_wavefunctionFiles.size())
+                  .arg(m_pairs.size()));
+}
+
+QStringList OccPairBatchTask::pairArguments(int index) const {
+  const auto &params = m_pairs[index];
+  QStringList args{"pair", "-a", m_wavefunctionFiles[m_wavefunctionA[index]],
+                   "-b", m_wavefunctionFiles[m_wavefunctionB[index]]};
+  // concurrency comes from running several pairs at once
+  args << "--threads=1";
+  args << QString("--model=%1").arg(params.model);
+  args << QString("--json=%1").arg(pairOutputName(index));
+  appendTransformArguments("a", params.transformA, args);
+  appendTransformArguments("b", params.transformB, args);
+  return args;
+}
+
+void OccPairBatchTask::start() {
+  if (!beginRun())
+    return;
+
+  m_nextPair = 0;
+  m_finishedPairs = 0;
+  m_failedPairs = 0;
+  m_wavefunctionFiles.clear();
+  m_pairReported.assign(m_pairs.size(), false);
+
+  // a pair without wavefunctions fails on its own, the others still run
+  for (int i = 0; i < static_cast<int>(m_pairs.size()); i++) {
+    if (!(m_pairs[i].wfnA && m_pairs[i].wfnB)) {
+      m_finishedPairs++;
+      m_failedPairs++;
+      failPair(i, "Invalid wavefunctions specified");
+    }
+  }
+
+  runStage([this](std::function<void(int, QString)> progress) {
+    writeInputs(progress);
+  }, [this]() {
+    if (!errorMessage().isEmpty()) {
+      // nothing was launched, so failing the task fails every pair
+      finishRun();
+      return;
+    }
+    launchPending();
+  });
+}
+
+void OccPairBatchTask::launchPending() {
+  const int total = static_cast<int>(m_pairs.size());
+  auto *supervisor = ProcessSupervisor::instance();
+
+  while (!isCanceled() && m_nextPair < total &&
+         static_cast<int>(m_running.size()) < threads()) {
+    const int index = m_nextPair++;
+    if (m_pairReported[index])
+      continue;
+    ProcessRequest request;
+    request.program = m_executable;
+    request.arguments = pairArguments(index);
+    request.workingDirectory = m_tempDir->path();
+    request.environment = m_environment;
+    request.timeout = m_timeout;
+    m_running[index] = supervisor->launch(
+        request, this, [this, index](const ProcessResult &result) {
+          pairFinished(index, result);
+        });
+  }
+
+  // pairs never launched because of cancellation still need reporting
+  if (isCanceled()) {
+    for (; m_nextPair < total; m_nextPair++) {
+      if (m_pairReported[m_nextPair])
+        continue;
+      m_finishedPairs++;
+      m_failedPairs++;
+      failPair(m_nextPair, "Task was canceled");
+    }
+  }
+
+  if (m_running.empty() && m_finishedPairs == total) {
+    if (isCanceled()) {
+      setErrorMessage("Task was canceled");
+    } else if (m_failedPairs > 0) {
+      setErrorMessage(QString("%1 of %2 pair energies failed")
+                          .arg(m_failedPairs)
+                          .arg(total));
+    }
+    m_tempDir.reset();
+    finishRun();
+  }
+}
+
+void OccPairBatchTask::pairFinished(int index, const ProcessResult &result) {
+  m_running.erase(index);
+  m_finishedPairs++;
+
+  const QString jsonPath =
+      QDir(m_tempDir->path()).filePath(pairOutputName(index));
+  QString error;
+  if (result.canceled) {
+    error = "Task was canceled";
+  } else if (result.timedOut) {
+    error = "Process timeout";
+  } else if (result.failedToStart) {
+    error = "Process failed to start: " + result.errorString;
+  } else if (result.exitStatus == QProcess::CrashExit) {
+    error = "Process crashed";
+  } else if (result.exitCode != 0 || !QFile::exists(jsonPath)) {
+    error = QString("occ exited with code %1: %2")
+                .arg(result.exitCode)
+                .arg(QString::fromUtf8(result.standardError).trimmed());
+  }
+
+  if (error.isEmpty()) {
+    m_pairReported[index] = true;
+    emit pairCompleted(index, jsonPath);
+  } else {
+    m_failedPairs++;
+    qWarning() << "Pair" << m_pairs[index].deriveName() << "failed:" << error;
+    failPair(index, error);
+  }
+
+  const int total = static_cast<int>(m_pairs.size());
+  emit progress(5 + (95 * m_finishedPairs) / std::max(total, 1));
+  emit progressText(
+      QString("Computed %1 of %2 pair energies").arg(m_finishedPairs).arg(total));
+  launchPending();
+}
+
+void OccPairBatchTask::stop() {
+  m_canceled = true;
+  auto *supervisor = ProcessSupervisor::instance();
+  for (const auto &[index, id] : m_running) {
+    supervisor->cancel(id);
+  }
+}
+
+#else // Q_OS_WASM
+
+void OccPairBatchTask::start() {
+  setErrorMessage("External program execution not supported in WASM");
+  emit errorOccurred(errorMessage());
+}
+
+void OccPairBatchTask::stop() {}
+
+#endif // Q_OS_WASM
@@ -0,0 +1,76 @@
+#pragma once
+#include "task.h"
+#include "pair_energy_parameters.h"
+#include "processsupervisor.h"
+#include <QString>
+#include <ankerl/unordered_dense.h>
+#include <memory>
+#include <vector>
+
+#ifndef Q_OS_WASM
+#include <QProcessEnvironment>
+#include <QTemporaryDir>
+#endif
+
+/**
+ * @brief Computes a set of OCC pair energies as a single task
+ *
+ * Each distinct monomer wavefunction is written once into a shared working
+ * directory, and the pairs are then evaluated by up to threads() concurrent
+ * occ processes. Results are
+ * reported per pair as they arrive rather than when the whole batch is done,
+ * and every pair is reported exactly once, including when the task fails.
+ */
+class OccPairBatchTask : public Task {
+    Q_OBJECT
+public:
+    explicit OccPairBatchTask(QObject *parent = nullptr);
+    ~OccPairBatchTask();
+
+    void setPairs(const std::vector<pair_energy::Parameters> &);
+    inline const auto &pairs() const { return m_pairs; }
+
+    void setExecutable(const QString &exe) { m_executable = exe; }
+    void setTimeout(int timeout) { m_timeout = timeout; }
+#ifndef Q_OS_WASM
+    void setEnvironment(const QProcessEnvironment &env) { m_environment = env; }
+#else
+    template<typename T> void setEnvironment(const T&) {}
+#endif
+
+    int threads() const;
+
+    virtual void start() override;
+    virtual void stop() override;
+
+signals:
+    // jsonPath is removed with the working directory once the batch is done,
+    // so results should be read when this is emitted
+    void pairCompleted(int index, QString jsonPath);
+    void pairFailed(int index, QString error);
+
+private:
+    // Report a pair as failed unless it has already been reported
+    void failPair(int index, const QString &error);
+
+#ifndef Q_OS_WASM
+    void writeInputs(std::function<void(int, QString)> progress);
+    void launchPending();
+    void pairFinished(int index, const ProcessResult &result);
+    QStringList pairArguments(int index) const;
+
+    QProcessEnvironment m_environment;
+    std::unique_ptr<QTemporaryDir> m_tempDir;
+    QStringList m_wavefunctionFiles;
+    std::vector<int> m_wavefunctionA;
+    std::vector<int> m_wavefunctionB;
+    ankerl::unordered_dense::map<int, ProcessId> m_running; // pair -> process
+    int m_nextPair{0};
+    int m_finishedPairs{0};
+    int m_failedPairs{0};
+#endif
+    std::vector<pair_energy::Parameters> m_pairs;
+    std::vector<bool> m_pairReported;
+    QString m_executable{"occ"};
+    int m_timeout{0};
+};
@@ -0,0 +1,245 @@
+#include "processsupervisor.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <cstring>
+
+OutputRingBuffer::OutputRingBuffer(qsizetype capacity)
+    : m_capacity(std::max<qsizetype>(capacity, 1)) {}
+
+void OutputRingBuffer::append(const QByteArray &chunk) {
+  m_totalBytes += chunk.size();
+  const char *src = chunk.constData();
+  qsizetype n = chunk.size();
+  if (n == 0)
+    return;
+
+  if (n >= m_capacity) {
+    m_data = QByteArray(src + n - m_capacity, m_capacity);
+    m_start = 0;
+    m_size = m_capacity;
+    return;
+  }
+
+  // storage grows with the output until the capacity is reached, so short
+  // outputs stay small
+  if (m_data.size() < m_capacity) {
+    const qsizetype linear = std::min(n, m_capacity - m_data.size());
+    m_data.append(src, linear);
+    m_size = m_data.size();
+    src += linear;
+    n -= linear;
+  }
+
+  // full: overwrite the oldest bytes
+  while (n > 0) {
+    const qsizetype count = std::min(n, m_capacity - m_start);
+    std::memcpy(m_data.data() + m_start, src, count);
+    m_start = (m_start + count) % m_capacity;
+    src += count;
+    n -= count;
+  }
+}
+
+void OutputRingBuffer::clear() {
+  m_data.clear();
+  m_start = 0;
+  m_size = 0;
+  m_totalBytes = 0;
+}
+
+QByteArray OutputRingBuffer::contents() const {
+  if (m_start == 0)
+    return m_data;
+  return m_data.mid(m_start) + m_data.left(m_start);
+}
+
+#ifndef Q_OS_WASM
+
+ProcessSupervisor::ProcessSupervisor(QObject *parent) : QObject(parent) {}
+
+ProcessSupervisor::~ProcessSupervisor() {
+  // nothing is reported once the supervisor is gone
+  for (auto &[id, entry] : m_entries) {
+    entry->process->disconnect(this);
+    if (entry->process->state() != QProcess::NotRunning) {
+      entry->process->kill();
+      entry->process->waitForFinished(1000);
+    }
+  }
+  m_entries.clear();
+}
+
+ProcessSupervisor *ProcessSupervisor::instance() {
+  static QPointer<ProcessSupervisor> shared;
+  if (!shared) {
+    auto *app = QCoreApplication::instance();
+    Q_ASSERT(!app || QThread::currentThread() == app->thread());
+    shared = new ProcessSupervisor(app);
+  }
+  return shared;
+}
+
+ProcessSupervisor::Entry *ProcessSupervisor::entry(ProcessId id) const {
+  auto it = m_entries.find(id);
+  if (it == m_entries.end())
+    return nullptr;
+  return it->second.get();
+}
+
+ProcessId ProcessSupervisor::launch(const ProcessRequest &request,
+                                    QObject *context,
+                                    FinishedCallback onFinished,
+                                    OutputCallback onOutput) {
+  Q_ASSERT(QThread::currentThread() == thread());
+  const ProcessId id = m_nextId++;
+
+  auto newEntry = std::make_unique<Entry>();
+  newEntry->process = new QProcess(this);
+  newEntry->context = context;
+  newEntry->onFinished = std::move(onFinished);
+  newEntry->onOutput = std::move(onOutput);
+  newEntry->standardOutput = OutputRingBuffer(request.outputCapacity);
+  newEntry->standardError = OutputRingBuffer(request.outputCapacity);
+  QProcess *process = newEntry->process;
+  m_entries.emplace(id, std::move(newEntry));
+
+  process->setProcessEnvironment(request.environment);
+  process->setWorkingDirectory(request.workingDirectory);
+
+  connect(process, &QProcess::readyReadStandardOutput, this,
+          [this, id]() { readOutput(id, QProcess::StandardOutput); });
+  connect(process, &QProcess::readyReadStandardError, this,
+          [this, id]() { readOutput(id, QProcess::StandardError); });
+  connect(process, &QProcess::started, this, [this, id]() {
+    Entry *e = entry(id);
+    if (!e)
+      return;
+    // canceled before the process was running
+    if (e->canceled)
+      stop(*e);
+    emit processStarted(id);
+  });
+  connect(process, &QProcess::finished, this,
+          [this, id](int exitCode, QProcess::ExitStatus exitStatus) {
+            finish(id, exitCode, exitStatus, false);
+          });
+  connect(process, &QProcess::errorOccurred, this,
+          [this, id](QProcess::ProcessError error) {
+            Entry *e = entry(id);
+            if (!e)
+              return;
+            e->errorString = e->process->errorString();
+            // finished() is never emitted for a process that failed to
+            // start, and this may be raised from within start() itself
+            if (error == QProcess::FailedToStart) {
+              QMetaObject::invokeMethod(
+                  this,
+                  [this, id]() { finish(id, -1, QProcess::CrashExit, true); },
+                  Qt::QueuedConnection);
+            }
+          });
+
+  if (request.timeout > 0) {
+    auto *timer = new QTimer(process);
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, [this, id]() {
+      Entry *e = entry(id);
+      if (!e)
+        return;
+      e->timedOut = true;
+      e->process->kill();
+    });
+    timer->start(request.timeout);
+  }
+
+  process->start(request.program, request.arguments);
+  return id;
+}
+
+void ProcessSupervisor::readOutput(ProcessId id,
+                                   QProcess::ProcessChannel channel) {
+  Entry *e = entry(id);
+  if (!e)
+    return;
+  if (channel == QProcess::StandardOutput) {
+    e->standardOutput.append(e->process->readAllStandardOutput());
+  } else {
+    e->standardError.append(e->process->readAllStandardError());
+  }
+  if (e->context && e->onOutput)
+    e->onOutput(channel);
+}
+
+void ProcessSupervisor::stop(Entry &e) {
+  if (e.process->state() != QProcess::Running)
+    return;
+  e.process->terminate();
+  QTimer::singleShot(TerminateGracePeriod, e.process, [process = e.process]() {
+    if (process->state() != QProcess::NotRunning)
+      process->kill();
+  });
+}
+
+void ProcessSupervisor::cancel(ProcessId id) {
+  Entry *e = entry(id);
+  if (!e || e->canceled)
+    return;
+  e->canceled = true;
+  stop(*e);
+}
+
+void ProcessSupervisor::finish(ProcessId id, int exitCode,
+                               QProcess::ExitStatus exitStatus,
+                               bool failedToStart) {
+  auto it = m_entries.find(id);
+  if (it == m_entries.end())
+    return;
+  std::unique_ptr<Entry> e = std::move(it->second);
+  m_entries.erase(it);
+
+  if (!failedToStart) {
+    e->standardOutput.append(e->process->readAllStandardOutput());
+    e->standardError.append(e->process->readAllStandardError());
+  }
+  e->process->disconnect(this);
+  e->process->deleteLater();
+
+  ProcessResult result;
+  result.exitCode = exitCode;
+  result.exitStatus = exitStatus;
+  result.failedToStart = failedToStart;
+  result.timedOut = e->timedOut;
+  result.canceled = e->canceled;
+  result.errorString = e->errorString;
+  result.standardOutput = e->standardOutput.contents();
+  result.standardError = e->standardError.contents();
+  result.droppedOutputBytes =
+      e->standardOutput.droppedBytes() + e->standardError.droppedBytes();
+
+  emit processFinished(id);
+  if (e->context && e->onFinished)
+    e->onFinished(result);
+}
+
+bool ProcessSupervisor::isRunning(ProcessId id) const {
+  return entry(id) != nullptr;
+}
+
+int ProcessSupervisor::numberOfProcesses() const {
+  return static_cast<int>(m_entries.size());
+}
+
+QByteArray ProcessSupervisor::standardOutput(ProcessId id) const {
+  Entry *e = entry(id);
+  return e ? e->standardOutput.contents() : QByteArray();
+}
+
+QByteArray ProcessSupervisor::standardError(ProcessId id) const {
+  Entry *e = entry(id);
+  return e ? e->standardError.contents() : QByteArray();
+}
+
+#endif // Q_OS_WASM
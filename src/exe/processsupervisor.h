@@ -0,0 +1,149 @@
+#pragma once
+#include <QByteArray>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <ankerl/unordered_dense.h>
+#include <functional>
+#include <memory>
+
+// QProcess and related functionality not available in WASM
+#ifndef Q_OS_WASM
+#include <QProcess>
+#include <QProcessEnvironment>
+#endif
+
+/**
+ * @brief Fixed capacity byte buffer keeping the most recent output
+ *
+ * Appending is O(chunk) regardless of how much has been written, and once
+ * the capacity is reached the oldest bytes are dropped.
+ */
+class OutputRingBuffer {
+public:
+    static constexpr qsizetype DefaultCapacity = 16 * 1024 * 1024;
+
+    explicit OutputRingBuffer(qsizetype capacity = DefaultCapacity);
+
+    void append(const QByteArray &chunk);
+    void clear();
+
+    // Retained output, oldest first
+    [[nodiscard]] QByteArray contents() const;
+
+    [[nodiscard]] inline qsizetype size() const { return m_size; }
+    [[nodiscard]] inline qsizetype capacity() const { return m_capacity; }
+    [[nodiscard]] inline qint64 totalBytesWritten() const { return m_totalBytes; }
+    [[nodiscard]] inline qint64 droppedBytes() const {
+        return m_totalBytes - m_size;
+    }
+
+private:
+    QByteArray m_data;
+    qsizetype m_capacity{0};
+    qsizetype m_start{0};
+    qsizetype m_size{0};
+    qint64 m_totalBytes{0};
+};
+
+#ifndef Q_OS_WASM
+
+using ProcessId = quint64;
+
+struct ProcessRequest {
+    QString program;
+    QStringList arguments;
+    QString workingDirectory;
+    QProcessEnvironment environment{QProcessEnvironment::systemEnvironment()};
+    int timeout{0}; // milliseconds, 0 for no limit
+    qsizetype outputCapacity{OutputRingBuffer::DefaultCapacity};
+};
+
+struct ProcessResult {
+    int exitCode{-1};
+    QProcess::ExitStatus exitStatus{QProcess::NormalExit};
+    bool failedToStart{false};
+    bool timedOut{false};
+    bool canceled{false};
+    QString errorString;
+    QByteArray standardOutput;
+    QByteArray standardError;
+    qint64 droppedOutputBytes{0};
+
+    [[nodiscard]] inline bool succeeded() const {
+        return !failedToStart && !timedOut && !canceled &&
+               exitStatus == QProcess::NormalExit && exitCode == 0;
+    }
+};
+
+/**
+ * @brief Owns and monitors every external process started by tasks
+ *
+ * Processes are driven entirely by the event loop of the thread the
+ * supervisor lives in (the GUI thread for the shared instance), so waiting
+ * on a child costs no worker thread. Output, timeouts, cancellation and
+ * exit status are all handled through QProcess signals, and callbacks are
+ * only invoked while their context object is alive.
+ */
+class ProcessSupervisor : public QObject {
+    Q_OBJECT
+public:
+    using OutputCallback = std::function<void(QProcess::ProcessChannel)>;
+    using FinishedCallback = std::function<void(const ProcessResult &)>;
+
+    explicit ProcessSupervisor(QObject *parent = nullptr);
+    ~ProcessSupervisor();
+
+    // Shared instance, created on first use. Must be called from the
+    // application's main thread.
+    static ProcessSupervisor *instance();
+
+    // Start a process, returning its id. onFinished is always called
+    // exactly once (unless context is destroyed first), including when the
+    // process fails to start.
+    ProcessId launch(const ProcessRequest &request, QObject *context,
+                     FinishedCallback onFinished,
+                     OutputCallback onOutput = {});
+
+    // Ask the process to terminate, killing it if it does not exit promptly
+    void cancel(ProcessId id);
+
+    [[nodiscard]] bool isRunning(ProcessId id) const;
+    [[nodiscard]] int numberOfProcesses() const;
+
+    // Output retained so far for a running process
+    [[nodiscard]] QByteArray standardOutput(ProcessId id) const;
+    [[nodiscard]] QByteArray standardError(ProcessId id) const;
+
+    // Grace period between terminate() and kill() on cancellation
+    static constexpr int TerminateGracePeriod = 3000;
+
+signals:
+    void processStarted(ProcessId);
+    void processFinished(ProcessId);
+
+private:
+    struct Entry {
+        QProcess *process{nullptr};
+        QPointer<QObject> context;
+        FinishedCallback onFinished;
+        OutputCallback onOutput;
+        OutputRingBuffer standardOutput;
+        OutputRingBuffer standardError;
+        bool timedOut{false};
+        bool canceled{false};
+        QString errorString;
+    };
+
+    Entry *entry(ProcessId id) const;
+    void readOutput(ProcessId id, QProcess::ProcessChannel channel);
+    void finish(ProcessId id, int exitCode, QProcess::ExitStatus exitStatus,
+                bool failedToStart);
+    void stop(Entry &entry);
+
+    ProcessId m_nextId{1};
+    ankerl::unordered_dense::map<ProcessId, std::unique_ptr<Entry>> m_entries;
+};
+
+#endif // Q_OS_WASM
@@ -72,15 +72,39 @@ protected:
      */
     template<typename Callable>
     void run(Callable taskCallable) {
+        if (!beginRun()) {
+            return;
+        }
+        runStage(taskCallable, [this]() { finishRun(); });
+    }
+
+    /**
+     * @brief Mark the task as running, emitting an error if there is no backend
+     * @return false if the task cannot run
+     */
+    bool beginRun() {
         if (!m_backend) {
             m_errorMessage = "No backend set for task";
             emit errorOccurred(m_errorMessage);
-            return;
+            return false;
         }
 
         m_running = true;
         m_provenance.startedAt = QDateTime::currentDateTime();
+        return true;
+    }
 
+    /**
+     * @brief Run one stage of a task on the backend
+     * @param taskCallable Callable taking progress callback function(int percentage, QString text)
+     * @param next Called on the task's thread once the stage is done
+     *
+     * Tasks made of several stages (e.g. waiting on an external process
+     * between preparing inputs and reading outputs) call this once per
+     * stage, and finishRun() after the last one.
+     */
+    template<typename Callable>
+    void runStage(Callable taskCallable, std::function<void()> next) {
         // Progress callback - posts to main thread if needed
         auto onProgress = [this](int percent, QString message) {
             QMetaObject::invokeMethod(this, [this, percent, message]() {
@@ -90,24 +114,8 @@ protected:
         };
 
         // Completion callback - posts to main thread if needed
-        auto onComplete = [this]() {
-            QMetaObject::invokeMethod(this, [this]() {
-                m_provenance.completedAt = QDateTime::currentDateTime();
-                m_finished = true;
-                m_running = false;
-
-                // Set wallTime property
-                double wallTime = wallTimeSec();
-                setProperty("wallTime", wallTime);
-
-                if (m_errorMessage.isEmpty()) {
-                    qDebug() << "[TASK COMPLETE]" << property("name").toString()
-                             << "Wall time:" << wallTime << "seconds";
-                    emit completed();
-                } else {
-                    emit errorOccurred(m_errorMessage);
-                }
-            }, Qt::AutoConnection);
+        auto onComplete = [this, next]() {
+            QMetaObject::invokeMethod(this, next, Qt::AutoConnection);
         };
 
         // Work callable - wraps user callable with error handling
@@ -125,6 +133,27 @@ protected:
         m_backend->execute(work, onProgress, onComplete);
     }
 
+    /**
+     * @brief Record completion and emit completed() or errorOccurred()
+     */
+    void finishRun() {
+        m_provenance.completedAt = QDateTime::currentDateTime();
+        m_finished = true;
+        m_running = false;
+
+        // Set wallTime property
+        double wallTime = wallTimeSec();
+        setProperty("wallTime", wallTime);
+
+        if (m_errorMessage.isEmpty()) {
+            qDebug() << "[TASK COMPLETE]" << property("name").toString()
+                     << "Wall time:" << wallTime << "seconds";
+            emit completed();
+        } else {
+            emit errorOccurred(m_errorMessage);
+        }
+    }
+
 protected:
     TaskBackend *m_backend{nullptr};
     QMap<QString, QVariant> m_properties;
@@ -1,5 +1,6 @@
 #include "taskmanager.h"
 #include "taskbackend.h"
+#include "performancetimer.h"
 
 TaskManager::TaskManager(QObject *parent) : QObject(parent) {
     // Create shared backend for all tasks
@@ -69,11 +70,23 @@ void TaskManager::remove(TaskID taskId) {
   }
 }
 
+void TaskManager::cancel(TaskID taskId) {
+  Task *task = get(taskId);
+  if (!task)
+    return;
+  if (m_pendingTasks.contains(taskId)) {
+    remove(taskId);
+  } else if (task->isRunning()) {
+    task->stop();
+  }
+}
+
 Task *TaskManager::get(TaskID taskId) const {
   return m_tasks.value(taskId, nullptr);
 }
 
 void TaskManager::handleTaskComplete(TaskID id) {
+  PERF_SCOPED_TIMER("Task completion");
   Task *task = get(id);
   if (task) {
     m_currentConcurrentTasks -= getTaskThreadCount(task);
@@ -17,6 +17,8 @@ public:
 
     TaskID add(Task* task, bool start=true);
     void remove(TaskID taskId);
+    // Stop a running task, or drop it if it has not been started yet
+    void cancel(TaskID taskId);
     Task* get(TaskID taskId) const;
 
     int numFinished() const;
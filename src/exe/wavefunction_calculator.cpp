@@ -117,6 +117,7 @@ Task *WavefunctionCalculator::makeOccTask(wfn::Parameters params) {
   connect(task, &Task::completed, this, [this]() {
     onWavefunctionTaskComplete();
   });
+  connectTaskErrors(task);
 
   return task;
 }
@@ -150,10 +151,21 @@ Task *WavefunctionCalculator::makeOrcaTask(wfn::Parameters params) {
   connect(task, &Task::completed, this, [this]() {
     onWavefunctionTaskComplete();
   });
+  connectTaskErrors(task);
 
   return task;
 }
 
+void WavefunctionCalculator::connectTaskErrors(Task *task) {
+  connect(task, &Task::errorOccurred, this, [this, task](QString message) {
+    qWarning() << "Wavefunction task" << task->property("name").toString()
+               << "failed:" << message;
+    emit errorOccurred(message);
+  });
+  connect(task, &Task::stopped, this,
+          [this]() { emit errorOccurred("Wavefunction calculation stopped"); });
+}
+
 void WavefunctionCalculator::start(wfn::Parameters params) {
   if (!params.structure) {
     qDebug()
@@ -206,6 +218,7 @@ void WavefunctionCalculator::start(xtb::Parameters params) {
     connect(task, &Task::completed, this, [this]() {
       onXtbTaskComplete();
     });
+    connectTaskErrors(task);
     m_taskManager->add(task);  // TaskManager starts it
   }
 }
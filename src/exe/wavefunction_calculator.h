@@ -24,6 +24,7 @@ public:
 
 signals:
   void calculationComplete();
+  void errorOccurred(QString);
 
 private slots:
   void onWavefunctionTaskComplete();
@@ -32,6 +33,7 @@ private slots:
 private:
   Task * makeOccTask(wfn::Parameters);
   Task * makeOrcaTask(wfn::Parameters);
+  void connectTaskErrors(Task *);
 
   TaskManager *m_taskManager{nullptr};
   XtbEnergyCalculator *m_xtb{nullptr};
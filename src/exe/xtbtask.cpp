@@ -34,16 +34,21 @@ QString XtbTask::stdoutContents() const {
   return property("stdout").toString();
 }
 
-QString XtbTask::jsonContents() const {
-  return property(getOutputFilePropertyName("xtbout.json")).toString();
+QString XtbTask::outputContents(const QString &filename) const {
+  auto it = m_keptOutputs.constFind(filename);
+  if (it != m_keptOutputs.constEnd())
+    return *it;
+  return outputFileContents(filename);
 }
 
+QString XtbTask::jsonContents() const { return outputContents("xtbout.json"); }
+
 QString XtbTask::moldenContents() const {
-  return property(getOutputFilePropertyName("molden.input")).toString();
+  return outputContents("molden.input");
 }
 
 QString XtbTask::propertiesContents() const {
-  return property(getOutputFilePropertyName("properties.txt")).toString();
+  return outputContents("properties.txt");
 }
 
 QString XtbTask::coordFilename() const {
@@ -99,6 +104,9 @@ void XtbTask::postProcess() {
   setProperty("result_success", true);
 
   if (deleteWorkingFiles()) {
+    for (const QString &name : {"xtbout.json", "properties.txt", "molden.input"}) {
+      m_keptOutputs.insert(name, outputFileContents(name));
+    }
     emit progressText("Deleting XTB working files");
     io::deleteFile(jsonFilename());
     io::deleteFile(propertiesFilename());
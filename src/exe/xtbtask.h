@@ -1,6 +1,7 @@
 #pragma once
 #include "externalprogram.h"
 #include "xtb_parameters.h"
+#include <QHash>
 
 class XtbTask : public ExternalProgramTask {
   Q_OBJECT
@@ -30,5 +31,9 @@ public:
   QString propertiesContents() const;
 
 private:
+  QString outputContents(const QString &filename) const;
+
   xtb::Parameters m_parameters;
+  // outputs read before the working files are deleted
+  QHash<QString, QString> m_keptOutputs;
 };
@@ -6,6 +6,7 @@
 #include <QToolTip>
 #include <QVector2D>
 #include <cmath>
+#include <cstring>
 
 #include "elementdata.h"
 #include "glwindow.h"
@@ -15,6 +16,8 @@
 #include "settings.h"
 #include "performancetimer.h"
 #include "colorbarwidget.h"
+#include "raytracer.h"
+#include "streaming_image_writer.h"
 #include <fmt/core.h>
 
 // OpenGL ES compatibility
@@ -141,6 +144,10 @@ void GLWindow::makeFrameBufferObject() {
     delete m_resolvedFramebuffer;
     m_resolvedFramebuffer = nullptr;
   }
+  if (m_transparencyFramebuffer) {
+    delete m_transparencyFramebuffer;
+    m_transparencyFramebuffer = nullptr;
+  }
 
   // Create the FBO
   QOpenGLFramebufferObjectFormat format;
@@ -152,6 +159,22 @@ void GLWindow::makeFrameBufferObject() {
   int h = std::max(1, static_cast<int>(height() * devicePixelRatio()));
   m_framebuffer = new QOpenGLFramebufferObject(w, h, format);
   m_resolvedFramebuffer = new QOpenGLFramebufferObject(w, h);
+
+#ifndef Q_OS_WASM
+  // Transparent surfaces are accumulated at constant cost rather than sorted:
+  // the first target holds the weighted premultiplied colour sum (rgb) and
+  // the revealage product (a), the second the sum of weights
+  m_transparencyFramebuffer = new QOpenGLFramebufferObject(
+      w, h, QOpenGLFramebufferObject::CombinedDepthStencil, GL_TEXTURE_2D,
+      GL_RGBA16F);
+  m_transparencyFramebuffer->addColorAttachment(w, h, GL_R16F);
+  if (!m_transparencyFramebuffer->isValid()) {
+    qWarning() << "Float framebuffers unavailable, falling back to ordered "
+                  "transparency";
+    delete m_transparencyFramebuffer;
+    m_transparencyFramebuffer = nullptr;
+  }
+#endif
 }
 
 /*!
@@ -234,6 +257,52 @@ void GLWindow::initializeGL() {
   m_postprocessShader->bindAttributeLocation("aTexCoords", 1);
   m_postprocessShader->link();
 
+#ifndef Q_OS_WASM
+  m_transparencyCompositeShader = new QOpenGLShaderProgram();
+  m_transparencyCompositeShader->addShaderFromSourceCode(QOpenGLShader::Vertex,
+                                                         R"(
+      #version 330 core
+      layout (location = 0) in vec2 aPos;
+      layout (location = 1) in vec2 aTexCoords;
+
+      out vec2 TexCoords;
+
+      void main()
+      {
+          gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
+          TexCoords = aTexCoords;
+      }
+  )");
+  m_transparencyCompositeShader->addShaderFromSourceCode(
+      QOpenGLShader::Fragment, R"(
+      #version 330 core
+      out vec4 FragColor;
+
+      in vec2 TexCoords;
+
+      uniform sampler2D accumTexture;
+      uniform sampler2D weightTexture;
+
+      void main()
+      {
+          vec4 accum = texture(accumTexture, TexCoords);
+          float revealage = accum.a;
+          if (revealage >= 0.9999) discard;
+          float weight = texture(weightTexture, TexCoords).r;
+          // blended with (ONE_MINUS_SRC_ALPHA, SRC_ALPHA) over the opaque image
+          FragColor = vec4(accum.rgb / max(weight, 1e-5), revealage);
+      }
+  )");
+  m_transparencyCompositeShader->bindAttributeLocation("aPos", 0);
+  m_transparencyCompositeShader->bindAttributeLocation("aTexCoords", 1);
+  if (!m_transparencyCompositeShader->link()) {
+    qWarning() << "Transparency composite shader link error:"
+               << m_transparencyCompositeShader->log();
+    delete m_transparencyCompositeShader;
+    m_transparencyCompositeShader = nullptr;
+  }
+#endif
+
   // Create the screen-filling quad
   m_quadVAO.create();
   m_quadVBO.create();
@@ -396,9 +465,11 @@ void GLWindow::paintGL() {
     setModelView();
   }
 
+  const bool deferTransparency =
+      m_transparencyFramebuffer && m_transparencyCompositeShader;
   {
     PERF_SCOPED_TIMER("Scene Rendering");
-    drawScene(false);
+    drawScene(false, deferTransparency);
   }
 
   {
@@ -407,9 +478,14 @@ void GLWindow::paintGL() {
     m_framebuffer->blitFramebuffer(
         m_resolvedFramebuffer, QRect(QPoint(), m_resolvedFramebuffer->size()),
         m_framebuffer, QRect(QPoint(), m_framebuffer->size()));
-    glDisable(GL_DEPTH_TEST);
   }
 
+  if (deferTransparency && scene && scene->hasTransparentMeshes()) {
+    PERF_SCOPED_TIMER("Transparency");
+    drawTransparency();
+  }
+  glDisable(GL_DEPTH_TEST);
+
   {
     PERF_SCOPED_TIMER("Post-processing");
     QOpenGLFramebufferObject::bindDefault();
@@ -431,35 +507,223 @@ void GLWindow::paintGL() {
   PERF_FRAME_END();
 }
 
-QImage GLWindow::exportToImage(int scaleFactor, const QColor &background) {
-  makeCurrent();
-  int w = width() * scaleFactor;
-  int h = height() * scaleFactor;
-  glViewport(0, 0, w, h);
+/*!
+ Weighted blended order independent transparency (McGuire & Bavoil, 2013).
+ Transparent mesh fragments deferred by drawScene are accumulated in a
+ single pass, tested against the opaque depth buffer but not writing to it,
+ then composited over the resolved opaque image. The cost is independent of
+ triangle count and view direction, with no sorting required.
+ */
+void GLWindow::drawTransparency() {
+  const QRect rect(QPoint(), m_transparencyFramebuffer->size());
+  QOpenGLFramebufferObject::blitFramebuffer(
+      m_transparencyFramebuffer, rect, m_framebuffer, rect,
+      GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+  m_transparencyFramebuffer->bind();
+  const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+  glDrawBuffers(2, drawBuffers);
+  const GLfloat accumClear[] = {0.0f, 0.0f, 0.0f, 1.0f};
+  const GLfloat weightClear[] = {0.0f, 0.0f, 0.0f, 0.0f};
+  glClearBufferfv(GL_COLOR, 0, accumClear);
+  glClearBufferfv(GL_COLOR, 1, weightClear);
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthMask(GL_FALSE);
+  // colour and weights are summed, revealage multiplied by (1 - alpha)
+  glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+  scene->drawTransparentMeshes();
+  glDepthMask(GL_TRUE);
+  glDisable(GL_DEPTH_TEST);
+  m_transparencyFramebuffer->release();
+
+  m_resolvedFramebuffer->bind();
+  const auto textures = m_transparencyFramebuffer->textures();
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, textures[0]);
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_2D, textures[1]);
+  glActiveTexture(GL_TEXTURE0);
+
+  glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+  m_transparencyCompositeShader->bind();
+  m_transparencyCompositeShader->setUniformValue("accumTexture", 0);
+  m_transparencyCompositeShader->setUniformValue("weightTexture", 1);
+  m_quadVAO.bind();
+  glDrawArrays(GL_TRIANGLES, 0, 6);
+  m_transparencyCompositeShader->release();
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  m_resolvedFramebuffer->release();
+}
 
-  setModelView();
-  QOpenGLFramebufferObject fbo(w, h,
+/*!
+ Renders the view at scaleFactor times the window size, one tile at a time
+ into a framebuffer of at most EXPORT_TILE_SIZE square. Each tile narrows
+ the projection to its part of the image (an off-centre sub-frustum), so
+ the tiles join seamlessly. onBand receives each full-width band of rows
+ top to bottom as soon as its tiles are done, and can stop the export by
+ returning false. The GL context must be current.
+ */
+bool GLWindow::renderTiles(int scaleFactor, const QColor &background,
+                           const ImageBandCallback &onBand) {
+  const int w = width() * scaleFactor;
+  const int h = height() * scaleFactor;
+  if (w <= 0 || h <= 0)
+    return false;
+
+  GLint maxRenderbufferSize = 0;
+  glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbufferSize);
+  const int maxTileSize =
+      std::max(1, std::min<int>(EXPORT_TILE_SIZE, maxRenderbufferSize));
+  const int tileWidth = std::min(w, maxTileSize);
+  const int tileHeight = std::min(h, maxTileSize);
+
+  QOpenGLFramebufferObject fbo(tileWidth, tileHeight,
                                QOpenGLFramebufferObject::CombinedDepthStencil);
+  if (!fbo.isValid()) {
+    qWarning() << "Could not create" << tileWidth << "x" << tileHeight
+               << "framebuffer for image export";
+    return false;
+  }
+  glViewport(0, 0, tileWidth, tileHeight);
+  setModelView();
 
-  fbo.bind();
-  if (enableDepthTest) {
-    glEnable(GL_DEPTH_TEST);
+  const QMatrix4x4 projection = m_projection;
+  const bool tiled = tileWidth < w || tileHeight < h;
+  if (scene && tiled) {
+    scene->setTiledImageSize(QSize(w, h));
+  }
+  if (tiled) {
+    qDebug() << "Exporting" << w << "x" << h << "image in"
+             << ((w + tileWidth - 1) / tileWidth) *
+                    ((h + tileHeight - 1) / tileHeight)
+             << "tiles";
+  }
+
+  bool ok = true;
+  for (int y0 = 0; ok && y0 < h; y0 += tileHeight) {
+    const int bandHeight = std::min(tileHeight, h - y0);
+    QImage band(w, bandHeight, QImage::Format_RGBA8888);
+    for (int x0 = 0; x0 < w; x0 += tileWidth) {
+      // normalised device coordinates of the tile within the whole image,
+      // tiles on the right and bottom edges hang over and are cropped
+      const float left = -1.0f + 2.0f * x0 / w;
+      const float right = -1.0f + 2.0f * (x0 + tileWidth) / w;
+      const float top = 1.0f - 2.0f * y0 / h;
+      const float bottom = 1.0f - 2.0f * (y0 + tileHeight) / h;
+      QMatrix4x4 tile;
+      tile.translate(-(left + right) / (right - left),
+                     -(top + bottom) / (top - bottom), 0.0f);
+      tile.scale(2.0f / (right - left), 2.0f / (top - bottom), 1.0f);
+      m_projection = tile * projection;
+
+      fbo.bind();
+      if (enableDepthTest) {
+        glEnable(GL_DEPTH_TEST);
+      }
+      glClearColor(background.redF(), background.greenF(), background.blueF(),
+                   background.alphaF());
+      glClearDepth(0);
+      glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      glClearDepth(0);
+      drawScene(false);
+      fbo.release();
+
+      const QImage image =
+          fbo.toImage().convertToFormat(QImage::Format_RGBA8888);
+      const int copyBytes = 4 * std::min(tileWidth, w - x0);
+      for (int row = 0; row < bandHeight; row++) {
+        std::memcpy(band.scanLine(row) + 4 * x0, image.constScanLine(row),
+                    copyBytes);
+      }
+    }
+    ok = onBand(band, y0);
   }
-  glClearColor(background.redF(), background.greenF(), background.blueF(),
-               background.alphaF());
-  glClearDepth(0);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glClearDepth(0);
-  drawScene(false);
-  fbo.release();
 
-  QImage result(fbo.toImage());
-  const QColor &color = scene->backgroundColor();
+  m_projection = projection;
+  if (scene) {
+    scene->setTiledImageSize(QSize());
+  }
+  const QColor &color = scene ? scene->backgroundColor() : background;
   glClearColor(color.redF(), color.greenF(), color.blueF(), color.alphaF());
   glClearDepth(0);
+  return ok;
+}
 
+QImage GLWindow::exportToImage(int scaleFactor, const QColor &background) {
+  makeCurrent();
+  QImage result(width() * scaleFactor, height() * scaleFactor,
+                QImage::Format_RGBA8888);
+  const bool ok = renderTiles(
+      scaleFactor, background, [&result](const QImage &band, int firstRow) {
+        for (int row = 0; row < band.height(); row++) {
+          std::memcpy(result.scanLine(firstRow + row), band.constScanLine(row),
+                      band.bytesPerLine());
+        }
+        return true;
+      });
   doneCurrent();
-  return result;
+  return ok ? result : QImage();
+}
+
+bool GLWindow::exportToImageFile(const QString &filename, int scaleFactor,
+                                 const QColor &background) {
+  using cx::io::StreamingImageWriter;
+  const auto format = StreamingImageWriter::formatForFilename(filename);
+  if (!format) {
+    qWarning() << "No image format for" << filename;
+    return false;
+  }
+  StreamingImageWriter writer(filename, width() * scaleFactor,
+                              height() * scaleFactor, *format);
+  if (!writer.open())
+    return false;
+
+  makeCurrent();
+  const bool rendered =
+      renderTiles(scaleFactor, background,
+                  [&writer](const QImage &band, int) {
+                    return writer.writeRows(band);
+                  });
+  doneCurrent();
+  return rendered && writer.finish();
+}
+
+bool GLWindow::exportRayTracedImageFile(const QString &filename,
+                                        int scaleFactor,
+                                        const QColor &background) {
+  using cx::io::StreamingImageWriter;
+  if (!scene)
+    return false;
+  const auto format = StreamingImageWriter::formatForFilename(filename);
+  if (!format) {
+    qWarning() << "No image format for" << filename;
+    return false;
+  }
+
+  setModelView();
+  cx::graphics::RayTracerCamera camera{m_view * m_model, m_projection};
+  cx::graphics::RayTracerOptions options;
+  options.width = width() * scaleFactor;
+  options.height = height() * scaleFactor;
+  options.background = background;
+
+  QElapsedTimer timer;
+  timer.start();
+  const cx::graphics::RayTracer tracer(scene->getExportData());
+  qDebug() << "Built ray tracer for" << tracer.numberOfPrimitives()
+           << "primitives in" << timer.restart() << "ms";
+
+  StreamingImageWriter writer(filename, options.width, options.height,
+                              *format);
+  if (!writer.open())
+    return false;
+  const bool rendered = tracer.render(
+      camera, options,
+      [&writer](const QImage &band, int) { return writer.writeRows(band); });
+  qDebug() << "Ray traced" << options.width << "x" << options.height
+           << "image in" << timer.elapsed() << "ms";
+  return rendered && writer.finish();
 }
 
 QImage GLWindow::renderToImage(int scaleFactor, bool for_picking) {
@@ -555,12 +819,13 @@ void GLWindow::applyAnimationRotation() {
   }
 }
 
-void GLWindow::drawScene(bool forPicking) {
+void GLWindow::drawScene(bool forPicking, bool deferTransparency) {
   // should only be called in paintGL
   //    QPainter painter(this);
 
   if (scene) {
     scene->setModelViewProjection(m_model, m_view, m_projection);
+    scene->setDeferTransparentMeshes(deferTransparency);
     if (forPicking) {
       scene->drawForPicking();
     } else {
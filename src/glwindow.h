@@ -2,6 +2,7 @@
 #include <QMatrix4x4>
 #include <QOpenGLWidget>
 #include <QVector3D>
+#include <functional>
 
 #include "atom_label_options.h"
 #include "elementeditor.h"
@@ -41,6 +42,8 @@ enum class SelectionMode {
 };
 
 const int ANIMATION_REDRAW_WAIT_TIME = 16; // Aim for 60 fps
+// Largest framebuffer used for exported images, larger images are tiled
+const int EXPORT_TILE_SIZE = 1024;
 
 class GLWindow : public QOpenGLWidget, protected QOpenGLExtraFunctions {
   Q_OBJECT
@@ -54,6 +57,14 @@ public:
   QImage renderToImage(int scaleFactor, bool for_picking = false);
   QImage exportToImage(int scaleFactor = 1,
                        const QColor &background = Qt::white);
+  // Encodes each band of tiles as it is rendered, so neither the GPU nor
+  // host memory needs to hold the whole image. PNG or TIFF by extension.
+  bool exportToImageFile(const QString &filename, int scaleFactor = 1,
+                         const QColor &background = Qt::white);
+  // Same framing as exportToImageFile, traced on the CPU from the scene's
+  // export data rather than rendered with OpenGL
+  bool exportRayTracedImageFile(const QString &filename, int scaleFactor = 1,
+                                const QColor &background = Qt::white);
   bool renderToPovRay(QTextStream &);
 
 public slots:
@@ -182,7 +193,12 @@ private:
   void initPointers();
   void setProjection(GLfloat, GLfloat);
   void setModelView();
-  void drawScene(bool forPicking = false);
+  void drawScene(bool forPicking = false, bool deferTransparency = false);
+  void drawTransparency();
+  using ImageBandCallback =
+      std::function<bool(const QImage &band, int firstRow)>;
+  bool renderTiles(int scaleFactor, const QColor &background,
+                   const ImageBandCallback &onBand);
   void handleLeftMousePressForPicking(QMouseEvent *);
   void handleRightMousePress(QPoint);
   void handleObjectInformationDisplay(QPoint);
@@ -273,6 +289,9 @@ private:
   QOpenGLFramebufferObject *m_framebuffer{nullptr};
   QOpenGLFramebufferObject *m_resolvedFramebuffer{nullptr};
   QOpenGLShaderProgram *m_postprocessShader{nullptr};
+  // weighted blended order independent transparency, see drawTransparency
+  QOpenGLFramebufferObject *m_transparencyFramebuffer{nullptr};
+  QOpenGLShaderProgram *m_transparencyCompositeShader{nullptr};
   QOpenGLVertexArrayObject m_quadVAO;
   QOpenGLBuffer m_quadVBO;
 
@@ -200,6 +200,9 @@ void ChemicalStructureRenderer::forceUpdates() {
   m_atomsNeedsUpdate = true;
   m_bondsNeedsUpdate = true;
   m_meshesNeedsUpdate = true;
+  for (auto &[mesh, cached] : m_meshRendererCache) {
+    cached.needsUpload = true;
+  }
   m_frameworkRenderer->forceUpdates();
 }
 
@@ -219,6 +222,15 @@ void ChemicalStructureRenderer::updateBonds() {
 }
 
 void ChemicalStructureRenderer::updateMeshes() {
+  // external callers may have changed colours or vertex masks in place, so
+  // everything is re-uploaded
+  for (auto &[mesh, cached] : m_meshRendererCache) {
+    cached.needsUpload = true;
+  }
+  updateMeshInstances();
+}
+
+void ChemicalStructureRenderer::updateMeshInstances() {
   m_meshesNeedsUpdate = true;
   emit meshesChanged();
 }
@@ -693,6 +705,25 @@ void ChemicalStructureRenderer::draw(bool forPicking) {
     m_uniforms.u_selectionMode = true;
   }
 
+  // Skip whatever lies outside the view, the renderers only regather their
+  // visible items when the set of visible chunks changes
+  const cx::graphics::Frustum frustum(m_uniforms.u_modelViewProjectionMat,
+                                      m_uniforms.u_viewport_size);
+  {
+    PERF_SCOPED_TIMER("Frustum Culling");
+    // impostor radii are scaled in the shaders, in view space
+    const float modelViewScale =
+        m_uniforms.u_modelViewMat.row(0).toVector3D().length();
+    const float impostorScale =
+        modelViewScale > 0.0f
+            ? m_uniforms.u_scale * m_uniforms.u_scale / modelViewScale
+            : 1.0f;
+    m_ellipsoidRenderer->cull(frustum);
+    m_sphereImpostorRenderer->cull(frustum, impostorScale);
+    m_cylinderRenderer->cull(frustum);
+    m_cylinderImpostorRenderer->cull(frustum, impostorScale);
+  }
+
   m_ellipsoidRenderer->bind();
   m_uniforms.apply(m_ellipsoidRenderer);
   m_ellipsoidRenderer->draw();
@@ -729,22 +760,34 @@ void ChemicalStructureRenderer::draw(bool forPicking) {
 
   // Sort mesh renderers into opaque and transparent groups
   std::vector<MeshInstanceRenderer *> opaqueMeshes;
-  std::vector<MeshInstanceRenderer *> transparentMeshes;
+  m_transparentMeshes.clear();
 
   for (auto *renderer : m_meshRenderers) {
+    renderer->cull(frustum);
     if (renderer->hasTransparentObjects()) {
-      transparentMeshes.push_back(renderer);
+      m_transparentMeshes.push_back(renderer);
     } else {
       opaqueMeshes.push_back(renderer);
     }
   }
 
+  using TransparencyPass = MeshInstanceRenderer::TransparencyPass;
+  auto drawMeshes = [&](const std::vector<MeshInstanceRenderer *> &renderers,
+                        TransparencyPass pass) {
+    for (auto *meshRenderer : renderers) {
+      meshRenderer->bind();
+      m_uniforms.apply(meshRenderer);
+      meshRenderer->setTransparencyPass(pass);
+      meshRenderer->draw();
+      meshRenderer->release();
+    }
+  };
+  const bool deferTransparency = m_deferTransparentMeshes && !forPicking;
+
   // Draw opaque meshes first
-  for (auto *meshRenderer : opaqueMeshes) {
-    meshRenderer->bind();
-    m_uniforms.apply(meshRenderer);
-    meshRenderer->draw();
-    meshRenderer->release();
+  drawMeshes(opaqueMeshes, TransparencyPass::All);
+  if (deferTransparency) {
+    drawMeshes(m_transparentMeshes, TransparencyPass::OpaqueOnly);
   }
 
   m_frameworkRenderer->draw();
@@ -757,12 +800,10 @@ void ChemicalStructureRenderer::draw(bool forPicking) {
     m_planeRenderer->release();
   }
 
-  // Draw transparent meshes last
-  for (auto *meshRenderer : transparentMeshes) {
-    meshRenderer->bind();
-    m_uniforms.apply(meshRenderer);
-    meshRenderer->draw();
-    meshRenderer->release();
+  // Draw transparent meshes last, unless they are deferred to
+  // drawTransparentMeshes
+  if (!deferTransparency) {
+    drawMeshes(m_transparentMeshes, TransparencyPass::All);
   }
 
   if (!forPicking) {
@@ -788,17 +829,57 @@ void ChemicalStructureRenderer::draw(bool forPicking) {
   }
 }
 
+void ChemicalStructureRenderer::drawTransparentMeshes() {
+  PERF_SCOPED_TIMER("ChemicalStructureRenderer::drawTransparentMeshes");
+  for (auto *meshRenderer : m_transparentMeshes) {
+    meshRenderer->bind();
+    m_uniforms.apply(meshRenderer);
+    meshRenderer->setTransparencyPass(
+        MeshInstanceRenderer::TransparencyPass::WeightedBlended);
+    meshRenderer->draw();
+    meshRenderer->setTransparencyPass(
+        MeshInstanceRenderer::TransparencyPass::All);
+    meshRenderer->release();
+  }
+}
+
 void ChemicalStructureRenderer::updateRendererUniforms(
     const RendererUniforms &uniforms) {
   m_uniforms = uniforms;
   m_frameworkRenderer->updateRendererUniforms(uniforms);
 }
 
+MeshUploadState MeshUploadState::fromMesh(const Mesh *mesh) {
+  MeshUploadState state;
+  state.numberOfVertices = mesh->numberOfVertices();
+  state.numberOfFaces = mesh->numberOfFaces();
+  state.properties = mesh->availableVertexProperties();
+  state.propertyRanges.reserve(state.properties.size());
+  for (const auto &prop : state.properties) {
+    auto range = mesh->vertexPropertyRange(prop);
+    state.propertyRanges.emplace_back(range.lower, range.upper);
+  }
+  return state;
+}
+
+inline void deleteCachedRenderer(CachedMeshRenderer &cached) {
+  delete cached.meshRenderer;
+  delete cached.pointCloudRenderer;
+  cached.meshRenderer = nullptr;
+  cached.pointCloudRenderer = nullptr;
+}
+
 void ChemicalStructureRenderer::clearMeshRenderers() {
-  for (auto *r : m_meshRenderers) {
-    delete r;
+  for (auto &[mesh, cached] : m_meshRendererCache) {
+    deleteCachedRenderer(cached);
+  }
+  m_meshRendererCache.clear();
+  for (auto &cached : m_staleMeshRenderers) {
+    deleteCachedRenderer(cached);
   }
+  m_staleMeshRenderers.clear();
   m_meshRenderers.clear();
+  m_pointCloudRenderers.clear();
 }
 
 template <class Renderer>
@@ -845,8 +926,13 @@ void ChemicalStructureRenderer::addFaceHighlightsForMeshInstance(
 void ChemicalStructureRenderer::handleMeshesUpdate() {
   if (!m_meshesNeedsUpdate)
     return;
+  PERF_SCOPED_TIMER("Mesh renderer update");
+
+  for (auto &cached : m_staleMeshRenderers) {
+    deleteCachedRenderer(cached);
+  }
+  m_staleMeshRenderers.clear();
 
-  // TODO re-use mesh renderers
   m_meshRenderers.clear();
   m_pointCloudRenderers.clear();
 
@@ -856,15 +942,34 @@ void ChemicalStructureRenderer::handleMeshesUpdate() {
   if (m_selectionHandler) {
     m_selectionHandler->clear(SelectionType::Surface);
   }
+
+  // Renderers are kept per mesh; only the instance lists are rebuilt here
+  // unless the mesh's vertices or property colours changed.
+  ankerl::unordered_dense::set<Mesh *> current;
   for (auto *child : m_structure->children()) {
     auto *mesh = qobject_cast<Mesh *>(child);
     if (!mesh)
       continue;
+    current.insert(mesh);
 
-    if (mesh->numberOfFaces() == 0) {
-      PointCloudInstanceRenderer *instanceRenderer =
-          new PointCloudInstanceRenderer(mesh);
+    auto &cached = m_meshRendererCache[mesh];
+    auto state = MeshUploadState::fromMesh(mesh);
+    const bool pointCloud = mesh->numberOfFaces() == 0;
+    const bool upload = cached.needsUpload || !(state == cached.uploaded);
+
+    if (pointCloud) {
+      if (cached.meshRenderer) {
+        delete cached.meshRenderer;
+        cached.meshRenderer = nullptr;
+      }
+      if (!cached.pointCloudRenderer) {
+        cached.pointCloudRenderer = new PointCloudInstanceRenderer(mesh);
+      } else if (upload) {
+        cached.pointCloudRenderer->setMesh(mesh);
+      }
+      auto *instanceRenderer = cached.pointCloudRenderer;
       instanceRenderer->beginUpdates();
+      instanceRenderer->instances().clear();
       for (auto *meshChild : child->children()) {
         auto *meshInstance = qobject_cast<MeshInstance *>(meshChild);
         addInstanceToInstanceRenderer<PointCloudInstanceRenderer>(
@@ -876,8 +981,18 @@ void ChemicalStructureRenderer::handleMeshesUpdate() {
       m_pointCloudRenderers.push_back(instanceRenderer);
 
     } else {
-      MeshInstanceRenderer *instanceRenderer = new MeshInstanceRenderer(mesh);
+      if (cached.pointCloudRenderer) {
+        delete cached.pointCloudRenderer;
+        cached.pointCloudRenderer = nullptr;
+      }
+      if (!cached.meshRenderer) {
+        cached.meshRenderer = new MeshInstanceRenderer(mesh);
+      } else if (upload) {
+        cached.meshRenderer->setMesh(mesh);
+      }
+      auto *instanceRenderer = cached.meshRenderer;
       instanceRenderer->beginUpdates();
+      instanceRenderer->instances().clear();
       for (auto *meshChild : child->children()) {
         auto *meshInstance = qobject_cast<MeshInstance *>(meshChild);
         addInstanceToInstanceRenderer<MeshInstanceRenderer>(
@@ -889,21 +1004,33 @@ void ChemicalStructureRenderer::handleMeshesUpdate() {
       instanceRenderer->endUpdates();
       m_meshRenderers.push_back(instanceRenderer);
     }
+    cached.uploaded = std::move(state);
+    cached.needsUpload = false;
+  }
+
+  // drop renderers for meshes that are no longer children of the structure
+  for (auto it = m_meshRendererCache.begin();
+       it != m_meshRendererCache.end();) {
+    if (current.contains(it->first)) {
+      ++it;
+    } else {
+      deleteCachedRenderer(it->second);
+      it = m_meshRendererCache.erase(it);
+    }
   }
   m_meshesNeedsUpdate = false;
 }
 
 void ChemicalStructureRenderer::childVisibilityChanged() {
-  // TODO more granularity
-  qDebug() << "ChemicalStructureRenderer::childVisibilityChanged() called";
-  updateMeshes();
+  // visibility only affects the instance lists, cached buffers stay valid
+  updateMeshInstances();
   m_planesNeedUpdate = true;
 }
 
 void ChemicalStructureRenderer::childPropertyChanged() {
-  // TODO more granularity
-  qDebug() << "ChemicalStructureRenderer::childPropertyChanged() called";
-  updateMeshes();
+  // transparency and selected property are per instance; new properties or
+  // colour ranges are picked up by comparing MeshUploadState
+  updateMeshInstances();
   m_planesNeedUpdate = true;
 }
 
@@ -951,7 +1078,8 @@ void ChemicalStructureRenderer::childAddedToStructure(QObject *child) {
   }
 
   if (mesh || meshInstance) {
-    updateMeshes();
+    // new meshes get their own renderer, existing buffers are unaffected
+    updateMeshInstances();
   }
   if (plane || planeInstance) {
     m_planesNeedUpdate = true;
@@ -966,6 +1094,12 @@ void ChemicalStructureRenderer::childRemovedFromStructure(QObject *child) {
     qDebug() << "Child removed (mesh) from structure, disconnected";
     disconnect(mesh, &Mesh::visibilityChanged, this,
                &ChemicalStructureRenderer::childVisibilityChanged);
+    // the address may be reused by a new mesh before the next draw
+    auto loc = m_meshRendererCache.find(mesh);
+    if (loc != m_meshRendererCache.end()) {
+      m_staleMeshRenderers.push_back(loc->second);
+      m_meshRendererCache.erase(loc);
+    }
     m_meshesNeedsUpdate = true;
   } else if (plane) {
     qDebug() << "Child removed (plane) from structure, disconnected";
@@ -1069,6 +1203,16 @@ void ChemicalStructureRenderer::getCurrentAtomsForExport(
 
     sphere.radius = radius;
 
+    if (atomStyle() == AtomDrawingStyle::Ellipsoid &&
+        (atomicNumbers(i) != 1 || m_showHydrogenAtomEllipsoids)) {
+      auto adp = m_structure->atomicDisplacementParameters(
+          m_structure->indexToGenericIndex(i));
+      if (!adp.isZero()) {
+        sphere.ellipsoidAxes = adp.thermalEllipsoidMatrixForProbability(
+            m_thermalEllipsoidProbability);
+      }
+    }
+
     sphere.color = element->color();
     sphere.name = QString("Atom_%1").arg(i);
     sphere.group = QString("Atoms/%1").arg(element->symbol());
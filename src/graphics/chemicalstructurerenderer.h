@@ -23,6 +23,7 @@
 #include "renderselection.h"
 #include "scene_export_data.h"
 #include "sphereimpostorrenderer.h"
+#include <ankerl/unordered_dense.h>
 
 namespace cx::graphics {
 
@@ -36,6 +37,25 @@ struct AggregateIndex {
   QVector3D position;
 };
 
+// What was last uploaded to the GPU for a mesh, used to decide whether the
+// cached renderer's vertex/property buffers are still valid.
+struct MeshUploadState {
+  int numberOfVertices{0};
+  int numberOfFaces{0};
+  QStringList properties;
+  std::vector<std::pair<float, float>> propertyRanges;
+
+  static MeshUploadState fromMesh(const Mesh *);
+  bool operator==(const MeshUploadState &) const = default;
+};
+
+struct CachedMeshRenderer {
+  MeshInstanceRenderer *meshRenderer{nullptr};
+  PointCloudInstanceRenderer *pointCloudRenderer{nullptr};
+  MeshUploadState uploaded;
+  bool needsUpload{true};
+};
+
 class ChemicalStructureRenderer : public QObject {
   Q_OBJECT
 public:
@@ -101,6 +121,19 @@ public:
 
   void forceUpdates();
   void draw(bool forPicking = false);
+
+  // When set, draw() only emits the opaque fragments of transparent meshes;
+  // the rest are drawn by drawTransparentMeshes() into weighted blended
+  // accumulation targets bound by the caller.
+  inline void setDeferTransparentMeshes(bool defer) {
+    m_deferTransparentMeshes = defer;
+  }
+  // Whether the last draw() had any transparent meshes
+  [[nodiscard]] inline bool hasTransparentMeshes() const {
+    return !m_transparentMeshes.empty();
+  }
+  void drawTransparentMeshes();
+
   [[nodiscard]] inline double getThermalEllipsoidProbability() const {
     return m_thermalEllipsoidProbability;
   }
@@ -142,6 +175,7 @@ private:
   void addAggregateRepresentations();
 
   void clearMeshRenderers();
+  void updateMeshInstances();
   void addFaceHighlightsForMeshInstance(Mesh *, MeshInstance *);
   QList<TextLabel> getCurrentLabels();
 
@@ -154,6 +188,8 @@ private:
   bool m_cellsNeedsUpdate{true};
   bool m_planesNeedUpdate{true};
 
+  bool m_deferTransparentMeshes{false};
+
   bool m_showHydrogens{true};
   bool m_showSuppressedAtoms{false};
   bool m_showHydrogenAtomEllipsoids{true};
@@ -178,8 +214,13 @@ private:
   CylinderRenderer *m_cylinderRenderer{nullptr};
   SphereImpostorRenderer *m_sphereImpostorRenderer{nullptr};
   CylinderImpostorRenderer *m_cylinderImpostorRenderer{nullptr};
+  // draw order for this frame, owned by m_meshRendererCache
   std::vector<MeshInstanceRenderer *> m_meshRenderers;
+  std::vector<MeshInstanceRenderer *> m_transparentMeshes;
   std::vector<PointCloudInstanceRenderer *> m_pointCloudRenderers;
+  ankerl::unordered_dense::map<Mesh *, CachedMeshRenderer> m_meshRendererCache;
+  // renderers for removed meshes, deleted once a GL context is current
+  std::vector<CachedMeshRenderer> m_staleMeshRenderers;
   FrameworkRenderer *m_frameworkRenderer{nullptr};
   BillboardRenderer *m_labelRenderer{nullptr};
 
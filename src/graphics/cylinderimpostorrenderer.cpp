@@ -1,6 +1,8 @@
 #include "cylinderimpostorrenderer.h"
 #include "shaderloader.h"
 #include <QOpenGLShaderProgram>
+#include <algorithm>
+#include <cmath>
 
 CylinderImpostorRenderer::CylinderImpostorRenderer()
     : m_vertex(QOpenGLBuffer::VertexBuffer) {
@@ -171,6 +173,40 @@ void CylinderImpostorRenderer::clear() {
   }
 }
 
+void CylinderImpostorRenderer::cull(const cx::graphics::Frustum &frustum,
+                                    float radiusScale) {
+  if (m_updatesDisabled)
+    return;
+  const size_t numberOfBonds = m_vertices.size() / 6;
+  if (m_visibilityNeedsUpdate) {
+    std::vector<QVector3D> centers;
+    std::vector<float> radii;
+    centers.reserve(numberOfBonds);
+    radii.reserve(numberOfBonds);
+    for (size_t i = 0; i < numberOfBonds; i++) {
+      const auto &vertex = m_vertices[6 * i];
+      centers.push_back(0.5f * (vertex.pointA() + vertex.pointB()));
+      radii.push_back(0.5f * (vertex.pointB() - vertex.pointA()).length() +
+                      std::abs(vertex.radius()));
+    }
+    m_visibility.build(centers, radii);
+    m_visibilityNeedsUpdate = false;
+  }
+  // the scale applies to the bond length too, so never shrink the bounds
+  if (!m_visibility.update(frustum, std::max(radiusScale, 1.0f)))
+    return;
+
+  m_visibleIndices.clear();
+  for (uint32_t i : m_visibility.visibleItems()) {
+    m_visibleIndices.insert(m_visibleIndices.end(), m_indices.begin() + 12 * i,
+                            m_indices.begin() + 12 * i + 12);
+  }
+  m_index.bind();
+  m_index.allocate(m_visibleIndices.data(),
+                   static_cast<int>(sizeof(GLuint) * m_visibleIndices.size()));
+  m_numberOfIndices = static_cast<GLsizei>(m_visibleIndices.size());
+}
+
 void CylinderImpostorRenderer::beginUpdates() { m_updatesDisabled = true; }
 
 void CylinderImpostorRenderer::endUpdates() {
@@ -181,6 +217,8 @@ void CylinderImpostorRenderer::endUpdates() {
 void CylinderImpostorRenderer::updateBuffers() {
   if (m_updatesDisabled)
     return;
+  m_visibilityNeedsUpdate = true;
+  m_numberOfIndices = static_cast<GLsizei>(m_indices.size());
   m_vertex.bind();
   m_index.bind();
 
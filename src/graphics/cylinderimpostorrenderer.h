@@ -1,5 +1,6 @@
 #pragma once
 #include "cylinderimpostorvertex.h"
+#include "frustumculling.h"
 #include "renderer.h"
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
@@ -18,6 +19,10 @@ public:
   virtual ~CylinderImpostorRenderer();
   void setRadii(float newRadius);
 
+  // Only draw bonds inside the frustum, radiusScale converts the vertex
+  // radii to model space as sized by the shader
+  void cull(const cx::graphics::Frustum &frustum, float radiusScale);
+
   virtual void beginUpdates() override;
   virtual void endUpdates() override;
   virtual void clear() override;
@@ -29,6 +34,10 @@ private:
   vector<GLuint> m_indices;
   vector<GroupIndex<CylinderImpostorVertex>> m_groups;
 
+  cx::graphics::ChunkedVisibility m_visibility;
+  bool m_visibilityNeedsUpdate{true};
+  vector<GLuint> m_visibleIndices;
+
 protected:
   bool m_impostor = true;
 };
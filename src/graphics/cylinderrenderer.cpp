@@ -3,6 +3,7 @@
 #include <QFile>
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLShaderProgram>
+#include <cmath>
 
 CylinderRenderer::CylinderRenderer() {
   QOpenGLExtraFunctions f(QOpenGLContext::currentContext());
@@ -221,10 +222,40 @@ void CylinderRenderer::clear() {
   }
 }
 
+void CylinderRenderer::cull(const cx::graphics::Frustum &frustum) {
+  if (m_updatesDisabled)
+    return;
+  if (m_visibilityNeedsUpdate) {
+    std::vector<QVector3D> centers;
+    std::vector<float> radii;
+    centers.reserve(m_instances.size());
+    radii.reserve(m_instances.size());
+    for (const auto &instance : m_instances) {
+      centers.push_back(0.5f * (instance.a() + instance.b()));
+      radii.push_back(0.5f * (instance.b() - instance.a()).length() +
+                      std::abs(instance.radius()));
+    }
+    m_visibility.build(centers, radii);
+    m_visibilityNeedsUpdate = false;
+  }
+  if (!m_visibility.update(frustum))
+    return;
+
+  m_visibleInstances.clear();
+  for (uint32_t i : m_visibility.visibleItems()) {
+    m_visibleInstances.push_back(m_instances[i]);
+  }
+  m_instance.bind();
+  m_instance.allocate(m_visibleInstances.data(),
+                      static_cast<int>(sizeof(CylinderInstance) *
+                                       m_visibleInstances.size()));
+  m_numberOfInstancesDrawn = m_visibleInstances.size();
+}
+
 void CylinderRenderer::draw() {
   QOpenGLExtraFunctions f(QOpenGLContext::currentContext());
   f.glDrawElementsInstanced(DrawType, m_faces.size() * 3, GL_UNSIGNED_INT, 0,
-                            m_instances.size());
+                            m_numberOfInstancesDrawn);
 }
 
 void CylinderRenderer::beginUpdates() { Renderer::beginUpdates(); }
@@ -237,6 +268,8 @@ void CylinderRenderer::endUpdates() {
 void CylinderRenderer::updateBuffers() {
   if (m_updatesDisabled)
     return;
+  m_visibilityNeedsUpdate = true;
+  m_numberOfInstancesDrawn = m_instances.size();
   m_instance.bind();
   m_instance.allocate(
       m_instances.data(),
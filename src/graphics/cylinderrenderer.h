@@ -1,5 +1,6 @@
 #pragma once
 
+#include "frustumculling.h"
 #include "renderer.h"
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
@@ -97,6 +98,9 @@ public:
   void addInstance(const CylinderInstance &);
   void addInstances(const vector<CylinderInstance> &instances);
 
+  // Only draw instances inside the frustum, until the instances change
+  void cull(const cx::graphics::Frustum &frustum);
+
   virtual void beginUpdates() override;
   virtual void endUpdates() override;
   virtual void draw() override;
@@ -113,4 +117,9 @@ private:
   vector<QVector3D> m_vertices;
   vector<Face> m_faces;
   vector<CylinderInstance> m_instances;
+
+  cx::graphics::ChunkedVisibility m_visibility;
+  bool m_visibilityNeedsUpdate{true};
+  vector<CylinderInstance> m_visibleInstances;
+  size_t m_numberOfInstancesDrawn{0};
 };
@@ -1,8 +1,8 @@
 #include "ellipsoidrenderer.h"
 #include "shaderloader.h"
-#include <QFile>
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLShaderProgram>
+#include <cmath>
 
 EllipsoidRenderer::EllipsoidRenderer() {
   QOpenGLExtraFunctions f(QOpenGLContext::currentContext());
@@ -162,33 +162,102 @@ EllipsoidRenderer::EllipsoidRenderer(
 }
 
 void EllipsoidRenderer::loadBaseMesh() {
-  QFile obj(":/mesh/icosphere.obj");
-  obj.open(QIODevice::ReadOnly);
-  if (!obj.isOpen())
-    return;
-
-  QTextStream stream(&obj);
-  QStringList tokens;
-  QString line;
-  while (stream.readLineInto(&line)) {
-    if (line.startsWith('v')) {
-      tokens = line.split(' ');
-      QVector3D pos(tokens[1].toFloat(), tokens[2].toFloat(),
-                    tokens[3].toFloat());
-      m_vertices.push_back(pos);
-    } else if (line.startsWith('f')) {
-      tokens = line.split(' ');
-      m_faces.push_back({tokens[1].toUInt() - 1, tokens[2].toUInt() - 1,
-                         tokens[3].toUInt() - 1});
-    }
+  // coarser icosphere levels use a prefix of the finer level's vertices, so
+  // one vertex buffer serves all levels of detail
+  m_sphere = cx::primitives::icosphere(DetailLevels - 1);
+  std::vector<uint32_t> indices;
+  for (int level = 0; level < DetailLevels; level++) {
+    const auto &levelIndices = cx::primitives::icosphere(level)->indexData;
+    m_detailIndexOffset[level] = static_cast<int>(indices.size());
+    m_detailIndexCount[level] = static_cast<int>(levelIndices.size());
+    indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
   }
+
   m_vertex.bind();
   m_index.bind();
 
-  m_vertex.allocate(m_vertices.data(),
-                    static_cast<int>(sizeof(QVector3D) * m_vertices.size()));
-  m_index.allocate(m_faces.data(),
-                   static_cast<int>(sizeof(Face) * m_faces.size()));
+  m_vertex.allocate(
+      m_sphere->vertexData.data(),
+      static_cast<int>(sizeof(float) * m_sphere->vertexData.size()));
+  m_index.allocate(indices.data(),
+                   static_cast<int>(sizeof(uint32_t) * indices.size()));
+}
+
+void EllipsoidRenderer::setInstanceAttributes(int firstInstance) {
+  const int offset = firstInstance * EllipsoidInstance::stride();
+  m_instance.bind();
+  m_program->setAttributeBuffer(
+      1, GL_FLOAT, offset + EllipsoidInstance::positionOffset(),
+      EllipsoidInstance::PositionTupleSize, EllipsoidInstance::stride());
+  m_program->setAttributeBuffer(2, GL_FLOAT,
+                                offset + EllipsoidInstance::aOffset(),
+                                EllipsoidInstance::ATupleSize,
+                                EllipsoidInstance::stride());
+  m_program->setAttributeBuffer(3, GL_FLOAT,
+                                offset + EllipsoidInstance::bOffset(),
+                                EllipsoidInstance::BTupleSize,
+                                EllipsoidInstance::stride());
+  m_program->setAttributeBuffer(4, GL_FLOAT,
+                                offset + EllipsoidInstance::cOffset(),
+                                EllipsoidInstance::CTupleSize,
+                                EllipsoidInstance::stride());
+  m_program->setAttributeBuffer(5, GL_FLOAT,
+                                offset + EllipsoidInstance::colorOffset(),
+                                EllipsoidInstance::ColorTupleSize,
+                                EllipsoidInstance::stride());
+  m_program->setAttributeBuffer(
+      6, GL_FLOAT, offset + EllipsoidInstance::selectionIdOffset(),
+      EllipsoidInstance::SelectionIdSize, EllipsoidInstance::stride());
+}
+
+namespace {
+// Icosphere subdivisions for an ellipsoid of the given radius in pixels
+int ellipsoidDetailLevel(float pixels) {
+  if (pixels < 3.0f)
+    return 0;
+  if (pixels < 10.0f)
+    return 1;
+  if (pixels < 30.0f)
+    return 2;
+  return 3;
+}
+} // namespace
+
+void EllipsoidRenderer::cull(const cx::graphics::Frustum &frustum) {
+  if (m_updatesDisabled)
+    return;
+  if (m_visibilityNeedsUpdate) {
+    std::vector<QVector3D> centers;
+    std::vector<float> radii;
+    centers.reserve(m_instances.size());
+    radii.reserve(m_instances.size());
+    for (const auto &instance : m_instances) {
+      centers.push_back(instance.position());
+      // bounds the largest semi-axis however a, b and c are oriented
+      radii.push_back(std::sqrt(instance.a().lengthSquared() +
+                                instance.b().lengthSquared() +
+                                instance.c().lengthSquared()));
+    }
+    m_visibility.build(centers, radii);
+    m_visibilityNeedsUpdate = false;
+  }
+
+  if (!m_visibility.update(frustum, 1.0f, DetailLevels, ellipsoidDetailLevel))
+    return;
+
+  m_visibleInstances.clear();
+  for (int level = 0; level < DetailLevels; level++) {
+    const auto &items = m_visibility.visibleItems(level);
+    for (uint32_t i : items) {
+      m_visibleInstances.push_back(m_instances[i]);
+    }
+    m_visibleCount[level] = static_cast<int>(items.size());
+  }
+  m_instance.bind();
+  m_instance.allocate(m_visibleInstances.data(),
+                      static_cast<int>(sizeof(EllipsoidInstance) *
+                                       m_visibleInstances.size()));
+  m_culled = true;
 }
 
 void EllipsoidRenderer::addInstances(
@@ -213,8 +282,31 @@ void EllipsoidRenderer::clear() {
 
 void EllipsoidRenderer::draw() {
   QOpenGLExtraFunctions f(QOpenGLContext::currentContext());
-  f.glDrawElementsInstanced(DrawType, m_faces.size() * 3, GL_UNSIGNED_INT, 0,
-                            m_instances.size());
+  auto indexOffset = [&](int level) {
+    return reinterpret_cast<const void *>(sizeof(GLuint) *
+                                          m_detailIndexOffset[level]);
+  };
+  if (!m_culled) {
+    f.glDrawElementsInstanced(DrawType, m_detailIndexCount[DetailLevels - 1],
+                              GL_UNSIGNED_INT, indexOffset(DetailLevels - 1),
+                              m_instances.size());
+    return;
+  }
+
+  // visible instances are grouped by level of detail; there is no base
+  // instance in GL 3.3, so offset the instance attributes for each group
+  int first = 0;
+  for (int level = 0; level < DetailLevels; level++) {
+    if (m_visibleCount[level] == 0)
+      continue;
+    setInstanceAttributes(first);
+    f.glDrawElementsInstanced(DrawType, m_detailIndexCount[level],
+                              GL_UNSIGNED_INT, indexOffset(level),
+                              m_visibleCount[level]);
+    first += m_visibleCount[level];
+  }
+  if (first > 0)
+    setInstanceAttributes(0);
 }
 
 void EllipsoidRenderer::beginUpdates() { Renderer::beginUpdates(); }
@@ -227,6 +319,8 @@ void EllipsoidRenderer::endUpdates() {
 void EllipsoidRenderer::updateBuffers() {
   if (m_updatesDisabled)
     return;
+  m_visibilityNeedsUpdate = true;
+  m_culled = false;
   m_instance.bind();
   m_instance.allocate(
       m_instances.data(),
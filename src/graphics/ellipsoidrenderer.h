@@ -1,11 +1,15 @@
 #pragma once
 
+#include "frustumculling.h"
+#include "geometry_primitives.h"
 #include "renderer.h"
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLTexture>
 #include <QOpenGLVertexArrayObject>
+#include <array>
+#include <memory>
 #include <vector>
 
 class EllipsoidInstance {
@@ -86,20 +90,32 @@ public:
 
   inline size_t size() const { return m_instances.size(); }
 
+  // Only draw instances inside the frustum, using coarser icospheres for
+  // those that are small on screen. Applies until the instances change.
+  void cull(const cx::graphics::Frustum &frustum);
+
   virtual void beginUpdates() override;
   virtual void endUpdates() override;
   virtual void draw() override;
   virtual void clear() override;
 
 private:
+  // icosphere subdivisions 0-3, sharing the vertices of the finest level
+  static constexpr int DetailLevels = 4;
+
   void loadBaseMesh();
-  struct Face {
-    GLuint i, j, k;
-  };
   void updateBuffers();
+  void setInstanceAttributes(int firstInstance);
   QOpenGLBuffer m_vertex;
   QOpenGLBuffer m_instance;
-  vector<QVector3D> m_vertices;
-  vector<Face> m_faces;
+  std::shared_ptr<const cx::primitives::Icosphere> m_sphere;
+  std::array<int, DetailLevels> m_detailIndexOffset{};
+  std::array<int, DetailLevels> m_detailIndexCount{};
   vector<EllipsoidInstance> m_instances;
+
+  cx::graphics::ChunkedVisibility m_visibility;
+  bool m_visibilityNeedsUpdate{true};
+  bool m_culled{false};
+  vector<EllipsoidInstance> m_visibleInstances;
+  std::array<int, DetailLevels> m_visibleCount{};
 };
@@ -36,9 +36,21 @@ FrameworkRenderer::FrameworkRenderer(ChemicalStructure *structure,
 }
 
 void FrameworkRenderer::update(ChemicalStructure *structure) {
+  if (m_interactions)
+    disconnect(m_interactions, nullptr, this, nullptr);
   m_structure = structure;
-  if (m_structure)
-    m_interactions = structure->pairInteractions();
+  m_interactions = m_structure ? structure->pairInteractions() : nullptr;
+  if (m_interactions) {
+    auto interactionsChanged = [this]() {
+      m_interactionsVersion++;
+      m_needsUpdate = true;
+    };
+    connect(m_interactions, &PairInteractions::interactionAdded, this,
+            interactionsChanged);
+    connect(m_interactions, &PairInteractions::interactionRemoved, this,
+            interactionsChanged);
+  }
+  m_geometry = FrameworkGeometry{};
   m_needsUpdate = true;
 }
 
@@ -105,73 +117,91 @@ FrameworkRenderer::getPairPositions(const FragmentDimer &pair) const {
   return {QVector3D(pa.x(), pa.y(), pa.z()), QVector3D(pb.x(), pb.y(), pb.z())};
 }
 
-void FrameworkRenderer::handleInteractionsUpdate() {
-  if (!m_needsUpdate)
-    return;
-  if (!m_structure || !m_interactions)
-    return;
-
-  beginUpdates();
-  m_ellipsoidRenderer->clear();
-  m_lineRenderer->clear();
-  m_cylinderRenderer->clear();
-  m_sphereImpostorRenderer->clear();
-  m_cylinderImpostorRenderer->clear();
-  m_labelRenderer->clear();
-
-  if (m_options.display == FrameworkOptions::Display::None)
-    return;
-
-  // Check impostor setting once per update for performance
-  bool useImpostors =
-      settings::readSetting(settings::keys::USE_IMPOSTOR_RENDERING).toBool();
-
-  FragmentPairSettings pairSettings;
+const FrameworkRenderer::FrameworkGeometry *
+FrameworkRenderer::currentGeometry() const {
+  // Safety check: ensure structure has completed fragments before finding pairs
+  if (!m_structure || !m_interactions || m_structure->numberOfAtoms() == 0)
+    return nullptr;
 
-  pairSettings.allowInversion =
+  const bool allowInversion =
       m_options.allowInversion &
       m_interactions->hasPermutationSymmetry(m_options.model);
 
-  // Safety check: ensure structure has completed fragments before finding pairs
-  if (m_structure->numberOfAtoms() == 0) {
-    return;
+  auto &geometry = m_geometry;
+  const bool stale =
+      !geometry.valid ||
+      geometry.positionGeneration != m_structure->positionGeneration() ||
+      geometry.fragmentGeneration != m_structure->fragmentGeneration() ||
+      geometry.interactionsVersion != m_interactionsVersion ||
+      geometry.allowInversion != allowInversion;
+
+  if (stale) {
+    FragmentPairSettings pairSettings;
+    pairSettings.allowInversion = allowInversion;
+    geometry.fragmentPairs = m_structure->findFragmentPairs(pairSettings);
+    geometry.interactions = m_interactions->getInteractionsMatchingFragments(
+        geometry.fragmentPairs.uniquePairs);
+
+    geometry.edges.clear();
+    for (const auto &[fragIndex, molPairs] : geometry.fragmentPairs.pairs) {
+      for (const auto &[pair, uniqueIndex] : molPairs) {
+        geometry.edges.push_back(FrameworkEdge{&pair, uniqueIndex, {}, {}});
+      }
+    }
+    geometry.positionGeneration = m_structure->positionGeneration();
+    geometry.fragmentGeneration = m_structure->fragmentGeneration();
+    geometry.interactionsVersion = m_interactionsVersion;
+    geometry.allowInversion = allowInversion;
+    geometry.valid = true;
   }
 
-  auto fragmentPairs = m_structure->findFragmentPairs(pairSettings);
-
-  std::vector<FragmentDimer> uniquePairs = fragmentPairs.uniquePairs;
-
-  // Safety check: ensure we have valid fragment pairs
-  if (uniquePairs.empty()) {
-    return;
+  if (stale || geometry.connectionMode != m_options.connectionMode) {
+    geometry.connectionMode = m_options.connectionMode;
+    for (auto &edge : geometry.edges) {
+      std::tie(edge.va, edge.vb) = getPairPositions(*edge.pair);
+    }
   }
 
-  auto interactionMap =
-      m_interactions->getInteractionsMatchingFragments(uniquePairs);
-
-  auto uniqueInteractions = interactionMap.value(m_options.model, {});
-  if (uniqueInteractions.empty() ||
-      uniqueInteractions.size() < uniquePairs.size())
-    return;
+  // Safety check: ensure we have valid fragment pairs
+  if (geometry.fragmentPairs.uniquePairs.empty())
+    return nullptr;
+  return &geometry;
+}
 
+std::vector<FrameworkRenderer::EdgeAppearance>
+FrameworkRenderer::uniquePairAppearance(
+    const PairInteractions::PairInteractionList &uniqueInteractions) const {
   QColor color = m_options.customColor;
   if (m_options.coloring == FrameworkOptions::Coloring::Component) {
     color = m_interactionComponentColors.value(
         m_options.component.toLower(), m_defaultInteractionComponentColor);
   }
 
-  std::vector<std::tuple<QColor, double, QString>> energies;
-  energies.reserve(uniqueInteractions.size());
+  std::vector<EdgeAppearance> result;
+  result.reserve(uniqueInteractions.size());
 
   double emin = std::numeric_limits<double>::max();
   double emax = std::numeric_limits<double>::min();
 
+  // resolve the component name once for all interactions
+  const PairInteractions *owner = nullptr;
+  int componentId = -1;
+  for (const auto *interaction : uniqueInteractions) {
+    if (interaction && interaction->owner()) {
+      owner = interaction->owner();
+      componentId = owner->componentId(m_options.component);
+      break;
+    }
+  }
+
   for (const auto *interaction : uniqueInteractions) {
     QColor c = color;
     double energy = 0.0;
     QString label = "";
     if (interaction) {
-      energy = interaction->getComponent(m_options.component);
+      energy = (componentId >= 0 && interaction->owner() == owner)
+                   ? interaction->getComponent(componentId)
+                   : interaction->getComponent(m_options.component);
       if (m_options.coloring == FrameworkOptions::Coloring::Interaction) {
         c = interaction->color();
       }
@@ -180,7 +210,6 @@ void FrameworkRenderer::handleInteractionsUpdate() {
         label = QString::number(energy, 'd', 1);
         break;
       case FrameworkOptions::LabelDisplay::Interaction: {
-        const auto &params = interaction->parameters();
         label = interaction->label();
         break;
       }
@@ -199,7 +228,7 @@ void FrameworkRenderer::handleInteractionsUpdate() {
     }
     emin = qMin(energy, emin);
     emax = qMax(energy, emax);
-    energies.push_back({c, energy, label});
+    result.push_back({c, energy, label});
   }
 
   if (m_options.coloring == FrameworkOptions::Coloring::Value) {
@@ -208,101 +237,141 @@ void FrameworkRenderer::handleInteractionsUpdate() {
     double minVal = qMin(emin, 0.0);
     double maxVal = qMax(emax, 0.0);
     ColorMap cmap("OrangeWhiteBlue", minVal, maxVal);
-    for (auto &[color, energy, label] : energies) {
-      color = cmap(energy);
+    for (auto &edge : result) {
+      edge.color = cmap(edge.energy);
     }
   }
+  return result;
+}
 
-  const bool inv = pairSettings.allowInversion;
+bool FrameworkRenderer::edgeIsHidden(const FrameworkEdge &edge,
+                                     const FragmentSet &selected) const {
+  if (selected.size() == 0)
+    return false;
+  const auto &index = edge.pair->index;
+  if (m_options.showOnlySelectedFragmentInteractions && selected.size() > 1) {
+    return !selected.contains(index.a) || !selected.contains(index.b);
+  }
+  return !selected.contains(index.a) && !selected.contains(index.b);
+}
 
-  const auto selectedFragments = m_structure->selectedFragments();
-  ankerl::unordered_dense::set<FragmentIndex, FragmentIndexHash> selected(
-      selectedFragments.begin(), selectedFragments.end());
-
-  for (const auto &[fragIndex, molPairs] : fragmentPairs.pairs) {
-    for (const auto &[pair, uniqueIndex] : molPairs) {
-      if (selected.size() != 0) {
-        if (m_options.showOnlySelectedFragmentInteractions &&
-            selected.size() > 1) {
-          if (selected.find(pair.index.a) == selected.end() ||
-              selected.find(pair.index.b) == selected.end())
-            continue;
-        } else {
-          if (selected.find(pair.index.a) == selected.end() &&
-              selected.find(pair.index.b) == selected.end())
-            continue;
-        }
-      }
-      auto [color, energy, label] = energies[uniqueIndex];
-      if ((m_options.cutoff != 0.0) && (std::abs(energy) <= m_options.cutoff))
-        continue;
-      double scale = -energy * thickness();
-      if (std::abs(scale) < 1e-4)
-        continue;
+void FrameworkRenderer::handleInteractionsUpdate() {
+  if (!m_needsUpdate)
+    return;
+  if (!m_structure || !m_interactions)
+    return;
+
+  beginUpdates();
+  m_ellipsoidRenderer->clear();
+  m_lineRenderer->clear();
+  m_cylinderRenderer->clear();
+  m_sphereImpostorRenderer->clear();
+  m_cylinderImpostorRenderer->clear();
+  m_labelRenderer->clear();
+
+  auto finish = [this]() {
+    endUpdates();
+    m_needsUpdate = false;
+  };
 
-      auto [va, vb] = getPairPositions(pair);
-      QVector3D m = va + (vb - va) * 0.5;
+  if (m_options.display == FrameworkOptions::Display::None)
+    return finish();
 
-      const double lineWidth = DrawingStyleConstants::bondLineWidth;
+  // Check impostor setting once per update for performance
+  bool useImpostors =
+      settings::readSetting(settings::keys::USE_IMPOSTOR_RENDERING).toBool();
 
-      if (inv) {
-        if (pair.index.b > pair.index.a)
-          continue;
-        if (m_options.display == FrameworkOptions::Display::Tubes) {
-          if (useImpostors) {
-            // Use impostor renderers
-            cx::graphics::addSphereToSphereRenderer(m_sphereImpostorRenderer,
-                                                    va, color, std::abs(scale));
-            cx::graphics::addSphereToSphereRenderer(m_sphereImpostorRenderer,
-                                                    vb, color, std::abs(scale));
-            cx::graphics::addCylinderToCylinderRenderer(
-                m_cylinderImpostorRenderer, va, vb, color, color, scale);
-          } else {
-            // Use geometry-based renderers
-            cx::graphics::addSphereToEllipsoidRenderer(m_ellipsoidRenderer, va,
-                                                       color, std::abs(scale));
-            cx::graphics::addSphereToEllipsoidRenderer(m_ellipsoidRenderer, vb,
-                                                       color, std::abs(scale));
-            cx::graphics::addCylinderToCylinderRenderer(
-                m_cylinderRenderer, va, vb, color, color, scale);
-          }
-        } else if (m_options.display == FrameworkOptions::Display::Lines) {
-          cx::graphics::addLineToLineRenderer(*m_lineRenderer, va, vb,
-                                              lineWidth, color);
+  // pair search and interaction matching are cached, only the appearance
+  // below is redone for option changes
+  const auto *geometry = currentGeometry();
+  if (!geometry)
+    return finish();
+
+  const auto uniqueInteractions =
+      geometry->interactions.value(m_options.model, {});
+  if (uniqueInteractions.empty() ||
+      uniqueInteractions.size() < geometry->fragmentPairs.uniquePairs.size())
+    return finish();
+
+  const auto appearance = uniquePairAppearance(uniqueInteractions);
+  const bool inv = geometry->allowInversion;
+
+  const auto selectedFragments = m_structure->selectedFragments();
+  FragmentSet selected(selectedFragments.begin(), selectedFragments.end());
+
+  for (const auto &edge : geometry->edges) {
+    if (edgeIsHidden(edge, selected))
+      continue;
+    const auto &pair = *edge.pair;
+    const auto &[color, energy, label] = appearance[edge.uniqueIndex];
+    if ((m_options.cutoff != 0.0) && (std::abs(energy) <= m_options.cutoff))
+      continue;
+    double scale = -energy * thickness();
+    if (std::abs(scale) < 1e-4)
+      continue;
+
+    const QVector3D &va = edge.va;
+    const QVector3D &vb = edge.vb;
+    QVector3D m = va + (vb - va) * 0.5;
+
+    const double lineWidth = DrawingStyleConstants::bondLineWidth;
+
+    if (inv) {
+      if (pair.index.b > pair.index.a)
+        continue;
+      if (m_options.display == FrameworkOptions::Display::Tubes) {
+        if (useImpostors) {
+          // Use impostor renderers
+          cx::graphics::addSphereToSphereRenderer(m_sphereImpostorRenderer, va,
+                                                  color, std::abs(scale));
+          cx::graphics::addSphereToSphereRenderer(m_sphereImpostorRenderer, vb,
+                                                  color, std::abs(scale));
+          cx::graphics::addCylinderToCylinderRenderer(
+              m_cylinderImpostorRenderer, va, vb, color, color, scale);
+        } else {
+          // Use geometry-based renderers
+          cx::graphics::addSphereToEllipsoidRenderer(m_ellipsoidRenderer, va,
+                                                     color, std::abs(scale));
+          cx::graphics::addSphereToEllipsoidRenderer(m_ellipsoidRenderer, vb,
+                                                     color, std::abs(scale));
+          cx::graphics::addCylinderToCylinderRenderer(m_cylinderRenderer, va,
+                                                      vb, color, color, scale);
         }
-        if (!label.isEmpty())
-          cx::graphics::addTextToBillboardRenderer(*m_labelRenderer, m, label);
-      } else {
-        QVector3D m2 = va + (m - va) * 0.5;
-        if (m_options.display == FrameworkOptions::Display::Tubes) {
-          if (useImpostors) {
-            // Use impostor renderers
-            cx::graphics::addSphereToSphereRenderer(m_sphereImpostorRenderer,
-                                                    va, color, std::abs(scale));
-            cx::graphics::addSphereToSphereRenderer(m_sphereImpostorRenderer, m,
-                                                    color, std::abs(scale));
-            cx::graphics::addCylinderToCylinderRenderer(
-                m_cylinderImpostorRenderer, va, m, color, color, scale);
-          } else {
-            // Use geometry-based renderers
-            cx::graphics::addSphereToEllipsoidRenderer(m_ellipsoidRenderer, va,
-                                                       color, std::abs(scale));
-            cx::graphics::addSphereToEllipsoidRenderer(m_ellipsoidRenderer, m,
-                                                       color, std::abs(scale));
-            cx::graphics::addCylinderToCylinderRenderer(m_cylinderRenderer, va,
-                                                        m, color, color, scale);
-          }
-        } else if (m_options.display == FrameworkOptions::Display::Lines) {
-          cx::graphics::addLineToLineRenderer(*m_lineRenderer, va, m, lineWidth,
-                                              color);
+      } else if (m_options.display == FrameworkOptions::Display::Lines) {
+        cx::graphics::addLineToLineRenderer(*m_lineRenderer, va, vb, lineWidth,
+                                            color);
+      }
+      if (!label.isEmpty())
+        cx::graphics::addTextToBillboardRenderer(*m_labelRenderer, m, label);
+    } else {
+      QVector3D m2 = va + (m - va) * 0.5;
+      if (m_options.display == FrameworkOptions::Display::Tubes) {
+        if (useImpostors) {
+          // Use impostor renderers
+          cx::graphics::addSphereToSphereRenderer(m_sphereImpostorRenderer, va,
+                                                  color, std::abs(scale));
+          cx::graphics::addSphereToSphereRenderer(m_sphereImpostorRenderer, m,
+                                                  color, std::abs(scale));
+          cx::graphics::addCylinderToCylinderRenderer(
+              m_cylinderImpostorRenderer, va, m, color, color, scale);
+        } else {
+          // Use geometry-based renderers
+          cx::graphics::addSphereToEllipsoidRenderer(m_ellipsoidRenderer, va,
+                                                     color, std::abs(scale));
+          cx::graphics::addSphereToEllipsoidRenderer(m_ellipsoidRenderer, m,
+                                                     color, std::abs(scale));
+          cx::graphics::addCylinderToCylinderRenderer(m_cylinderRenderer, va, m,
+                                                      color, color, scale);
         }
-        if (!label.isEmpty())
-          cx::graphics::addTextToBillboardRenderer(*m_labelRenderer, m2, label);
+      } else if (m_options.display == FrameworkOptions::Display::Lines) {
+        cx::graphics::addLineToLineRenderer(*m_lineRenderer, va, m, lineWidth,
+                                            color);
       }
+      if (!label.isEmpty())
+        cx::graphics::addTextToBillboardRenderer(*m_labelRenderer, m2, label);
     }
   }
-  endUpdates();
-  m_needsUpdate = false;
+  finish();
 }
 
 void FrameworkRenderer::draw(bool forPicking) {
@@ -361,160 +430,72 @@ std::vector<FrameworkRenderer::FrameworkTube>
 FrameworkRenderer::generateFrameworkTubes() const {
   std::vector<FrameworkTube> tubes;
 
-  if (!m_structure || !m_interactions) {
-    return tubes;
-  }
-
   if (m_options.display == FrameworkOptions::Display::None) {
     return tubes;
   }
 
-  FragmentPairSettings pairSettings;
-  pairSettings.allowInversion =
-      m_options.allowInversion &
-      m_interactions->hasPermutationSymmetry(m_options.model);
-
-  // Safety check: ensure structure has completed fragments before finding pairs
-  if (m_structure->numberOfAtoms() == 0) {
-    return tubes;
-  }
-
-  auto fragmentPairs = m_structure->findFragmentPairs(pairSettings);
-  std::vector<FragmentDimer> uniquePairs = fragmentPairs.uniquePairs;
-
-  // Safety check: ensure we have valid fragment pairs
-  if (uniquePairs.empty()) {
+  const auto *geometry = currentGeometry();
+  if (!geometry) {
     return tubes;
   }
 
-  auto interactionMap =
-      m_interactions->getInteractionsMatchingFragments(uniquePairs);
-
-  auto uniqueInteractions = interactionMap.value(m_options.model, {});
+  const auto uniqueInteractions =
+      geometry->interactions.value(m_options.model, {});
   if (uniqueInteractions.empty() ||
-      uniqueInteractions.size() < uniquePairs.size())
+      uniqueInteractions.size() < geometry->fragmentPairs.uniquePairs.size())
     return tubes;
 
-  QColor color = m_options.customColor;
-  if (m_options.coloring == FrameworkOptions::Coloring::Component) {
-    color = m_interactionComponentColors.value(
-        m_options.component.toLower(), m_defaultInteractionComponentColor);
-  }
-
-  std::vector<std::tuple<QColor, double, QString>> energies;
-  energies.reserve(uniqueInteractions.size());
-
-  double emin = std::numeric_limits<double>::max();
-  double emax = std::numeric_limits<double>::min();
-
-  for (const auto *interaction : uniqueInteractions) {
-    QColor c = color;
-    double energy = 0.0;
-    QString label = "";
-    if (interaction) {
-      energy = interaction->getComponent(m_options.component);
-      if (m_options.coloring == FrameworkOptions::Coloring::Interaction) {
-        c = interaction->color();
-      }
-      switch (m_options.labels) {
-      case FrameworkOptions::LabelDisplay::Value:
-        label = QString::number(energy, 'd', 1);
-        break;
-      case FrameworkOptions::LabelDisplay::Interaction: {
-        label = interaction->label();
-        break;
-      }
-      case FrameworkOptions::LabelDisplay::Fragments: {
-        const auto &params = interaction->parameters();
-        label = m_structure->getFragmentLabel(
-                    params.fragmentDimer.a.asymmetricFragmentIndex) +
-                ":" +
-                m_structure->getFragmentLabel(
-                    params.fragmentDimer.b.asymmetricFragmentIndex);
-        break;
-      }
-      default:
-        break;
-      }
-    }
-    emin = qMin(energy, emin);
-    emax = qMax(energy, emax);
-    energies.push_back({c, energy, label});
-  }
-
-  if (m_options.coloring == FrameworkOptions::Coloring::Value) {
-    // Blue (binding/negative) to White (neutral) to Orange (repulsive/positive)
-    // For tricolor map, ensure range spans from negative to positive
-    double minVal = qMin(emin, 0.0);
-    double maxVal = qMax(emax, 0.0);
-    ColorMap cmap("OrangeWhiteBlue", minVal, maxVal);
-    for (auto &[color, energy, label] : energies) {
-      color = cmap(energy);
-    }
-  }
-
-  const bool inv = pairSettings.allowInversion;
+  const auto appearance = uniquePairAppearance(uniqueInteractions);
+  const bool inv = geometry->allowInversion;
   const auto selectedFragments = m_structure->selectedFragments();
-  ankerl::unordered_dense::set<FragmentIndex, FragmentIndexHash> selected(
-      selectedFragments.begin(), selectedFragments.end());
-
-  for (const auto &[fragIndex, molPairs] : fragmentPairs.pairs) {
-    for (const auto &[pair, uniqueIndex] : molPairs) {
-      if (selected.size() != 0) {
-        if (m_options.showOnlySelectedFragmentInteractions &&
-            selected.size() > 1) {
-          if (selected.find(pair.index.a) == selected.end() ||
-              selected.find(pair.index.b) == selected.end())
-            continue;
-        } else {
-          if (selected.find(pair.index.a) == selected.end() &&
-              selected.find(pair.index.b) == selected.end())
-            continue;
-        }
-      }
-      auto [tubeColor, energy, label] = energies[uniqueIndex];
-      if ((m_options.cutoff != 0.0) && (std::abs(energy) <= m_options.cutoff))
-        continue;
-      double scale = -energy * thickness();
-      if (std::abs(scale) < 1e-4)
-        continue;
-
-      auto [va, vb] = getPairPositions(pair);
-
-      if (m_options.display == FrameworkOptions::Display::Tubes) {
-        if (inv) {
-          // Full tube from va to vb
-          FrameworkTube tube;
-          tube.startPos = va;
-          tube.endPos = vb;
-          tube.color = tubeColor;
-          tube.radius = std::abs(scale);
-          tube.label = label;
-          tubes.push_back(tube);
-        } else {
-          // Two half-tubes
-          QVector3D m = va + (vb - va) * 0.5;
-
-          FrameworkTube tubeA;
-          tubeA.startPos = va;
-          tubeA.endPos = m;
-          tubeA.color = tubeColor;
-          tubeA.radius = std::abs(scale);
-          tubeA.label = label + "_A";
-          tubes.push_back(tubeA);
-
-          FrameworkTube tubeB;
-          tubeB.startPos = m;
-          tubeB.endPos = vb;
-          tubeB.color = tubeColor;
-          tubeB.radius = std::abs(scale);
-          tubeB.label = label + "_B";
-          tubes.push_back(tubeB);
-        }
+  FragmentSet selected(selectedFragments.begin(), selectedFragments.end());
+
+  for (const auto &edge : geometry->edges) {
+    if (edgeIsHidden(edge, selected))
+      continue;
+    const auto &[tubeColor, energy, label] = appearance[edge.uniqueIndex];
+    if ((m_options.cutoff != 0.0) && (std::abs(energy) <= m_options.cutoff))
+      continue;
+    double scale = -energy * thickness();
+    if (std::abs(scale) < 1e-4)
+      continue;
+
+    const QVector3D &va = edge.va;
+    const QVector3D &vb = edge.vb;
+
+    if (m_options.display == FrameworkOptions::Display::Tubes) {
+      if (inv) {
+        // Full tube from va to vb
+        FrameworkTube tube;
+        tube.startPos = va;
+        tube.endPos = vb;
+        tube.color = tubeColor;
+        tube.radius = std::abs(scale);
+        tube.label = label;
+        tubes.push_back(tube);
+      } else {
+        // Two half-tubes
+        QVector3D m = va + (vb - va) * 0.5;
+
+        FrameworkTube tubeA;
+        tubeA.startPos = va;
+        tubeA.endPos = m;
+        tubeA.color = tubeColor;
+        tubeA.radius = std::abs(scale);
+        tubeA.label = label + "_A";
+        tubes.push_back(tubeA);
+
+        FrameworkTube tubeB;
+        tubeB.startPos = m;
+        tubeB.endPos = vb;
+        tubeB.color = tubeColor;
+        tubeB.radius = std::abs(scale);
+        tubeB.label = label + "_B";
+        tubes.push_back(tubeB);
       }
-      // Note: We could extend this to handle Display::Lines mode by creating
-      // thin tubes
     }
+    // Note: We could extend this to handle Display::Lines mode by creating
+    // thin tubes
   }
 
   return tubes;
@@ -72,8 +72,45 @@ private:
     QString label;
   };
 
+  using FragmentSet =
+      ankerl::unordered_dense::set<FragmentIndex, FragmentIndexHash>;
+
+  struct FrameworkEdge {
+    const FragmentDimer *pair{nullptr};
+    int uniqueIndex{-1};
+    QVector3D va;
+    QVector3D vb;
+  };
+
+  // Fragment pairs and their matching interactions, which only change with
+  // the structure or the set of interactions. Appearance options (component,
+  // colouring, scale, labels, cutoff, selection) are applied on top of this
+  // without repeating the pair search.
+  struct FrameworkGeometry {
+    bool valid{false};
+    quint64 positionGeneration{0};
+    quint64 fragmentGeneration{0};
+    quint64 interactionsVersion{0};
+    bool allowInversion{false};
+    FragmentPairs fragmentPairs;
+    QMap<QString, PairInteractions::PairInteractionList> interactions;
+    FrameworkOptions::ConnectionMode connectionMode{
+        FrameworkOptions::ConnectionMode::Centroids};
+    std::vector<FrameworkEdge> edges;
+  };
+
+  struct EdgeAppearance {
+    QColor color;
+    double energy{0.0};
+    QString label;
+  };
+
   void handleInteractionsUpdate();
   std::pair<QVector3D, QVector3D> getPairPositions(const FragmentDimer &) const;
+  const FrameworkGeometry *currentGeometry() const;
+  std::vector<EdgeAppearance>
+  uniquePairAppearance(const PairInteractions::PairInteractionList &) const;
+  bool edgeIsHidden(const FrameworkEdge &, const FragmentSet &selected) const;
   std::vector<FrameworkTube> generateFrameworkTubes() const;
 
   [[nodiscard]] bool shouldSkipAtom(int idx) const;
@@ -91,6 +128,8 @@ private:
   ChemicalStructure *m_structure{nullptr};
 
   PairInteractions *m_interactions{nullptr};
+  quint64 m_interactionsVersion{0};
+  mutable FrameworkGeometry m_geometry;
   RendererUniforms m_uniforms;
 
   FrameworkOptions m_options;
@@ -0,0 +1,174 @@
+#include "frustumculling.h"
+#include <ankerl/unordered_dense.h>
+#include <cmath>
+#include <limits>
+
+namespace cx::graphics {
+
+Frustum::Frustum(const QMatrix4x4 &modelViewProjection,
+                 const QVector2D &viewportSize)
+    : m_valid(true), m_modelViewProjection(modelViewProjection),
+      m_viewportSize(viewportSize) {
+  // Gribb & Hartmann: the clip volume -w <= x, y, z <= w as world planes
+  const QVector4D r0 = modelViewProjection.row(0);
+  const QVector4D r1 = modelViewProjection.row(1);
+  const QVector4D r2 = modelViewProjection.row(2);
+  const QVector4D r3 = modelViewProjection.row(3);
+  m_planes = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2};
+  for (auto &plane : m_planes) {
+    const float length = plane.toVector3D().length();
+    if (length > 0.0f)
+      plane /= length;
+  }
+  m_pixelsPerUnit = r0.toVector3D().length() * 0.5f * viewportSize.x();
+}
+
+bool Frustum::intersectsSphere(const QVector3D &center, float radius) const {
+  if (!m_valid)
+    return true;
+  for (const auto &plane : m_planes) {
+    if (QVector3D::dotProduct(plane.toVector3D(), center) + plane.w() <
+        -radius)
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersectsBox(const QVector3D &lower,
+                            const QVector3D &upper) const {
+  if (!m_valid)
+    return true;
+  for (const auto &plane : m_planes) {
+    // corner furthest along the plane normal
+    const QVector3D corner(plane.x() >= 0.0f ? upper.x() : lower.x(),
+                           plane.y() >= 0.0f ? upper.y() : lower.y(),
+                           plane.z() >= 0.0f ? upper.z() : lower.z());
+    if (QVector3D::dotProduct(plane.toVector3D(), corner) + plane.w() < 0.0f)
+      return false;
+  }
+  return true;
+}
+
+float Frustum::projectedRadius(const QVector3D &center, float radius) const {
+  if (!m_valid)
+    return std::numeric_limits<float>::infinity();
+  const float w = QVector3D::dotProduct(
+                      m_modelViewProjection.row(3).toVector3D(), center) +
+                  m_modelViewProjection(3, 3);
+  if (std::abs(w) < 1e-6f)
+    return std::numeric_limits<float>::infinity();
+  return radius * m_pixelsPerUnit / std::abs(w);
+}
+
+void ChunkedVisibility::clear() {
+  m_chunks.clear();
+  m_chunkLevels.clear();
+  for (auto &visible : m_visible) {
+    visible.clear();
+  }
+  m_forceUpdate = true;
+}
+
+void ChunkedVisibility::build(const std::vector<QVector3D> &centers,
+                              const std::vector<float> &radii) {
+  clear();
+  const size_t n = centers.size();
+  if (n == 0)
+    return;
+
+  QVector3D lower = centers[0], upper = centers[0];
+  for (const auto &c : centers) {
+    lower = QVector3D(std::min(lower.x(), c.x()), std::min(lower.y(), c.y()),
+                      std::min(lower.z(), c.z()));
+    upper = QVector3D(std::max(upper.x(), c.x()), std::max(upper.y(), c.y()),
+                      std::max(upper.z(), c.z()));
+  }
+
+  // aim for a few dozen items per chunk, so chunk tests stay cheap relative
+  // to the items they cover
+  constexpr float itemsPerChunk = 64.0f;
+  constexpr float minimumCellSize = 2.0f;
+  const QVector3D extent = upper - lower;
+  const float volume = std::max(extent.x(), 1.0f) *
+                       std::max(extent.y(), 1.0f) *
+                       std::max(extent.z(), 1.0f);
+  const float cellSize =
+      std::max(minimumCellSize, std::cbrt(volume * itemsPerChunk / n));
+
+  ankerl::unordered_dense::map<uint64_t, uint32_t> cellChunks;
+  for (size_t i = 0; i < n; i++) {
+    const QVector3D &c = centers[i];
+    const QVector3D cell = (c - lower) / cellSize;
+    const uint64_t key = static_cast<uint64_t>(cell.x()) |
+                         (static_cast<uint64_t>(cell.y()) << 21) |
+                         (static_cast<uint64_t>(cell.z()) << 42);
+    auto [it, inserted] =
+        cellChunks.try_emplace(key, static_cast<uint32_t>(m_chunks.size()));
+    if (inserted) {
+      m_chunks.push_back(Chunk{c, c, 0.0f, {}});
+    }
+    Chunk &chunk = m_chunks[it->second];
+    chunk.lower = QVector3D(std::min(chunk.lower.x(), c.x()),
+                            std::min(chunk.lower.y(), c.y()),
+                            std::min(chunk.lower.z(), c.z()));
+    chunk.upper = QVector3D(std::max(chunk.upper.x(), c.x()),
+                            std::max(chunk.upper.y(), c.y()),
+                            std::max(chunk.upper.z(), c.z()));
+    chunk.maxRadius = std::max(chunk.maxRadius, radii[i]);
+    chunk.items.push_back(static_cast<uint32_t>(i));
+  }
+  m_chunkLevels.assign(m_chunks.size(), -1);
+}
+
+bool ChunkedVisibility::update(const Frustum &frustum, float radiusScale,
+                               int levels, LevelFunction level) {
+  bool changed = m_forceUpdate;
+  m_forceUpdate = false;
+  if (static_cast<int>(m_visible.size()) != levels) {
+    m_visible.assign(levels, {});
+    changed = true;
+  }
+
+  for (size_t k = 0; k < m_chunks.size(); k++) {
+    const Chunk &chunk = m_chunks[k];
+    const float pad = chunk.maxRadius * radiusScale;
+    const QVector3D padding(pad, pad, pad);
+    int chunkLevel = -1;
+    if (frustum.intersectsBox(chunk.lower - padding, chunk.upper + padding)) {
+      chunkLevel = levels - 1;
+      if (level) {
+        const QVector3D center = 0.5f * (chunk.lower + chunk.upper);
+        chunkLevel =
+            std::min(level(frustum.projectedRadius(center, pad)), levels - 1);
+      }
+    }
+    if (chunkLevel != m_chunkLevels[k]) {
+      m_chunkLevels[k] = static_cast<int8_t>(chunkLevel);
+      changed = true;
+    }
+  }
+  if (!changed)
+    return false;
+
+  for (auto &visible : m_visible) {
+    visible.clear();
+  }
+  for (size_t k = 0; k < m_chunks.size(); k++) {
+    if (m_chunkLevels[k] < 0)
+      continue;
+    auto &visible = m_visible[m_chunkLevels[k]];
+    visible.insert(visible.end(), m_chunks[k].items.begin(),
+                   m_chunks[k].items.end());
+  }
+  return true;
+}
+
+size_t ChunkedVisibility::numberOfVisibleItems() const {
+  size_t result = 0;
+  for (const auto &visible : m_visible) {
+    result += visible.size();
+  }
+  return result;
+}
+
+} // namespace cx::graphics
@@ -0,0 +1,85 @@
+#pragma once
+#include <QMatrix4x4>
+#include <QVector2D>
+#include <QVector3D>
+#include <QVector4D>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace cx::graphics {
+
+/*
+ * Clip volume of a model-view-projection matrix, for culling geometry on
+ * the CPU before it is submitted. A default constructed frustum contains
+ * everything.
+ */
+class Frustum {
+public:
+  Frustum() = default;
+  Frustum(const QMatrix4x4 &modelViewProjection, const QVector2D &viewportSize);
+
+  [[nodiscard]] bool intersectsSphere(const QVector3D &center,
+                                      float radius) const;
+  [[nodiscard]] bool intersectsBox(const QVector3D &lower,
+                                   const QVector3D &upper) const;
+
+  // Approximate radius in pixels of a sphere once projected, infinite for a
+  // default constructed frustum
+  [[nodiscard]] float projectedRadius(const QVector3D &center,
+                                      float radius) const;
+
+private:
+  bool m_valid{false};
+  std::array<QVector4D, 6> m_planes;
+  QMatrix4x4 m_modelViewProjection;
+  QVector2D m_viewportSize;
+  float m_pixelsPerUnit{0.0f};
+};
+
+/*
+ * Buckets renderer items (instances, impostor quads) into spatial chunks on
+ * a regular grid, so that per frame only one bounding box per chunk is
+ * tested against the frustum. Each visible chunk is also assigned a level
+ * of detail, and the visible items are only regathered when the set of
+ * visible chunks or their levels change.
+ */
+class ChunkedVisibility {
+public:
+  // -1 to cull the chunk, otherwise a level in [0, levels)
+  using LevelFunction = int (*)(float projectedRadius);
+
+  // Discard the current chunks, items are supplied by their bounding spheres
+  void build(const std::vector<QVector3D> &centers,
+             const std::vector<float> &radii);
+  void clear();
+  [[nodiscard]] inline bool isEmpty() const { return m_chunks.empty(); }
+
+  // Returns true if the visible items changed since the last call. Radii are
+  // multiplied by radiusScale, for impostors sized in the shader.
+  bool update(const Frustum &frustum, float radiusScale = 1.0f,
+              int levels = 1, LevelFunction level = nullptr);
+
+  // Visible item indices assigned to the given level of detail
+  [[nodiscard]] inline const std::vector<uint32_t> &
+  visibleItems(int level = 0) const {
+    return m_visible[level];
+  }
+  [[nodiscard]] size_t numberOfVisibleItems() const;
+
+private:
+  struct Chunk {
+    QVector3D lower;
+    QVector3D upper;
+    float maxRadius{0.0f};
+    std::vector<uint32_t> items;
+  };
+
+  std::vector<Chunk> m_chunks;
+  std::vector<int8_t> m_chunkLevels;
+  bool m_forceUpdate{true};
+  std::vector<std::vector<uint32_t>> m_visible =
+      std::vector<std::vector<uint32_t>>(1);
+};
+
+} // namespace cx::graphics
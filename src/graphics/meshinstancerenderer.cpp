@@ -3,6 +3,7 @@
 #include "shaderloader.h"
 
 #include <QOpenGLShaderProgram>
+#include <algorithm>
 
 // OpenGL constants not available in WebGL/GLES
 #ifndef GL_TEXTURE_BUFFER
@@ -140,6 +141,18 @@ void MeshInstanceRenderer::setMesh(Mesh *mesh) {
   }
   m_numVertices = vertices.cols();
 
+  if (vertices.cols() > 0) {
+    const Eigen::Vector3d lower = vertices.rowwise().minCoeff();
+    const Eigen::Vector3d upper = vertices.rowwise().maxCoeff();
+    const Eigen::Vector3d center = 0.5 * (lower + upper);
+    m_meshCenter = QVector3D(center.x(), center.y(), center.z());
+    m_meshRadius = (vertices.colwise() - center).colwise().norm().maxCoeff();
+  } else {
+    m_meshCenter = QVector3D();
+    m_meshRadius = 0.0f;
+  }
+  m_visibilityNeedsUpdate = true;
+
   std::vector<GLuint> temp_faces;
   temp_faces.reserve(faces.size());
   for (int i = 0; i < faces.cols(); i++) {
@@ -256,10 +269,46 @@ MeshInstanceRenderer::getCurrentPropertyColors(int propertyIndex) const {
   return currentColors;
 }
 
+void MeshInstanceRenderer::cull(const cx::graphics::Frustum &frustum) {
+  if (m_updatesDisabled)
+    return;
+  if (m_visibilityNeedsUpdate) {
+    std::vector<QVector3D> centers;
+    std::vector<float> radii;
+    centers.reserve(m_instances.size());
+    radii.reserve(m_instances.size());
+    for (const auto &instance : m_instances) {
+      const QVector3D &r1 = instance.rotation1();
+      const QVector3D &r2 = instance.rotation2();
+      const QVector3D &r3 = instance.rotation3();
+      centers.push_back(instance.translation() + r1 * m_meshCenter.x() +
+                        r2 * m_meshCenter.y() + r3 * m_meshCenter.z());
+      const float scale = std::max({r1.length(), r2.length(), r3.length()});
+      radii.push_back(m_meshRadius * scale);
+    }
+    m_visibility.build(centers, radii);
+    m_visibilityNeedsUpdate = false;
+  }
+  if (!m_visibility.update(frustum))
+    return;
+
+  m_visibleInstances.clear();
+  for (uint32_t i : m_visibility.visibleItems()) {
+    m_visibleInstances.push_back(m_instances[i]);
+  }
+  m_instance.bind();
+  m_instance.allocate(m_visibleInstances.data(),
+                      static_cast<int>(sizeof(MeshInstanceVertex) *
+                                       m_visibleInstances.size()));
+  m_numberOfInstancesDrawn = m_visibleInstances.size();
+}
+
 void MeshInstanceRenderer::draw() {
   // After linking the program and before rendering
   m_program->setUniformValue("u_propertyBuffer", 0);
   m_program->setUniformValue("u_numVertices", m_numVertices);
+  m_program->setUniformValue("u_transparencyPass",
+                             static_cast<int>(m_transparencyPass));
   m_vertexPropertyTexture->bind();
 
   // TODO split the meshes into two groups to avoid over-drawing, especially
@@ -269,11 +318,11 @@ void MeshInstanceRenderer::draw() {
   glFrontFace(
       GL_CW); // Assuming counter-clockwise winding order for front faces
   this->glDrawElementsInstanced(DrawType, m_numIndices, IndexType, 0,
-                                static_cast<int>(m_instances.size()));
+                                static_cast<int>(m_numberOfInstancesDrawn));
   glFrontFace(
       GL_CCW); // Assuming counter-clockwise winding order for front faces
   this->glDrawElementsInstanced(DrawType, m_numIndices, IndexType, 0,
-                                static_cast<int>(m_instances.size()));
+                                static_cast<int>(m_numberOfInstancesDrawn));
 
   m_vertexPropertyTexture->release();
 }
@@ -288,6 +337,8 @@ void MeshInstanceRenderer::endUpdates() {
 void MeshInstanceRenderer::updateBuffers() {
   if (m_updatesDisabled)
     return;
+  m_visibilityNeedsUpdate = true;
+  m_numberOfInstancesDrawn = m_instances.size();
   m_instance.bind();
   m_instance.allocate(
       m_instances.data(),
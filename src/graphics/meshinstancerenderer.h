@@ -1,5 +1,6 @@
 #pragma once
 #include "colormap.h"
+#include "frustumculling.h"
 #include "mesh.h"
 #include "meshinstancevertex.h"
 #include "renderer.h"
@@ -17,6 +18,13 @@ public:
     GLuint i, j, k;
   };
 
+  // Which fragments draw() emits, see meshinstance.frag
+  enum class TransparencyPass {
+    All = 0,
+    OpaqueOnly = 1,
+    WeightedBlended = 2,
+  };
+
   explicit MeshInstanceRenderer(Mesh *mesh = nullptr);
 
   void addInstance(const MeshInstanceVertex &);
@@ -31,10 +39,17 @@ public:
   [[nodiscard]] inline auto &instances() { return m_instances; }
   void setMesh(Mesh *);
 
+  // Only draw instances whose transformed mesh bounds are inside the frustum,
+  // until the instances change
+  void cull(const cx::graphics::Frustum &frustum);
+
   inline const auto &availableProperties() const {
     return m_availableProperties;
   }
   bool hasTransparentObjects() const;
+  inline void setTransparencyPass(TransparencyPass pass) {
+    m_transparencyPass = pass;
+  }
 
   // Export support
   const std::vector<float> &getVertexPropertyData() const;
@@ -53,8 +68,17 @@ private:
   QStringList m_availableProperties;
   int m_numIndices{0};
   int m_numVertices{0};
+  TransparencyPass m_transparencyPass{TransparencyPass::All};
   std::vector<float> m_cachedPropertyData;
 
+  // bounding sphere of the untransformed mesh
+  QVector3D m_meshCenter;
+  float m_meshRadius{0.0f};
+  cx::graphics::ChunkedVisibility m_visibility;
+  bool m_visibilityNeedsUpdate{true};
+  std::vector<MeshInstanceVertex> m_visibleInstances;
+  size_t m_numberOfInstancesDrawn{0};
+
 protected:
   bool m_impostor = false;
 };
@@ -0,0 +1,949 @@
+#include "raytracer.h"
+#include <Eigen/Dense>
+#include <QThreadPool>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+
+#ifdef CX_HAS_CONCURRENT
+#include <QtConcurrent>
+#endif
+
+namespace cx::graphics {
+
+namespace {
+
+using Vec3 = Eigen::Vector3f;
+using Vec4 = Eigen::Vector4f;
+using Mat3 = Eigen::Matrix3f;
+using Mat4 = Eigen::Matrix4f;
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+// offset of secondary rays from the surface they leave, in Angstroms
+constexpr float SURFACE_OFFSET = 1e-3f;
+constexpr int MAX_LEAF_SIZE = 4;
+// larger leaves are split whenever possible, even if SAH says otherwise
+constexpr int MAX_SAH_LEAF_SIZE = 16;
+// bounds the traversal stack
+constexpr int MAX_TREE_DEPTH = 60;
+constexpr int SAH_BINS = 16;
+constexpr int MAX_TRANSPARENT_LAYERS = 8;
+
+constexpr float TWO_PI = 6.28318530718f;
+constexpr float AMBIENT = 0.3f;
+constexpr float DIFFUSE = 0.7f;
+constexpr float SPECULAR = 0.2f;
+constexpr float SHININESS = 32.0f;
+
+struct Ray {
+  Vec3 origin;
+  Vec3 direction; // unit length
+  Vec3 inverseDirection;
+
+  Ray(const Vec3 &o, const Vec3 &d)
+      : origin(o), direction(d), inverseDirection(d.cwiseInverse()) {}
+};
+
+struct Box {
+  Vec3 lower{Vec3::Constant(INF)};
+  Vec3 upper{Vec3::Constant(-INF)};
+
+  inline void expand(const Vec3 &p) {
+    lower = lower.cwiseMin(p);
+    upper = upper.cwiseMax(p);
+  }
+  inline void expand(const Box &b) {
+    lower = lower.cwiseMin(b.lower);
+    upper = upper.cwiseMax(b.upper);
+  }
+  [[nodiscard]] inline bool isEmpty() const {
+    return (lower.array() > upper.array()).any();
+  }
+  [[nodiscard]] inline Vec3 centroid() const { return 0.5f * (lower + upper); }
+  [[nodiscard]] inline float area() const {
+    if (isEmpty())
+      return 0.0f;
+    const Vec3 e = upper - lower;
+    return 2.0f * (e.x() * e.y() + e.y() * e.z() + e.z() * e.x());
+  }
+  // Distance along the ray to the box, INF if it is missed before tMax
+  [[nodiscard]] inline float entry(const Ray &ray, float tMin,
+                                   float tMax) const {
+    const Vec3 t0 = (lower - ray.origin).cwiseProduct(ray.inverseDirection);
+    const Vec3 t1 = (upper - ray.origin).cwiseProduct(ray.inverseDirection);
+    const float tNear = std::max(t0.cwiseMin(t1).maxCoeff(), tMin);
+    const float tFar = std::min(t0.cwiseMax(t1).minCoeff(), tMax);
+    return tNear <= tFar ? tNear : INF;
+  }
+};
+
+enum class Kind : std::uint8_t { Sphere, Cylinder, Ellipsoid, Triangle };
+
+struct Primitive {
+  Kind kind;
+  std::uint32_t index;
+};
+
+struct Sphere {
+  Vec3 center;
+  float radius;
+  Vec3 color;
+};
+
+struct Cylinder {
+  Vec3 start;
+  Vec3 axis; // unit length
+  float length;
+  float radius;
+  Vec3 color;
+};
+
+struct Ellipsoid {
+  Vec3 center;
+  Mat3 axes; // columns are the semi-axes
+  Mat3 inverseAxes;
+  Vec3 color;
+};
+
+struct Triangle {
+  std::uint32_t mesh;
+  std::array<std::uint32_t, 3> vertices;
+};
+
+struct Mesh {
+  std::vector<Vec3> positions;
+  std::vector<Vec3> normals; // empty if the mesh has none
+  std::vector<Vec3> colors;  // empty if the mesh has none
+  Vec3 color;
+  float opacity{1.0f};
+};
+
+// Children of an interior node are adjacent, at first and first + 1
+struct Node {
+  Box box;
+  std::uint32_t first{0};
+  std::uint32_t count{0}; // primitives in a leaf, 0 for interior nodes
+};
+
+struct Hit {
+  float t{INF};
+  std::uint32_t primitive{0};
+  // barycentric coordinates for triangles, the part hit for cylinders
+  float u{0.0f};
+  float v{0.0f};
+};
+
+struct SurfacePoint {
+  Vec3 position;
+  Vec3 normal; // facing the incoming ray
+  Vec3 color;
+  float opacity{1.0f};
+};
+
+inline Vec3 toVec3(const QVector3D &v) { return Vec3(v.x(), v.y(), v.z()); }
+
+inline Vec3 toVec3(const QColor &c) {
+  return Vec3(c.redF(), c.greenF(), c.blueF());
+}
+
+inline Mat4 toMat4(const QMatrix4x4 &m) {
+  // both are column major
+  return Eigen::Map<const Mat4>(m.constData());
+}
+
+// PCG hash, cheap and good enough for sampling
+inline std::uint32_t hash(std::uint32_t v) {
+  const std::uint32_t state = v * 747796405u + 2891336453u;
+  const std::uint32_t word =
+      ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+  return (word >> 22u) ^ word;
+}
+
+// Seeded per pixel, so the image does not depend on the tiling or threads
+struct Random {
+  std::uint32_t state;
+
+  Random(int x, int y, int sample)
+      : state(hash(static_cast<std::uint32_t>(x) +
+                   hash(static_cast<std::uint32_t>(y) +
+                        hash(static_cast<std::uint32_t>(sample))))) {}
+
+  inline float next() {
+    state = hash(state);
+    return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+  }
+};
+
+// Duff et al., "Building an Orthonormal Basis, Revisited"
+inline void orthonormalBasis(const Vec3 &n, Vec3 &b1, Vec3 &b2) {
+  const float sign = std::copysign(1.0f, n.z());
+  const float a = -1.0f / (sign + n.z());
+  const float b = n.x() * n.y() * a;
+  b1 = Vec3(1.0f + sign * n.x() * n.x() * a, sign * b, -sign * n.x());
+  b2 = Vec3(b, sign + n.y() * n.y() * a, -n.y());
+}
+
+// Nearest root of a*t^2 + 2*b*t + c in (tMin, tMax), or INF
+inline float nearestRoot(float a, float b, float c, float tMin, float tMax) {
+  const float discriminant = b * b - a * c;
+  if (discriminant < 0.0f || a == 0.0f)
+    return INF;
+  const float s = std::sqrt(discriminant);
+  float t = (-b - s) / a;
+  if (t <= tMin)
+    t = (-b + s) / a;
+  return (t > tMin && t < tMax) ? t : INF;
+}
+
+} // namespace
+
+struct RayTracer::Geometry {
+  std::vector<Sphere> spheres;
+  std::vector<Cylinder> cylinders;
+  std::vector<Ellipsoid> ellipsoids;
+  std::vector<Triangle> triangles;
+  std::vector<Mesh> meshes;
+
+  // reordered during the build so that each leaf is a contiguous range
+  std::vector<Primitive> primitives;
+  std::vector<Node> nodes;
+
+  explicit Geometry(const SceneExportData &data);
+
+  [[nodiscard]] Box bounds(const Primitive &) const;
+  void build();
+
+  bool intersect(const Primitive &, const Ray &, float tMin, Hit &) const;
+  bool closestHit(const Ray &, float tMin, float tMax, Hit &) const;
+  // Any opaque hit, for ambient occlusion
+  bool occluded(const Ray &, float tMin, float tMax) const;
+
+  [[nodiscard]] SurfacePoint surface(const Hit &, const Ray &) const;
+  [[nodiscard]] bool isTranslucent(const Primitive &p) const {
+    return p.kind == Kind::Triangle &&
+           meshes[triangles[p.index].mesh].opacity < 1.0f;
+  }
+};
+
+RayTracer::Geometry::Geometry(const SceneExportData &data) {
+  for (const auto &s : data.spheres()) {
+    if (s.ellipsoidAxes) {
+      const auto &m = *s.ellipsoidAxes;
+      Mat3 axes;
+      for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+          axes(i, j) = m(i, j);
+        }
+      }
+      // non positive definite ADPs give degenerate axes, drawn as spheres
+      if (axes.allFinite() && std::abs(axes.determinant()) > 1e-9f) {
+        primitives.push_back(
+            {Kind::Ellipsoid, static_cast<std::uint32_t>(ellipsoids.size())});
+        ellipsoids.push_back(
+            {toVec3(s.position), axes, axes.inverse(), toVec3(s.color)});
+        continue;
+      }
+    }
+    if (s.radius <= 0.0f)
+      continue;
+    primitives.push_back(
+        {Kind::Sphere, static_cast<std::uint32_t>(spheres.size())});
+    spheres.push_back({toVec3(s.position), s.radius, toVec3(s.color)});
+  }
+
+  for (const auto &c : data.cylinders()) {
+    const Vec3 start = toVec3(c.startPosition);
+    const Vec3 axis = toVec3(c.endPosition) - start;
+    const float length = axis.norm();
+    if (length <= 0.0f || c.radius <= 0.0f)
+      continue;
+    primitives.push_back(
+        {Kind::Cylinder, static_cast<std::uint32_t>(cylinders.size())});
+    cylinders.push_back(
+        {start, axis / length, length, c.radius, toVec3(c.color)});
+  }
+
+  for (const auto &m : data.meshes()) {
+    if (m.opacity <= 0.0f)
+      continue;
+    const std::size_t numVertices = m.vertices.size() / 3;
+    Mesh mesh;
+    mesh.color = toVec3(m.fallbackColor);
+    mesh.opacity = std::min(m.opacity, 1.0f);
+    mesh.positions.reserve(numVertices);
+    for (std::size_t i = 0; i < numVertices; i++) {
+      mesh.positions.emplace_back(m.vertices[3 * i], m.vertices[3 * i + 1],
+                                  m.vertices[3 * i + 2]);
+    }
+    if (m.normals.size() == m.vertices.size()) {
+      mesh.normals.reserve(numVertices);
+      for (std::size_t i = 0; i < numVertices; i++) {
+        mesh.normals.emplace_back(m.normals[3 * i], m.normals[3 * i + 1],
+                                  m.normals[3 * i + 2]);
+      }
+    }
+    if (m.colors.size() == m.vertices.size()) {
+      mesh.colors.reserve(numVertices);
+      for (std::size_t i = 0; i < numVertices; i++) {
+        mesh.colors.emplace_back(m.colors[3 * i], m.colors[3 * i + 1],
+                                 m.colors[3 * i + 2]);
+      }
+    }
+
+    const auto meshIndex = static_cast<std::uint32_t>(meshes.size());
+    for (std::size_t i = 0; i + 2 < m.indices.size(); i += 3) {
+      const std::array<std::uint32_t, 3> v{m.indices[i], m.indices[i + 1],
+                                           m.indices[i + 2]};
+      if (v[0] >= numVertices || v[1] >= numVertices || v[2] >= numVertices)
+        continue;
+      primitives.push_back(
+          {Kind::Triangle, static_cast<std::uint32_t>(triangles.size())});
+      triangles.push_back({meshIndex, v});
+    }
+    meshes.push_back(std::move(mesh));
+  }
+
+  build();
+}
+
+Box RayTracer::Geometry::bounds(const Primitive &p) const {
+  Box box;
+  switch (p.kind) {
+  case Kind::Sphere: {
+    const auto &s = spheres[p.index];
+    box.expand(s.center - Vec3::Constant(s.radius));
+    box.expand(s.center + Vec3::Constant(s.radius));
+    break;
+  }
+  case Kind::Cylinder: {
+    const auto &c = cylinders[p.index];
+    // extent of the end caps along each axis
+    const Vec3 e =
+        c.radius * (Vec3::Ones() - c.axis.cwiseProduct(c.axis))
+                       .cwiseMax(0.0f)
+                       .cwiseSqrt();
+    const Vec3 end = c.start + c.length * c.axis;
+    box.expand(c.start - e);
+    box.expand(c.start + e);
+    box.expand(end - e);
+    box.expand(end + e);
+    break;
+  }
+  case Kind::Ellipsoid: {
+    const auto &el = ellipsoids[p.index];
+    const Vec3 e = el.axes.rowwise().norm();
+    box.expand(el.center - e);
+    box.expand(el.center + e);
+    break;
+  }
+  case Kind::Triangle: {
+    const auto &t = triangles[p.index];
+    const auto &mesh = meshes[t.mesh];
+    for (auto v : t.vertices) {
+      box.expand(mesh.positions[v]);
+    }
+    break;
+  }
+  }
+  return box;
+}
+
+void RayTracer::Geometry::build() {
+  nodes.clear();
+  if (primitives.empty())
+    return;
+
+  const std::size_t n = primitives.size();
+  std::vector<Box> boxes(n);
+  std::vector<Vec3> centroids(n);
+  for (std::size_t i = 0; i < n; i++) {
+    boxes[i] = bounds(primitives[i]);
+    centroids[i] = boxes[i].centroid();
+  }
+  // primitives are partitioned through this, and permuted at the end
+  std::vector<std::uint32_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+
+  nodes.reserve(2 * n);
+  nodes.push_back({{}, 0, static_cast<std::uint32_t>(n)});
+
+  struct Task {
+    std::uint32_t node;
+    int depth;
+  };
+  std::vector<Task> stack{{0, 0}};
+
+  struct Bin {
+    Box box;
+    std::uint32_t count{0};
+  };
+
+  while (!stack.empty()) {
+    const Task task = stack.back();
+    stack.pop_back();
+    const std::uint32_t first = nodes[task.node].first;
+    const std::uint32_t count = nodes[task.node].count;
+    const auto begin = order.begin() + first;
+    const auto end = begin + count;
+
+    Box box, centroidBox;
+    for (auto it = begin; it != end; ++it) {
+      box.expand(boxes[*it]);
+      centroidBox.expand(centroids[*it]);
+    }
+    nodes[task.node].box = box;
+    if (count <= MAX_LEAF_SIZE || task.depth >= MAX_TREE_DEPTH)
+      continue;
+
+    // binned surface area heuristic, Wald (2007)
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = INF;
+    for (int axis = 0; axis < 3; axis++) {
+      const float lower = centroidBox.lower(axis);
+      const float extent = centroidBox.upper(axis) - lower;
+      if (!(extent > 0.0f))
+        continue;
+      const float scale = SAH_BINS / extent;
+      std::array<Bin, SAH_BINS> bins;
+      for (auto it = begin; it != end; ++it) {
+        const int b = std::min(
+            SAH_BINS - 1,
+            static_cast<int>((centroids[*it](axis) - lower) * scale));
+        bins[b].box.expand(boxes[*it]);
+        bins[b].count++;
+      }
+      std::array<float, SAH_BINS> rightCost{};
+      Box right;
+      std::uint32_t rightCount = 0;
+      for (int b = SAH_BINS - 1; b > 0; b--) {
+        right.expand(bins[b].box);
+        rightCount += bins[b].count;
+        rightCost[b] = rightCount * right.area();
+      }
+      Box left;
+      std::uint32_t leftCount = 0;
+      for (int b = 1; b < SAH_BINS; b++) {
+        left.expand(bins[b - 1].box);
+        leftCount += bins[b - 1].count;
+        const float cost = leftCount * left.area() + rightCost[b];
+        if (leftCount > 0 && leftCount < count && cost < bestCost) {
+          bestCost = cost;
+          bestAxis = axis;
+          bestSplit = b;
+        }
+      }
+    }
+    // every centroid coincides, nothing to split on
+    if (bestAxis < 0)
+      continue;
+    const float area = box.area();
+    if (count <= MAX_SAH_LEAF_SIZE && area > 0.0f &&
+        bestCost / area >= static_cast<float>(count))
+      continue;
+
+    const float lower = centroidBox.lower(bestAxis);
+    const float scale =
+        SAH_BINS / (centroidBox.upper(bestAxis) - centroidBox.lower(bestAxis));
+    const auto middle = std::partition(begin, end, [&](std::uint32_t i) {
+      const int b = std::min(
+          SAH_BINS - 1,
+          static_cast<int>((centroids[i](bestAxis) - lower) * scale));
+      return b < bestSplit;
+    });
+    const auto leftCount = static_cast<std::uint32_t>(middle - begin);
+
+    const auto left = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back({{}, first, leftCount});
+    nodes.push_back({{}, first + leftCount, count - leftCount});
+    nodes[task.node].first = left;
+    nodes[task.node].count = 0;
+    stack.push_back({left + 1, task.depth + 1});
+    stack.push_back({left, task.depth + 1});
+  }
+
+  std::vector<Primitive> ordered;
+  ordered.reserve(n);
+  for (auto i : order) {
+    ordered.push_back(primitives[i]);
+  }
+  primitives = std::move(ordered);
+}
+
+bool RayTracer::Geometry::intersect(const Primitive &p, const Ray &ray,
+                                    float tMin, Hit &hit) const {
+  switch (p.kind) {
+  case Kind::Sphere: {
+    const auto &s = spheres[p.index];
+    const Vec3 oc = ray.origin - s.center;
+    const float t = nearestRoot(1.0f, oc.dot(ray.direction),
+                                oc.squaredNorm() - s.radius * s.radius, tMin,
+                                hit.t);
+    if (t == INF)
+      return false;
+    hit.t = t;
+    return true;
+  }
+  case Kind::Cylinder: {
+    const auto &c = cylinders[p.index];
+    const Vec3 oc = ray.origin - c.start;
+    const float da = ray.direction.dot(c.axis);
+    const float oa = oc.dot(c.axis);
+    // components perpendicular to the axis
+    const Vec3 d = ray.direction - da * c.axis;
+    const Vec3 o = oc - oa * c.axis;
+    float best = INF;
+    float part = 0.0f;
+    const float a = d.squaredNorm();
+    if (a > 1e-12f) {
+      const float b = o.dot(d);
+      const float discriminant = b * b - a * (o.squaredNorm() - c.radius * c.radius);
+      if (discriminant >= 0.0f) {
+        const float s = std::sqrt(discriminant);
+        for (float t : {(-b - s) / a, (-b + s) / a}) {
+          const float along = oa + t * da;
+          if (t > tMin && t < hit.t && along >= 0.0f && along <= c.length) {
+            best = t;
+            break;
+          }
+        }
+      }
+    }
+    if (std::abs(da) > 1e-12f) {
+      for (int cap = 1; cap <= 2; cap++) {
+        const float along = cap == 1 ? 0.0f : c.length;
+        const float t = (along - oa) / da;
+        if (t > tMin && t < std::min(best, hit.t) &&
+            (o + t * d).squaredNorm() <= c.radius * c.radius) {
+          best = t;
+          part = static_cast<float>(cap);
+        }
+      }
+    }
+    if (best == INF)
+      return false;
+    hit.t = best;
+    hit.u = part;
+    return true;
+  }
+  case Kind::Ellipsoid: {
+    const auto &el = ellipsoids[p.index];
+    // a unit sphere in the frame of the semi-axes
+    const Vec3 o = el.inverseAxes * (ray.origin - el.center);
+    const Vec3 d = el.inverseAxes * ray.direction;
+    const float t =
+        nearestRoot(d.squaredNorm(), o.dot(d), o.squaredNorm() - 1.0f, tMin,
+                    hit.t);
+    if (t == INF)
+      return false;
+    hit.t = t;
+    return true;
+  }
+  case Kind::Triangle: {
+    // Moller & Trumbore, double sided
+    const auto &tri = triangles[p.index];
+    const auto &positions = meshes[tri.mesh].positions;
+    const Vec3 &v0 = positions[tri.vertices[0]];
+    const Vec3 e1 = positions[tri.vertices[1]] - v0;
+    const Vec3 e2 = positions[tri.vertices[2]] - v0;
+    const Vec3 pv = ray.direction.cross(e2);
+    const float det = e1.dot(pv);
+    if (std::abs(det) < 1e-12f)
+      return false;
+    const float inverseDet = 1.0f / det;
+    const Vec3 tv = ray.origin - v0;
+    const float u = tv.dot(pv) * inverseDet;
+    if (u < 0.0f || u > 1.0f)
+      return false;
+    const Vec3 qv = tv.cross(e1);
+    const float v = ray.direction.dot(qv) * inverseDet;
+    if (v < 0.0f || u + v > 1.0f)
+      return false;
+    const float t = e2.dot(qv) * inverseDet;
+    if (!(t > tMin && t < hit.t))
+      return false;
+    hit.t = t;
+    hit.u = u;
+    hit.v = v;
+    return true;
+  }
+  }
+  return false;
+}
+
+bool RayTracer::Geometry::closestHit(const Ray &ray, float tMin, float tMax,
+                                     Hit &hit) const {
+  if (nodes.empty() || nodes[0].box.entry(ray, tMin, tMax) == INF)
+    return false;
+  hit.t = tMax;
+  bool found = false;
+  std::array<std::uint32_t, MAX_TREE_DEPTH + 2> stack;
+  int top = 0;
+  std::uint32_t current = 0;
+  while (true) {
+    const Node &node = nodes[current];
+    if (node.count > 0) {
+      for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+        if (intersect(primitives[i], ray, tMin, hit)) {
+          hit.primitive = i;
+          found = true;
+        }
+      }
+    } else {
+      // nearer child first, the other is revisited only if still in range
+      std::uint32_t near = node.first, far = node.first + 1;
+      float tNear = nodes[near].box.entry(ray, tMin, hit.t);
+      float tFar = nodes[far].box.entry(ray, tMin, hit.t);
+      if (tFar < tNear) {
+        std::swap(near, far);
+        std::swap(tNear, tFar);
+      }
+      if (tNear != INF) {
+        if (tFar != INF)
+          stack[top++] = far;
+        current = near;
+        continue;
+      }
+    }
+    // the next node still in range of the closest hit so far
+    bool more = false;
+    while (top > 0 && !more) {
+      current = stack[--top];
+      more = nodes[current].box.entry(ray, tMin, hit.t) != INF;
+    }
+    if (!more)
+      break;
+  }
+  return found;
+}
+
+bool RayTracer::Geometry::occluded(const Ray &ray, float tMin,
+                                   float tMax) const {
+  if (nodes.empty())
+    return false;
+  std::array<std::uint32_t, MAX_TREE_DEPTH + 2> stack;
+  int top = 0;
+  stack[top++] = 0;
+  Hit hit;
+  while (top > 0) {
+    const Node &node = nodes[stack[--top]];
+    if (node.box.entry(ray, tMin, tMax) == INF)
+      continue;
+    if (node.count > 0) {
+      for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+        // translucent surfaces would darken everything they enclose
+        if (isTranslucent(primitives[i]))
+          continue;
+        hit.t = tMax;
+        if (intersect(primitives[i], ray, tMin, hit))
+          return true;
+      }
+    } else {
+      stack[top++] = node.first;
+      stack[top++] = node.first + 1;
+    }
+  }
+  return false;
+}
+
+SurfacePoint RayTracer::Geometry::surface(const Hit &hit,
+                                          const Ray &ray) const {
+  SurfacePoint s;
+  s.position = ray.origin + hit.t * ray.direction;
+  const Primitive &p = primitives[hit.primitive];
+  switch (p.kind) {
+  case Kind::Sphere: {
+    const auto &sphere = spheres[p.index];
+    s.normal = (s.position - sphere.center) / sphere.radius;
+    s.color = sphere.color;
+    break;
+  }
+  case Kind::Cylinder: {
+    const auto &c = cylinders[p.index];
+    if (hit.u == 1.0f) {
+      s.normal = -c.axis;
+    } else if (hit.u == 2.0f) {
+      s.normal = c.axis;
+    } else {
+      const Vec3 r = s.position - c.start;
+      s.normal = (r - r.dot(c.axis) * c.axis).normalized();
+    }
+    s.color = c.color;
+    break;
+  }
+  case Kind::Ellipsoid: {
+    const auto &el = ellipsoids[p.index];
+    const Vec3 local = el.inverseAxes * (s.position - el.center);
+    s.normal = (el.inverseAxes.transpose() * local).normalized();
+    s.color = el.color;
+    break;
+  }
+  case Kind::Triangle: {
+    const auto &tri = triangles[p.index];
+    const auto &mesh = meshes[tri.mesh];
+    const auto [a, b, c] = tri.vertices;
+    const float w = 1.0f - hit.u - hit.v;
+    if (!mesh.normals.empty()) {
+      s.normal = w * mesh.normals[a] + hit.u * mesh.normals[b] +
+                 hit.v * mesh.normals[c];
+    }
+    if (mesh.normals.empty() || s.normal.squaredNorm() < 1e-12f) {
+      s.normal = (mesh.positions[b] - mesh.positions[a])
+                     .cross(mesh.positions[c] - mesh.positions[a]);
+    }
+    s.normal.normalize();
+    s.color = mesh.colors.empty()
+                  ? mesh.color
+                  : Vec3(w * mesh.colors[a] + hit.u * mesh.colors[b] +
+                         hit.v * mesh.colors[c]);
+    s.opacity = mesh.opacity;
+    break;
+  }
+  }
+  if (s.normal.dot(ray.direction) > 0.0f)
+    s.normal = -s.normal;
+  return s;
+}
+
+RayTracer::RayTracer(const SceneExportData &data)
+    : m_geometry(std::make_unique<Geometry>(data)) {}
+
+RayTracer::~RayTracer() = default;
+
+int RayTracer::numberOfPrimitives() const {
+  return static_cast<int>(m_geometry->primitives.size());
+}
+
+QImage RayTracer::render(const RayTracerCamera &camera,
+                         const RayTracerOptions &options) const {
+  QImage image(std::max(options.width, 1), std::max(options.height, 1),
+               QImage::Format_RGBA8888);
+  render(camera, options, [&image](const QImage &band, int firstRow) {
+    for (int y = 0; y < band.height(); y++) {
+      std::copy_n(band.constScanLine(y), band.bytesPerLine(),
+                  image.scanLine(firstRow + y));
+    }
+    return true;
+  });
+  return image;
+}
+
+bool RayTracer::render(const RayTracerCamera &camera,
+                       const RayTracerOptions &options,
+                       const BandCallback &onBand) const {
+  const Geometry &geometry = *m_geometry;
+  const int width = std::max(options.width, 1);
+  const int height = std::max(options.height, 1);
+  const int tileSize = std::max(options.tileSize, 8);
+  const int samplesAcross =
+      std::max(1, static_cast<int>(std::sqrt(
+                      static_cast<float>(std::max(options.samplesPerPixel, 1)))));
+  const int samples = samplesAcross * samplesAcross;
+  // the occlusion samples of a pixel are shared between its primary rays
+  const int occlusionSamples =
+      options.ambientOcclusionSamples > 0
+          ? std::max(1, (options.ambientOcclusionSamples + samples - 1) /
+                            samples)
+          : 0;
+
+  const Mat4 view = toMat4(camera.view);
+  const Mat4 inverseViewProjection =
+      toMat4(camera.projection * camera.view).inverse();
+  // from over the viewer's left shoulder, like the interactive view
+  const Mat3 viewRotation = view.topLeftCorner<3, 3>();
+  const Vec3 light =
+      (viewRotation.inverse() * Vec3(-0.3f, 0.4f, 1.0f)).normalized();
+  const Vec4 background(options.background.redF(),
+                        options.background.greenF(),
+                        options.background.blueF(),
+                        options.background.alphaF());
+
+  auto primaryRay = [&](float x, float y, float &tMax) {
+    const float ndcX = 2.0f * x / width - 1.0f;
+    const float ndcY = 1.0f - 2.0f * y / height;
+    Vec4 a = inverseViewProjection * Vec4(ndcX, ndcY, -1.0f, 1.0f);
+    Vec4 b = inverseViewProjection * Vec4(ndcX, ndcY, 1.0f, 1.0f);
+    a /= static_cast<float>(a.w());
+    b /= static_cast<float>(b.w());
+    // the depth range may be reversed, so start from whichever end of the
+    // clip volume is nearer the viewer
+    if (view.row(2).dot(a) < view.row(2).dot(b))
+      std::swap(a, b);
+    const Vec3 direction = (b - a).head<3>();
+    tMax = direction.norm();
+    return Ray(a.head<3>(), direction / tMax);
+  };
+
+  auto shade = [&](const SurfacePoint &s, const Ray &ray, Random &random) {
+    float occlusion = 1.0f;
+    if (occlusionSamples > 0) {
+      Vec3 b1, b2;
+      orthonormalBasis(s.normal, b1, b2);
+      const Vec3 origin = s.position + SURFACE_OFFSET * s.normal;
+      int blocked = 0;
+      for (int i = 0; i < occlusionSamples; i++) {
+        // cosine weighted over the hemisphere
+        const float phi = TWO_PI * random.next();
+        const float r2 = random.next();
+        const float r = std::sqrt(r2);
+        const Vec3 direction = r * std::cos(phi) * b1 +
+                               r * std::sin(phi) * b2 +
+                               std::sqrt(std::max(0.0f, 1.0f - r2)) * s.normal;
+        if (geometry.occluded(Ray(origin, direction), 0.0f,
+                              options.ambientOcclusionDistance))
+          blocked++;
+      }
+      occlusion = 1.0f - options.ambientOcclusionStrength * blocked /
+                             static_cast<float>(occlusionSamples);
+    }
+    const float diffuse = std::max(0.0f, s.normal.dot(light));
+    const Vec3 halfway = (light - ray.direction).normalized();
+    const float specular =
+        SPECULAR * std::pow(std::max(0.0f, s.normal.dot(halfway)), SHININESS);
+    return Vec3(s.color * ((AMBIENT + DIFFUSE * diffuse) * occlusion) +
+                Vec3::Constant(specular * occlusion));
+  };
+
+  // premultiplied colour and alpha along a primary ray
+  auto trace = [&](const Ray &ray, float tMax, Random &random) {
+    Vec3 color = Vec3::Zero();
+    float alpha = 0.0f;
+    float transmission = 1.0f;
+    float tMin = 0.0f;
+    for (int layer = 0; layer < MAX_TRANSPARENT_LAYERS; layer++) {
+      Hit hit;
+      if (!geometry.closestHit(ray, tMin, tMax, hit))
+        break;
+      const SurfacePoint s = geometry.surface(hit, ray);
+      color += transmission * s.opacity * shade(s, ray, random);
+      alpha += transmission * s.opacity;
+      transmission *= 1.0f - s.opacity;
+      if (transmission < 1.0f / 512.0f)
+        break;
+      tMin = hit.t + SURFACE_OFFSET;
+    }
+    color += transmission * background.w() * background.head<3>();
+    alpha += transmission * background.w();
+    return Vec4(color.x(), color.y(), color.z(), alpha);
+  };
+
+  auto toByte = [](float v) {
+    return static_cast<uchar>(
+        std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+  };
+
+#ifdef CX_HAS_CONCURRENT
+  QThreadPool pool;
+  if (options.threads > 0)
+    pool.setMaxThreadCount(options.threads);
+#endif
+
+  std::vector<int> tiles;
+  for (int x = 0; x < width; x += tileSize) {
+    tiles.push_back(x);
+  }
+
+  for (int firstRow = 0; firstRow < height; firstRow += tileSize) {
+    const int rows = std::min(tileSize, height - firstRow);
+    QImage band(width, rows, QImage::Format_RGBA8888);
+    // taken once, scanLine() may detach and is not safe to call concurrently
+    uchar *bits = band.bits();
+    const qsizetype bytesPerLine = band.bytesPerLine();
+
+    auto renderTile = [&](const int &firstColumn) {
+      const int columns = std::min(tileSize, width - firstColumn);
+      for (int row = 0; row < rows; row++) {
+        const int y = firstRow + row;
+        uchar *pixel = bits + row * bytesPerLine + 4 * firstColumn;
+        for (int x = firstColumn; x < firstColumn + columns; x++) {
+          Vec4 sum = Vec4::Zero();
+          for (int sample = 0; sample < samples; sample++) {
+            Random random(x, y, sample);
+            // jittered within each cell of a samplesAcross grid
+            const float sx =
+                (sample % samplesAcross + random.next()) / samplesAcross;
+            const float sy =
+                (sample / samplesAcross + random.next()) / samplesAcross;
+            float tMax = 0.0f;
+            const Ray ray = primaryRay(x + sx, y + sy, tMax);
+            sum += trace(ray, tMax, random);
+          }
+          sum /= static_cast<float>(samples);
+          const float alpha = sum.w();
+          const Vec3 color =
+              alpha > 0.0f ? Vec3(sum.head<3>() / alpha) : Vec3::Zero();
+          pixel[0] = toByte(color.x());
+          pixel[1] = toByte(color.y());
+          pixel[2] = toByte(color.z());
+          pixel[3] = toByte(alpha);
+          pixel += 4;
+        }
+      }
+    };
+
+#ifdef CX_HAS_CONCURRENT
+    QtConcurrent::blockingMap(&pool, tiles, renderTile);
+#else
+    for (int tile : tiles) {
+      renderTile(tile);
+    }
+#endif
+    if (!onBand(band, firstRow))
+      return false;
+  }
+  return true;
+}
+
+RayTracerCamera RayTracerCamera::fitting(const SceneExportData &data,
+                                         float aspect) {
+  Box box;
+  for (const auto &s : data.spheres()) {
+    const Vec3 center = toVec3(s.position);
+    Vec3 extent = Vec3::Constant(s.radius);
+    if (s.ellipsoidAxes) {
+      for (int i = 0; i < 3; i++) {
+        extent(i) = std::max(extent(i), QVector3D((*s.ellipsoidAxes)(i, 0),
+                                                  (*s.ellipsoidAxes)(i, 1),
+                                                  (*s.ellipsoidAxes)(i, 2))
+                                            .length());
+      }
+    }
+    box.expand(center - extent);
+    box.expand(center + extent);
+  }
+  for (const auto &c : data.cylinders()) {
+    const Vec3 extent = Vec3::Constant(c.radius);
+    for (const auto &end : {c.startPosition, c.endPosition}) {
+      box.expand(toVec3(end) - extent);
+      box.expand(toVec3(end) + extent);
+    }
+  }
+  for (const auto &m : data.meshes()) {
+    for (std::size_t i = 0; i + 2 < m.vertices.size(); i += 3) {
+      box.expand(Vec3(m.vertices[i], m.vertices[i + 1], m.vertices[i + 2]));
+    }
+  }
+
+  RayTracerCamera camera;
+  if (box.isEmpty())
+    return camera;
+  const Vec3 center = box.centroid();
+  // a little margin around the bounding sphere
+  const float radius =
+      std::max(0.5f * (box.upper - box.lower).norm(), 1e-3f) * 1.05f;
+  aspect = aspect > 0.0f ? aspect : 1.0f;
+  const float halfWidth = aspect >= 1.0f ? radius * aspect : radius;
+  const float halfHeight = aspect >= 1.0f ? radius : radius / aspect;
+
+  const QVector3D target(center.x(), center.y(), center.z());
+  camera.view.lookAt(target + QVector3D(0.0f, 0.0f, 2.0f * radius), target,
+                     QVector3D(0.0f, 1.0f, 0.0f));
+  camera.projection.ortho(-halfWidth, halfWidth, -halfHeight, halfHeight,
+                          radius, 3.0f * radius);
+  return camera;
+}
+
+} // namespace cx::graphics
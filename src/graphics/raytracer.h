@@ -0,0 +1,71 @@
+#pragma once
+#include "scene_export_data.h"
+#include <QColor>
+#include <QImage>
+#include <QMatrix4x4>
+#include <functional>
+#include <memory>
+
+namespace cx::graphics {
+
+struct RayTracerCamera {
+  QMatrix4x4 view;
+  QMatrix4x4 projection;
+
+  // Orthographic view down -z framing every primitive in the data, for
+  // rendering without a window
+  static RayTracerCamera fitting(const SceneExportData &data, float aspect);
+};
+
+struct RayTracerOptions {
+  int width{1024};
+  int height{1024};
+  QColor background{Qt::white};
+  int samplesPerPixel{4};          // rounded down to a square number
+  int ambientOcclusionSamples{16}; // 0 to disable ambient occlusion
+  float ambientOcclusionDistance{3.0f}; // Angstroms
+  float ambientOcclusionStrength{0.6f};
+  int tileSize{32};
+  int threads{0}; // 0 for one per core
+};
+
+/*
+ * Renders the primitives of a SceneExportData on the CPU, so that figures
+ * can be produced without an OpenGL context (e.g. on compute nodes or in
+ * tests).
+ *
+ * Spheres, capped cylinders, thermal ellipsoids and triangle meshes with
+ * per-vertex colours are placed in a bounding volume hierarchy once, after
+ * which the tracer is immutable and may render any number of views. Shading
+ * is a single key light from the viewer with hemispherical ambient
+ * occlusion, translucent meshes are blended over whatever lies behind them.
+ *
+ * Rays are generated from the inverse of a view and projection matrix, so
+ * the same matrices as the OpenGL view give the same framing, including
+ * the reversed depth range used there.
+ */
+class RayTracer {
+public:
+  explicit RayTracer(const SceneExportData &data);
+  ~RayTracer();
+
+  [[nodiscard]] int numberOfPrimitives() const;
+
+  [[nodiscard]] QImage render(const RayTracerCamera &camera,
+                              const RayTracerOptions &options) const;
+
+  // Rendered in bands of options.tileSize rows, each passed on as soon as
+  // it is finished, so large images need never be held in memory (see
+  // cx::io::StreamingImageWriter). The tiles of a band are traced in
+  // parallel. Returning false from the callback stops the render, in which
+  // case this returns false.
+  using BandCallback = std::function<bool(const QImage &band, int firstRow)>;
+  bool render(const RayTracerCamera &camera, const RayTracerOptions &options,
+              const BandCallback &onBand) const;
+
+private:
+  struct Geometry;
+  std::unique_ptr<Geometry> m_geometry;
+};
+
+} // namespace cx::graphics
@@ -10,6 +10,8 @@ struct RendererUniforms {
   float u_time{0.0f};
   float u_screenGamma{2.2f};
   QVector2D u_viewport_size{0.0f, 0.0f};
+  // larger than the viewport when an image is rendered in tiles
+  QVector2D u_image_size{0.0f, 0.0f};
   float u_ortho{1.0};
   float u_pointSize{1.0};
   int u_renderMode{0};
@@ -74,6 +76,7 @@ struct RendererUniforms {
     SET_UNIFORM(u_attenuationClamp);
 
     SET_UNIFORM(u_viewport_size);
+    SET_UNIFORM(u_image_size);
     SET_UNIFORM(u_ortho);
     SET_UNIFORM(u_time);
     SET_UNIFORM(u_screenGamma);
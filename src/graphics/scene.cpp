@@ -857,6 +857,10 @@ void Scene::updateRendererUniforms() {
   m_uniforms.u_lightingExposure = settingsExposure;
   m_uniforms.u_toneMapIdentifier = settingsToneMap;
   m_uniforms.u_viewport_size = viewportSize;
+  m_uniforms.u_image_size =
+      m_tiledImageSize.isEmpty()
+          ? viewportSize
+          : QVector2D(m_tiledImageSize.width(), m_tiledImageSize.height());
   m_uniforms.u_ortho =
       (m_camera.projectionType() == CameraProjection::Orthographic) ? 1.0f
                                                                     : 0.0f;
@@ -935,10 +939,22 @@ void Scene::ensureRenderersInitialized() {
 
 void Scene::drawChemicalStructure() {
   if (m_structureRenderer) {
+    m_structureRenderer->setDeferTransparentMeshes(m_deferTransparentMeshes);
     m_structureRenderer->draw();
   }
 }
 
+bool Scene::hasTransparentMeshes() const {
+  return m_deferTransparentMeshes && m_structureRenderer &&
+         m_structureRenderer->hasTransparentMeshes();
+}
+
+void Scene::drawTransparentMeshes() {
+  if (m_structureRenderer) {
+    m_structureRenderer->drawTransparentMeshes();
+  }
+}
+
 void Scene::drawExtras() {
   if (hasVisibleAtoms()) {
     {
@@ -1058,6 +1074,7 @@ void Scene::setRendererUniforms(QOpenGLShaderProgram *prog,
   SET_UNIFORM(u_attenuationClamp);
 
   SET_UNIFORM(u_viewport_size);
+  SET_UNIFORM(u_image_size);
   SET_UNIFORM(u_ortho);
   SET_UNIFORM(u_time);
   SET_UNIFORM(u_screenGamma);
@@ -108,6 +108,14 @@ public:
   GLfloat scale() { return m_orientation.scale(); }
   void draw();
   void drawForPicking();
+
+  // Weighted blended transparency: when deferred, draw() skips translucent
+  // mesh fragments and drawTransparentMeshes() accumulates them afterwards
+  inline void setDeferTransparentMeshes(bool defer) {
+    m_deferTransparentMeshes = defer;
+  }
+  bool hasTransparentMeshes() const;
+  void drawTransparentMeshes();
   inline auto selectionType() const { return m_selection.type; }
 
   const SelectedAtom &selectedAtom() const;
@@ -196,6 +204,10 @@ public:
 
   void setModelViewProjection(const QMatrix4x4 &, const QMatrix4x4 &,
                               const QMatrix4x4 &);
+  // Size of the whole image when the projection only covers one tile of
+  // it, so sizes meant relative to the image stay the same. Empty (the
+  // default) when drawing the full viewport.
+  inline void setTiledImageSize(const QSize &size) { m_tiledImageSize = size; }
 
   void generateAllExternalFragments();
   void generateInternalFragment();
@@ -357,6 +369,8 @@ private:
   cx::graphics::RenderSelection *m_selectionHandler{nullptr};
 
   cx::graphics::ChemicalStructureRenderer *m_structureRenderer{nullptr};
+  bool m_deferTransparentMeshes{false};
+  QSize m_tiledImageSize;
 
   FragmentColorSettings m_fragmentColorSettings;
 
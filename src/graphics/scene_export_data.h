@@ -1,8 +1,10 @@
 #pragma once
 
 #include <QColor>
+#include <QMatrix3x3>
 #include <QString>
 #include <QVector3D>
+#include <optional>
 #include <vector>
 
 namespace cx::graphics {
@@ -13,6 +15,9 @@ struct ExportSphere {
   QColor color;
   QString name;
   QString group; // e.g., "Atoms/Carbon", "Atoms/Hydrogen"
+  // Columns are the semi-axes of a thermal ellipsoid drawn in place of the
+  // sphere, formats without ellipsoids fall back to radius
+  std::optional<QMatrix3x3> ellipsoidAxes;
 };
 
 struct ExportCylinder {
@@ -2,6 +2,7 @@
 #include "shaderloader.h"
 #include <QOpenGLShaderProgram>
 #include <QUuid>
+#include <cmath>
 
 SphereImpostorRenderer::SphereImpostorRenderer()
     : m_vertex(QOpenGLBuffer::VertexBuffer) {
@@ -148,6 +149,36 @@ void SphereImpostorRenderer::setRadii(float newRadius) {
   updateBuffers();
 }
 
+void SphereImpostorRenderer::cull(const cx::graphics::Frustum &frustum,
+                                  float radiusScale) {
+  if (m_updatesDisabled)
+    return;
+  if (m_visibilityNeedsUpdate) {
+    std::vector<QVector3D> centers;
+    std::vector<float> radii;
+    centers.reserve(size());
+    radii.reserve(size());
+    for (size_t i = 0; i < size(); i++) {
+      centers.push_back(m_vertices[4 * i].position());
+      radii.push_back(std::abs(m_vertices[4 * i].radius()));
+    }
+    m_visibility.build(centers, radii);
+    m_visibilityNeedsUpdate = false;
+  }
+  if (!m_visibility.update(frustum, radiusScale))
+    return;
+
+  m_visibleIndices.clear();
+  for (uint32_t i : m_visibility.visibleItems()) {
+    m_visibleIndices.insert(m_visibleIndices.end(), m_indices.begin() + 6 * i,
+                            m_indices.begin() + 6 * i + 6);
+  }
+  m_index.bind();
+  m_index.allocate(m_visibleIndices.data(),
+                   static_cast<int>(sizeof(GLuint) * m_visibleIndices.size()));
+  m_numberOfIndices = static_cast<GLsizei>(m_visibleIndices.size());
+}
+
 void SphereImpostorRenderer::beginUpdates() { m_updatesDisabled = true; }
 
 void SphereImpostorRenderer::endUpdates() {
@@ -158,6 +189,8 @@ void SphereImpostorRenderer::endUpdates() {
 void SphereImpostorRenderer::updateBuffers() {
   if (m_updatesDisabled)
     return;
+  m_visibilityNeedsUpdate = true;
+  m_numberOfIndices = static_cast<GLsizei>(m_indices.size());
   if (!m_vertex.bind())
     qDebug() << "Failed to bind vertex buffer";
   if (!m_index.bind())
@@ -1,4 +1,5 @@
 #pragma once
+#include "frustumculling.h"
 #include "renderer.h"
 #include "sphereimpostorvertex.h"
 #include <QOpenGLBuffer>
@@ -31,6 +32,10 @@ public:
 
   void setRadii(float newRadius);
 
+  // Only draw spheres inside the frustum, radiusScale converts the vertex
+  // radii to model space as sized by the shader
+  void cull(const cx::graphics::Frustum &frustum, float radiusScale);
+
 private:
   void updateBuffers();
   QOpenGLBuffer m_vertex;
@@ -40,6 +45,10 @@ private:
   vector<GroupIndex<SphereImpostorVertex>> m_atoms;
   vector<GroupIndex<SphereImpostorVertex>> m_groups;
 
+  cx::graphics::ChunkedVisibility m_visibility;
+  bool m_visibilityNeedsUpdate{true};
+  vector<GLuint> m_visibleIndices;
+
 protected:
   bool m_impostor = true;
 };
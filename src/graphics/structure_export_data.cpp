@@ -0,0 +1,138 @@
+#include "structure_export_data.h"
+#include "chemicalstructure.h"
+#include "colormap.h"
+#include "elementdata.h"
+#include "globalconfiguration.h"
+#include "mesh.h"
+#include "settings.h"
+#include <occ/core/element.h>
+
+namespace cx::graphics {
+
+namespace {
+
+// Same as ChemicalStructureRenderer::bondThickness, without requiring
+// element data to have been loaded
+float defaultBondRadius() {
+  const float factor =
+      settings::readSetting(settings::keys::BOND_THICKNESS).toInt() / 100.0;
+  auto *hydrogen = ElementData::elementFromAtomicNumber(1);
+  const double radius = hydrogen ? hydrogen->covRadius()
+                                 : occ::core::Element(1).covalent_radius();
+  return radius * factor;
+}
+
+void addAtomsAndBonds(const ChemicalStructure &structure,
+                      SceneExportData &data) {
+  const auto &positions = structure.atomicPositions();
+  const auto covalentRadii = structure.covalentRadii();
+  const int numAtoms = structure.numberOfAtoms();
+
+  std::vector<bool> visible(numAtoms);
+  for (int i = 0; i < numAtoms; i++) {
+    auto idx = structure.indexToGenericIndex(i);
+    visible[i] = !structure.testAtomFlag(idx, AtomFlag::Suppressed);
+    if (!visible[i])
+      continue;
+
+    ExportSphere sphere;
+    sphere.position = QVector3D(positions(0, i), positions(1, i),
+                                positions(2, i));
+    sphere.radius = covalentRadii(i) * 0.5;
+    sphere.color = structure.atomColor(idx);
+    sphere.name = QString("Atom_%1").arg(i);
+    sphere.group = "Atoms";
+    data.spheres().push_back(sphere);
+  }
+
+  const float bondRadius = defaultBondRadius();
+  const auto &bonds = structure.covalentBonds();
+  for (size_t i = 0; i < bonds.size(); i++) {
+    const auto [a, b] = bonds[i];
+    if (a >= b || !visible[a] || !visible[b])
+      continue;
+    QVector3D start(positions(0, a), positions(1, a), positions(2, a));
+    QVector3D end(positions(0, b), positions(1, b), positions(2, b));
+    QVector3D mid = 0.5f * (start + end);
+
+    // half bonds in the colour of their atom
+    ExportCylinder cylinder;
+    cylinder.radius = bondRadius;
+    cylinder.group = "Bonds";
+    cylinder.startPosition = start;
+    cylinder.endPosition = mid;
+    cylinder.color = structure.atomColor(structure.indexToGenericIndex(a));
+    cylinder.name = QString("Bond_%1_A").arg(i);
+    data.cylinders().push_back(cylinder);
+
+    cylinder.startPosition = mid;
+    cylinder.endPosition = end;
+    cylinder.color = structure.atomColor(structure.indexToGenericIndex(b));
+    cylinder.name = QString("Bond_%1_B").arg(i);
+    data.cylinders().push_back(cylinder);
+  }
+}
+
+void addMesh(const Mesh &mesh, SceneExportData &data) {
+  const auto &vertices = mesh.vertices();
+  const auto &normals = mesh.vertexNormals();
+  const auto &faces = mesh.faces();
+
+  ExportMesh exportMesh;
+  exportMesh.name = mesh.objectName().isEmpty()
+                        ? QString("Surface_%1").arg(data.meshes().size())
+                        : mesh.objectName().replace(" ", "_");
+  exportMesh.group = "Surfaces";
+  exportMesh.opacity =
+      mesh.isTransparent() ? (1.0f - mesh.getTransparency()) : 1.0f;
+  exportMesh.fallbackColor = QColor(128, 128, 128);
+
+  exportMesh.vertices.reserve(vertices.size());
+  exportMesh.normals.reserve(normals.size());
+  for (int i = 0; i < vertices.cols(); i++) {
+    for (int j = 0; j < 3; j++) {
+      exportMesh.vertices.push_back(static_cast<float>(vertices(j, i)));
+      exportMesh.normals.push_back(static_cast<float>(normals(j, i)));
+    }
+  }
+  exportMesh.indices.reserve(faces.size());
+  for (int i = 0; i < faces.cols(); i++) {
+    for (int j = 0; j < 3; j++) {
+      exportMesh.indices.push_back(static_cast<uint32_t>(faces(j, i)));
+    }
+  }
+
+  // coloured as MeshInstanceRenderer does for the selected property
+  const QString &property = mesh.getSelectedProperty();
+  if (mesh.haveVertexProperty(property)) {
+    const auto &values = mesh.vertexProperty(property);
+    const auto range = mesh.vertexPropertyRange(property);
+    ColorMap cmap(
+        GlobalConfiguration::getInstance()->getColorMapNameForProperty(
+            property),
+        range.lower, range.upper);
+    exportMesh.colors.reserve(3 * values.rows());
+    for (int i = 0; i < values.rows(); i++) {
+      const QColor color = cmap(values(i));
+      exportMesh.colors.push_back(color.redF());
+      exportMesh.colors.push_back(color.greenF());
+      exportMesh.colors.push_back(color.blueF());
+    }
+  }
+  data.meshes().push_back(std::move(exportMesh));
+}
+
+} // namespace
+
+SceneExportData structureExportData(const ChemicalStructure &structure) {
+  SceneExportData data;
+  addAtomsAndBonds(structure, data);
+  for (auto *child : structure.children()) {
+    auto *mesh = qobject_cast<Mesh *>(child);
+    if (mesh && mesh->isVisible() && mesh->numberOfVertices() > 0)
+      addMesh(*mesh, data);
+  }
+  return data;
+}
+
+} // namespace cx::graphics
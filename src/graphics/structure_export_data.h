@@ -0,0 +1,18 @@
+#pragma once
+#include "scene_export_data.h"
+
+class ChemicalStructure;
+
+namespace cx::graphics {
+
+/*
+ * Primitives for a structure in the default ball and stick style, with each
+ * visible surface on the structure coloured by its selected property.
+ *
+ * Unlike Scene::getExportData this needs no renderers, and so no OpenGL
+ * context, for producing figures headless (e.g. in batch jobs) with the
+ * RayTracer or the glTF exporter.
+ */
+SceneExportData structureExportData(const ChemicalStructure &structure);
+
+} // namespace cx::graphics
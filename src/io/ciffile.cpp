@@ -1,13 +1,19 @@
 #include "ciffile.h"
 #include <QByteArray>
+#include <QFile>
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <gemmi/cif.hpp>
 #include <gemmi/numb.hpp>
 #include <gemmi/symmetry.hpp>
 #include <gemmi/to_cif.hpp>
 
+#ifdef CX_HAS_CONCURRENT
+#include <QtConcurrent>
+#endif
+
 struct CifAtomData {
   std::string element;
   std::string siteLabel;
@@ -272,13 +278,18 @@ QByteArray blockToQByteArray(
   return QByteArray::fromStdString(ss.str());
 }
 
-std::vector<CifCrystalData> readDocument(gemmi::cif::Document &document) {
+std::vector<CifCrystalData>
+readDocument(gemmi::cif::Document &document,
+             const QByteArray *singleBlockContents = nullptr) {
   std::vector<CifCrystalData> result;
   int blockNumber = 0;
+  if (document.blocks.size() != 1)
+    singleBlockContents = nullptr;
   for (const auto &block : document.blocks) {
     CifCrystalData cifData;
 
-    cifData.cifContents = blockToQByteArray(block);
+    cifData.cifContents = singleBlockContents ? *singleBlockContents
+                                              : blockToQByteArray(block);
     cifData.name = QString::fromStdString(block.name);
     for (const auto &item : block.items) {
       switch (item.type) {
@@ -470,6 +481,27 @@ bool CifFile::readFromString(const QString &content) {
   return true;
 }
 
+bool CifFile::readFromBlockContents(const QByteArray &content) {
+  gemmi::cif::Document document;
+  try {
+    document = gemmi::cif::read_memory(content.constData(), content.size(),
+                                       "block");
+  } catch (std::runtime_error &e) {
+    qDebug() << "Error reading cif" << e.what();
+    return false;
+  }
+  std::vector<CifCrystalData> crystals = readDocument(document, &content);
+  for (const auto &crystal : crystals) {
+    m_crystals.emplace_back(
+        occ::crystal::Crystal(buildAsymmetricUnit(crystal.atoms, crystal.adps),
+                              buildSpacegroup(crystal.symmetryData),
+                              buildUnitCell(crystal.cellData)));
+    m_crystalCifContents.push_back(crystal.cifContents);
+    m_crystalNames.push_back(crystal.name);
+  }
+  return true;
+}
+
 int CifFile::numberOfCrystals() const { return m_crystals.size(); }
 
 const OccCrystal &CifFile::getCrystalStructure(int index) const {
@@ -483,3 +515,162 @@ const QByteArray &CifFile::getCrystalCifContents(int index) const {
 const QString &CifFile::getCrystalName(int index) const {
   return m_crystalNames.at(index);
 }
+
+namespace {
+
+// Offsets of each line starting a data block, ignoring text fields
+std::vector<qint64> findBlockStarts(const char *data, qint64 size) {
+  std::vector<qint64> starts;
+  bool inTextField = false;
+  qint64 pos = 0;
+  while (pos < size) {
+    const char *line = data + pos;
+    const char *newline =
+        static_cast<const char *>(std::memchr(line, '\n', size - pos));
+    const qint64 length = newline ? newline - line : size - pos;
+    if (length > 0 && line[0] == ';') {
+      inTextField = !inTextField;
+    } else if (!inTextField) {
+      qint64 i = 0;
+      while (i < length && (line[i] == ' ' || line[i] == '\t'))
+        i++;
+      if (length - i >= 5 && qstrnicmp(line + i, "data_", 5) == 0)
+        starts.push_back(pos);
+    }
+    pos += length + 1;
+  }
+  return starts;
+}
+
+// Only the handful of values shown when browsing are extracted
+CifBlockSummary summariseBlock(const char *data, qint64 size) {
+  CifBlockSummary summary;
+  try {
+    gemmi::cif::Document document =
+        gemmi::cif::read_memory(data, size, "block");
+    if (document.blocks.empty())
+      return summary;
+    auto &block = document.blocks.front();
+    summary.name = QString::fromStdString(block.name);
+
+    auto number = [&block](const char *tag) {
+      const std::string *value = block.find_value(tag);
+      if (!value || gemmi::cif::is_null(*value))
+        return 0.0;
+      return gemmi::cif::as_number(*value, 0.0);
+    };
+    auto text = [&block](std::initializer_list<const char *> tags) {
+      for (const char *tag : tags) {
+        const std::string *value = block.find_value(tag);
+        if (value && !gemmi::cif::is_null(*value))
+          return QString::fromStdString(gemmi::cif::as_string(*value))
+              .simplified();
+      }
+      return QString();
+    };
+
+    summary.cell = {number("_cell_length_a"),    number("_cell_length_b"),
+                    number("_cell_length_c"),    number("_cell_angle_alpha"),
+                    number("_cell_angle_beta"), number("_cell_angle_gamma")};
+    summary.formula =
+        text({"_chemical_formula_sum", "_chemical_formula_moiety"});
+    summary.spaceGroup = text({"_space_group_name_H-M_alt",
+                               "_symmetry_space_group_name_H-M",
+                               "_space_group_name_Hall",
+                               "_symmetry_space_group_name_Hall"});
+    summary.numberOfAtomSites =
+        static_cast<int>(block.find_values("_atom_site_fract_x").length());
+  } catch (std::runtime_error &e) {
+    qDebug() << "Error reading cif block" << e.what();
+  }
+  return summary;
+}
+
+} // namespace
+
+bool CifCatalogue::indexFile(const QString &fileName) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qDebug() << "Unable to open" << fileName;
+    return false;
+  }
+  m_fileName = fileName;
+  m_contents.clear();
+
+  // mapping avoids holding a copy of the whole file while indexing
+  const qint64 size = file.size();
+  uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+  if (mapped) {
+    index(reinterpret_cast<const char *>(mapped), size);
+    file.unmap(mapped);
+  } else {
+    const QByteArray contents = file.readAll();
+    index(contents.constData(), contents.size());
+  }
+  return !m_blocks.empty();
+}
+
+bool CifCatalogue::indexContents(const QByteArray &contents) {
+  m_fileName.clear();
+  m_contents = contents;
+  index(m_contents.constData(), m_contents.size());
+  return !m_blocks.empty();
+}
+
+void CifCatalogue::index(const char *data, qint64 size) {
+  m_blocks.clear();
+  const std::vector<qint64> starts = findBlockStarts(data, size);
+  m_blocks.reserve(starts.size());
+  for (size_t i = 0; i < starts.size(); i++) {
+    const qint64 end = i + 1 < starts.size() ? starts[i + 1] : size;
+    m_blocks.push_back({starts[i], end - starts[i]});
+  }
+
+  auto summarise = [data](const BlockRange &range) {
+    return summariseBlock(data + range.offset, range.size);
+  };
+#ifdef CX_HAS_CONCURRENT
+  m_summaries =
+      QtConcurrent::blockingMapped<std::vector<CifBlockSummary>>(m_blocks,
+                                                                 summarise);
+#else
+  m_summaries.clear();
+  m_summaries.reserve(m_blocks.size());
+  for (const auto &range : m_blocks) {
+    m_summaries.push_back(summarise(range));
+  }
+#endif
+}
+
+const CifBlockSummary &CifCatalogue::summary(int index) const {
+  return m_summaries.at(index);
+}
+
+int CifCatalogue::firstValidBlock() const {
+  for (int i = 0; i < numberOfBlocks(); i++) {
+    if (m_summaries[i].isValid())
+      return i;
+  }
+  return -1;
+}
+
+QByteArray CifCatalogue::blockContents(int index) const {
+  const BlockRange &range = m_blocks.at(index);
+  if (m_fileName.isEmpty())
+    return m_contents.mid(range.offset, range.size);
+
+  QFile file(m_fileName);
+  if (!file.open(QIODevice::ReadOnly) || !file.seek(range.offset)) {
+    qDebug() << "Unable to read block" << index << "from" << m_fileName;
+    return {};
+  }
+  return file.read(range.size);
+}
+
+bool CifCatalogue::readBlock(int index, CifFile &destination) const {
+  const QByteArray contents = blockContents(index);
+  if (contents.isEmpty())
+    return false;
+  return destination.readFromBlockContents(contents) &&
+         destination.numberOfCrystals() > 0;
+}
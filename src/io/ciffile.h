@@ -3,6 +3,7 @@
 #include <QDebug>
 #include <QStringList>
 #include <QVector3D>
+#include <array>
 #include <occ/crystal/crystal.h>
 
 using OccCrystal = occ::crystal::Crystal;
@@ -12,6 +13,9 @@ public:
   CifFile() = default;
   bool readFromFile(const QString &fileName);
   bool readFromString(const QString &content);
+  // Contents of a single data block are kept as they are rather than being
+  // written out again from the parsed block
+  bool readFromBlockContents(const QByteArray &content);
 
   int numberOfCrystals() const;
 
@@ -24,3 +28,52 @@ private:
   std::vector<QByteArray> m_crystalCifContents;
   std::vector<QString> m_crystalNames;
 };
+
+struct CifBlockSummary {
+  QString name;
+  QString formula;
+  QString spaceGroup;
+  // a, b, c in Angstroms then alpha, beta, gamma in degrees
+  std::array<double, 6> cell{0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  int numberOfAtomSites{0};
+
+  // cell and atom sites present, space group is checked when the block is read
+  inline bool isValid() const {
+    return cell[0] > 0.0 && cell[1] > 0.0 && cell[2] > 0.0 &&
+           numberOfAtomSites > 0;
+  }
+};
+
+// Index of the data blocks in a CIF, for files with many structures (e.g.
+// CSP landscapes or database exports). Only the name, cell, formula and space
+// group of each block are read up front, and the block offsets are kept
+// rather than its contents, so a block is read again from the file and turned
+// into a crystal only when it is needed.
+class CifCatalogue {
+public:
+  CifCatalogue() = default;
+  bool indexFile(const QString &fileName);
+  bool indexContents(const QByteArray &contents);
+
+  inline int numberOfBlocks() const { return m_summaries.size(); }
+  inline const QString &fileName() const { return m_fileName; }
+  const CifBlockSummary &summary(int index) const;
+  // -1 if there are no valid blocks
+  int firstValidBlock() const;
+
+  QByteArray blockContents(int index) const;
+  bool readBlock(int index, CifFile &destination) const;
+
+private:
+  struct BlockRange {
+    qint64 offset{0};
+    qint64 size{0};
+  };
+
+  void index(const char *data, qint64 size);
+
+  QString m_fileName;
+  QByteArray m_contents; // only kept when indexed from memory
+  std::vector<BlockRange> m_blocks;
+  std::vector<CifBlockSummary> m_summaries;
+};
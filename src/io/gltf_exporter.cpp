@@ -10,6 +10,7 @@
 #include "mesh.h"
 #include "meshinstance.h"
 #include "scene.h"
+#include "scene_export_data.h"
 #include "settings.h"
 
 #include <QBuffer>
@@ -21,10 +22,57 @@
 #include <algorithm>
 #include <ankerl/unordered_dense.h>
 #include <cmath>
+#include <cstdint>
 #include <unordered_set>
 
 namespace cx::core {
 
+namespace {
+
+constexpr const char *GPU_INSTANCING_EXTENSION = "EXT_mesh_gpu_instancing";
+constexpr const char *MESH_QUANTIZATION_EXTENSION = "KHR_mesh_quantization";
+
+// instancing attributes have no fallback, so viewers must support them
+void requireExtension(fastgltf::Asset &asset, const std::string &name) {
+  auto contains = [&name](const auto &list) {
+    return std::find(list.begin(), list.end(), name) != list.end();
+  };
+  if (!contains(asset.extensionsUsed))
+    asset.extensionsUsed.push_back(name);
+  if (!contains(asset.extensionsRequired))
+    asset.extensionsRequired.push_back(name);
+}
+
+// Quaternion (x, y, z, w) rotating the cylinder mesh axis (+Z) onto direction
+std::array<float, 4> rotationFromZAxis(QVector3D direction) {
+  direction.normalize();
+  const QVector3D defaultDirection(0.0f, 0.0f, 1.0f);
+  QVector3D axis = QVector3D::crossProduct(defaultDirection, direction);
+  float dot = QVector3D::dotProduct(defaultDirection, direction);
+  if (axis.length() > 0.001f) {
+    axis.normalize();
+    float angle = std::acos(std::clamp(dot, -1.0f, 1.0f));
+    float s = std::sin(angle * 0.5f);
+    return {axis.x() * s, axis.y() * s, axis.z() * s, std::cos(angle * 0.5f)};
+  }
+  // Parallel or anti-parallel
+  if (dot < 0)
+    return {1.0f, 0.0f, 0.0f, 0.0f};
+  return {0.0f, 0.0f, 0.0f, 1.0f};
+}
+
+template <typename T> void appendValue(std::vector<std::byte> &bytes, T value) {
+  const auto *data = reinterpret_cast<const std::byte *>(&value);
+  bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+int16_t quantizeShort(float value) {
+  return static_cast<int16_t>(
+      std::lround(std::clamp(value, -32767.0f, 32767.0f)));
+}
+
+} // namespace
+
 GLTFExporter::GLTFExporter() {
   // Read material properties from settings
   m_materialRoughness =
@@ -34,36 +82,12 @@ GLTFExporter::GLTFExporter() {
 }
 
 void GLTFExporter::loadIcosphereMesh() {
-  QFile obj(":/mesh/icosphere.obj");
-  if (!obj.open(QIODevice::ReadOnly)) {
-    qWarning() << "Failed to open icosphere.obj";
-    return;
-  }
-
-  QTextStream stream(&obj);
-  QString line;
-  while (stream.readLineInto(&line)) {
-    if (line.startsWith('v')) {
-      QStringList tokens = line.split(' ');
-      if (tokens.size() >= 4) {
-        m_sphereVertices.push_back(tokens[1].toFloat());
-        m_sphereVertices.push_back(tokens[2].toFloat());
-        m_sphereVertices.push_back(tokens[3].toFloat());
-      }
-    } else if (line.startsWith('f')) {
-      QStringList tokens = line.split(' ');
-      if (tokens.size() >= 4) {
-        m_sphereIndices.push_back(tokens[1].toUInt() - 1);
-        m_sphereIndices.push_back(tokens[2].toUInt() - 1);
-        m_sphereIndices.push_back(tokens[3].toUInt() - 1);
-      }
-    }
-  }
-  qDebug() << "Loaded icosphere:" << m_sphereVertices.size() / 3 << "vertices,"
-           << m_sphereIndices.size() / 3 << "triangles";
+  m_sphere = cx::primitives::icosphere(3);
 }
 
 void GLTFExporter::loadCylinderMesh() {
+  m_cylinderVertices.clear();
+  m_cylinderIndices.clear();
   QFile obj(":/mesh/cylinder.obj");
   if (!obj.open(QIODevice::ReadOnly)) {
     qWarning() << "Failed to open cylinder.obj";
@@ -100,12 +124,14 @@ void GLTFExporter::addAtomsToAsset(
     const ExportOptions &options) {
   // Convert vertex data to bytes (copying from wad2gltf pattern)
   std::vector<uint8_t> vertexBytes;
-  vertexBytes.resize(m_sphereVertices.size() * sizeof(float));
-  std::memcpy(vertexBytes.data(), m_sphereVertices.data(), vertexBytes.size());
+  vertexBytes.resize(m_sphere->vertexData.size() * sizeof(float));
+  std::memcpy(vertexBytes.data(), m_sphere->vertexData.data(),
+              vertexBytes.size());
 
   std::vector<uint8_t> indexBytes;
-  indexBytes.resize(m_sphereIndices.size() * sizeof(uint32_t));
-  std::memcpy(indexBytes.data(), m_sphereIndices.data(), indexBytes.size());
+  indexBytes.resize(m_sphere->indexData.size() * sizeof(uint32_t));
+  std::memcpy(indexBytes.data(), m_sphere->indexData.data(),
+              indexBytes.size());
 
   // Create buffers exactly like wad2gltf
   auto &vertexBuffer = asset.buffers.emplace_back();
@@ -146,14 +172,14 @@ void GLTFExporter::addAtomsToAsset(
   positionAccessor.bufferViewIndex =
       asset.bufferViews.size() - 2; // vertex buffer view
   positionAccessor.componentType = fastgltf::ComponentType::Float;
-  positionAccessor.count = m_sphereVertices.size() / 3;
+  positionAccessor.count = m_sphere->numberOfVertices();
   positionAccessor.type = fastgltf::AccessorType::Vec3;
 
   auto &indexAccessor = asset.accessors.emplace_back();
   indexAccessor.bufferViewIndex =
       asset.bufferViews.size() - 1; // index buffer view
   indexAccessor.componentType = fastgltf::ComponentType::UnsignedInt;
-  indexAccessor.count = m_sphereIndices.size();
+  indexAccessor.count = m_sphere->indexData.size();
   indexAccessor.type = fastgltf::AccessorType::Scalar;
 
   // Create materials and meshes for each element type
@@ -183,6 +209,20 @@ void GLTFExporter::addAtomsToAsset(
     primitive.indicesAccessor = asset.accessors.size() - 1; // index accessor
     primitive.materialIndex = asset.materials.size() - 1;
 
+    if (options.gpuInstancing) {
+      std::vector<InstanceTransform> instances;
+      instances.reserve(atoms.size());
+      for (const auto &[position, radius] : atoms) {
+        instances.push_back({position,
+                             {0.0f, 0.0f, 0.0f, 1.0f},
+                             QVector3D(radius, radius, radius)});
+      }
+      addInstancedNode(asset, asset.meshes.size() - 1,
+                       element->symbol().toStdString() + "_atoms", instances,
+                       false, options);
+      continue;
+    }
+
     // Create nodes for each atom instance
     for (const auto &[position, radius] : atoms) {
       auto &node = asset.nodes.emplace_back();
@@ -213,7 +253,14 @@ bool GLTFExporter::exportScene(const Scene *scene, const QString &filePath,
   }
 
   // Get export data from scene
-  auto exportData = scene->getExportData();
+  return exportSceneData(scene->getExportData(), filePath, options);
+}
+
+bool GLTFExporter::exportSceneData(
+    const cx::graphics::SceneExportData &exportData, const QString &filePath,
+    const ExportOptions &options) {
+  m_instanceBytes.clear();
+  m_instanceBufferIndex.reset();
 
   // Load primitive meshes
   loadIcosphereMesh();
@@ -252,6 +299,7 @@ bool GLTFExporter::exportScene(const Scene *scene, const QString &filePath,
   if (options.exportMeshes && !exportData.meshes().empty()) {
     addMeshesToAsset(asset, exportData.meshes(), options);
   }
+  finishInstanceBuffer(asset);
 
   // Write file
   fastgltf::FileExporter exporter;
@@ -288,16 +336,19 @@ bool GLTFExporter::exportStructure(const ChemicalStructure *structure,
   }
 
   // Load meshes if needed
-  if (m_sphereVertices.empty()) {
+  if (!m_sphere) {
     loadIcosphereMesh();
     loadCylinderMesh();
   }
 
-  if (m_sphereVertices.empty()) {
+  if (!m_sphere) {
     qWarning() << "GLTFExporter: Failed to load sphere mesh";
     return false;
   }
 
+  m_instanceBytes.clear();
+  m_instanceBufferIndex.reset();
+
   // Create fastgltf asset
   fastgltf::Asset asset;
   asset.assetInfo =
@@ -310,6 +361,7 @@ bool GLTFExporter::exportStructure(const ChemicalStructure *structure,
 
   // Always use fragment-based approach for proper hierarchy
   addStructureByFragments(asset, structure, options, scene);
+  finishInstanceBuffer(asset);
 
   // Write file
   fastgltf::FileExporter exporter;
@@ -437,6 +489,8 @@ void GLTFExporter::addBondsToAsset(fastgltf::Asset &asset,
   indexAccessor.componentType = fastgltf::ComponentType::UnsignedInt;
   indexAccessor.count = m_cylinderIndices.size();
   indexAccessor.type = fastgltf::AccessorType::Scalar;
+  const size_t positionAccessorIndex = asset.accessors.size() - 2;
+  const size_t indexAccessorIndex = asset.accessors.size() - 1;
 
   // Create bond mesh (shared by all half-bonds)
   auto &bondMesh = asset.meshes.emplace_back();
@@ -451,6 +505,8 @@ void GLTFExporter::addBondsToAsset(fastgltf::Asset &asset,
 
   // Collect unique element colors and create materials for them
   ankerl::unordered_dense::map<QRgb, size_t> colorToMaterialIndex;
+  ankerl::unordered_dense::map<size_t, std::vector<InstanceTransform>>
+      halfBondsByMaterial;
   const auto &positions = structure->atomicPositions();
   const auto &atomicNumbers = structure->atomicNumbers();
 
@@ -510,6 +566,13 @@ void GLTFExporter::addBondsToAsset(fastgltf::Asset &asset,
         colorToMaterialIndex[colorKey] = materialIndex;
       }
 
+      if (options.gpuInstancing) {
+        halfBondsByMaterial[materialIndex].push_back(
+            {halfBondCenter, rotationFromZAxis(bondVector),
+             QVector3D(bondRadius, bondRadius, halfBondLength)});
+        continue;
+      }
+
       // Create mesh instance with this material
       auto &halfMesh = asset.meshes.emplace_back();
       halfMesh.name = "Half Bond Cylinder";
@@ -558,6 +621,22 @@ void GLTFExporter::addBondsToAsset(fastgltf::Asset &asset,
     }
   }
 
+  // One mesh and instanced node per bond color
+  for (const auto &[materialIndex, instances] : halfBondsByMaterial) {
+    auto &halfMesh = asset.meshes.emplace_back();
+    halfMesh.name = "Half Bond Cylinders";
+
+    auto &halfPrimitive = halfMesh.primitives.emplace_back();
+    halfPrimitive.type = fastgltf::PrimitiveType::Triangles;
+    halfPrimitive.attributes.emplace_back("POSITION",
+                                          positionAccessorIndex);
+    halfPrimitive.indicesAccessor = indexAccessorIndex;
+    halfPrimitive.materialIndex = materialIndex;
+
+    addInstancedNode(asset, asset.meshes.size() - 1, "Half Bonds", instances,
+                     true, options);
+  }
+
   qDebug() << "Added" << bonds.size() << "bonds to GLTF asset";
 }
 
@@ -944,6 +1023,144 @@ void GLTFExporter::addFrameworkToAsset(fastgltf::Asset &asset,
   qDebug() << "Added" << tubeCount << "framework tubes to GLTF asset";
 }
 
+void GLTFExporter::addInstancedNode(
+    fastgltf::Asset &asset, size_t meshIndex, const std::string &name,
+    const std::vector<InstanceTransform> &instances, bool withRotation,
+    const ExportOptions &options) {
+  if (instances.empty())
+    return;
+  requireExtension(asset, GPU_INSTANCING_EXTENSION);
+
+  // Quantized translations are 16-bit offsets from the centre of the group,
+  // the node transform maps them back to world space. Instance scales are
+  // divided by the node scale to compensate.
+  const bool quantize = options.quantizeInstances;
+  QVector3D origin(0.0f, 0.0f, 0.0f);
+  float step = 1.0f;
+  if (quantize) {
+    requireExtension(asset, MESH_QUANTIZATION_EXTENSION);
+    QVector3D lower = instances[0].translation;
+    QVector3D upper = lower;
+    for (const auto &instance : instances) {
+      const auto &t = instance.translation;
+      lower = QVector3D(std::min(lower.x(), t.x()), std::min(lower.y(), t.y()),
+                        std::min(lower.z(), t.z()));
+      upper = QVector3D(std::max(upper.x(), t.x()), std::max(upper.y(), t.y()),
+                        std::max(upper.z(), t.z()));
+    }
+    origin = (lower + upper) * 0.5f;
+    const QVector3D halfExtent = (upper - lower) * 0.5f;
+    const float maxHalfExtent =
+        std::max({halfExtent.x(), halfExtent.y(), halfExtent.z()});
+    if (maxHalfExtent > 0.0f)
+      step = maxHalfExtent / 32767.0f;
+  }
+
+  std::vector<std::byte> translations, rotations, scales;
+  translations.reserve(instances.size() * (quantize ? 8 : 12));
+  scales.reserve(instances.size() * 12);
+  if (withRotation)
+    rotations.reserve(instances.size() * (quantize ? 8 : 16));
+
+  for (const auto &instance : instances) {
+    if (quantize) {
+      const QVector3D q = (instance.translation - origin) / step;
+      appendValue(translations, quantizeShort(q.x()));
+      appendValue(translations, quantizeShort(q.y()));
+      appendValue(translations, quantizeShort(q.z()));
+      appendValue(translations, int16_t{0}); // pad to a 4 byte stride
+    } else {
+      appendValue(translations, instance.translation.x());
+      appendValue(translations, instance.translation.y());
+      appendValue(translations, instance.translation.z());
+    }
+    if (withRotation) {
+      for (float component : instance.rotation) {
+        if (quantize)
+          appendValue(rotations, quantizeShort(component * 32767.0f));
+        else
+          appendValue(rotations, component);
+      }
+    }
+    appendValue(scales, instance.scale.x() / step);
+    appendValue(scales, instance.scale.y() / step);
+    appendValue(scales, instance.scale.z() / step);
+  }
+
+  const size_t translationAccessor = addInstanceAccessor(
+      asset, translations, instances.size(), 3, quantize);
+  const size_t scaleAccessor =
+      addInstanceAccessor(asset, scales, instances.size(), 3, false);
+  std::optional<size_t> rotationAccessor;
+  if (withRotation)
+    rotationAccessor = addInstanceAccessor(asset, rotations, instances.size(),
+                                           4, quantize);
+
+  auto &node = asset.nodes.emplace_back();
+  node.name = name;
+  node.meshIndex = meshIndex;
+  fastgltf::TRS trs;
+  trs.translation = {origin.x(), origin.y(), origin.z()};
+  trs.rotation = fastgltf::math::fquat(0.0f, 0.0f, 0.0f, 1.0f);
+  trs.scale = {step, step, step};
+  node.transform = trs;
+  node.instancingAttributes.emplace_back("TRANSLATION", translationAccessor);
+  node.instancingAttributes.emplace_back("SCALE", scaleAccessor);
+  if (rotationAccessor)
+    node.instancingAttributes.emplace_back("ROTATION", *rotationAccessor);
+
+  if (!asset.scenes.empty()) {
+    asset.scenes[0].nodeIndices.push_back(asset.nodes.size() - 1);
+  }
+}
+
+size_t GLTFExporter::addInstanceAccessor(fastgltf::Asset &asset,
+                                         const std::vector<std::byte> &bytes,
+                                         size_t count, int components,
+                                         bool quantized) {
+  if (!m_instanceBufferIndex) {
+    auto &buffer = asset.buffers.emplace_back();
+    buffer.name = "instances";
+    m_instanceBufferIndex = asset.buffers.size() - 1;
+  }
+
+  // keep every view 4 byte aligned
+  m_instanceBytes.resize((m_instanceBytes.size() + 3) & ~size_t{3});
+
+  auto &bufferView = asset.bufferViews.emplace_back();
+  bufferView.bufferIndex = *m_instanceBufferIndex;
+  bufferView.byteOffset = m_instanceBytes.size();
+  bufferView.byteLength = bytes.size();
+  if (quantized)
+    bufferView.byteStride = 4 * sizeof(int16_t);
+  m_instanceBytes.insert(m_instanceBytes.end(), bytes.begin(), bytes.end());
+
+  auto &accessor = asset.accessors.emplace_back();
+  accessor.bufferViewIndex = asset.bufferViews.size() - 1;
+  accessor.count = count;
+  accessor.type = components == 4 ? fastgltf::AccessorType::Vec4
+                                  : fastgltf::AccessorType::Vec3;
+  accessor.componentType = quantized ? fastgltf::ComponentType::Short
+                                     : fastgltf::ComponentType::Float;
+  // quantized rotations (the only VEC4 attribute) are unit normalized,
+  // quantized translations are plain integers scaled by the node transform
+  accessor.normalized = quantized && components == 4;
+  return asset.accessors.size() - 1;
+}
+
+void GLTFExporter::finishInstanceBuffer(fastgltf::Asset &asset) {
+  if (m_instanceBufferIndex) {
+    auto &buffer = asset.buffers[*m_instanceBufferIndex];
+    buffer.byteLength = m_instanceBytes.size();
+    buffer.data = fastgltf::sources::Array{
+        .bytes = fastgltf::StaticVector<std::byte>::fromVector(m_instanceBytes)};
+    qDebug() << "Wrote" << m_instanceBytes.size()
+             << "bytes of instancing attributes";
+  }
+  m_instanceBytes.clear();
+  m_instanceBufferIndex.reset();
+}
+
 void GLTFExporter::addCameraToAsset(fastgltf::Asset &asset,
                                     const cx::graphics::ExportCamera &camera) {
   // TODO: Camera export is currently broken, needs investigation
@@ -1030,12 +1247,14 @@ void GLTFExporter::addSpheresToAsset(
 
   // Convert vertex data to bytes
   std::vector<uint8_t> vertexBytes;
-  vertexBytes.resize(m_sphereVertices.size() * sizeof(float));
-  std::memcpy(vertexBytes.data(), m_sphereVertices.data(), vertexBytes.size());
+  vertexBytes.resize(m_sphere->vertexData.size() * sizeof(float));
+  std::memcpy(vertexBytes.data(), m_sphere->vertexData.data(),
+              vertexBytes.size());
 
   std::vector<uint8_t> indexBytes;
-  indexBytes.resize(m_sphereIndices.size() * sizeof(uint32_t));
-  std::memcpy(indexBytes.data(), m_sphereIndices.data(), indexBytes.size());
+  indexBytes.resize(m_sphere->indexData.size() * sizeof(uint32_t));
+  std::memcpy(indexBytes.data(), m_sphere->indexData.data(),
+              indexBytes.size());
 
   // Create buffers
   auto &vertexBuffer = asset.buffers.emplace_back();
@@ -1071,13 +1290,13 @@ void GLTFExporter::addSpheresToAsset(
   auto &positionAccessor = asset.accessors.emplace_back();
   positionAccessor.bufferViewIndex = asset.bufferViews.size() - 2;
   positionAccessor.componentType = fastgltf::ComponentType::Float;
-  positionAccessor.count = m_sphereVertices.size() / 3;
+  positionAccessor.count = m_sphere->numberOfVertices();
   positionAccessor.type = fastgltf::AccessorType::Vec3;
 
   auto &indexAccessor = asset.accessors.emplace_back();
   indexAccessor.bufferViewIndex = asset.bufferViews.size() - 1;
   indexAccessor.componentType = fastgltf::ComponentType::UnsignedInt;
-  indexAccessor.count = m_sphereIndices.size();
+  indexAccessor.count = m_sphere->indexData.size();
   indexAccessor.type = fastgltf::AccessorType::Scalar;
 
   // Group spheres by element for materials
@@ -1115,6 +1334,21 @@ void GLTFExporter::addSpheresToAsset(
     primitive.indicesAccessor = asset.accessors.size() - 1;
     primitive.materialIndex = asset.materials.size() - 1;
 
+    if (options.gpuInstancing) {
+      std::vector<InstanceTransform> instances;
+      instances.reserve(groupSpheres.size());
+      for (const auto *sphere : groupSpheres) {
+        float radius = sphere->radius * options.atomRadiusScale;
+        instances.push_back({sphere->position,
+                             {0.0f, 0.0f, 0.0f, 1.0f},
+                             QVector3D(radius, radius, radius)});
+      }
+      addInstancedNode(asset, asset.meshes.size() - 1,
+                       "Spheres_" + group.toStdString(), instances, false,
+                       options);
+      continue;
+    }
+
     // Create instances for each sphere in this group
     for (const auto *sphere : groupSpheres) {
       auto &node = asset.nodes.emplace_back();
@@ -1232,6 +1466,25 @@ void GLTFExporter::addCylindersToAsset(
     primitive.indicesAccessor = asset.accessors.size() - 1;
     primitive.materialIndex = asset.materials.size() - 1;
 
+    if (options.gpuInstancing) {
+      std::vector<InstanceTransform> instances;
+      instances.reserve(colorCylinders.size());
+      for (const auto *cylinder : colorCylinders) {
+        QVector3D direction = cylinder->endPosition - cylinder->startPosition;
+        float length = direction.length();
+        if (length <= 0.0f)
+          continue;
+        float radius = cylinder->radius * options.bondRadiusScale;
+        instances.push_back(
+            {(cylinder->startPosition + cylinder->endPosition) / 2.0f,
+             rotationFromZAxis(direction), QVector3D(radius, radius, length)});
+      }
+      addInstancedNode(asset, asset.meshes.size() - 1,
+                       QString("Cylinders_%1").arg(color.name()).toStdString(),
+                       instances, true, options);
+      continue;
+    }
+
     // Create instances for each cylinder with this color
     for (const auto *cylinder : colorCylinders) {
       auto &node = asset.nodes.emplace_back();
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "geometry_primitives.h"
 #include <QColor>
 #include <QString>
 #include <QVector3D>
 #include <ankerl/unordered_dense.h>
+#include <array>
+#include <cstddef>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 class Scene;
@@ -17,6 +22,7 @@ struct ExportSphere;
 struct ExportCylinder;
 struct ExportMesh;
 struct ExportCamera;
+class SceneExportData;
 } // namespace cx::graphics
 
 namespace fastgltf {
@@ -34,6 +40,10 @@ namespace cx::core {
  * - Mesh surfaces with colors and transparency
  * - Framework tubes and structures
  * - Materials and lighting information
+ *
+ * With ExportOptions::gpuInstancing, atoms, bonds and cylinders are written
+ * as one node per material group carrying EXT_mesh_gpu_instancing
+ * attributes, rather than one node per primitive.
  */
 class GLTFExporter {
 public:
@@ -54,6 +64,12 @@ public:
     // Output options
     bool binaryFormat = false; // Export as .glb instead of .gltf
     bool prettyPrint = true;
+
+    // One node per material group via EXT_mesh_gpu_instancing
+    bool gpuInstancing = false;
+    // Store instance translations and rotations as 16-bit integers
+    // (requires KHR_mesh_quantization), only used with gpuInstancing
+    bool quantizeInstances = false;
   };
 
   GLTFExporter();
@@ -66,6 +82,13 @@ public:
                    const ExportOptions &options);
   bool exportScene(const Scene *scene, const QString &filePath);
 
+  /**
+   * @brief Export primitives already gathered, e.g. by Scene::getExportData
+   * or cx::graphics::structureExportData, as binary GLTF
+   */
+  bool exportSceneData(const cx::graphics::SceneExportData &exportData,
+                       const QString &filePath, const ExportOptions &options);
+
   /**
    * @brief Export a ChemicalStructure to GLTF format
    */
@@ -115,11 +138,29 @@ private:
   void addCameraToAsset(fastgltf::Asset &asset,
                         const cx::graphics::ExportCamera &camera);
 
-  std::vector<float> m_sphereVertices;
-  std::vector<uint32_t> m_sphereIndices;
+  struct InstanceTransform {
+    QVector3D translation;
+    std::array<float, 4> rotation{0.0f, 0.0f, 0.0f, 1.0f}; // x, y, z, w
+    QVector3D scale;
+  };
+
+  void addInstancedNode(fastgltf::Asset &asset, size_t meshIndex,
+                        const std::string &name,
+                        const std::vector<InstanceTransform> &instances,
+                        bool withRotation, const ExportOptions &options);
+  size_t addInstanceAccessor(fastgltf::Asset &asset,
+                             const std::vector<std::byte> &bytes, size_t count,
+                             int components, bool quantized);
+  void finishInstanceBuffer(fastgltf::Asset &asset);
+
+  std::shared_ptr<const cx::primitives::Icosphere> m_sphere;
   std::vector<float> m_cylinderVertices;
   std::vector<uint32_t> m_cylinderIndices;
 
+  // Shared binary buffer for all instancing attributes of an export
+  std::vector<std::byte> m_instanceBytes;
+  std::optional<size_t> m_instanceBufferIndex;
+
   // Material properties from settings
   float m_materialRoughness = 0.5f;
   float m_materialMetallic = 0.0f;
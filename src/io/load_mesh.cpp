@@ -8,11 +8,7 @@ Mesh *loadMesh(const QString &filename, bool preload) {
 }
 
 QList<Mesh *> loadMeshes(QStringList &filenames, bool preload) {
-  QList<Mesh *> result;
-  for (const auto &filename : filenames) {
-    result.append(loadMesh(filename, preload));
-  }
-  return result;
+  return PlyReader::loadFromFiles(filenames, preload);
 }
 
 } // namespace io
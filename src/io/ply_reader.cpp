@@ -3,10 +3,131 @@
 #include "isosurface_parameters.h"
 #include <fmt/core.h>
 #include <QDebug>
+#include <QThread>
+#include <algorithm>
+#include <bit>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <string_view>
 #include <vector>
 
+#ifdef CX_HAS_CONCURRENT
+#include <QtConcurrent>
+#endif
+
+namespace {
+
+using tinyply::Type;
+
+int typeSize(Type t) {
+  switch (t) {
+  case Type::INT8:
+  case Type::UINT8:
+    return 1;
+  case Type::INT16:
+  case Type::UINT16:
+    return 2;
+  case Type::INT32:
+  case Type::UINT32:
+  case Type::FLOAT32:
+    return 4;
+  case Type::FLOAT64:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+template <typename T> inline T load(const char *p) {
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+  return value;
+}
+
+inline double loadAsDouble(Type t, const char *p) {
+  switch (t) {
+  case Type::INT8:
+    return load<int8_t>(p);
+  case Type::UINT8:
+    return load<uint8_t>(p);
+  case Type::INT16:
+    return load<int16_t>(p);
+  case Type::UINT16:
+    return load<uint16_t>(p);
+  case Type::INT32:
+    return load<int32_t>(p);
+  case Type::UINT32:
+    return load<uint32_t>(p);
+  case Type::FLOAT32:
+    return load<float>(p);
+  case Type::FLOAT64:
+    return load<double>(p);
+  default:
+    return 0.0;
+  }
+}
+
+inline int64_t loadAsInteger(Type t, const char *p) {
+  switch (t) {
+  case Type::INT8:
+    return load<int8_t>(p);
+  case Type::UINT8:
+    return load<uint8_t>(p);
+  case Type::INT16:
+    return load<int16_t>(p);
+  case Type::UINT16:
+    return load<uint16_t>(p);
+  case Type::INT32:
+    return load<int32_t>(p);
+  case Type::UINT32:
+    return load<uint32_t>(p);
+  default:
+    return -1;
+  }
+}
+
+// Fixed record size of an element, or 0 if it has list properties
+int elementStride(const tinyply::PlyElement &element) {
+  int stride = 0;
+  for (const auto &property : element.properties) {
+    if (property.isList)
+      return 0;
+    stride += typeSize(property.propertyType);
+  }
+  return stride;
+}
+
+// Walks one record of an element with list properties, calling onList for
+// each list. Returns the start of the next record, or nullptr if the record
+// runs past end.
+template <typename OnList>
+const char *walkRecord(const tinyply::PlyElement &element, const char *p,
+                       const char *end, OnList &&onList) {
+  for (const auto &property : element.properties) {
+    if (!property.isList) {
+      p += typeSize(property.propertyType);
+      if (p > end)
+        return nullptr;
+      continue;
+    }
+    const int countSize = typeSize(property.listType);
+    if (p + countSize > end)
+      return nullptr;
+    const int64_t count = loadAsInteger(property.listType, p);
+    p += countSize;
+    const int64_t bytes = count * typeSize(property.propertyType);
+    if (count < 0 || bytes > end - p)
+      return nullptr;
+    if (!onList(property, count, p))
+      return nullptr;
+    p += bytes;
+  }
+  return p;
+}
+
+} // namespace
+
 PlyReader::PlyReader(const QString &filepath, bool preloadIntoMemory)
     : m_filepath(filepath), m_preloadIntoMemory(preloadIntoMemory),
       m_plyFile(std::make_unique<tinyply::PlyFile>()) {}
@@ -16,8 +137,9 @@ PlyReader::~PlyReader() = default;
 bool PlyReader::parseFile() {
   if (m_preloadIntoMemory) {
     qDebug() << "Reading PLY file into memory:" << m_filepath;
-    return parseFileFromBuffer(
-        io::readFileBytes(m_filepath, QIODevice::ReadOnly));
+    if (m_buffer.isEmpty())
+      m_buffer = io::readFileBytes(m_filepath, QIODevice::ReadOnly);
+    return parseFileFromBuffer(m_buffer);
   } else {
     qDebug() << "Reading PLY file directly from disk:" << m_filepath;
     return parseFileFromDisk();
@@ -249,7 +371,233 @@ Mesh *PlyReader::constructMesh() {
   return mesh;
 }
 
+bool PlyReader::readBinaryDirect(Mesh *&mesh) {
+  if constexpr (std::endian::native != std::endian::little) {
+    return false;
+  }
+  if (m_preloadIntoMemory) {
+    m_buffer = io::readFileBytes(m_filepath, QIODevice::ReadOnly);
+    return decodeBinary(m_buffer.constData(), m_buffer.size(), mesh);
+  }
+
+  QFile file(m_filepath);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+  uchar *mapped = file.map(0, file.size());
+  if (!mapped)
+    return false;
+  const bool handled = decodeBinary(reinterpret_cast<const char *>(mapped),
+                                    file.size(), mesh);
+  file.unmap(mapped);
+  return handled;
+}
+
+// Decodes binary little endian triangle meshes straight into the Mesh
+// matrices and property vectors, skipping the intermediate tinyply buffers.
+// Returns false (leaving the file to tinyply) for any other layout.
+bool PlyReader::decodeBinary(const char *data, qint64 size, Mesh *&mesh) {
+  mesh = nullptr;
+  constexpr std::string_view endHeader = "end_header";
+  const std::string_view head(data, std::min<qint64>(size, 64 * 1024));
+  const size_t headerEnd = head.find(endHeader);
+  if (headerEnd == std::string_view::npos)
+    return false;
+  const char *p = data + headerEnd + endHeader.size();
+  const char *end = data + size;
+  if (p < end && *p == '\r')
+    p++;
+  if (p >= end || *p != '\n')
+    return false;
+  p++;
+
+  const std::string header(data, p - data);
+  if (header.find("format binary_little_endian") == std::string::npos)
+    return false;
+
+  // tinyply needs a fresh PlyFile to parse the header again
+  auto fallback = [this]() {
+    m_plyFile = std::make_unique<tinyply::PlyFile>();
+    return false;
+  };
+  try {
+    std::istringstream headerStream(header);
+    if (!m_plyFile->parse_header(headerStream))
+      return fallback();
+  } catch (const std::exception &e) {
+    qDebug() << "Error parsing PLY header:" << e.what();
+    return fallback();
+  }
+
+  enum class Target { Position, Normal, Property };
+  struct Field {
+    int offset;
+    Type type;
+    Target target;
+    int index;
+  };
+
+  Mesh::VertexList vertices, normals;
+  Mesh::FaceList faces;
+  std::vector<std::pair<QString, Mesh::ScalarPropertyValues>> properties;
+  bool haveVertices = false, haveFaces = false;
+
+  const auto elements = m_plyFile->get_elements();
+  for (const auto &element : elements) {
+    const Eigen::Index count = static_cast<Eigen::Index>(element.size);
+
+    if (element.name == "vertex") {
+      const int stride = elementStride(element);
+      if (stride == 0)
+        return fallback();
+      std::vector<Field> fields;
+      int positionFields = 0, normalFields = 0;
+      int offset = 0;
+      for (const auto &property : element.properties) {
+        const auto &name = property.name;
+        if (name == "x" || name == "y" || name == "z") {
+          fields.push_back({offset, property.propertyType, Target::Position,
+                            name[0] - 'x'});
+          positionFields++;
+        } else if (name == "nx" || name == "ny" || name == "nz") {
+          fields.push_back({offset, property.propertyType, Target::Normal,
+                            name[1] - 'x'});
+          normalFields++;
+        } else {
+          switch (property.propertyType) {
+          case Type::FLOAT32:
+          case Type::INT32:
+          case Type::UINT32:
+          case Type::FLOAT64:
+            fields.push_back({offset, property.propertyType, Target::Property,
+                              static_cast<int>(properties.size())});
+            properties.emplace_back(
+                isosurface::getSurfacePropertyDisplayName(
+                    QString::fromStdString(name)),
+                Mesh::ScalarPropertyValues(count));
+            break;
+          default:
+            qDebug() << "Unsupported property type"
+                     << static_cast<int>(property.propertyType)
+                     << "for property" << QString::fromStdString(name);
+          }
+        }
+        offset += typeSize(property.propertyType);
+      }
+      if (positionFields != 3)
+        return fallback();
+      if (static_cast<qint64>(stride) * count > end - p) {
+        qDebug() << "Truncated vertex data in" << m_filepath;
+        return true;
+      }
+
+      vertices.resize(3, count);
+      if (normalFields == 3)
+        normals.resize(3, count);
+      else
+        std::erase_if(fields, [](const Field &field) {
+          return field.target == Target::Normal;
+        });
+
+      for (Eigen::Index i = 0; i < count; i++, p += stride) {
+        for (const auto &field : fields) {
+          const double value = loadAsDouble(field.type, p + field.offset);
+          switch (field.target) {
+          case Target::Position:
+            vertices(field.index, i) = value;
+            break;
+          case Target::Normal:
+            normals(field.index, i) = value;
+            break;
+          case Target::Property:
+            properties[field.index].second(i) = static_cast<float>(value);
+            break;
+          }
+        }
+      }
+      haveVertices = true;
+    } else if (element.name == "face") {
+      faces.resize(3, count);
+      bool haveIndices = false, triangles = true;
+      for (Eigen::Index i = 0; i < count && p; i++) {
+        p = walkRecord(element, p, end,
+                       [&](const tinyply::PlyProperty &property,
+                           int64_t listCount, const char *values) {
+                         if (property.name != "vertex_indices" &&
+                             property.name != "vertex_index")
+                           return true;
+                         haveIndices = true;
+                         if (listCount != 3) {
+                           triangles = false;
+                           return false;
+                         }
+                         const int size = typeSize(property.propertyType);
+                         for (int k = 0; k < 3; k++) {
+                           faces(k, i) = static_cast<int>(loadAsInteger(
+                               property.propertyType, values + k * size));
+                         }
+                         return true;
+                       });
+      }
+      if (!triangles || (count > 0 && !haveIndices))
+        return fallback();
+      if (!p) {
+        qDebug() << "Truncated face data in" << m_filepath;
+        return true;
+      }
+      haveFaces = true;
+    } else {
+      const int stride = elementStride(element);
+      if (stride > 0) {
+        if (static_cast<qint64>(stride) * count > end - p)
+          return fallback();
+        p += stride * count;
+        continue;
+      }
+      for (Eigen::Index i = 0; i < count && p; i++) {
+        p = walkRecord(element, p, end,
+                       [](const tinyply::PlyProperty &, int64_t,
+                          const char *) { return true; });
+      }
+      if (!p)
+        return fallback();
+    }
+  }
+
+  if (!haveVertices || !haveFaces) {
+    qDebug() << "Required mesh data not loaded";
+    return true;
+  }
+  if (faces.size() > 0 &&
+      (faces.minCoeff() < 0 || faces.maxCoeff() >= vertices.cols())) {
+    qWarning() << "Face indices out of range in" << m_filepath;
+    return true;
+  }
+
+  maybeReadMetaData();
+
+  mesh = new Mesh(vertices, faces);
+  if (normals.cols() == vertices.cols()) {
+    mesh->setVertexNormals(normals);
+  } else {
+    mesh->setVertexNormals(
+        mesh->computeVertexNormals(Mesh::NormalSetting::Average));
+  }
+
+  mesh->setVertexProperty("None", Eigen::VectorXf::Zero(vertices.cols()));
+  for (const auto &[displayName, values] : properties) {
+    mesh->setVertexProperty(displayName, values);
+  }
+
+  processMetaData(mesh);
+  return true;
+}
+
 Mesh *PlyReader::read() {
+  Mesh *mesh = nullptr;
+  if (readBinaryDirect(mesh)) {
+    return mesh;
+  }
+
   if (!parseFile()) {
     return nullptr;
   }
@@ -261,3 +609,26 @@ Mesh *PlyReader::loadFromFile(const QString &filepath, bool preloadIntoMemory) {
   PlyReader reader(filepath, preloadIntoMemory);
   return reader.read();
 }
+
+QList<Mesh *> PlyReader::loadFromFiles(const QStringList &filepaths,
+                                       bool preloadIntoMemory) {
+  QThread *owner = QThread::currentThread();
+  auto load = [owner, preloadIntoMemory](const QString &filepath) {
+    Mesh *mesh = loadFromFile(filepath, preloadIntoMemory);
+    // meshes built on a pool thread must be handed over before returning
+    if (mesh && mesh->thread() != owner)
+      mesh->moveToThread(owner);
+    return mesh;
+  };
+
+#ifdef CX_HAS_CONCURRENT
+  if (filepaths.size() > 1) {
+    return QtConcurrent::blockingMapped<QList<Mesh *>>(filepaths, load);
+  }
+#endif
+  QList<Mesh *> result;
+  for (const auto &filepath : filepaths) {
+    result.append(load(filepath));
+  }
+  return result;
+}
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "mesh.h"
+#include <QList>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 #include <QByteArray>
 #include <memory>
 #include <vector>
@@ -21,9 +23,17 @@ public:
     // Static helper method
     static Mesh* loadFromFile(const QString &filepath, bool preloadIntoMemory = true);
 
+    // Reads the files concurrently, returning meshes in the same order as
+    // filepaths (nullptr where a file failed). Meshes are owned by the
+    // calling thread.
+    static QList<Mesh*> loadFromFiles(const QStringList &filepaths,
+                                      bool preloadIntoMemory = true);
+
     inline const auto &metaData() const { return m_metaData; }
 
 private:
+    bool readBinaryDirect(Mesh *&mesh);
+    bool decodeBinary(const char *data, qint64 size, Mesh *&mesh);
     bool parseFile();
     bool parseFileFromBuffer(const QByteArray& buffer);
     bool parseFileFromDisk();
@@ -38,6 +48,7 @@ private:
     QString m_filepath;
     bool m_preloadIntoMemory;
     std::unique_ptr<tinyply::PlyFile> m_plyFile;
+    QByteArray m_buffer;
 
     nlohmann::json m_metaData;
     
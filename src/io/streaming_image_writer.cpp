@@ -0,0 +1,397 @@
+#include "streaming_image_writer.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#ifdef CX_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace cx::io {
+
+namespace {
+
+constexpr int bytesPerPixel = 4;
+// compressed data is written out in IDAT chunks of about this size
+constexpr size_t pngChunkSize = 256 * 1024;
+
+quint32 crc32Update(quint32 crc, const char *data, size_t size) {
+  static const auto table = []() {
+    std::array<quint32, 256> t{};
+    for (quint32 n = 0; n < 256; n++) {
+      quint32 c = n;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      t[n] = c;
+    }
+    return t;
+  }();
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ static_cast<uchar>(data[i])) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+void appendBigEndian(QByteArray &bytes, quint32 value) {
+  char buffer[4];
+  qToBigEndian(value, buffer);
+  bytes.append(buffer, 4);
+}
+
+void appendLittleEndian16(QByteArray &bytes, quint16 value) {
+  char buffer[2];
+  qToLittleEndian(value, buffer);
+  bytes.append(buffer, 2);
+}
+
+void appendLittleEndian32(QByteArray &bytes, quint32 value) {
+  char buffer[4];
+  qToLittleEndian(value, buffer);
+  bytes.append(buffer, 4);
+}
+
+} // namespace
+
+// The zlib stream making up the PNG image data. Without zlib the data is
+// framed as stored blocks, which any PNG reader accepts.
+struct StreamingImageWriter::Deflate {
+  std::vector<char> output;
+
+#ifdef CX_HAS_ZLIB
+  z_stream stream{};
+  bool initialized{false};
+
+  Deflate() { initialized = deflateInit(&stream, 6) == Z_OK; }
+  ~Deflate() {
+    if (initialized)
+      deflateEnd(&stream);
+  }
+
+  bool compress(const uchar *data, size_t size, bool final) {
+    if (!initialized)
+      return false;
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    char buffer[64 * 1024];
+    int ret = Z_OK;
+    do {
+      stream.next_out = reinterpret_cast<Bytef *>(buffer);
+      stream.avail_out = sizeof(buffer);
+      ret = deflate(&stream, final ? Z_FINISH : Z_NO_FLUSH);
+      if (ret == Z_STREAM_ERROR)
+        return false;
+      output.insert(output.end(), buffer,
+                    buffer + (sizeof(buffer) - stream.avail_out));
+    } while (final ? ret != Z_STREAM_END : stream.avail_out == 0);
+    return true;
+  }
+#else
+  quint32 adler{1};
+  bool headerWritten{false};
+
+  void updateAdler(const uchar *data, size_t size) {
+    quint32 a = adler & 0xffff;
+    quint32 b = adler >> 16;
+    for (size_t i = 0; i < size; i++) {
+      a = (a + data[i]) % 65521;
+      b = (b + a) % 65521;
+    }
+    adler = (b << 16) | a;
+  }
+
+  void storedBlock(const uchar *data, quint16 size, bool final) {
+    output.push_back(final ? 1 : 0);
+    const quint16 length[2] = {qToLittleEndian(size),
+                               qToLittleEndian(quint16(~size))};
+    const char *header = reinterpret_cast<const char *>(length);
+    output.insert(output.end(), header, header + sizeof(length));
+    output.insert(output.end(), data, data + size);
+  }
+
+  bool compress(const uchar *data, size_t size, bool final) {
+    if (!headerWritten) {
+      // deflate, 32K window, no preset dictionary, fastest
+      output.push_back(0x78);
+      output.push_back(0x01);
+      headerWritten = true;
+    }
+    updateAdler(data, size);
+    while (size > 0) {
+      const quint16 n = static_cast<quint16>(
+          std::min<size_t>(size, std::numeric_limits<quint16>::max()));
+      storedBlock(data, n, false);
+      data += n;
+      size -= n;
+    }
+    if (final) {
+      storedBlock(nullptr, 0, true);
+      char checksum[4];
+      qToBigEndian(adler, checksum);
+      output.insert(output.end(), checksum, checksum + 4);
+    }
+    return true;
+  }
+#endif
+};
+
+std::optional<StreamingImageWriter::Format>
+StreamingImageWriter::formatForFilename(const QString &filename) {
+  const QString suffix = QFileInfo(filename).suffix().toLower();
+  if (suffix == "png")
+    return Format::PNG;
+  if (suffix == "tif" || suffix == "tiff")
+    return Format::TIFF;
+  return std::nullopt;
+}
+
+StreamingImageWriter::StreamingImageWriter(const QString &filename, int width,
+                                           int height, Format format)
+    : m_file(filename), m_width(width), m_height(height), m_format(format) {}
+
+StreamingImageWriter::~StreamingImageWriter() {
+  // don't leave a truncated image behind
+  if (m_file.isOpen() && !m_finished) {
+    m_file.close();
+    m_file.remove();
+  }
+}
+
+bool StreamingImageWriter::fail(const QString &error) {
+  m_errorString = error;
+  qWarning() << "StreamingImageWriter:" << error;
+  return false;
+}
+
+bool StreamingImageWriter::writeBytes(const char *data, qint64 size) {
+  if (m_file.write(data, size) != size)
+    return fail("Could not write to " + m_file.fileName() + ": " +
+                m_file.errorString());
+  return true;
+}
+
+bool StreamingImageWriter::open() {
+  if (m_width <= 0 || m_height <= 0)
+    return fail(QString("Invalid image size %1x%2").arg(m_width).arg(m_height));
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return fail("Could not open " + m_file.fileName() + ": " +
+                m_file.errorString());
+  m_rowsWritten = 0;
+  m_finished = false;
+
+  if (m_format == Format::TIFF)
+    return writeTiffHeader();
+  return writePngHeader();
+}
+
+bool StreamingImageWriter::writeRows(const QImage &rows) {
+  if (!m_file.isOpen() || m_finished)
+    return fail("Image is not open for writing");
+  if (rows.width() != m_width)
+    return fail(QString("Row width %1 does not match image width %2")
+                    .arg(rows.width())
+                    .arg(m_width));
+  if (m_rowsWritten + rows.height() > m_height)
+    return fail("More rows written than the image height");
+
+  const QImage rgba = rows.format() == QImage::Format_RGBA8888
+                          ? rows
+                          : rows.convertToFormat(QImage::Format_RGBA8888);
+  const qint64 rowBytes = qint64(m_width) * bytesPerPixel;
+  for (int y = 0; y < rgba.height(); y++) {
+    const uchar *row = rgba.constScanLine(y);
+    const bool ok =
+        m_format == Format::TIFF
+            ? writeBytes(reinterpret_cast<const char *>(row), rowBytes)
+            : writePngRow(row);
+    if (!ok)
+      return false;
+    m_rowsWritten++;
+  }
+  return true;
+}
+
+bool StreamingImageWriter::finish() {
+  if (!m_file.isOpen() || m_finished)
+    return fail("Image is not open for writing");
+  if (m_rowsWritten != m_height)
+    return fail(QString("Only %1 of %2 rows were written")
+                    .arg(m_rowsWritten)
+                    .arg(m_height));
+  if (m_format == Format::PNG && !writePngEnd())
+    return false;
+  if (!m_file.flush())
+    return fail("Could not write to " + m_file.fileName());
+  m_finished = true;
+  m_file.close();
+  return true;
+}
+
+bool StreamingImageWriter::writePngChunk(const char type[4], const char *data,
+                                         quint32 size) {
+  QByteArray header;
+  appendBigEndian(header, size);
+  header.append(type, 4);
+  quint32 crc = crc32Update(0xffffffffu, type, 4);
+  crc = crc32Update(crc, data, size) ^ 0xffffffffu;
+  QByteArray trailer;
+  appendBigEndian(trailer, crc);
+  return writeBytes(header.constData(), header.size()) &&
+         writeBytes(data, size) &&
+         writeBytes(trailer.constData(), trailer.size());
+}
+
+bool StreamingImageWriter::writePngHeader() {
+  static const char signature[] = {'\x89', 'P',    'N',  'G',
+                                   '\r',   '\n',   '\x1a', '\n'};
+  if (!writeBytes(signature, sizeof(signature)))
+    return false;
+
+  QByteArray ihdr;
+  appendBigEndian(ihdr, m_width);
+  appendBigEndian(ihdr, m_height);
+  ihdr.append(char(8)); // bit depth
+  ihdr.append(char(6)); // truecolour with alpha
+  ihdr.append(char(0)); // deflate
+  ihdr.append(char(0)); // adaptive filtering
+  ihdr.append(char(0)); // no interlace
+  if (!writePngChunk("IHDR", ihdr.constData(), ihdr.size()))
+    return false;
+
+  const size_t rowBytes = size_t(m_width) * bytesPerPixel;
+  m_previousRow.assign(rowBytes, 0);
+  m_filteredRow.assign(rowBytes + 1, 0);
+  m_deflate = std::make_unique<Deflate>();
+#ifdef CX_HAS_ZLIB
+  if (!m_deflate->initialized)
+    return fail("Could not initialise zlib");
+#endif
+  return true;
+}
+
+bool StreamingImageWriter::writePngRow(const uchar *row) {
+  // the Up filter: rendered images are mostly flat or smooth vertically
+  const size_t rowBytes = m_previousRow.size();
+  m_filteredRow[0] = 2;
+  for (size_t i = 0; i < rowBytes; i++) {
+    m_filteredRow[i + 1] = static_cast<uchar>(row[i] - m_previousRow[i]);
+  }
+  std::copy(row, row + rowBytes, m_previousRow.begin());
+
+  if (!m_deflate->compress(m_filteredRow.data(), m_filteredRow.size(), false))
+    return fail("Compression failed");
+  return flushPngData(false);
+}
+
+bool StreamingImageWriter::flushPngData(bool final) {
+  auto &output = m_deflate->output;
+  size_t offset = 0;
+  while (output.size() - offset >= pngChunkSize ||
+         (final && offset < output.size())) {
+    const size_t n = std::min(pngChunkSize, output.size() - offset);
+    if (!writePngChunk("IDAT", output.data() + offset, n))
+      return false;
+    offset += n;
+  }
+  output.erase(output.begin(), output.begin() + offset);
+  return true;
+}
+
+bool StreamingImageWriter::writePngEnd() {
+  if (!m_deflate->compress(nullptr, 0, true))
+    return fail("Compression failed");
+  if (!flushPngData(true))
+    return false;
+  m_deflate.reset();
+  return writePngChunk("IEND", nullptr, 0);
+}
+
+bool StreamingImageWriter::writeTiffHeader() {
+  const quint64 rowBytes = quint64(m_width) * bytesPerPixel;
+  const quint32 rowsPerStrip =
+      std::max<quint32>(1, static_cast<quint32>(65536 / rowBytes));
+  const quint32 strips = (m_height + rowsPerStrip - 1) / rowsPerStrip;
+
+  struct Entry {
+    quint16 tag;
+    quint16 type;
+    quint32 count;
+    quint32 value;
+  };
+  constexpr quint16 SHORT = 3, LONG = 4, RATIONAL = 5;
+  constexpr quint32 numberOfEntries = 14;
+
+  // everything that doesn't fit in an entry follows the directory
+  const quint32 directoryOffset = 8;
+  const quint32 bitsPerSampleOffset =
+      directoryOffset + 2 + numberOfEntries * 12 + 4;
+  const quint32 resolutionOffset = bitsPerSampleOffset + 8;
+  const quint32 stripOffsetsOffset = resolutionOffset + 16;
+  const quint32 stripCountsOffset = stripOffsetsOffset + 4 * strips;
+  const quint64 dataOffset = stripCountsOffset + 4 * quint64(strips);
+  if (dataOffset + rowBytes * m_height > std::numeric_limits<quint32>::max())
+    return fail("Image is too large for TIFF, use PNG instead");
+
+  const auto stripBytes = [&](quint32 strip) {
+    const quint32 rows =
+        std::min<quint32>(rowsPerStrip, m_height - strip * rowsPerStrip);
+    return static_cast<quint32>(rows * rowBytes);
+  };
+
+  const std::array<Entry, numberOfEntries> entries{{
+      {256, LONG, 1, quint32(m_width)},
+      {257, LONG, 1, quint32(m_height)},
+      {258, SHORT, 4, bitsPerSampleOffset},
+      {259, SHORT, 1, 1}, // no compression
+      {262, SHORT, 1, 2}, // RGB
+      {273, LONG, strips,
+       strips == 1 ? quint32(dataOffset) : stripOffsetsOffset},
+      {277, SHORT, 1, 4},
+      {278, LONG, 1, rowsPerStrip},
+      {279, LONG, strips, strips == 1 ? stripBytes(0) : stripCountsOffset},
+      {282, RATIONAL, 1, resolutionOffset},
+      {283, RATIONAL, 1, resolutionOffset + 8},
+      {284, SHORT, 1, 1}, // interleaved
+      {296, SHORT, 1, 2}, // inches
+      {338, SHORT, 1, 2}, // unassociated alpha
+  }};
+
+  QByteArray header("II");
+  appendLittleEndian16(header, 42);
+  appendLittleEndian32(header, directoryOffset);
+  appendLittleEndian16(header, numberOfEntries);
+  for (const auto &entry : entries) {
+    appendLittleEndian16(header, entry.tag);
+    appendLittleEndian16(header, entry.type);
+    appendLittleEndian32(header, entry.count);
+    // short values are left justified, which little endian gives for free
+    appendLittleEndian32(header, entry.value);
+  }
+  appendLittleEndian32(header, 0); // no further directories
+
+  for (int i = 0; i < 4; i++) {
+    appendLittleEndian16(header, 8);
+  }
+  for (int i = 0; i < 2; i++) {
+    appendLittleEndian32(header, 72);
+    appendLittleEndian32(header, 1);
+  }
+  if (strips > 1) {
+    for (quint32 s = 0; s < strips; s++) {
+      appendLittleEndian32(header, quint32(dataOffset + quint64(s) *
+                                                            rowsPerStrip *
+                                                            rowBytes));
+    }
+    for (quint32 s = 0; s < strips; s++) {
+      appendLittleEndian32(header, stripBytes(s));
+    }
+  }
+  // single strip arrays are stored inline, pad to keep dataOffset exact
+  header.resize(dataOffset, '\0');
+  return writeBytes(header.constData(), header.size());
+}
+
+} // namespace cx::io
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QFile>
+#include <QImage>
+#include <QString>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace cx::io {
+
+/**
+ * @brief Writes an RGBA image to PNG or TIFF a band of rows at a time
+ *
+ * The image dimensions are fixed when the file is opened, rows are then
+ * appended top to bottom and encoded as they arrive, so only the rows
+ * passed to writeRows need to be held in memory. Intended for exports too
+ * large to assemble as a single QImage.
+ *
+ * PNG output is deflate compressed when zlib is available
+ * (CX_HAS_ZLIB) and written as stored (uncompressed) deflate blocks
+ * otherwise. TIFF output is uncompressed baseline TIFF, which limits it to
+ * images under 4 GiB.
+ */
+class StreamingImageWriter {
+public:
+  enum class Format { PNG, TIFF };
+
+  // Deduced from the file extension
+  static std::optional<Format> formatForFilename(const QString &filename);
+
+  StreamingImageWriter(const QString &filename, int width, int height,
+                       Format format);
+  ~StreamingImageWriter();
+
+  bool open();
+  // Appends rows.height() rows, rows.width() must match width()
+  bool writeRows(const QImage &rows);
+  // Must be called after the last row, the file is incomplete otherwise
+  bool finish();
+
+  inline int width() const { return m_width; }
+  inline int height() const { return m_height; }
+  inline int rowsWritten() const { return m_rowsWritten; }
+  inline const QString &errorString() const { return m_errorString; }
+
+private:
+  bool fail(const QString &error);
+  bool writeBytes(const char *data, qint64 size);
+
+  bool writePngHeader();
+  bool writePngRow(const uchar *row);
+  bool writePngChunk(const char type[4], const char *data, quint32 size);
+  bool flushPngData(bool final);
+  bool writePngEnd();
+
+  bool writeTiffHeader();
+
+  struct Deflate;
+
+  QFile m_file;
+  int m_width{0};
+  int m_height{0};
+  Format m_format{Format::PNG};
+  int m_rowsWritten{0};
+  bool m_finished{false};
+  QString m_errorString;
+
+  // PNG rows are filtered against the previous one before compression
+  std::vector<uchar> m_previousRow;
+  std::vector<uchar> m_filteredRow;
+  std::unique_ptr<Deflate> m_deflate;
+};
+
+} // namespace cx::io
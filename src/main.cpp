@@ -1,6 +1,7 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QDateTime>
+#include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -8,7 +9,9 @@
 #include <QSettings>
 #include <QString>
 #include <QSurfaceFormat>
+#include <QTimer>
 
+#include "batchrunner.h"
 #include "crystalx.h"
 #include "default_paths.h"
 #include "globalconfiguration.h"
@@ -73,7 +76,40 @@ void maybeReOpenFiles(Crystalx *cx) {
   }
 }
 
+// Checked before the application exists, for "-b job", "--batch job" and
+// "--batch=job". Other arguments starting with -b (e.g. the X11 -bg) must not
+// switch the GUI to the offscreen platform.
+bool batchModeRequested(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    if (qstrcmp(argv[i], "-b") == 0 || qstrcmp(argv[i], "--batch") == 0 ||
+        qstrncmp(argv[i], "--batch=", 8) == 0)
+      return true;
+  }
+  return false;
+}
+
+int runBatch(QApplication &app, const QString &jobFile) {
+  BatchJob job;
+  QString errorMessage;
+  if (!BatchJob::loadFromFile(jobFile, job, errorMessage)) {
+    qCritical() << errorMessage;
+    return 1;
+  }
+  BatchRunner runner(job);
+  QObject::connect(&runner, &BatchRunner::finished, &app,
+                   // a failure count would wrap modulo 256
+                   [&app](int failures) { app.exit(failures > 0 ? 1 : 0); },
+                   Qt::QueuedConnection);
+  QTimer::singleShot(0, &runner, &BatchRunner::start);
+  return app.exec();
+}
+
 int main(int argc, char *argv[]) {
+  // Batch jobs never open a window, so don't require a display
+  const bool batchMode = batchModeRequested(argc, argv);
+  if (batchMode && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
   QApplication::addLibraryPath("./");
   QSurfaceFormat format;
   format.setDepthBufferSize(
@@ -121,6 +157,13 @@ int main(int argc, char *argv[]) {
       QCoreApplication::translate("main", "Specify file to open"),
       QCoreApplication::translate("main", "filename"));
   parser.addOption(filesOption);
+  QCommandLineOption batchOption(
+      QStringList() << "b"
+                    << "batch",
+      QCoreApplication::translate(
+          "main", "Run the batch job described in a JSON file without a GUI"),
+      QCoreApplication::translate("main", "job"));
+  parser.addOption(batchOption);
   parser.process(app);
 
   // ensure default settings are written
@@ -131,6 +174,10 @@ int main(int argc, char *argv[]) {
   auto *config = GlobalConfiguration::getInstance();
   config->load();
 
+  if (batchMode && parser.isSet(batchOption)) {
+    return runBatch(app, parser.value(batchOption));
+  }
+
   Crystalx *cx = new Crystalx();
   cx->show();
 
@@ -118,20 +118,9 @@ double ElasticTensor::shear_modulus(CartesianDirection a,
 
 std::pair<double, double>
 ElasticTensor::shear_modulus_minmax(CartesianDirection n) const {
-  double min_v = std::numeric_limits<double>::max();
-  double max_v = std::numeric_limits<double>::lowest();
-
-  const int num_steps = 360;
-  const double step = 2 * occ::constants::pi<double> / num_steps;
-
-  for (int i = 0; i < num_steps; ++i) {
-    double angle = i * step;
-    double v = shear_modulus(n, angle);
-    min_v = std::min(min_v, v);
-    max_v = std::max(max_v, v);
-  }
-
-  return {min_v, max_v};
+  Mat3N dir = n.normalized();
+  auto props = directional_properties(dir);
+  return {props.shear_modulus_min(0), props.shear_modulus_max(0)};
 }
 
 double ElasticTensor::poisson_ratio_angular(AngularDirection dir,
@@ -164,20 +153,90 @@ double ElasticTensor::poisson_ratio(CartesianDirection a,
 
 std::pair<double, double>
 ElasticTensor::poisson_ratio_minmax(CartesianDirection n) const {
-  double min_poisson = std::numeric_limits<double>::max();
-  double max_poisson = std::numeric_limits<double>::lowest();
+  Mat3N dir = n.normalized();
+  auto props = directional_properties(dir);
+  return {props.poisson_ratio_min(0), props.poisson_ratio_max(0)};
+}
 
-  const int num_steps = 360;
-  const double step = 2 * occ::constants::pi<double> / num_steps;
+namespace {
+// eigenvalues (ascending) of the symmetric 2x2 matrix [[a, b], [b, d]]
+inline std::pair<double, double> symmetric_eigenvalues_2x2(double a, double b,
+                                                           double d) {
+  const double mean = 0.5 * (a + d);
+  const double half_diff = 0.5 * (a - d);
+  const double r = std::sqrt(half_diff * half_diff + b * b);
+  return {mean - r, mean + r};
+}
+} // namespace
+
+ElasticTensor::DirectionalProperties
+ElasticTensor::directional_properties(Eigen::Ref<const Mat3N> dirs) const {
+  using Mat9 = Eigen::Matrix<double, 9, 9>;
+  using Mat9N = Eigen::Matrix<double, 9, Eigen::Dynamic>;
+  const Eigen::Index n = dirs.cols();
+
+  // s_aa(ij, kl) = S_ijkl contracts as (a a)(a a) or (a a)(b b)
+  // s_ab(jl, ik) = S_ijkl contracts as (a b)(a b)
+  Mat9 s_aa, s_ab;
+  Eigen::Matrix<double, 9, 1> s_trace = Eigen::Matrix<double, 9, 1>::Zero();
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      for (int k = 0; k < 3; k++) {
+        for (int l = 0; l < 3; l++) {
+          const double s = m_components[i][j][k][l];
+          s_aa(3 * i + j, 3 * k + l) = s;
+          s_ab(3 * j + l, 3 * i + k) = s;
+          if (k == l)
+            s_trace(3 * i + j) += s;
+        }
+      }
+    }
+  }
 
-  for (int i = 0; i < num_steps; ++i) {
-    double angle = i * step;
-    double poisson = poisson_ratio(n, angle);
-    min_poisson = std::min(min_poisson, poisson);
-    max_poisson = std::max(max_poisson, poisson);
+  Mat9N aa(9, n);
+  for (Eigen::Index c = 0; c < n; c++) {
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) {
+        aa(3 * i + j, c) = dirs(i, c) * dirs(j, c);
+      }
+    }
   }
 
-  return {min_poisson, max_poisson};
+  // column c holds the 3x3 quadratic forms for direction c
+  const Mat9N poisson_forms = s_aa.transpose() * aa;
+  const Mat9N shear_forms = s_ab * aa;
+  const Vec s_aaaa =
+      (aa.array() * poisson_forms.array()).colwise().sum().transpose().matrix();
+
+  DirectionalProperties result;
+  result.youngs_modulus = s_aaaa.cwiseInverse();
+  result.linear_compressibility = 1000.0 * (aa.transpose() * s_trace);
+  result.shear_modulus_min.resize(n);
+  result.shear_modulus_max.resize(n);
+  result.poisson_ratio_min.resize(n);
+  result.poisson_ratio_max.resize(n);
+
+  for (Eigen::Index c = 0; c < n; c++) {
+    const Vec3 a = dirs.col(c);
+    Eigen::Matrix<double, 3, 2> plane;
+    plane.col(0) = a.unitOrthogonal();
+    plane.col(1) = a.cross(plane.col(0)).normalized();
+
+    Mat3 m = Eigen::Map<const Mat3>(shear_forms.col(c).data());
+    Eigen::Matrix2d p = plane.transpose() * (0.5 * (m + m.transpose())) * plane;
+    auto [s_lo, s_hi] = symmetric_eigenvalues_2x2(p(0, 0), p(0, 1), p(1, 1));
+    const double g_a = 0.25 / s_lo, g_b = 0.25 / s_hi;
+    result.shear_modulus_min(c) = std::min(g_a, g_b);
+    result.shear_modulus_max(c) = std::max(g_a, g_b);
+
+    m = Eigen::Map<const Mat3>(poisson_forms.col(c).data());
+    p = plane.transpose() * (0.5 * (m + m.transpose())) * plane;
+    auto [p_lo, p_hi] = symmetric_eigenvalues_2x2(p(0, 0), p(0, 1), p(1, 1));
+    const double nu_a = -p_lo / s_aaaa(c), nu_b = -p_hi / s_aaaa(c);
+    result.poisson_ratio_min(c) = std::min(nu_a, nu_b);
+    result.poisson_ratio_max(c) = std::max(nu_a, nu_b);
+  }
+  return result;
 }
 
 double ElasticTensor::average_bulk_modulus(AveragingScheme avg) const {
@@ -24,14 +24,58 @@ inline Mat3N wrap_to_unit_cell(const Mat3N &v) {
   return (v.array() - v.array().floor());
 }
 
+// For each site (column of wrapped fractional coordinates) the index of the
+// first earlier kept site within tolerance of it under the minimum image
+// convention, or its own index if there is none. Kept sites are bucketed on
+// a periodic grid of cells at least tolerance wide, so each site is only
+// compared against those in the 27 surrounding cells.
+inline IVec coincident_site_targets(const Mat3N &frac, double tolerance) {
+  const int nsites = frac.cols();
+  const int ncells = std::max(1, static_cast<int>(1.0 / tolerance));
+  const double tolerance2 = tolerance * tolerance;
+
+  auto cell = [ncells](double x) {
+    return std::clamp(static_cast<int>(x * ncells), 0, ncells - 1);
+  };
+  auto key = [ncells](int a, int b, int c) {
+    auto wrap = [ncells](int i) { return (i + ncells) % ncells; };
+    return (static_cast<int64_t>(wrap(a)) * ncells + wrap(b)) * ncells +
+           wrap(c);
+  };
+
+  ankerl::unordered_dense::map<int64_t, std::vector<int>> cells;
+  IVec targets(nsites);
+  for (int i = 0; i < nsites; i++) {
+    const occ::Vec3 p = frac.col(i);
+    const int a = cell(p(0)), b = cell(p(1)), c = cell(p(2));
+    targets(i) = i;
+    for (int da = -1; da <= 1; da++) {
+      for (int db = -1; db <= 1; db++) {
+        for (int dc = -1; dc <= 1; dc++) {
+          const auto it = cells.find(key(a + da, b + db, c + dc));
+          if (it == cells.end())
+            continue;
+          for (int j : it->second) {
+            occ::Vec3 d = frac.col(j) - p;
+            d.array() -= d.array().round();
+            if (d.squaredNorm() < tolerance2)
+              targets(i) = std::min(targets(i), j);
+          }
+        }
+      }
+    }
+    if (targets(i) == i)
+      cells[key(a, b, c)].push_back(i);
+  }
+  return targets;
+}
+
 void Crystal::update_unit_cell_atoms() const {
-  // TODO merge sites
   constexpr double merge_tolerance = 1e-2;
   const auto &pos = m_asymmetric_unit.positions;
   const auto &atoms = m_asymmetric_unit.atomic_numbers;
   const int natom = num_sites();
   const int nsymops = symmetry_operations().size();
-  Vec occupation = m_asymmetric_unit.occupations.replicate(nsymops, 1);
   IVec uc_nums = atoms.replicate(nsymops, 1);
   IVec asym_idx = IVec::LinSpaced(natom, 0, natom - 1).replicate(nsymops, 1);
   IVec sym;
@@ -40,21 +84,14 @@ void Crystal::update_unit_cell_atoms() const {
   uc_pos = clean_small_values(uc_pos);
   uc_pos = wrap_to_unit_cell(uc_pos);
 
+  // images of atoms on special positions coincide with earlier sites,
+  // the identity comes first so asymmetric unit atoms are always kept
+  const IVec targets = coincident_site_targets(uc_pos, merge_tolerance);
   occ::MaskArray mask(uc_pos.cols());
-  mask.setConstant(false);
-
   for (size_t i = 0; i < uc_pos.cols(); i++) {
-    if ((mask(i)))
-      continue;
-    occ::Vec3 p = uc_pos.col(i);
-    for (size_t j = i + 1; j < uc_pos.cols(); j++) {
-      double dist = (uc_pos.col(j) - p).norm();
-      if (dist < merge_tolerance)
-        mask(j) = true;
-      if (occupation.rows() > 0)
-        occupation(i) += occupation(j);
-    }
+    mask(i) = targets(i) != static_cast<int>(i);
   }
+
   IVec idxs(uc_pos.cols() - mask.count());
   IVec uc_idxs(uc_pos.cols() - mask.count());
   size_t n = 0;
@@ -601,6 +638,101 @@ void Crystal::update_symmetry_unique_molecules() const {
   m_symmetry_unique_molecules_needs_update = false;
 }
 
+namespace {
+
+using occ::core::Dimer;
+
+// Bounding sphere of a molecule's atoms. Two molecules cannot be closer
+// than the distance between their centroids less both radii, so most
+// pairs are rejected without comparing every pair of atoms.
+struct MoleculeBounds {
+  occ::Vec3 centroid;
+  double radius{0.0};
+
+  explicit MoleculeBounds(const occ::core::Molecule &mol)
+      : centroid(mol.centroid()) {
+    if (mol.size() > 0) {
+      radius =
+          (mol.positions().colwise() - centroid).colwise().norm().maxCoeff();
+    }
+  }
+
+  // True if no atom of other, translated by shift, can be within distance
+  inline bool beyond(const MoleculeBounds &other, const occ::Vec3 &shift,
+                     double distance) const {
+    constexpr double slack = 1e-6;
+    const double separation = (other.centroid + shift - centroid).norm();
+    return separation - radius - other.radius > distance + slack;
+  }
+};
+
+// Unique dimers bucketed by centroid separation. Equal dimers have centroid
+// distances within 1e-7, so a candidate only needs comparing with those in
+// its own and the two adjacent bins rather than every dimer found so far.
+class UniqueDimers {
+public:
+  explicit UniqueDimers(std::vector<Dimer> &dimers) : m_dimers(dimers) {}
+
+  // Index of the first dimer equal to d, which is appended if there is none
+  int find_or_insert(const Dimer &d) {
+    const int64_t bin =
+        static_cast<int64_t>(std::floor(d.centroid_distance() / bin_width));
+    int found = -1;
+    for (int64_t b = bin - 1; b <= bin + 1; b++) {
+      const auto it = m_bins.find(b);
+      if (it == m_bins.end())
+        continue;
+      for (int idx : it->second) {
+        if ((found < 0 || idx < found) && m_dimers[idx] == d)
+          found = idx;
+      }
+    }
+    if (found >= 0)
+      return found;
+    const int idx = static_cast<int>(m_dimers.size());
+    m_dimers.push_back(d);
+    m_bins[bin].push_back(idx);
+    return idx;
+  }
+
+private:
+  static constexpr double bin_width = 1e-3;
+  std::vector<Dimer> &m_dimers;
+  ankerl::unordered_dense::map<int64_t, std::vector<int>> m_bins;
+};
+
+// Sorts unique dimers and each molecule's neighbors by nearest distance,
+// keeping the neighbors' unique_index pointing at the same dimers
+void sort_crystal_dimers(CrystalDimers &result) {
+  auto &dimers = result.unique_dimers;
+  std::vector<int> order(dimers.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&dimers](int a, int b) {
+    return dimers[a].nearest_distance() < dimers[b].nearest_distance();
+  });
+  std::vector<int> new_index(dimers.size());
+  std::vector<Dimer> sorted;
+  sorted.reserve(dimers.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    new_index[order[i]] = i;
+    sorted.push_back(std::move(dimers[order[i]]));
+  }
+  dimers = std::move(sorted);
+
+  auto sort_func = [](const CrystalDimers::SymmetryRelatedDimer &a,
+                      const CrystalDimers::SymmetryRelatedDimer &b) {
+    return a.dimer.nearest_distance() < b.dimer.nearest_distance();
+  };
+  for (auto &vec : result.molecule_neighbors) {
+    std::stable_sort(vec.begin(), vec.end(), sort_func);
+    for (auto &d : vec) {
+      d.unique_index = new_index[d.unique_index];
+    }
+  }
+}
+
+} // namespace
+
 CrystalDimers Crystal::symmetry_unique_dimers(double radius) const {
   using occ::core::Dimer;
   CrystalDimers result;
@@ -633,26 +765,33 @@ CrystalDimers Crystal::symmetry_unique_dimers(double radius) const {
   const auto &asym_mols = symmetry_unique_molecules();
   mol_nbs.resize(asym_mols.size());
 
+  std::vector<MoleculeBounds> asym_bounds, uc_bounds;
+  for (const auto &mol : asym_mols)
+    asym_bounds.emplace_back(mol);
+  for (const auto &mol : uc_mols)
+    uc_bounds.emplace_back(mol);
+  UniqueDimers unique(dimers);
+
   for (int h = lower.h; h <= upper.h; h++) {
     for (int k = lower.k; k <= upper.k; k++) {
       for (int l = lower.l; l <= upper.l; l++) {
         occ::Vec3 cart_shift = to_cartesian(occ::Vec3{static_cast<double>(h),
                                                       static_cast<double>(k),
                                                       static_cast<double>(l)});
-        for (const auto &asym_mol : asym_mols) {
+        for (size_t a = 0; a < asym_mols.size(); a++) {
+          const auto &asym_mol = asym_mols[a];
           int asym_idx_a = asym_mol.asymmetric_molecule_idx();
-          for (const auto &uc_mol : uc_mols) {
-            auto mol_translated = uc_mol.translated(cart_shift);
+          for (size_t b = 0; b < uc_mols.size(); b++) {
+            if (asym_bounds[a].beyond(uc_bounds[b], cart_shift, radius))
+              continue;
+            auto mol_translated = uc_mols[b].translated(cart_shift);
             mol_translated.set_cell_shift({h, k, l});
             double distance =
                 std::get<2>(asym_mol.nearest_atom(mol_translated));
             if ((distance < radius) && (distance > 1e-1)) {
               Dimer d(asym_mol, mol_translated);
-              mol_nbs[asym_idx_a].push_back({d, -1});
-              if (std::any_of(dimers.begin(), dimers.end(),
-                              [&d](const Dimer &d2) { return d == d2; }))
-                continue;
-              dimers.push_back(d);
+              const int idx = unique.find_or_insert(d);
+              mol_nbs[asym_idx_a].push_back({d, idx});
             }
           }
         }
@@ -660,24 +799,7 @@ CrystalDimers Crystal::symmetry_unique_dimers(double radius) const {
     }
   }
 
-  auto dimer_sort_func = [](const Dimer &a, const Dimer &b) {
-    return a.nearest_distance() < b.nearest_distance();
-  };
-
-  auto sort_func = [](const CrystalDimers::SymmetryRelatedDimer &a,
-                      const CrystalDimers::SymmetryRelatedDimer &b) {
-    return a.dimer.nearest_distance() < b.dimer.nearest_distance();
-  };
-
-  std::stable_sort(dimers.begin(), dimers.end(), dimer_sort_func);
-  for (auto &vec : mol_nbs) {
-    std::stable_sort(vec.begin(), vec.end(), sort_func);
-    for (auto &d : vec) {
-      size_t idx = std::distance(
-          dimers.begin(), std::find(dimers.begin(), dimers.end(), d.dimer));
-      d.unique_index = idx;
-    }
-  }
+  sort_crystal_dimers(result);
   return result;
 }
 
@@ -716,52 +838,37 @@ CrystalDimers Crystal::unit_cell_dimers(double radius) const {
 
   mol_nbs.resize(uc_mols.size());
 
+  std::vector<MoleculeBounds> uc_bounds;
+  for (const auto &mol : uc_mols)
+    uc_bounds.emplace_back(mol);
+  UniqueDimers unique(dimers);
+
   for (int h = lower.h; h <= upper.h; h++) {
     for (int k = lower.k; k <= upper.k; k++) {
       for (int l = lower.l; l <= upper.l; l++) {
         occ::Vec3 cart_shift = to_cartesian(occ::Vec3{static_cast<double>(h),
                                                       static_cast<double>(k),
                                                       static_cast<double>(l)});
-        int uc_idx_a = 0;
-        for (const auto &uc_mol1 : uc_mols) {
-          for (const auto &uc_mol2 : uc_mols) {
-            auto mol_translated = uc_mol2.translated(cart_shift);
+        for (size_t a = 0; a < uc_mols.size(); a++) {
+          for (size_t b = 0; b < uc_mols.size(); b++) {
+            if (uc_bounds[a].beyond(uc_bounds[b], cart_shift, radius))
+              continue;
+            auto mol_translated = uc_mols[b].translated(cart_shift);
             mol_translated.set_cell_shift({h, k, l});
-            double distance = std::get<2>(uc_mol1.nearest_atom(mol_translated));
+            double distance =
+                std::get<2>(uc_mols[a].nearest_atom(mol_translated));
             if ((distance < radius) && (distance > 1e-1)) {
-              Dimer d(uc_mol1, mol_translated);
-              mol_nbs[uc_idx_a].push_back({d, -1});
-              if (std::any_of(dimers.begin(), dimers.end(),
-                              [&d](const Dimer &d2) { return d == d2; }))
-                continue;
-              dimers.push_back(d);
+              Dimer d(uc_mols[a], mol_translated);
+              const int idx = unique.find_or_insert(d);
+              mol_nbs[a].push_back({d, idx});
             }
           }
-          uc_idx_a++;
         }
       }
     }
   }
 
-  auto dimer_sort_func = [](const Dimer &a, const Dimer &b) {
-    return a.nearest_distance() < b.nearest_distance();
-  };
-
-  auto sort_func = [](const CrystalDimers::SymmetryRelatedDimer &a,
-                      const CrystalDimers::SymmetryRelatedDimer &b) {
-    return a.dimer.nearest_distance() < b.dimer.nearest_distance();
-  };
-
-  std::stable_sort(dimers.begin(), dimers.end(), dimer_sort_func);
-
-  for (auto &vec : mol_nbs) {
-    std::stable_sort(vec.begin(), vec.end(), sort_func);
-    for (auto &d : vec) {
-      size_t idx = std::distance(
-          dimers.begin(), std::find(dimers.begin(), dimers.end(), d.dimer));
-      d.unique_index = idx;
-    }
-  }
+  sort_crystal_dimers(result);
   return result;
 }
 
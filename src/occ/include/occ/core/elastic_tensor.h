@@ -22,6 +22,23 @@ public:
   using AngularDirection = Eigen::Ref<const Eigen::Vector<double, 2>>;
   using CartesianDirection = Eigen::Ref<const Eigen::Vector<double, 3>>;
 
+  /**
+   * Directional properties evaluated for a batch of directions.
+   *
+   * The min/max shear modulus and Poisson ratio are the extrema over all
+   * unit vectors perpendicular to each direction, found analytically from
+   * the eigenvalues of the 2x2 projection of the relevant quadratic form
+   * onto the perpendicular plane.
+   */
+  struct DirectionalProperties {
+    Vec youngs_modulus;
+    Vec linear_compressibility;
+    Vec shear_modulus_min;
+    Vec shear_modulus_max;
+    Vec poisson_ratio_min;
+    Vec poisson_ratio_max;
+  };
+
   explicit ElasticTensor(Eigen::Ref<const Mat6> c_voigt);
 
   double youngs_modulus_angular(AngularDirection) const;
@@ -40,6 +57,13 @@ public:
   double poisson_ratio(CartesianDirection, CartesianDirection) const;
   std::pair<double, double> poisson_ratio_minmax(CartesianDirection) const;
 
+  /**
+   * Evaluate all directional properties for the unit vectors stored as
+   * columns of \p directions using dense matrix products.
+   */
+  DirectionalProperties
+  directional_properties(Eigen::Ref<const Mat3N> directions) const;
+
   double
   average_bulk_modulus(AveragingScheme avg = AveragingScheme::Hill) const;
   double
@@ -1,9 +1,11 @@
 #include "pair_energy_calculator.h"
+#include "customenergycalculatortask.h"
 #include "interaction_energy_calculator.h"
 #include "io_utilities.h"
 #include "load_pair_energy_json.h"
 #include "load_wavefunction.h"
 #include "molecular_wavefunction_provider.h"
+#include "occpairbatchtask.h"
 #include "occpairtask.h"
 #include "xtbtask.h"
 #include "settings.h"
@@ -66,6 +68,9 @@ void PairEnergyCalculator::start(pair_energy::Parameters params) {
       connect(task, &Task::completed, this, [this]() {
         onXtbTaskComplete();
       });
+      connect(task, &Task::errorOccurred, this, [this, params](QString error) {
+        onPairEnergyFailed(params.deriveName(), error);
+      });
       m_taskManager->add(task);  // TaskManager starts it
     }
     return;
@@ -86,15 +91,23 @@ void PairEnergyCalculator::start(pair_energy::Parameters params) {
     connect(task, &Task::completed, this, [this]() {
       onPairEnergyTaskComplete();
     });
+    connect(task, &Task::errorOccurred, this, [this, name](QString error) {
+      onPairEnergyFailed(name, error);
+    });
   }
 }
 
 void PairEnergyCalculator::start_batch(
     const std::vector<pair_energy::Parameters> &energies) {
-  QList<OccPairTask *> tasks;
+  std::vector<pair_energy::Parameters> occPairs;
   m_completedTaskCount = 0;
+  m_complete = false;
+  if (energies.empty()) {
+    m_complete = true;
+    emit calculationComplete();
+    return;
+  }
 
-  int idx = 0;
   m_totalTasks = energies.size();
   for (const auto &params : energies) {
     if (!params.structure) {
@@ -116,31 +129,130 @@ void PairEnergyCalculator::start_batch(
         connect(task, &Task::completed, this, [this]() {
         onXtbTaskComplete();
       });
+        connect(task, &Task::errorOccurred, this,
+                [this, params](QString error) {
+                  onPairEnergyFailed(params.deriveName(), error);
+                });
         m_taskManager->add(task);  // TaskManager starts it
       }
       continue;
     }
 
-    auto *task = new OccPairTask();
-    QString name = params.deriveName();
-    task->setParameters(params);
-    task->setExecutable(m_occExecutable);
-    task->setEnvironment(m_environment);
-    task->setProperty("name", name);
-    task->setProperty("basename", name);
+    if (params.isCustomModel()) {
+      auto *task = new CustomEnergyCalculatorTask();
+      task->setParameters(params);
+      task->setCalculatorName(params.model);
+      task->setProperty("name", params.deriveName());
+      // persistent calculators keep up to one worker per task slot
+      task->setMaximumWorkers(m_taskManager->maximumConcurrency());
+      connect(task, &CustomEnergyCalculatorTask::calculationComplete, this,
+              &PairEnergyCalculator::onCustomTaskComplete);
+      connect(task, &Task::errorOccurred, this,
+              [this, params](QString error) {
+                onPairEnergyFailed(params.deriveName(), error);
+              });
+      m_taskManager->add(task);
+      continue;
+    }
+    occPairs.push_back(params);
+  }
 
-    // Store context in task properties for safe retrieval in slot
-    task->setProperty("pair_params", QVariant::fromValue(params));
+  if (occPairs.empty())
+    return;
 
-    tasks.append(task);
-    connect(task, &Task::completed, this, [this]() {
-      onPairEnergyTaskComplete();
-    });
+  // All OCC pairs share one task, so each monomer wavefunction is written
+  // once and the pairs run side by side within the task's thread budget
+  auto *task = new OccPairBatchTask();
+  task->setPairs(occPairs);
+  task->setExecutable(m_occExecutable);
+  task->setEnvironment(m_environment);
+  task->setProperty("name", QString("Pair energies (%1 pairs)")
+                                .arg(occPairs.size()));
+  task->setProperty("threads", m_taskManager->maximumConcurrency());
+
+  connect(task, &OccPairBatchTask::pairCompleted, this,
+          [this, task](int index, QString jsonPath) {
+            onPairEnergyLoaded(task->pairs()[index], jsonPath);
+          });
+  connect(task, &OccPairBatchTask::pairFailed, this,
+          [this, task](int index, QString error) {
+            onPairEnergyFailed(task->pairs()[index].deriveName(), error);
+          });
+  m_taskManager->add(task);
+}
+
+bool PairEnergyCalculator::resolvePairParameters(
+    ChemicalStructure *structure,
+    const pair_energy::EnergyModelParameters &modelParameters,
+    std::vector<pair_energy::Parameters> &energies) {
+  if (!structure)
+    return false;
+
+  std::vector<MolecularWavefunction *> wavefunctions;
+  for (const auto &wfn : modelParameters.wavefunctions) {
+    auto candidates = structure->wavefunctionsAndTransformsForAtoms(wfn.atoms);
+    bool found = false;
+    qDebug() << "Found " << candidates.size() << "candidates";
+    for (auto &candidate : candidates) {
+      if (wfn.hasEquivalentMethodTo(candidate.wavefunction->parameters())) {
+        found = true;
+        wavefunctions.push_back(candidate.wavefunction);
+        break;
+      }
+    }
+    if (!found) {
+      qDebug() << "Unable to find corresponding wavefunction...";
+    }
   }
 
-  for (auto *task : tasks) {
-    auto taskId = m_taskManager->add(task);
+  const bool needsWavefunctions =
+      !modelParameters.isXtbModel() && !modelParameters.isCustomModel();
+  auto *pairInteractions = structure->pairInteractions();
+  for (const auto &pair : modelParameters.pairs) {
+    pair_energy::Parameters p;
+    p.fragmentDimer = pair;
+    p.structure = structure;
+    p.atomsA = pair.a.atomIndices;
+    p.atomsB = pair.b.atomIndices;
+    p.model = modelParameters.model;
+
+    bool foundA = false;
+    bool foundB = false;
+    for (auto *wfn : wavefunctions) {
+      if (foundA && foundB)
+        break;
+      if (!foundA) {
+        foundA = structure->getTransformation(wfn->atomIndices(), p.atomsA,
+                                              p.transformA);
+        if (foundA) {
+          qDebug() << "Found wavefunction for A";
+          p.wfnA = wfn;
+        }
+      }
+      if (!foundB) {
+        foundB = structure->getTransformation(wfn->atomIndices(), p.atomsB,
+                                              p.transformB);
+        if (foundB) {
+          qDebug() << "Found wavefunction for B";
+          p.wfnB = wfn;
+        }
+      }
+    }
+    // xtb and custom models work from the geometry alone
+    if (needsWavefunctions && (!foundA || !foundB)) {
+      qDebug() << "Unable to find wavefunctions for A and B";
+      return false;
+    }
+
+    QString model = modelParameters.model.toUpper();
+    auto *existingInteraction = pairInteractions->getInteraction(model, pair);
+    if (!existingInteraction) {
+      energies.push_back(p);
+    } else {
+      qDebug() << "Found matching interaction:" << existingInteraction;
+    }
   }
+  return true;
 }
 
 void PairEnergyCalculator::onPairEnergyTaskComplete() {
@@ -161,23 +273,50 @@ void PairEnergyCalculator::onPairEnergyTaskComplete() {
 
   QString jsonFile = task->jsonFilename();
   qDebug() << "[SLOT START]" << task->baseName() << "loading" << jsonFile;
+  onPairEnergyLoaded(params, jsonFile);
+}
+
+void PairEnergyCalculator::onPairEnergyLoaded(
+    const pair_energy::Parameters &params, const QString &jsonFile) {
   if (params.structure) {
     auto *interactions = params.structure->pairInteractions();
     auto *result = load_pair_energy_json(jsonFile);
     result->setParameters(params);
-    qDebug() << "[SLOT DONE]" << task->baseName() << "model:" << result->objectName();
+    qDebug() << "[SLOT DONE]" << params.deriveName() << "model:" << result->objectName();
     interactions->add(result);
-    m_completedTaskCount++;
-    if (m_completedTaskCount == m_totalTasks) {
-      m_complete = true;
-    }
   }
-  if (m_complete) {
+  onPairEnergyFinished();
+}
+
+void PairEnergyCalculator::onPairEnergyFinished() {
+  m_completedTaskCount++;
+  // only once, even if a task is (wrongly) reported again afterwards
+  if (m_completedTaskCount == m_totalTasks) {
+    m_complete = true;
     qDebug() << "Calculation complete";
     emit calculationComplete();
   }
 }
 
+void PairEnergyCalculator::onPairEnergyFailed(const QString &name,
+                                              const QString &error) {
+  qWarning() << "Pair energy" << name << "failed:" << error;
+  emit errorOccurred(QString("%1: %2").arg(name, error));
+  onPairEnergyFinished();
+}
+
+void PairEnergyCalculator::onCustomTaskComplete(
+    pair_energy::Parameters params, CustomEnergyCalculatorTask *task) {
+  if (params.structure) {
+    // custom calculators report the interaction energy directly, in kJ/mol
+    auto *pair = new PairInteraction(params.model);
+    pair->addComponent("Total", task->interactionEnergy());
+    pair->setParameters(params);
+    params.structure->pairInteractions()->add(pair);
+  }
+  onPairEnergyFinished();
+}
+
 void PairEnergyCalculator::onXtbTaskComplete() {
   Task *taskBase = qobject_cast<Task*>(sender());
   if (!taskBase) {
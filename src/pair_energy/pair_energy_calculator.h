@@ -6,6 +6,7 @@
 #include "xtb_energy_calculator.h"
 
 class OccPairTask;
+class CustomEnergyCalculatorTask;
 
 class PairEnergyCalculator: public QObject {
     Q_OBJECT
@@ -16,14 +17,32 @@ public:
     void start(pair_energy::Parameters);
     void start_batch(const std::vector<pair_energy::Parameters> &);
 
+    // Match each requested pair to existing monomer wavefunctions on the
+    // structure, skipping pairs that already have an interaction for the
+    // model. Returns false if a pair has no matching wavefunctions.
+    static bool resolvePairParameters(
+        ChemicalStructure *,
+        const pair_energy::EnergyModelParameters &,
+        std::vector<pair_energy::Parameters> &);
+
 signals:
     void calculationComplete();
+    // Emitted for each pair that could not be computed; the calculation
+    // still completes once every other pair has finished
+    void errorOccurred(QString);
 
 private slots:
     void onPairEnergyTaskComplete();
     void onXtbTaskComplete();
+    void onCustomTaskComplete(pair_energy::Parameters, CustomEnergyCalculatorTask *);
 
 private:
+    // Add the interaction read from an occ pair result, counting it towards
+    // completion of the calculation
+    void onPairEnergyLoaded(const pair_energy::Parameters &, const QString &jsonFile);
+    void onPairEnergyFinished();
+    void onPairEnergyFailed(const QString &name, const QString &error);
+
     std::vector<GenericAtomIndex> m_atomsA;
     std::vector<GenericAtomIndex> m_atomsB;
     TaskManager * m_taskManager{nullptr};
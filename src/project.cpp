@@ -10,6 +10,7 @@
 #include "globals.h"
 #include "gulp.h"
 #include "pdbfile.h"
+#include "performancetimer.h"
 #include "project.h"
 #include "settings.h"
 #include "version.h"
@@ -204,6 +205,7 @@ void Project::deleteCurrentStructure() {
 }
 
 bool Project::saveToFile(QString filename) {
+  PERF_SCOPED_TIMER("Project save");
   try {
     // Convert to JSON
     nlohmann::json j = toJson();
@@ -425,28 +427,59 @@ bool Project::loadCrystalClearJson(const QString &filename) {
 }
 
 bool Project::loadCrystalStructuresFromCifFile(const QString &filename) {
-  CifFile cifReader;
-  bool success = cifReader.readFromFile(filename);
-  if (!success)
+  PERF_SCOPED_TIMER("CIF load");
+  if (!loadCifCatalogue(filename))
+    return false;
+  int block = m_cifCatalogue->firstValidBlock();
+  if (block < 0)
     return false;
+  return openCifBlocks({block});
+}
+
+bool Project::loadCifCatalogue(const QString &filename) {
+  PERF_SCOPED_TIMER("CIF index");
+  auto catalogue = std::make_shared<CifCatalogue>();
+  if (!catalogue->indexFile(filename))
+    return false;
+  m_cifCatalogue = catalogue;
+  return true;
+}
+
+bool Project::openCifBlocks(const QList<int> &blocks) {
+  if (!m_cifCatalogue)
+    return false;
+  PERF_SCOPED_TIMER("CIF block load");
+  const QString filename = m_cifCatalogue->fileName();
+  const bool multipleBlocks = m_cifCatalogue->numberOfBlocks() > 1;
+  const bool normalizeH =
+      settings::readSetting(settings::keys::XH_NORMALIZATION).toBool();
 
   int position = -1;
-  for (int i = 0; i < cifReader.numberOfCrystals(); i++) {
+  for (int block : blocks) {
+    CifFile cifReader;
+    if (!m_cifCatalogue->readBlock(block, cifReader)) {
+      qWarning() << "Unable to read block" << block << "from" << filename;
+      continue;
+    }
     CrystalStructure *tmp = new CrystalStructure();
-    tmp->setOccCrystal(cifReader.getCrystalStructure(i));
-    bool normalizeH = settings::readSetting(settings::keys::XH_NORMALIZATION).toBool();
+    tmp->setOccCrystal(cifReader.getCrystalStructure(0));
     tmp->normalizeHydrogenBondLengths(normalizeH);
-    tmp->setFileContents(cifReader.getCrystalCifContents(i));
+    tmp->setFileContents(cifReader.getCrystalCifContents(0));
     tmp->setFilename(filename);
-    tmp->setName(cifReader.getCrystalName(i));
+    tmp->setName(cifReader.getCrystalName(0));
     Scene *scene = new Scene(tmp);
-    scene->setTitle(QFileInfo(filename).baseName());
-    if (i == 0) {
-      position = m_scenes.size();
-      beginInsertRows(QModelIndex(), position, position);
-      m_scenes.append(scene);
-      endInsertRows();
+    QString title = QFileInfo(filename).baseName();
+    if (multipleBlocks) {
+      title = QString("%1 (%2)").arg(title, cifReader.getCrystalName(0));
     }
+    scene->setTitle(title);
+
+    const int row = m_scenes.size();
+    beginInsertRows(QModelIndex(), row, row);
+    m_scenes.append(scene);
+    endInsertRows();
+    if (position < 0)
+      position = row;
   }
 
   if (position > -1) {
@@ -455,10 +488,11 @@ bool Project::loadCrystalStructuresFromCifFile(const QString &filename) {
     emit sceneSelectionChanged(position);
   }
 
-  return true;
+  return position > -1;
 }
 
 bool Project::loadFromFile(QString filename) {
+  PERF_SCOPED_TIMER("Project load");
   qDebug() << "Load project from" << filename;
   QFile file(filename);
   if (!file.open(QIODevice::ReadOnly)) {
@@ -4,6 +4,7 @@
 #include <QDebug>
 #include <QObject>
 #include <QVector>
+#include <memory>
 
 #include "frameworkoptions.h"
 #include "json.h"
@@ -11,6 +12,7 @@
 #include "scene.h"
 
 class SlabStructure;
+class CifCatalogue;
 
 /*!
  \class Project
@@ -40,6 +42,11 @@ public:
 
   bool loadChemicalStructureFromXyzFile(const QString &);
   bool loadCrystalStructuresFromCifFile(const QString &);
+  // Index the data blocks of a CIF without building any structures, which
+  // are then added for the chosen blocks with openCifBlocks
+  bool loadCifCatalogue(const QString &);
+  inline const CifCatalogue *cifCatalogue() const { return m_cifCatalogue.get(); }
+  bool openCifBlocks(const QList<int> &blocks);
   bool loadCrystalStructuresFromPdbFile(const QString &);
   bool loadCrystalClearJson(const QString &);
   bool loadCrystalClearSurfaceJson(const QString &);
@@ -152,6 +159,7 @@ private:
   void resetModelState(); // New private helper method
 
   QVector<Scene *> m_scenes;
+  std::shared_ptr<CifCatalogue> m_cifCatalogue;
   int m_currentSceneIndex{-1};
   int m_previousSceneIndex{-1};
   QString _saveFilename;
@@ -147,6 +147,8 @@ void IsosurfaceCalculator::start(isosurface::Parameters params) {
 
   connect(surfaceTask, &Task::completed, this,
           &IsosurfaceCalculator::surfaceComplete);
+  connect(surfaceTask, &Task::errorOccurred, this,
+          &IsosurfaceCalculator::errorOccurred);
 }
 
 void setFragmentPatchForMesh(Mesh *mesh, ChemicalStructure *structure) {
@@ -220,6 +222,7 @@ void IsosurfaceCalculator::surfaceComplete() {
     instance->setObjectName("+ {x,y,z} [0,0,0]");
     idx++;
   }
+  emit calculationComplete(isosurface::Result{idx > 0});
 }
 
 } // namespace volume
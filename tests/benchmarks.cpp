@@ -0,0 +1,285 @@
+#define CATCH_CONFIG_RUNNER
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_session.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <QApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QWidget>
+#include <memory>
+
+#include "chemicalstructure.h"
+#include "crystalstructure.h"
+#include "fingerprintplot.h"
+#include "globalconfiguration.h"
+#include "isosurface_parameters.h"
+#include "mesh.h"
+#include "project.h"
+#include "surface_capping.h"
+#include <occ/core/element.h>
+#include <occ/crystal/crystal.h>
+
+// Micro-benchmarks for hot paths. Not registered with ctest; run with
+//   cmake --build . --target benchmark
+// or directly, e.g. cx_benchmarks --reporter JSON::out=baseline.json
+// then compare the mean/std-dev entries between two result files.
+
+namespace {
+
+auto bench_acetic_asym() {
+  const std::vector<std::string> labels = {"C1", "C2", "H1", "H2",
+                                           "H3", "H4", "O1", "O2"};
+  occ::IVec nums(labels.size());
+  occ::Mat positions(labels.size(), 3);
+  for (size_t i = 0; i < labels.size(); i++) {
+    nums(i) = occ::core::Element(labels[i]).atomic_number();
+  }
+  positions << 0.16510, 0.28580, 0.17090, 0.08940, 0.37620, 0.34810, 0.18200,
+      0.05100, -0.11600, 0.12800, 0.51000, 0.49100, 0.03300, 0.54000, 0.27900,
+      0.05300, 0.16800, 0.42100, 0.12870, 0.10750, 0.00000, 0.25290, 0.37030,
+      0.17690;
+  return occ::crystal::AsymmetricUnit(positions.transpose(), nums, labels);
+}
+
+OccCrystal bench_acetic_acid_crystal() {
+  occ::crystal::SpaceGroup sg(33);
+  occ::crystal::UnitCell cell =
+      occ::crystal::orthorhombic_cell(13.31, 4.1, 5.75);
+  return OccCrystal(bench_acetic_asym(), sg, cell);
+}
+
+// Same structure as above, as a file for the Project loaders
+const char *ACETIC_ACID_CIF = R"(data_acetic_acid
+_cell_length_a 13.31
+_cell_length_b 4.1
+_cell_length_c 5.75
+_cell_angle_alpha 90
+_cell_angle_beta 90
+_cell_angle_gamma 90
+_symmetry_space_group_name_H-M 'P n a 21'
+loop_
+_symmetry_equiv_pos_as_xyz
+x,y,z
+-x,-y,1/2+z
+1/2+x,1/2-y,z
+1/2-x,1/2+y,1/2+z
+loop_
+_atom_site_label
+_atom_site_type_symbol
+_atom_site_fract_x
+_atom_site_fract_y
+_atom_site_fract_z
+C1 C 0.16510 0.28580 0.17090
+C2 C 0.08940 0.37620 0.34810
+H1 H 0.18200 0.05100 -0.11600
+H2 H 0.12800 0.51000 0.49100
+H3 H 0.03300 0.54000 0.27900
+H4 H 0.05300 0.16800 0.42100
+O1 O 0.12870 0.10750 0.00000
+O2 O 0.25290 0.37030 0.17690
+)";
+
+// Cluster of n x n x n unit cells of acetic acid
+void bench_cluster(int n, std::vector<QString> &elements,
+                   std::vector<occ::Vec3> &positions) {
+  auto crystal = bench_acetic_acid_crystal();
+  const auto &uc = crystal.unit_cell_atoms();
+  for (int h = 0; h < n; h++) {
+    for (int k = 0; k < n; k++) {
+      for (int l = 0; l < n; l++) {
+        occ::Mat3N frac = uc.frac_pos.colwise() + occ::Vec3(h, k, l);
+        occ::Mat3N cart = crystal.to_cartesian(frac);
+        for (int i = 0; i < cart.cols(); i++) {
+          elements.push_back(QString::fromStdString(
+              occ::core::Element(uc.atomic_numbers(i)).symbol()));
+          positions.push_back(cart.col(i));
+        }
+      }
+    }
+  }
+}
+
+// Latitude/longitude sphere with outward facing triangles
+Mesh *bench_sphere(const occ::Vec3 &center, double radius, int nlat,
+                   int nlon) {
+  const int nv = 2 + (nlat - 1) * nlon;
+  Mesh::VertexList vertices(3, nv);
+  vertices.col(0) = center + occ::Vec3(0, 0, radius);
+  for (int i = 1; i < nlat; i++) {
+    double theta = M_PI * i / nlat;
+    for (int j = 0; j < nlon; j++) {
+      double phi = 2 * M_PI * j / nlon;
+      vertices.col(1 + (i - 1) * nlon + j) =
+          center + radius * occ::Vec3(std::sin(theta) * std::cos(phi),
+                                      std::sin(theta) * std::sin(phi),
+                                      std::cos(theta));
+    }
+  }
+  vertices.col(nv - 1) = center - occ::Vec3(0, 0, radius);
+
+  auto ring = [nlon](int i, int j) { return 1 + (i - 1) * nlon + (j % nlon); };
+  std::vector<Eigen::Vector3i> faces;
+  for (int j = 0; j < nlon; j++) {
+    faces.emplace_back(0, ring(1, j), ring(1, j + 1));
+    faces.emplace_back(nv - 1, ring(nlat - 1, j + 1), ring(nlat - 1, j));
+  }
+  for (int i = 1; i < nlat - 1; i++) {
+    for (int j = 0; j < nlon; j++) {
+      faces.emplace_back(ring(i, j), ring(i + 1, j), ring(i + 1, j + 1));
+      faces.emplace_back(ring(i, j), ring(i + 1, j + 1), ring(i, j + 1));
+    }
+  }
+  Mesh::FaceList faceList(3, faces.size());
+  for (size_t f = 0; f < faces.size(); f++) {
+    faceList.col(f) = faces[f];
+  }
+
+  auto *mesh = new Mesh(vertices, faceList);
+  Mesh::VertexList normals(3, nv);
+  for (int i = 0; i < nv; i++) {
+    normals.col(i) = (vertices.col(i) - center).normalized();
+  }
+  mesh->setVertexNormals(normals);
+  return mesh;
+}
+
+} // namespace
+
+TEST_CASE("Bond guessing", "[benchmark][bonds]") {
+  std::vector<QString> elements;
+  std::vector<occ::Vec3> positions;
+  bench_cluster(4, elements, positions);
+
+  ChemicalStructure structure;
+  structure.setAtoms(elements, positions);
+  REQUIRE(structure.numberOfAtoms() == 8 * 4 * 64);
+
+  BENCHMARK("updateBondGraph 2048 atoms") {
+    structure.updateBondGraph();
+    return structure.numberOfAtoms();
+  };
+}
+
+TEST_CASE("Unit cell connectivity", "[benchmark][crystal]") {
+  BENCHMARK_ADVANCED("CrystalStructure::setOccCrystal")
+  (Catch::Benchmark::Chronometer meter) {
+    std::vector<OccCrystal> crystals(meter.runs(), bench_acetic_acid_crystal());
+    std::vector<std::unique_ptr<CrystalStructure>> structures;
+    for (int i = 0; i < meter.runs(); i++) {
+      structures.push_back(std::make_unique<CrystalStructure>());
+    }
+    meter.measure([&](int i) { structures[i]->setOccCrystal(crystals[i]); });
+  };
+
+  BENCHMARK_ADVANCED("occ unit_cell_molecules")
+  (Catch::Benchmark::Chronometer meter) {
+    std::vector<OccCrystal> crystals(meter.runs(), bench_acetic_acid_crystal());
+    meter.measure(
+        [&](int i) { return crystals[i].unit_cell_molecules().size(); });
+  };
+
+  const OccCrystal acetic = bench_acetic_acid_crystal();
+  acetic.symmetry_unique_molecules(); // cached, not part of the measurement
+  BENCHMARK("occ symmetry_unique_dimers 12 Angstrom") {
+    return acetic.symmetry_unique_dimers(12.0).unique_dimers.size();
+  };
+
+  // 64 general positions in Fm-3m, 12288 sites before merging
+  occ::Mat3N positions = 0.5 * (occ::Mat3N::Random(3, 64).array() + 1.0);
+  occ::IVec nums = occ::IVec::Constant(64, 6);
+  const OccCrystal cubic(occ::crystal::AsymmetricUnit(positions, nums),
+                         occ::crystal::SpaceGroup(225),
+                         occ::crystal::cubic_cell(30.0));
+  BENCHMARK_ADVANCED("occ unit_cell_atoms Fm-3m")
+  (Catch::Benchmark::Chronometer meter) {
+    std::vector<OccCrystal> crystals(meter.runs(), cubic);
+    meter.measure([&](int i) { return crystals[i].unit_cell_atoms().size(); });
+  };
+}
+
+TEST_CASE("Fingerprint binning", "[benchmark][fingerprint]") {
+  std::unique_ptr<Mesh> mesh(bench_sphere(occ::Vec3::Zero(), 4.0, 128, 256));
+  const auto &v = mesh->vertices();
+  // smooth synthetic di/de spanning the usual plot range
+  Mesh::ScalarPropertyValues di(v.cols()), de(v.cols());
+  for (int i = 0; i < v.cols(); i++) {
+    di(i) = 1.4 + 0.6 * (v(2, i) / 4.0 + 1.0);
+    de(i) = 1.2 + 0.7 * (v(0, i) / 4.0 + 1.0);
+  }
+  mesh->setVertexProperty(isosurface::getSurfacePropertyDisplayName("di"), di);
+  mesh->setVertexProperty(isosurface::getSurfacePropertyDisplayName("de"), de);
+
+  QWidget container;
+  FingerprintPlot plot(&container);
+  BENCHMARK("FingerprintPlot::setMesh 65k faces") {
+    plot.setMesh(mesh.get());
+  };
+}
+
+TEST_CASE("Mesh point containment", "[benchmark][mesh]") {
+  std::unique_ptr<Mesh> mesh(bench_sphere(occ::Vec3::Zero(), 2.0, 32, 64));
+  occ::Mat3N points = occ::Mat3N::Random(3, 256) * 3.0;
+
+  BENCHMARK("containsPoint 256 points, 4k faces") {
+    int inside = 0;
+    for (int i = 0; i < points.cols(); i++) {
+      inside += mesh->containsPoint(points.col(i));
+    }
+    return inside;
+  };
+}
+
+TEST_CASE("Project save and load", "[benchmark][project]") {
+  QTemporaryDir dir;
+  REQUIRE(dir.isValid());
+  QString cifFile = dir.filePath("acetic_acid.cif");
+  {
+    QFile file(cifFile);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write(ACETIC_ACID_CIF);
+  }
+  QString projectFile = dir.filePath("acetic_acid.cxp.cbor");
+
+  Project project;
+  REQUIRE(project.loadCrystalStructuresFromCifFile(cifFile));
+  project.completeFragmentsForCurrentCrystal();
+  REQUIRE(project.saveToFile(projectFile));
+
+  BENCHMARK("Project::loadCrystalStructuresFromCifFile") {
+    Project p;
+    return p.loadCrystalStructuresFromCifFile(cifFile);
+  };
+
+  BENCHMARK("Project::saveToFile") { return project.saveToFile(projectFile); };
+
+  BENCHMARK("Project::loadFromFile") {
+    Project p;
+    return p.loadFromFile(projectFile);
+  };
+}
+
+TEST_CASE("Surface clipping", "[benchmark][surface]") {
+  CrystalStructure structure;
+  structure.setOccCrystal(bench_acetic_acid_crystal());
+  // centred in the cell but wider than b, so it crosses two cell faces
+  occ::Vec3 center = structure.cellVectors() * occ::Vec3(0.5, 0.5, 0.5);
+  std::unique_ptr<Mesh> mesh(bench_sphere(center, 3.0, 64, 128));
+  REQUIRE(SurfaceCapping::needsCapping(mesh.get(), &structure));
+
+  auto options = SurfaceCapping::getVoidSurfaceDefaults();
+  BENCHMARK("SurfaceCapping::applyCapping 16k faces") {
+    std::unique_ptr<Mesh> capped(
+        SurfaceCapping::applyCapping(mesh.get(), &structure, options));
+    return capped ? capped->numberOfFaces() : 0;
+  };
+}
+
+int main(int argc, char *argv[]) {
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  // Project and FingerprintPlot need a full application object
+  QApplication app(argc, argv);
+  GlobalConfiguration::getInstance()->load();
+  return Catch::Session().run(argc, argv);
+}
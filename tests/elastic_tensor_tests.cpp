@@ -291,4 +291,49 @@ TEST_CASE("ElasticTensorCollection management", "[core][elastic_tensor][collecti
         REQUIRE(newCollection.count() == 1);
         REQUIRE(newCollection.at(0)->name() == "Collection Test");
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("ElasticTensor batched directional properties", "[core][elastic_tensor][directional]") {
+    occ::Mat6 elasticMatrix;
+    elasticMatrix << 200, 60, 40, 5, 3, 1,
+                      60, 150, 50, 2, 4, 6,
+                      40, 50, 120, 1, 2, 3,
+                       5, 2, 1, 40, 3, 2,
+                       3, 4, 2, 3, 30, 1,
+                       1, 6, 3, 2, 1, 50;
+    occ::core::ElasticTensor tensor(elasticMatrix);
+
+    occ::Mat3N directions(3, 4);
+    directions << 1, 0, 1, 0.3,
+                  0, 1, 1, -0.7,
+                  0, 0, 1, 0.2;
+    directions.colwise().normalize();
+
+    auto props = tensor.directional_properties(directions);
+
+    for (int i = 0; i < directions.cols(); i++) {
+        occ::Vec3 a = directions.col(i);
+        REQUIRE(props.youngs_modulus(i) == Approx(tensor.youngs_modulus(a)));
+        REQUIRE(props.linear_compressibility(i) ==
+                Approx(tensor.linear_compressibility(a)));
+
+        // Analytic extrema must bound a fine angular scan
+        double shearMin = std::numeric_limits<double>::max();
+        double shearMax = std::numeric_limits<double>::lowest();
+        double poissonMin = std::numeric_limits<double>::max();
+        double poissonMax = std::numeric_limits<double>::lowest();
+        for (int j = 0; j < 720; j++) {
+            double angle = j * M_PI / 720;
+            shearMin = std::min(shearMin, tensor.shear_modulus(a, angle));
+            shearMax = std::max(shearMax, tensor.shear_modulus(a, angle));
+            poissonMin = std::min(poissonMin, tensor.poisson_ratio(a, angle));
+            poissonMax = std::max(poissonMax, tensor.poisson_ratio(a, angle));
+        }
+        REQUIRE(props.shear_modulus_min(i) <= shearMin + 1e-12);
+        REQUIRE(props.shear_modulus_max(i) >= shearMax - 1e-12);
+        REQUIRE(props.shear_modulus_min(i) == Approx(shearMin).epsilon(1e-4));
+        REQUIRE(props.shear_modulus_max(i) == Approx(shearMax).epsilon(1e-4));
+        REQUIRE(props.poisson_ratio_min(i) == Approx(poissonMin).epsilon(1e-4));
+        REQUIRE(props.poisson_ratio_max(i) == Approx(poissonMax).epsilon(1e-4));
+    }
+}
@@ -3,6 +3,9 @@
 #include <iostream>
 
 #include "mesh.h"
+#include "meshinstance.h"
+#include "geometry_primitives.h"
+#include "icosphere_mesh.h"
 #include "crystalstructure.h"
 #include <occ/crystal/crystal.h>
 
@@ -224,4 +227,84 @@ TEST_CASE("Mesh findAtomsInside with acetic acid crystal", "[mesh][crystal_struc
         
         delete cubeMesh;
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Mesh instance nearest point queries", "[mesh][nearest_point]") {
+    auto* cubeMesh = createTestCubeMesh(1.0);
+    MeshTransform shifted = MeshTransform::Identity();
+    shifted.rotate(Eigen::AngleAxisd(0.3, occ::Vec3(0, 0, 1)));
+    shifted.translation() = occ::Vec3(3.5, 0.25, 0.1);
+
+    auto* a = new MeshInstance(cubeMesh);
+    auto* b = new MeshInstance(cubeMesh, shifted);
+
+    SECTION("Nearest vertex to a point matches brute force") {
+        occ::Vec3 point(4.7, 1.9, -0.4);
+        auto result = b->nearestPoint(point);
+        const auto v = b->vertices();
+        Eigen::Index expected;
+        double d = (v.colwise() - point).colwise().norm().minCoeff(&expected);
+        REQUIRE(result.idx_this == expected);
+        REQUIRE(result.distance == Approx(d));
+    }
+
+    SECTION("Closest vertex pair between instances matches brute force") {
+        const auto va = a->vertices();
+        const auto vb = b->vertices();
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < va.cols(); i++) {
+            for (int j = 0; j < vb.cols(); j++) {
+                best = std::min(best, (va.col(i) - vb.col(j)).norm());
+            }
+        }
+        auto result = a->nearestPoint(b);
+        REQUIRE(result.distance == Approx(best));
+        REQUIRE((va.col(result.idx_this) - vb.col(result.idx_other)).norm() ==
+                Approx(best));
+
+        auto reversed = b->nearestPoint(a);
+        REQUIRE(reversed.distance == Approx(best));
+        REQUIRE((vb.col(reversed.idx_this) - va.col(reversed.idx_other)).norm() ==
+                Approx(best));
+    }
+
+    delete cubeMesh;
+}
+
+TEST_CASE("Shared icosphere primitives", "[mesh][icosphere]") {
+    using cx::primitives::icosphere;
+
+    REQUIRE(icosphere(-1) == nullptr);
+    REQUIRE(icosphere(cx::primitives::MaxIcosphereSubdivisions + 1) == nullptr);
+
+    for (int n = 0; n <= 4; n++) {
+        auto sphere = icosphere(n);
+        REQUIRE(sphere);
+        REQUIRE(sphere == icosphere(n));
+        REQUIRE(sphere->subdivisions == n);
+
+        // each subdivision quadruples the faces of the icosahedron
+        const size_t faces = 20 * (size_t(1) << (2 * n));
+        REQUIRE(sphere->numberOfFaces() == faces);
+        REQUIRE(sphere->numberOfVertices() == faces / 2 + 2);
+        REQUIRE(sphere->vertexData.size() == 3 * sphere->numberOfVertices());
+        REQUIRE(sphere->indexData.size() == 3 * faces);
+
+        const auto &v = sphere->vertices;
+        REQUIRE((v.colwise().norm().array() - 1.0).abs().maxCoeff() < 1e-12);
+        for (size_t i = 0; i < sphere->numberOfFaces(); i++) {
+            occ::Vec3 a = v.col(sphere->faces(0, i));
+            occ::Vec3 b = v.col(sphere->faces(1, i));
+            occ::Vec3 c = v.col(sphere->faces(2, i));
+            REQUIRE((b - a).cross(c - a).dot(a + b + c) > 0.0);
+        }
+    }
+
+    // coarser levels are a prefix of finer ones
+    REQUIRE(icosphere(3)->vertices.leftCols(162).isApprox(icosphere(2)->vertices));
+
+    Mesh *mesh = IcosphereMesh::create(2, 1.5);
+    REQUIRE(mesh != nullptr);
+    REQUIRE(mesh->numberOfVertices() == 162);
+    REQUIRE(mesh->vertices().colwise().norm().maxCoeff() == Approx(1.5));
+    delete mesh;
+}
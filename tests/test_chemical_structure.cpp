@@ -367,6 +367,28 @@ TEST_CASE("ChemicalStructure atom filtering", "[core][chemical_structure][filter
         auto surrounding = structure.atomsSurroundingAtomsWithFlags(selectedFlag, radius);
         REQUIRE(surrounding.size() >= 1);
     }
+
+    SECTION("Spatial index follows added atoms") {
+        auto index = structure.spatialIndex();
+        REQUIRE(index->size() == 4);
+        REQUIRE(structure.spatialIndex() == index); // reused while unchanged
+
+        auto generation = structure.positionGeneration();
+        structure.addAtoms({"Cl"}, {occ::Vec3(4.0, 0.0, 0.0)});
+        REQUIRE(structure.positionGeneration() != generation);
+
+        auto extended = structure.spatialIndex();
+        REQUIRE(extended->size() == 5);
+        REQUIRE(index->size() == 4); // earlier snapshot is untouched
+        auto [nearest, d2] = extended->nearest(occ::Vec3(3.9, 0.0, 0.0));
+        REQUIRE(nearest == 4);
+        REQUIRE(d2 == Approx(0.01));
+
+        auto surrounding = structure.atomsSurroundingAtoms(
+            {structure.indexToGenericIndex(4)}, 1.5f);
+        REQUIRE(surrounding.size() == 1);
+        REQUIRE(surrounding[0] == structure.indexToGenericIndex(3));
+    }
 }
 
 TEST_CASE("ChemicalStructure formula generation", "[core][chemical_structure]") {
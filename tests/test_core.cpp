@@ -5,7 +5,12 @@
 #include "fragment.h"
 #include "fragment_index.h"
 #include "generic_atom_index.h"
+#include "pair_energy_results.h"
+#include "performancetimer.h"
+#include <QFile>
+#include <QTemporaryDir>
 #include <nlohmann/json.hpp>
+#include <thread>
 
 using json = nlohmann::json;
 using Catch::Approx;
@@ -400,3 +405,136 @@ TEST_CASE("PublicationReference formatting", "[references]") {
         REQUIRE(fullCitation.contains("Journal of Applied Crystallography"));
     }
 }
+
+namespace {
+PairInteraction *makeInteraction(const QString &model, int u) {
+    auto *interaction = new PairInteraction(model);
+    pair_energy::Parameters params;
+    params.model = model;
+    params.fragmentDimer.index.b.u = u;
+    interaction->setParameters(params);
+    return interaction;
+}
+} // namespace
+
+TEST_CASE("PairInteractions component storage", "[core][pair_energy]") {
+    auto *a = makeInteraction("ce-1p", 0);
+    auto *b = makeInteraction("ce-1p", 1);
+    a->addComponent("Total", -10.0);
+    a->addComponent("Coulomb", -4.0);
+    b->addComponent("Total", -2.5);
+    REQUIRE(a->getComponent("Total") == Approx(-10.0));
+
+    PairInteractions interactions;
+    interactions.add(a);
+    interactions.add(b);
+
+    const int total = interactions.componentId("Total");
+    const int coulomb = interactions.componentId("Coulomb");
+    REQUIRE(total >= 0);
+    REQUIRE(coulomb >= 0);
+    REQUIRE(interactions.componentId("Repulsion") == -1);
+
+    SECTION("Values are read by name or id") {
+        REQUIRE(a->owner() == &interactions);
+        REQUIRE(a->getComponent("Coulomb") == Approx(-4.0));
+        REQUIRE(b->getComponent(total) == Approx(-2.5));
+        REQUIRE_FALSE(b->hasComponent(coulomb));
+        REQUIRE(b->getComponent("Coulomb") == 0.0);
+        REQUIRE(b->components().size() == 1);
+        REQUIRE(interactions.filterByModelAndComponent("ce-1p", "Coulomb").size() == 1);
+    }
+
+    SECTION("Columns hold every interaction of the model") {
+        const auto &rows = interactions.storedInteractions("ce-1p");
+        const auto &values = interactions.componentValues("ce-1p", "Total");
+        REQUIRE(rows.size() == 2);
+        REQUIRE(values.size() == 2);
+        for (size_t i = 0; i < rows.size(); i++) {
+            REQUIRE(values[i] == Approx(rows[i]->getComponent(total)));
+        }
+        REQUIRE(interactions.componentValues("ce-1p", "Repulsion").empty());
+    }
+
+    SECTION("Components added later extend the columns") {
+        b->addComponent("Coulomb", -1.0);
+        REQUIRE(b->getComponent(coulomb) == Approx(-1.0));
+        REQUIRE(interactions.interactionComponents("ce-1p").size() == 2);
+    }
+
+    SECTION("Removed interactions keep their values") {
+        interactions.remove(a);
+        REQUIRE(a->owner() == nullptr);
+        REQUIRE(a->getComponent("Total") == Approx(-10.0));
+        REQUIRE(a->getComponent("Coulomb") == Approx(-4.0));
+        REQUIRE(b->getComponent(total) == Approx(-2.5));
+        REQUIRE(interactions.storedInteractions("ce-1p").size() == 1);
+        delete a;
+        a = nullptr;
+    }
+
+    delete a;
+    delete b;
+    REQUIRE(interactions.storedInteractions("ce-1p").empty());
+}
+
+TEST_CASE("PairInteractions JSON round trip", "[core][pair_energy]") {
+    auto *a = makeInteraction("ce-1p", 0);
+    a->addComponent("Total", -10.0);
+    a->addComponent("Coulomb", -4.0);
+
+    PairInteractions interactions;
+    interactions.add(a);
+
+    const auto json = interactions.toJson();
+    REQUIRE(json["interactions"]["ce-1p"][0]["components"].size() == 2);
+
+    PairInteractions restored;
+    REQUIRE(restored.fromJson(json));
+    const auto &rows = restored.storedInteractions("ce-1p");
+    REQUIRE(rows.size() == 1);
+    REQUIRE(rows[0]->getComponent("Total") == Approx(-10.0));
+    REQUIRE(rows[0]->getComponent("Coulomb") == Approx(-4.0));
+    REQUIRE(restored.componentValues("ce-1p", "Total").size() == 1);
+
+    delete a;
+}
+
+TEST_CASE("Trace events of exited threads are exported", "[core][trace]") {
+    auto &timer = PerformanceTimer::instance();
+    timer.setTracingEnabled(true);
+    timer.clearTrace();
+
+    auto record = [&timer](const QString &name) {
+        std::thread thread([&timer, name]() {
+            timer.recordTraceEvent('B', name);
+            timer.recordTraceEvent('E', name);
+        });
+        thread.join();
+    };
+    // the second thread reuses the buffer of the first
+    record("first thread");
+    record("second thread");
+    timer.setTracingEnabled(false);
+
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString filename = dir.filePath("trace.json");
+    REQUIRE(timer.writeTrace(filename));
+
+    QFile file(filename);
+    REQUIRE(file.open(QIODevice::ReadOnly));
+    auto trace = json::parse(file.readAll().toStdString());
+    int first = 0, second = 0;
+    for (const auto &event : trace["traceEvents"]) {
+        if (event["ph"] == "M")
+            continue;
+        if (event["name"] == "first thread")
+            first++;
+        if (event["name"] == "second thread")
+            second++;
+    }
+    REQUIRE(first == 2);
+    REQUIRE(second == 2);
+    timer.clearTrace();
+}
@@ -4,6 +4,7 @@
 
 #include "crystalstructure.h"
 #include "slab_options.h"
+#include "surface_cut_generator.h"
 #include <occ/crystal/crystal.h>
 
 using Catch::Approx;
@@ -198,3 +199,108 @@ TEST_CASE("CrystalStructure atomsInBoundingBox", "[crystal][crystal_structure][b
     }
 }
 
+
+TEST_CASE("Surface cut screening", "[crystal][surface][screening]") {
+    CrystalStructure structure;
+    OccCrystal crystal = acetic_acid_crystal();
+    structure.setOccCrystal(crystal);
+
+    std::vector<occ::crystal::HKL> faces{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    auto candidates = cx::crystal::screenSurfaceCuts(&structure, faces);
+    REQUIRE(candidates.size() > 0);
+
+    SECTION("Candidates are ranked by cut dimer count") {
+        for (size_t i = 1; i < candidates.size(); i++) {
+            REQUIRE(candidates[i - 1].cutDimers <= candidates[i].cutDimers);
+        }
+    }
+
+    SECTION("Counts agree with explicit surface cut") {
+        const auto &dimers = structure.unitCellDimers();
+        for (const auto &candidate : candidates) {
+            occ::crystal::Surface surface(candidate.hkl, crystal);
+            auto cut = surface.count_crystal_dimers_cut_by_surface(
+                dimers, candidate.cutOffset);
+            int above = 0;
+            for (const auto &counts : cut.above) {
+                for (int c : counts) above += c;
+            }
+            REQUIRE(candidate.cutDimers == above);
+        }
+    }
+
+    SECTION("Result limit") {
+        cx::crystal::SurfaceCutScreeningOptions options;
+        options.maxResults = 1;
+        auto limited = cx::crystal::screenSurfaceCuts(&structure, faces, options);
+        REQUIRE(limited.size() == 1);
+        REQUIRE(limited[0].cutDimers == candidates[0].cutDimers);
+    }
+}
+
+TEST_CASE("Unit cell atom merging", "[crystal][unit_cell]") {
+    SECTION("General positions are all kept") {
+        OccCrystal crystal = acetic_acid_crystal();
+        REQUIRE(crystal.unit_cell_atoms().size() == 32); // 8 atoms x 4 symops
+    }
+
+    SECTION("Special positions and images across the cell boundary merge") {
+        occ::Mat3N positions(3, 3);
+        positions << 0.0, 0.5, 0.1,
+                     0.0, 0.5, 0.2,
+                     0.0, 0.99999, 0.3;
+        occ::IVec nums(3);
+        nums << 6, 8, 1;
+        occ::crystal::AsymmetricUnit asym(positions, nums, {"C1", "O1", "H1"});
+        // P-1: the inversion centre at the origin maps C1 onto itself, and
+        // O1 onto (0.5, 0.5, 0.00001), an image of itself in the next cell
+        OccCrystal crystal(asym, occ::crystal::SpaceGroup(2),
+                           occ::crystal::cubic_cell(10.0));
+        const auto &uc = crystal.unit_cell_atoms();
+        REQUIRE(uc.size() == 4);
+        CHECK(uc.asym_idx(0) == 0);
+        CHECK(uc.asym_idx(1) == 1);
+        CHECK(uc.asym_idx(2) == 2);
+        CHECK(uc.asym_idx(3) == 2);
+    }
+}
+
+TEST_CASE("Crystal dimer deduplication", "[crystal][dimers]") {
+    OccCrystal crystal = acetic_acid_crystal();
+    const double radius = 6.0;
+
+    auto checkDimers = [radius](const occ::crystal::CrystalDimers &dimers) {
+        const auto &unique = dimers.unique_dimers;
+        REQUIRE(!unique.empty());
+        for (size_t i = 0; i < unique.size(); i++) {
+            CHECK(unique[i].nearest_distance() < radius);
+            if (i > 0) {
+                CHECK(unique[i - 1].nearest_distance() <= unique[i].nearest_distance());
+            }
+            for (size_t j = 0; j < i; j++) {
+                CHECK_FALSE(unique[i] == unique[j]);
+            }
+        }
+        for (const auto &neighbors : dimers.molecule_neighbors) {
+            for (const auto &[dimer, index] : neighbors) {
+                REQUIRE(index >= 0);
+                REQUIRE(index < static_cast<int>(unique.size()));
+                CHECK(dimer == unique[index]);
+            }
+        }
+    };
+
+    SECTION("Symmetry unique dimers") {
+        const auto dimers = crystal.symmetry_unique_dimers(radius);
+        REQUIRE(dimers.molecule_neighbors.size() ==
+                crystal.symmetry_unique_molecules().size());
+        checkDimers(dimers);
+    }
+
+    SECTION("Unit cell dimers") {
+        const auto dimers = crystal.unit_cell_dimers(radius);
+        REQUIRE(dimers.molecule_neighbors.size() ==
+                crystal.unit_cell_molecules().size());
+        checkDimers(dimers);
+    }
+}
@@ -8,9 +8,22 @@
 #include "pair_energy_results.h"
 #include "crystalclear.h"
 #include "crystalstructure.h"
+#include "load_mesh.h"
+#include "ciffile.h"
+#include "tinyply.h"
+#include "streaming_image_writer.h"
+#include "gltf_exporter.h"
+#include "scene_export_data.h"
+#include <fastgltf/core.hpp>
+#include <QImage>
+#include <QImageReader>
+#include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QFile>
 #include <QDir>
+#include <algorithm>
+#include <fstream>
+#include <map>
 
 using Catch::Approx;
 
@@ -136,4 +149,273 @@ TEST_CASE("save_pair_energy_json functionality", "[io][pair_energy]") {
         bool result = save_pair_energy_json(nullptr, filename);
         REQUIRE_FALSE(result);
     }
-}
\ No newline at end of file
+}
+
+namespace {
+// A tetrahedron with normals and one float property, written by tinyply
+void writeTetrahedronPly(const QString &filename, bool binary) {
+    std::vector<float> positions{0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+    std::vector<float> normals{-1, -1, -1, 1, 0, 0, 0, 1, 0, 0, 0, 1};
+    std::vector<float> values{0.5f, 1.5f, 2.5f, 3.5f};
+    std::vector<uint32_t> faces{0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3};
+
+    tinyply::PlyFile ply;
+    ply.add_properties_to_element("vertex", {"x", "y", "z"},
+                                  tinyply::Type::FLOAT32, 4,
+                                  reinterpret_cast<uint8_t *>(positions.data()),
+                                  tinyply::Type::INVALID, 0);
+    ply.add_properties_to_element("vertex", {"nx", "ny", "nz"},
+                                  tinyply::Type::FLOAT32, 4,
+                                  reinterpret_cast<uint8_t *>(normals.data()),
+                                  tinyply::Type::INVALID, 0);
+    ply.add_properties_to_element("vertex", {"d_e"}, tinyply::Type::FLOAT32, 4,
+                                  reinterpret_cast<uint8_t *>(values.data()),
+                                  tinyply::Type::INVALID, 0);
+    ply.add_properties_to_element("face", {"vertex_indices"},
+                                  tinyply::Type::UINT32, 4,
+                                  reinterpret_cast<uint8_t *>(faces.data()),
+                                  tinyply::Type::UINT8, 3);
+    std::ofstream file(filename.toStdString(), std::ios::binary);
+    ply.write(file, binary);
+}
+} // namespace
+
+TEST_CASE("Loading PLY meshes", "[io][ply]") {
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    QStringList filenames{dir.filePath("binary.ply"), dir.filePath("ascii.ply")};
+    writeTetrahedronPly(filenames[0], true);
+    writeTetrahedronPly(filenames[1], false);
+
+    for (bool preload : {true, false}) {
+        QList<Mesh *> meshes = io::loadMeshes(filenames, preload);
+        REQUIRE(meshes.size() == 2);
+        for (auto *mesh : meshes) {
+            REQUIRE(mesh != nullptr);
+            REQUIRE(mesh->numberOfVertices() == 4);
+            REQUIRE(mesh->numberOfFaces() == 4);
+            REQUIRE(mesh->vertices()(0, 1) == Approx(1.0));
+            REQUIRE(mesh->vertices()(2, 3) == Approx(1.0));
+            REQUIRE(mesh->faces()(1, 0) == 2);
+            REQUIRE(mesh->faces()(2, 3) == 3);
+            REQUIRE(mesh->vertexNormals()(0, 0) == Approx(-1.0));
+            REQUIRE(mesh->availableVertexProperties().size() == 2);
+            REQUIRE(mesh->surfaceArea() > 0.0);
+        }
+        qDeleteAll(meshes);
+    }
+}
+
+TEST_CASE("Indexing multi-block CIF files", "[io][cif]") {
+    auto block = [](const QString &name, double a) {
+        return QString(
+            "data_%1\n"
+            "_chemical_formula_sum 'C6 H6'\n"
+            "_symmetry_space_group_name_H-M 'P 1'\n"
+            "_cell_length_a %2\n"
+            "_cell_length_b 6.0\n"
+            "_cell_length_c 7.0(2)\n"
+            "_cell_angle_alpha 90\n"
+            "_cell_angle_beta 90\n"
+            "_cell_angle_gamma 90\n"
+            "_publ_section_comment\n"
+            ";\n"
+            "data_not_a_block\n"
+            ";\n"
+            "loop_\n"
+            "_atom_site_label\n"
+            "_atom_site_type_symbol\n"
+            "_atom_site_fract_x\n"
+            "_atom_site_fract_y\n"
+            "_atom_site_fract_z\n"
+            "C1 C 0.1 0.2 0.3\n"
+            "H1 H 0.2 0.2 0.3\n").arg(name).arg(a);
+    };
+    QByteArray contents = ("# header comment\n" + block("first", 5.0) +
+                           "data_empty\n_cell_length_a 4.0\n" +
+                           block("third", 8.0)).toUtf8();
+
+    CifCatalogue catalogue;
+    REQUIRE(catalogue.indexContents(contents));
+    REQUIRE(catalogue.numberOfBlocks() == 3);
+
+    const auto &first = catalogue.summary(0);
+    REQUIRE(first.name == "first");
+    REQUIRE(first.formula == "C6 H6");
+    REQUIRE(first.spaceGroup == "P 1");
+    REQUIRE(first.cell[0] == Approx(5.0));
+    REQUIRE(first.cell[2] == Approx(7.0));
+    REQUIRE(first.cell[5] == Approx(90.0));
+    REQUIRE(first.numberOfAtomSites == 2);
+    REQUIRE(first.isValid());
+
+    REQUIRE(catalogue.summary(1).name == "empty");
+    REQUIRE_FALSE(catalogue.summary(1).isValid());
+    REQUIRE(catalogue.firstValidBlock() == 0);
+
+    SECTION("Block contents are the original text") {
+        QByteArray third = catalogue.blockContents(2);
+        REQUIRE(third.startsWith("data_third\n"));
+        REQUIRE(third == block("third", 8.0).toUtf8());
+    }
+
+    SECTION("Blocks are read on demand") {
+        CifFile cif;
+        REQUIRE(catalogue.readBlock(2, cif));
+        REQUIRE(cif.numberOfCrystals() == 1);
+        REQUIRE(cif.getCrystalName(0) == "third");
+        REQUIRE(cif.getCrystalStructure(0).unit_cell().a() == Approx(8.0));
+        REQUIRE(cif.getCrystalCifContents(0) == block("third", 8.0).toUtf8());
+
+        CifFile invalid;
+        REQUIRE_FALSE(catalogue.readBlock(1, invalid));
+    }
+
+    SECTION("Files are indexed without keeping their contents") {
+        QTemporaryDir dir;
+        QString path = dir.filePath("blocks.cif");
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write(contents);
+        file.close();
+
+        CifCatalogue fromFile;
+        REQUIRE(fromFile.indexFile(path));
+        REQUIRE(fromFile.numberOfBlocks() == 3);
+        REQUIRE(fromFile.summary(2).cell[0] == Approx(8.0));
+        REQUIRE(fromFile.blockContents(2) == catalogue.blockContents(2));
+    }
+}
+
+TEST_CASE("Writing images in bands of rows", "[io][image]") {
+    using cx::io::StreamingImageWriter;
+    const int width = 37;
+    const int height = 53;
+    QImage image(width, height, QImage::Format_RGBA8888);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            image.setPixelColor(x, y, QColor(x * 6, y * 4, (x + y) % 256, 255 - y));
+        }
+    }
+
+    QTemporaryDir dir;
+    auto writeInBands = [&](const QString &path) {
+        auto format = StreamingImageWriter::formatForFilename(path);
+        REQUIRE(format.has_value());
+        StreamingImageWriter writer(path, width, height, *format);
+        REQUIRE(writer.open());
+        for (int y = 0; y < height; y += 16) {
+            REQUIRE(writer.writeRows(image.copy(0, y, width, std::min(16, height - y))));
+        }
+        REQUIRE(writer.finish());
+    };
+
+    SECTION("PNG") {
+        const QString path = dir.filePath("bands.png");
+        writeInBands(path);
+        QImage loaded(path);
+        REQUIRE(loaded.size() == image.size());
+        REQUIRE(loaded.convertToFormat(QImage::Format_RGBA8888) == image);
+    }
+
+    SECTION("TIFF") {
+        const QString path = dir.filePath("bands.tif");
+        writeInBands(path);
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        REQUIRE(file.read(4) == QByteArray("II*\0", 4));
+        if (QImageReader::supportedImageFormats().contains("tiff")) {
+            QImage loaded(path);
+            REQUIRE(loaded.convertToFormat(QImage::Format_RGBA8888) == image);
+        }
+    }
+
+    SECTION("Incomplete images are not kept") {
+        const QString path = dir.filePath("incomplete.png");
+        {
+            StreamingImageWriter writer(path, width, height,
+                                        StreamingImageWriter::Format::PNG);
+            REQUIRE(writer.open());
+            REQUIRE(writer.writeRows(image.copy(0, 0, width, 10)));
+            REQUIRE_FALSE(writer.finish());
+        }
+        REQUIRE_FALSE(QFile::exists(path));
+    }
+}
+
+TEST_CASE("Exporting instanced glTF", "[io][gltf]") {
+    using cx::graphics::ExportCylinder;
+    using cx::graphics::ExportSphere;
+    cx::graphics::SceneExportData data;
+    auto addSphere = [&](QVector3D position, const QString &group) {
+        data.spheres().push_back(ExportSphere{position, 0.5f, Qt::gray, "Atom", group, {}});
+    };
+    addSphere({0, 0, 0}, "Atoms/C");
+    addSphere({1.5f, 0, 0}, "Atoms/C");
+    addSphere({-1, 0, 0}, "Atoms/H");
+    auto addCylinder = [&](QVector3D start, QVector3D end, QColor color) {
+        data.cylinders().push_back(ExportCylinder{start, end, 0.1f, color, "Bond", "Bonds"});
+    };
+    addCylinder({0, 0, 0}, {0.75f, 0, 0}, Qt::red);
+    addCylinder({0.75f, 0, 0}, {1.5f, 0, 0}, Qt::red);
+    addCylinder({0, 0, 0}, {-1, 0, 0}, Qt::blue);
+
+    // instances expected in the node for each mesh
+    const std::map<std::string, size_t> expected{
+        {"Sphere_Atoms/C", 2}, {"Sphere_Atoms/H", 1},
+        {"Cylinders_#ff0000", 2}, {"Cylinders_#0000ff", 1}};
+
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    for (bool quantize : {false, true}) {
+        const QString path = dir.filePath(quantize ? "quantized.glb" : "instanced.glb");
+        cx::core::GLTFExporter::ExportOptions options;
+        options.gpuInstancing = true;
+        options.quantizeInstances = quantize;
+        cx::core::GLTFExporter exporter;
+        REQUIRE(exporter.exportSceneData(data, path, options));
+
+        auto buffer = fastgltf::GltfDataBuffer::FromPath(path.toStdString());
+        REQUIRE(buffer.error() == fastgltf::Error::None);
+        fastgltf::Parser parser(fastgltf::Extensions::EXT_mesh_gpu_instancing |
+                                fastgltf::Extensions::KHR_mesh_quantization);
+        auto asset = parser.loadGltfBinary(buffer.get(), dir.path().toStdString());
+        REQUIRE(asset.error() == fastgltf::Error::None);
+
+        const auto &required = asset->extensionsRequired;
+        auto isRequired = [&](std::string_view name) {
+            return std::find(required.begin(), required.end(), name) != required.end();
+        };
+        REQUIRE(isRequired("EXT_mesh_gpu_instancing"));
+        REQUIRE(isRequired("KHR_mesh_quantization") == quantize);
+
+        // one mesh and one node per material group, plus the root node
+        REQUIRE(asset->meshes.size() == expected.size());
+        REQUIRE(asset->nodes.size() == expected.size() + 1);
+
+        size_t instancedNodes = 0;
+        for (const auto &node : asset->nodes) {
+            if (!node.meshIndex.has_value())
+                continue;
+            instancedNodes++;
+            const std::string meshName(asset->meshes[*node.meshIndex].name);
+            INFO(meshName);
+            REQUIRE(expected.contains(meshName));
+
+            std::map<std::string, size_t> accessors;
+            for (const auto &attribute : node.instancingAttributes) {
+                accessors[std::string(attribute.name)] = attribute.accessorIndex;
+            }
+            REQUIRE(accessors.contains("TRANSLATION"));
+            REQUIRE(accessors.contains("SCALE"));
+            REQUIRE(accessors.contains("ROTATION") == meshName.starts_with("Cylinders"));
+            for (const auto &[name, index] : accessors) {
+                REQUIRE(asset->accessors[index].count == expected.at(meshName));
+            }
+            const auto &translation = asset->accessors[accessors["TRANSLATION"]];
+            REQUIRE(translation.componentType == (quantize ? fastgltf::ComponentType::Short
+                                                           : fastgltf::ComponentType::Float));
+        }
+        REQUIRE(instancedNodes == expected.size());
+    }
+}
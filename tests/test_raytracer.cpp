@@ -0,0 +1,145 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "chemicalstructure.h"
+#include "raytracer.h"
+#include "structure_export_data.h"
+
+using cx::graphics::ExportCylinder;
+using cx::graphics::ExportMesh;
+using cx::graphics::ExportSphere;
+using cx::graphics::RayTracer;
+using cx::graphics::RayTracerCamera;
+using cx::graphics::RayTracerOptions;
+using cx::graphics::SceneExportData;
+
+namespace {
+
+SceneExportData sphereAndBond() {
+    SceneExportData data;
+    ExportSphere sphere;
+    sphere.position = QVector3D(0.0f, 0.0f, 0.0f);
+    sphere.radius = 1.0f;
+    sphere.color = QColor(Qt::red);
+    data.spheres().push_back(sphere);
+
+    ExportCylinder bond;
+    bond.startPosition = QVector3D(0.0f, 0.0f, 0.0f);
+    bond.endPosition = QVector3D(3.0f, 0.0f, 0.0f);
+    bond.radius = 0.2f;
+    bond.color = QColor(Qt::gray);
+    data.cylinders().push_back(bond);
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("Ray tracing export data", "[graphics][raytracer]") {
+    SceneExportData data = sphereAndBond();
+    RayTracerOptions options;
+    options.width = 64;
+    options.height = 48;
+    options.background = QColor(Qt::blue);
+    options.samplesPerPixel = 1;
+    options.ambientOcclusionSamples = 4;
+    options.tileSize = 16;
+
+    const RayTracer tracer(data);
+    REQUIRE(tracer.numberOfPrimitives() == 2);
+
+    // looking down -z at the sphere, with the reversed depth range of GLWindow
+    RayTracerCamera camera;
+    camera.view.translate(0.0f, 0.0f, -10.0f);
+    camera.projection.ortho(-4.0f, 4.0f, -3.0f, 3.0f, 200.0f, -50.0f);
+
+    const QImage image = tracer.render(camera, options);
+    REQUIRE(image.size() == QSize(64, 48));
+    const QColor centre = image.pixelColor(32, 24);
+    CHECK(centre.red() > 100);
+    CHECK(centre.blue() < 50);
+    CHECK(image.pixelColor(1, 1) == QColor(Qt::blue));
+
+    SECTION("Bands arrive in order and match the whole image") {
+        int nextRow = 0;
+        const bool finished = tracer.render(
+            camera, options, [&](const QImage &band, int firstRow) {
+                REQUIRE(firstRow == nextRow);
+                REQUIRE(band.width() == options.width);
+                REQUIRE(band.convertToFormat(image.format()) ==
+                        image.copy(0, firstRow, band.width(), band.height()));
+                nextRow += band.height();
+                return true;
+            });
+        CHECK(finished);
+        CHECK(nextRow == options.height);
+    }
+
+    SECTION("Rendering stops when asked") {
+        int bands = 0;
+        CHECK_FALSE(tracer.render(camera, options,
+                                  [&](const QImage &, int) {
+                                      bands++;
+                                      return false;
+                                  }));
+        CHECK(bands == 1);
+    }
+
+    SECTION("Translucent meshes blend with what is behind them") {
+        ExportMesh mesh;
+        mesh.vertices = {-4.0f, -3.0f, 2.0f, 4.0f, -3.0f, 2.0f,
+                         4.0f,  3.0f,  2.0f, -4.0f, 3.0f, 2.0f};
+        mesh.indices = {0, 1, 2, 0, 2, 3};
+        mesh.fallbackColor = QColor(Qt::white);
+        mesh.opacity = 0.5f;
+        data.meshes().push_back(mesh);
+
+        const QImage covered = RayTracer(data).render(camera, options);
+        const QColor corner = covered.pixelColor(1, 1);
+        CHECK(corner.red() > 50);
+        CHECK(corner.blue() > corner.red());
+        CHECK(covered.pixelColor(32, 24).red() > 100);
+    }
+
+    SECTION("A fitted camera frames the whole scene") {
+        const auto fitted = RayTracerCamera::fitting(data, 4.0f / 3.0f);
+        const QImage framed = tracer.render(fitted, options);
+        // bond end at the right, sphere at the left, margins all round
+        CHECK(framed.pixelColor(0, 24) == QColor(Qt::blue));
+        CHECK(framed.pixelColor(63, 24) == QColor(Qt::blue));
+        CHECK(framed.pixelColor(24, 24) != QColor(Qt::blue));
+    }
+}
+
+TEST_CASE("Export data for a structure without a renderer", "[graphics][raytracer]") {
+    ChemicalStructure structure;
+    structure.setAtoms({"O", "H", "H"},
+                       {occ::Vec3(0.0, 0.0, 0.0), occ::Vec3(0.96, 0.0, 0.0),
+                        occ::Vec3(-0.24, 0.93, 0.0)});
+    structure.updateBondGraph();
+    structure.setFlagForAtoms({structure.indexToGenericIndex(2)},
+                              AtomFlag::Suppressed);
+
+    const SceneExportData data = cx::graphics::structureExportData(structure);
+    REQUIRE(data.spheres().size() == 2);
+    CHECK(data.spheres()[0].radius > data.spheres()[1].radius);
+    // only the O-H bond between visible atoms, as two halves
+    CHECK(data.cylinders().size() == 2);
+    CHECK(data.meshes().empty());
+
+    RayTracerOptions options;
+    options.width = 32;
+    options.height = 32;
+    options.background = QColor(Qt::blue);
+    options.samplesPerPixel = 1;
+    options.ambientOcclusionSamples = 0;
+    const QImage image = RayTracer(data).render(
+        RayTracerCamera::fitting(data, 1.0f), options);
+    int covered = 0;
+    for (int y = 0; y < image.height(); y++) {
+        for (int x = 0; x < image.width(); x++) {
+            if (image.pixelColor(x, y) != QColor(Qt::blue))
+                covered++;
+        }
+    }
+    CHECK(image.pixelColor(0, 0) == QColor(Qt::blue));
+    CHECK(covered > 0);
+}
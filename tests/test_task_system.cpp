@@ -3,6 +3,10 @@
 #include "task.h"
 #include "taskmanager.h"
 #include "taskbackend.h"
+#include "processsupervisor.h"
+#include "calculatorworkerpool.h"
+#include "exefileutilities.h"
+#include <QTemporaryDir>
 #include <QtTest/QSignalSpy>
 #include <QtTest/QTest>
 
@@ -327,6 +331,18 @@ TEST_CASE("TaskManager basic operations", "[task][manager][basic]") {
         REQUIRE(manager.numTasks() == 0);
     }
 
+    SECTION("Cancel task waiting for threads") {
+        manager.setMaximumConcurrency(1);
+        TestTask *task = new TestTask();
+        task->setProperty("threads", 2);
+        TaskID id = manager.add(task);
+
+        REQUIRE_FALSE(task->isRunning());
+        manager.cancel(id);
+        REQUIRE(manager.numTasks() == 0);
+        REQUIRE(manager.get(id) == nullptr);
+    }
+
     SECTION("Get returns nullptr for invalid ID") {
         TaskID invalidId = TaskID::createUuid();
         REQUIRE(manager.get(invalidId) == nullptr);
@@ -458,4 +474,221 @@ TEST_CASE("TaskManager task execution", "[task][manager][execution]") {
     }
 }
 
+TEST_CASE("Staging task files", "[task][files]") {
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString source = dir.filePath("input.txt");
+    {
+        QFile file(source);
+        REQUIRE(file.open(QIODevice::WriteOnly));
+        file.write("wavefunction");
+    }
+
+    SECTION("Staged inputs share the source contents") {
+        const QString dest = dir.filePath("staged.txt");
+        exe::StagingMethod method;
+        REQUIRE(exe::stageFile(source, dest, false, &method));
+        REQUIRE(exe::readFileContents(dest) == QString("wavefunction"));
+        // existing files are only replaced when overwriting
+        REQUIRE_FALSE(exe::stageFile(source, dest, false));
+        REQUIRE(exe::stageFile(source, dest, true));
+    }
+
+    SECTION("Outputs are moved") {
+        const QString dest = dir.filePath("moved.txt");
+        REQUIRE(exe::moveFile(source, dest, false));
+        REQUIRE_FALSE(QFileInfo::exists(source));
+        REQUIRE(exe::readFileContents(dest) == QString("wavefunction"));
+    }
+
+    SECTION("Hashes identify contents") {
+        const QByteArray hash = exe::fileHash(source);
+        REQUIRE(hash == QByteArray("f45875e0b18fa3bb81e0739952acbea9ed458113"));
+        // cached until the file changes
+        REQUIRE(exe::fileHash(source) == hash);
+        REQUIRE(exe::fileHash(dir.filePath("missing.txt")).isEmpty());
+    }
+}
+
+TEST_CASE("Output ring buffer", "[task][process][buffer]") {
+    SECTION("Keeps everything below capacity") {
+        OutputRingBuffer buffer(16);
+        buffer.append("hello ");
+        buffer.append("world");
+        REQUIRE(buffer.contents() == QByteArray("hello world"));
+        REQUIRE(buffer.droppedBytes() == 0);
+    }
+
+    SECTION("Drops the oldest output once full") {
+        OutputRingBuffer buffer(8);
+        buffer.append("abcdef");
+        buffer.append("ghij");
+        REQUIRE(buffer.contents() == QByteArray("cdefghij"));
+        buffer.append("klm");
+        REQUIRE(buffer.contents() == QByteArray("fghijklm"));
+        REQUIRE(buffer.totalBytesWritten() == 13);
+        REQUIRE(buffer.droppedBytes() == 5);
+    }
+
+    SECTION("Chunks larger than the capacity keep their tail") {
+        OutputRingBuffer buffer(4);
+        buffer.append("ab");
+        buffer.append("0123456789");
+        REQUIRE(buffer.contents() == QByteArray("6789"));
+    }
+}
+
+#ifdef Q_OS_UNIX
+TEST_CASE("Process supervisor", "[task][process][supervisor]") {
+    ProcessSupervisor supervisor;
+
+    SECTION("Collects output and exit code") {
+        ProcessRequest request;
+        request.program = "/bin/sh";
+        request.arguments = {"-c", "echo out; echo err 1>&2; exit 3"};
+
+        bool finished = false;
+        ProcessResult result;
+        supervisor.launch(request, &supervisor,
+                          [&](const ProcessResult &r) {
+                              result = r;
+                              finished = true;
+                          });
+        REQUIRE(supervisor.numberOfProcesses() == 1);
+
+        QTRY_VERIFY(finished);
+        REQUIRE(result.exitCode == 3);
+        REQUIRE_FALSE(result.succeeded());
+        REQUIRE(result.standardOutput == QByteArray("out\n"));
+        REQUIRE(result.standardError == QByteArray("err\n"));
+        REQUIRE(supervisor.numberOfProcesses() == 0);
+    }
+
+    SECTION("Times out long running processes") {
+        ProcessRequest request;
+        request.program = "/bin/sh";
+        request.arguments = {"-c", "sleep 10"};
+        request.timeout = 100;
+
+        bool finished = false;
+        ProcessResult result;
+        supervisor.launch(request, &supervisor,
+                          [&](const ProcessResult &r) {
+                              result = r;
+                              finished = true;
+                          });
+        QTRY_VERIFY_WITH_TIMEOUT(finished, 5000);
+        REQUIRE(result.timedOut);
+    }
+
+    SECTION("Cancels running processes") {
+        ProcessRequest request;
+        request.program = "/bin/sh";
+        request.arguments = {"-c", "sleep 10"};
+
+        bool finished = false;
+        ProcessResult result;
+        auto id = supervisor.launch(request, &supervisor,
+                                    [&](const ProcessResult &r) {
+                                        result = r;
+                                        finished = true;
+                                    });
+        supervisor.cancel(id);
+        QTRY_VERIFY_WITH_TIMEOUT(finished, 5000);
+        REQUIRE(result.canceled);
+    }
+
+    SECTION("Reports programs that fail to start") {
+        ProcessRequest request;
+        request.program = "/nonexistent/program";
+
+        bool finished = false;
+        ProcessResult result;
+        supervisor.launch(request, &supervisor,
+                          [&](const ProcessResult &r) {
+                              result = r;
+                              finished = true;
+                          });
+        REQUIRE_FALSE(finished);
+        QTRY_VERIFY(finished);
+        REQUIRE(result.failedToStart);
+    }
+}
+#endif
+
+#ifdef Q_OS_UNIX
+// Answers pings and requests on stdin, exiting on any request mentioning
+// "crash"
+static const char *testWorkerScript = R"(
+while IFS= read -r line; do
+  id=$(printf '%s' "$line" | sed -e 's/.*"id":\([0-9]*\).*/\1/')
+  case "$line" in
+    *'"ping"'*) printf '{"id":%s}\n' "$id" ;;
+    *crash*) echo "crashed" 1>&2; exit 1 ;;
+    *) printf 'loading model\n{"id":%s,"result":{"energy":-1.5}}\n' "$id" ;;
+  esac
+done
+)";
+
+TEST_CASE("Calculator worker pool", "[task][process][worker]") {
+    CalculatorWorkerConfig config;
+    config.program = "/bin/sh";
+    config.arguments = {"-c", testWorkerScript};
+    config.maximumWorkers = 2;
+
+    SECTION("Reuses workers across requests") {
+        CalculatorWorkerPool pool(config);
+        std::vector<WorkerResponse> responses;
+        for (int i = 0; i < 5; i++) {
+            pool.submit({{"pair", i}}, &pool, [&](const WorkerResponse &r) {
+                responses.push_back(r);
+            });
+        }
+        REQUIRE(pool.numberOfWorkers() == 2);
+
+        QTRY_COMPARE(responses.size(), size_t(5));
+        for (const auto &response : responses) {
+            REQUIRE(response.succeeded);
+            REQUIRE(response.result["energy"].get<double>() == Approx(-1.5));
+        }
+        REQUIRE(pool.numberOfWorkers() == 2);
+    }
+
+    SECTION("Replaces workers that crash") {
+        CalculatorWorkerPool pool(config);
+        bool crashed = false;
+        WorkerResponse crashResponse;
+        pool.submit({{"action", "crash"}}, &pool, [&](const WorkerResponse &r) {
+            crashResponse = r;
+            crashed = true;
+        });
+        QTRY_VERIFY_WITH_TIMEOUT(crashed, 5000);
+        REQUIRE_FALSE(crashResponse.succeeded);
+        REQUIRE(crashResponse.error.contains("crashed"));
+
+        bool finished = false;
+        WorkerResponse response;
+        pool.submit({{"pair", 0}}, &pool, [&](const WorkerResponse &r) {
+            response = r;
+            finished = true;
+        });
+        QTRY_VERIFY_WITH_TIMEOUT(finished, 5000);
+        REQUIRE(response.succeeded);
+    }
+
+    SECTION("Cancelled requests are not answered") {
+        CalculatorWorkerPool pool(config);
+        bool answered = false;
+        auto id = pool.submit({{"pair", 0}}, &pool,
+                              [&](const WorkerResponse &) { answered = true; });
+        pool.cancel(id);
+        bool finished = false;
+        pool.submit({{"pair", 1}}, &pool,
+                    [&](const WorkerResponse &) { finished = true; });
+        QTRY_VERIFY(finished);
+        REQUIRE_FALSE(answered);
+    }
+}
+#endif
+
 #include "test_task_system.moc"